@@ -1,10 +1,10 @@
 #version 450
 
 layout(location = 0) in vec3 in_position;
-layout(location = 1) in vec3 in_normal;
+// Octahedral normal (xy), tangent angle around the normal / pi (z) and bitangent handedness (w).
+layout(location = 1) in vec4 in_normal_tangent;
 layout(location = 2) in vec2 in_texcoord;
 layout(location = 3) in vec4 in_colour;
-layout(location = 4) in vec4 in_tangent;
 
 
 layout(set = 0, binding = 0) uniform global_uniform_object {
@@ -34,7 +34,28 @@ layout(location = 1) out struct dto {
 	vec4 tangent;
 } out_dto;
 
+// These must match the encoding in geometry_pack_vertices().
+vec3 octahedral_decode(vec2 e) {
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+vec3 decode_tangent(vec3 n, float angle) {
+	float s = n.z >= 0.0 ? 1.0 : -1.0;
+	float a = -1.0 / (s + n.z);
+	float b = n.x * n.y * a;
+	vec3 b1 = vec3(1.0 + s * n.x * n.x * a, s * b, -s * n.x);
+	vec3 b2 = vec3(b, s + n.y * n.y * a, -n.y);
+	return cos(angle) * b1 + sin(angle) * b2;
+}
+
 void main() {
+	vec3 in_normal = octahedral_decode(in_normal_tangent.xy);
+	vec4 in_tangent = vec4(decode_tangent(in_normal, in_normal_tangent.z * 3.14159265358979), in_normal_tangent.w < 0.0 ? -1.0 : 1.0);
+
 	out_dto.tex_coord = in_texcoord;
 	out_dto.colour = in_colour;
 	// Fragment position in world space.
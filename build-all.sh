@@ -34,4 +34,11 @@ then
 echo "Error:"$ERRORLEVEL && exit
 fi
 
+make -f Makefile.klogdecode.linux.mak all
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
 echo "All assemblies built successfully."
\ No newline at end of file
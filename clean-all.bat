@@ -15,4 +15,8 @@ REM Tests
 make -f "Makefile.tests.windows.mak" clean
 IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
 
+REM Binary log decoder
+make -f "Makefile.klogdecode.windows.mak" clean
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
 ECHO "All assemblies cleaned successfully."
\ No newline at end of file
@@ -4,10 +4,14 @@
 #include "logger.h"
 
 #include "platform/platform.h"
+#include "platform/filesystem.h"
 #include "core/kmemory.h"
 #include "core/event.h"
 #include "core/input.h"
 #include "core/clock.h"
+#include "core/frame_pacer.h"
+#include "core/frame_stats.h"
+#include "core/profiler.h"
 #include "core/kstring.h"
 
 #include "memory/linear_allocator.h"
@@ -20,14 +24,41 @@
 #include "systems/geometry_system.h"
 #include "systems/resource_system.h"
 #include "systems/shader_system.h"
+#include "systems/job_system.h"
 
 // TODO: temp
 #include "math/kmath.h"
 #include "math/transform.h"
 #include "math/geometry_utils.h"
+#include "math/kernels.h"
 #include "containers/darray.h"
 // TODO: end temp
 
+// The number of frames held for frame statistics outside of benchmark mode.
+#define APPLICATION_FRAME_STATS_WINDOW 1024
+// The number of frames run before benchmark frames are recorded, so one-time costs are excluded.
+#define APPLICATION_BENCHMARK_WARMUP_FRAMES 8
+// The fixed delta time of benchmark frames, so every run follows the same path.
+#define APPLICATION_BENCHMARK_DELTA_TIME (1.0 / 60.0)
+// The number of frames rendered on demand after each change. More than one, as the game
+// may act on some changes a frame late, and a resize is only completed by the following frame.
+#define APPLICATION_REDRAW_FRAME_COUNT 3
+// The longest the loop blocks while idle, so work without platform messages, such as
+// file reads, is still noticed.
+#define APPLICATION_IDLE_WAIT_TIMEOUT 0.1
+// The maximum number of startup phases which can be timed.
+#define APPLICATION_STARTUP_PHASE_MAX 32
+// The number of meshes imported on job threads during startup.
+#define APPLICATION_STARTUP_MESH_COUNT 2
+
+/** @brief The time taken by a phase of startup. */
+typedef struct startup_phase {
+    const char* name;
+    f64 seconds;
+    /** @brief Set for work done on a job thread, which overlaps the main thread's phases. */
+    b8 background;
+} startup_phase;
+
 typedef struct application_state {
     game* game_inst;
     b8 is_running;
@@ -36,6 +67,21 @@ typedef struct application_state {
     i16 height;
     clock clock;
     f64 last_time;
+    frame_pacer frame_pacer;
+    frame_stats frame_stats;
+    /** @brief The number of frames run in benchmark mode so far, including warm-up frames. */
+    u32 benchmark_frames_run;
+    /** @brief The number of frames still to be rendered when rendering on demand. */
+    u32 redraw_frames_remaining;
+    /** @brief Set while rendering on demand has skipped frames, so timing restarts when resuming. */
+    b8 is_idle;
+
+    // Startup timing, reported once the first frame has been rendered.
+    f64 startup_begin_time;
+    f64 startup_phase_begin_time;
+    u32 startup_phase_count;
+    startup_phase startup_phases[APPLICATION_STARTUP_PHASE_MAX];
+    b8 startup_reported;
     linear_allocator systems_allocator;
 
     u64 event_system_memory_requirement;
@@ -50,6 +96,15 @@ typedef struct application_state {
     u64 platform_system_memory_requirement;
     void* platform_system_state;
 
+    u64 profiler_memory_requirement;
+    void* profiler_state;
+
+    u64 job_system_memory_requirement;
+    void* job_system_state;
+
+    u64 filesystem_async_memory_requirement;
+    void* filesystem_async_state;
+
     u64 resource_system_memory_requirement;
     void* resource_system_state;
 
@@ -73,6 +128,11 @@ typedef struct application_state {
     u32 mesh_count;
 
     geometry* test_ui_geometry;
+
+    // Meshes loaded during startup, to be uploaded by the main thread, and where they are placed.
+    resource_load_request startup_mesh_loads[APPLICATION_STARTUP_MESH_COUNT];
+    transform startup_mesh_transforms[APPLICATION_STARTUP_MESH_COUNT];
+    resource_load_batch startup_mesh_batch;
     // TODO: end temp
 
 } application_state;
@@ -83,6 +143,7 @@ static application_state* app_state;
 b8 application_on_event(u16 code, void* sender, void* listener_inst, event_context context);
 b8 application_on_key(u16 code, void* sender, void* listener_inst, event_context context);
 b8 application_on_resized(u16 code, void* sender, void* listener_inst, event_context context);
+b8 application_on_activity(u16 code, void* sender, void* listener_inst, event_context context);
 
 // TODO: temp
 b8 event_on_debug_event(u16 code, void* sender, void* listener_inst, event_context data) {
@@ -116,12 +177,132 @@ b8 event_on_debug_event(u16 code, void* sender, void* listener_inst, event_conte
 }
 // TODO: end temp
 
+b8 application_parse_arguments(application_config* config, i32 argc, char** argv) {
+    for (i32 i = 1; i < argc; ++i) {
+        if (strings_equal(argv[i], "--benchmark")) {
+            if (i + 1 >= argc || !string_to_u32(argv[i + 1], &config->benchmark_frame_count) || config->benchmark_frame_count == 0) {
+                KERROR("--benchmark requires a frame count greater than 0.");
+                return false;
+            }
+            i++;
+        } else if (strings_equal(argv[i], "--benchmark-output")) {
+            if (i + 1 >= argc) {
+                KERROR("--benchmark-output requires a path.");
+                return false;
+            }
+            config->benchmark_output_path = argv[i + 1];
+            i++;
+        } else if (strings_equal(argv[i], "--render-on-demand")) {
+            config->render_on_demand = true;
+        }
+    }
+    return true;
+}
+
+b8 application_benchmark_progress(f32* out_progress) {
+    u32 frame_count = app_state->game_inst->app_config.benchmark_frame_count;
+    if (frame_count == 0) {
+        return false;
+    }
+    i64 frame = (i64)app_state->benchmark_frames_run - APPLICATION_BENCHMARK_WARMUP_FRAMES;
+    if (frame < 0) {
+        frame = 0;
+    }
+    *out_progress = frame_count > 1 ? (f32)frame / (f32)(frame_count - 1) : 0.0f;
+    if (*out_progress > 1.0f) {
+        *out_progress = 1.0f;
+    }
+    return true;
+}
+
+void application_request_redraw() {
+    app_state->redraw_frames_remaining = APPLICATION_REDRAW_FRAME_COUNT;
+}
+
+b8 application_can_idle(const application_idle_state* state) {
+    if (!state->render_on_demand || state->benchmarking) {
+        return false;
+    }
+    return state->suspended || (state->redraw_frames_remaining == 0 && !state->input_active);
+}
+
+/**
+ * @brief Indicates if the current frame can be skipped when rendering on demand. Held keys
+ * and buttons count as change, as they usually drive movement, as does replaying an input journal.
+ */
+static b8 can_idle_now() {
+    application_idle_state state;
+    state.render_on_demand = app_state->game_inst->app_config.render_on_demand;
+    state.benchmarking = app_state->game_inst->app_config.benchmark_frame_count > 0;
+    state.suspended = app_state->is_suspended;
+    state.redraw_frames_remaining = app_state->redraw_frames_remaining;
+    state.input_active = input_is_any_down() || input_journal_is_replaying();
+    return application_can_idle(&state);
+}
+
+static void startup_phase_record(const char* name, f64 seconds, b8 background) {
+    if (app_state->startup_phase_count < APPLICATION_STARTUP_PHASE_MAX) {
+        startup_phase* phase = &app_state->startup_phases[app_state->startup_phase_count++];
+        phase->name = name;
+        phase->seconds = seconds;
+        phase->background = background;
+    }
+}
+
+/** @brief Ends the current phase of startup on the main thread, and begins the next. */
+static void startup_phase_end(const char* name) {
+    // Move on any file reads started during startup, so they overlap the phases which follow.
+    filesystem_async_pump();
+    f64 now = platform_get_absolute_time();
+    startup_phase_record(name, now - app_state->startup_phase_begin_time, false);
+    app_state->startup_phase_begin_time = now;
+}
+
+static void startup_report() {
+    f64 total = platform_get_absolute_time() - app_state->startup_begin_time;
+    KINFO("Time to first frame: %.2fms.", total * 1000.0);
+    for (u32 i = 0; i < app_state->startup_phase_count; ++i) {
+        startup_phase* phase = &app_state->startup_phases[i];
+        KINFO("  %-32s %9.2fms%s", phase->name, phase->seconds * 1000.0, phase->background ? " (job thread)" : "");
+    }
+    app_state->startup_reported = true;
+}
+
+static void log_frame_stats() {
+    for (u32 i = 0; i < FRAME_STAT_METRIC_COUNT; ++i) {
+        frame_stat_summary s;
+        if (frame_stats_summarize(&app_state->frame_stats, i, &s)) {
+            KINFO("Frame stats (%s, last %u samples): min %.3fms, avg %.3fms, p50 %.3fms, p95 %.3fms, p99 %.3fms, max %.3fms.",
+                  frame_stats_metric_name(i), s.sample_count,
+                  s.min * 1000.0, s.avg * 1000.0, s.p50 * 1000.0, s.p95 * 1000.0, s.p99 * 1000.0, s.max * 1000.0);
+        }
+    }
+}
+
+static void write_benchmark_summary() {
+    const char* base_path = app_state->game_inst->app_config.benchmark_output_path;
+    if (!base_path || !base_path[0]) {
+        base_path = "benchmark";
+    }
+    char path[512];
+    string_format(path, "%s.csv", base_path);
+    b8 written = frame_stats_write_csv(&app_state->frame_stats, path);
+    string_format(path, "%s.json", base_path);
+    written = frame_stats_write_json(&app_state->frame_stats, path) && written;
+    if (written) {
+        KINFO("Benchmark summary of %llu frames written to '%s.csv' and '%s.json'.", app_state->frame_stats.total_frame_count, base_path, base_path);
+    }
+}
+
 b8 application_create(game* game_inst) {
     if (game_inst->application_state) {
         KERROR("application_create called more than once.");
         return false;
     }
 
+    // Startup is timed from here. Phases are ended once the application state exists.
+    f64 startup_begin_time = platform_get_absolute_time();
+
     // Memory system must be the first thing to be stood up.
     memory_system_configuration memory_system_config = {};
     memory_system_config.total_alloc_size = GIBIBYTES(1);
@@ -139,6 +320,8 @@ b8 application_create(game* game_inst) {
     app_state->game_inst = game_inst;
     app_state->is_running = false;
     app_state->is_suspended = false;
+    app_state->startup_begin_time = startup_begin_time;
+    app_state->startup_phase_begin_time = startup_begin_time;
 
     // Create a linear allocator for all systems (except memory) to use.
     u64 systems_allocator_total_size = 64 * 1024 * 1024;  // 64 mb
@@ -158,13 +341,37 @@ b8 application_create(game* game_inst) {
         KERROR("Failed to initialize logging system; shutting down.");
         return false;
     }
+    startup_phase_end("Memory, events and logging");
+
+    // Select the optimized kernels for this CPU.
+    kernels_initialize();
+
+    // Profiler. Started before any threads, so they can all be profiled.
+    profiler_config profiler_cfg;
+    profiler_cfg.events_per_thread = 16384;
+    profiler_cfg.max_thread_count = 16;
+    profiler_initialize(&app_state->profiler_memory_requirement, 0, profiler_cfg);
+    app_state->profiler_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->profiler_memory_requirement);
+    if (!profiler_initialize(&app_state->profiler_memory_requirement, app_state->profiler_state, profiler_cfg)) {
+        KERROR("Failed to initialize profiler; shutting down.");
+        return false;
+    }
+    startup_phase_end("Kernels and profiler");
 
     // Input
     input_system_initialize(&app_state->input_system_memory_requirement, 0);
     app_state->input_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->input_system_memory_requirement);
     input_system_initialize(&app_state->input_system_memory_requirement, app_state->input_system_state);
 
-    // Register for engine-level events.
+    // Register for engine-level events. Activity is registered first, so it sees
+    // events even if they are handled by a later listener.
+    event_register(EVENT_CODE_KEY_PRESSED, 0, application_on_activity);
+    event_register(EVENT_CODE_KEY_RELEASED, 0, application_on_activity);
+    event_register(EVENT_CODE_BUTTON_PRESSED, 0, application_on_activity);
+    event_register(EVENT_CODE_BUTTON_RELEASED, 0, application_on_activity);
+    event_register(EVENT_CODE_MOUSE_MOVED, 0, application_on_activity);
+    event_register(EVENT_CODE_MOUSE_WHEEL, 0, application_on_activity);
+    event_register(EVENT_CODE_RESIZED, 0, application_on_activity);
     event_register(EVENT_CODE_APPLICATION_QUIT, 0, application_on_event);
     event_register(EVENT_CODE_KEY_PRESSED, 0, application_on_key);
     event_register(EVENT_CODE_KEY_RELEASED, 0, application_on_key);
@@ -174,7 +381,7 @@ b8 application_create(game* game_inst) {
     // TODO: end temp
 
     // Platform
-    platform_system_startup(&app_state->platform_system_memory_requirement, 0, 0, 0, 0, 0, 0);
+    platform_system_startup(&app_state->platform_system_memory_requirement, 0, 0, 0, 0, 0, 0, false);
     app_state->platform_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->platform_system_memory_requirement);
     if (!platform_system_startup(
             &app_state->platform_system_memory_requirement,
@@ -183,9 +390,35 @@ b8 application_create(game* game_inst) {
             game_inst->app_config.start_pos_x,
             game_inst->app_config.start_pos_y,
             game_inst->app_config.start_width,
-            game_inst->app_config.start_height)) {
+            game_inst->app_config.start_height,
+            game_inst->app_config.headless)) {
         return false;
     }
+    startup_phase_end("Input and platform");
+
+    // Job system
+    job_system_config job_sys_config;
+    job_sys_config.worker_count = 0;  // One per core.
+    job_system_initialize(&app_state->job_system_memory_requirement, 0, job_sys_config);
+    app_state->job_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->job_system_memory_requirement);
+    if (!job_system_initialize(&app_state->job_system_memory_requirement, app_state->job_system_state, job_sys_config)) {
+        KFATAL("Failed to initialize job system. Aborting application.");
+        return false;
+    }
+    startup_phase_end("Job system");
+
+    // Asynchronous file reads
+    filesystem_async_config filesystem_async_config;
+    filesystem_async_config.max_requests = 256;
+    filesystem_async_config.worker_thread_count = 0;  // Default.
+    filesystem_async_config.force_worker_threads = false;
+    filesystem_async_initialize(&app_state->filesystem_async_memory_requirement, 0, filesystem_async_config);
+    app_state->filesystem_async_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->filesystem_async_memory_requirement);
+    if (!filesystem_async_initialize(&app_state->filesystem_async_memory_requirement, app_state->filesystem_async_state, filesystem_async_config)) {
+        KFATAL("Failed to initialize asynchronous file reads. Aborting application.");
+        return false;
+    }
+    startup_phase_end("Async file reads");
 
     // Resource system.
     resource_system_config resource_sys_config;
@@ -197,6 +430,22 @@ b8 application_create(game* game_inst) {
         KFATAL("Failed to initialize resource system. Aborting application.");
         return false;
     }
+    startup_phase_end("Resource system");
+
+    // TODO: temp
+    // Mesh files are read asynchronously and parsed on job threads while the main thread stands
+    // up the renderer and the systems which depend on it. Uploads happen on the main thread later.
+    app_state->startup_mesh_loads[0].name = "falcon";
+    app_state->startup_mesh_transforms[0] = transform_from_position((vec3){15.0f, 0.0f, 1.0f});
+    app_state->startup_mesh_loads[1].name = "sponza";
+    app_state->startup_mesh_transforms[1] = transform_from_position_rotation_scale((vec3){15.0f, 0.0f, 1.0f}, quat_identity(), (vec3){0.05f, 0.05f, 0.05f});
+    for (u32 i = 0; i < APPLICATION_STARTUP_MESH_COUNT; ++i) {
+        app_state->startup_mesh_loads[i].type = RESOURCE_TYPE_MESH;
+    }
+    app_state->startup_mesh_batch.count = APPLICATION_STARTUP_MESH_COUNT;
+    app_state->startup_mesh_batch.requests = app_state->startup_mesh_loads;
+    resource_system_load_batch_begin(&app_state->startup_mesh_batch);
+    // TODO: end temp
 
     // Shader system
     shader_system_config shader_sys_config;
@@ -210,14 +459,20 @@ b8 application_create(game* game_inst) {
         KFATAL("Failed to initialize shader system. Aborting application.");
         return false;
     }
+    startup_phase_end("Shader system");
 
     // Renderer system
-    renderer_system_initialize(&app_state->renderer_system_memory_requirement, 0, 0);
+    renderer_system_config renderer_sys_config;
+    renderer_sys_config.application_name = game_inst->app_config.name;
+    renderer_sys_config.present_mode = game_inst->app_config.present_mode;
+    renderer_sys_config.backend_type = game_inst->app_config.renderer_backend;
+    renderer_system_initialize(&app_state->renderer_system_memory_requirement, 0, renderer_sys_config);
     app_state->renderer_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->renderer_system_memory_requirement);
-    if (!renderer_system_initialize(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, game_inst->app_config.name)) {
+    if (!renderer_system_initialize(&app_state->renderer_system_memory_requirement, app_state->renderer_system_state, renderer_sys_config)) {
         KFATAL("Failed to initialize renderer. Aborting application.");
         return false;
     }
+    startup_phase_end("Renderer and builtin shaders");
 
     // Texture system.
     texture_system_config texture_sys_config;
@@ -228,6 +483,7 @@ b8 application_create(game* game_inst) {
         KFATAL("Failed to initialize texture system. Application cannot continue.");
         return false;
     }
+    startup_phase_end("Texture system and defaults");
 
     // Material system.
     material_system_config material_sys_config;
@@ -238,16 +494,24 @@ b8 application_create(game* game_inst) {
         KFATAL("Failed to initialize material system. Application cannot continue.");
         return false;
     }
+    startup_phase_end("Material system");
 
     // Geometry system.
     geometry_system_config geometry_sys_config;
     geometry_sys_config.max_geometry_count = 4096;
+    // Each coarser level takes over when the projected size halves.
+    geometry_sys_config.lod_screen_sizes[0] = 0.5f;
+    geometry_sys_config.lod_screen_sizes[1] = 0.25f;
+    geometry_sys_config.lod_screen_sizes[2] = 0.125f;
+    geometry_sys_config.lod_screen_sizes[3] = 0.0625f;
+    geometry_sys_config.lod_hysteresis = 0.1f;
     geometry_system_initialize(&app_state->geometry_system_memory_requirement, 0, geometry_sys_config);
     app_state->geometry_system_state = linear_allocator_allocate(&app_state->systems_allocator, app_state->geometry_system_memory_requirement);
     if (!geometry_system_initialize(&app_state->geometry_system_memory_requirement, app_state->geometry_system_state, geometry_sys_config)) {
         KFATAL("Failed to initialize geometry system. Application cannot continue.");
         return false;
     }
+    startup_phase_end("Geometry system");
 
     // TODO: temp
     app_state->mesh_count = 0;
@@ -256,6 +520,7 @@ b8 application_create(game* game_inst) {
     mesh* cube_mesh = &app_state->meshes[app_state->mesh_count];
     cube_mesh->geometry_count = 1;
     cube_mesh->geometries = kallocate(sizeof(mesh*) * cube_mesh->geometry_count, MEMORY_TAG_ARRAY);
+    cube_mesh->geometry_lods = kallocate(sizeof(u8) * cube_mesh->geometry_count, MEMORY_TAG_ARRAY);
     geometry_config g_config = geometry_system_generate_cube_config(10.0f, 10.0f, 10.0f, 1.0f, 1.0f, "test_cube", "test_material");
     cube_mesh->geometries[0] = geometry_system_acquire_from_config(g_config, true);
     cube_mesh->transform = transform_create();
@@ -267,6 +532,7 @@ b8 application_create(game* game_inst) {
     mesh* cube_mesh_2 = &app_state->meshes[app_state->mesh_count];
     cube_mesh_2->geometry_count = 1;
     cube_mesh_2->geometries = kallocate(sizeof(mesh*) * cube_mesh_2->geometry_count, MEMORY_TAG_ARRAY);
+    cube_mesh_2->geometry_lods = kallocate(sizeof(u8) * cube_mesh_2->geometry_count, MEMORY_TAG_ARRAY);
     g_config = geometry_system_generate_cube_config(5.0f, 5.0f, 5.0f, 1.0f, 1.0f, "test_cube_2", "test_material");
     cube_mesh_2->geometries[0] = geometry_system_acquire_from_config(g_config, true);
     cube_mesh_2->transform = transform_from_position((vec3){10.0f, 0.0f, 1.0f});
@@ -280,6 +546,7 @@ b8 application_create(game* game_inst) {
     mesh* cube_mesh_3 = &app_state->meshes[app_state->mesh_count];
     cube_mesh_3->geometry_count = 1;
     cube_mesh_3->geometries = kallocate(sizeof(mesh*) * cube_mesh_3->geometry_count, MEMORY_TAG_ARRAY);
+    cube_mesh_3->geometry_lods = kallocate(sizeof(u8) * cube_mesh_3->geometry_count, MEMORY_TAG_ARRAY);
     g_config = geometry_system_generate_cube_config(2.0f, 2.0f, 2.0f, 1.0f, 1.0f, "test_cube_2", "test_material");
     cube_mesh_3->geometries[0] = geometry_system_acquire_from_config(g_config, true);
     cube_mesh_3->transform = transform_from_position((vec3){5.0f, 0.0f, 1.0f});
@@ -289,45 +556,11 @@ b8 application_create(game* game_inst) {
     // Clean up the allocations for the geometry config.
     geometry_system_config_dispose(&g_config);
 
-    // Test mesh loaded from file.
-    mesh* car_mesh = &app_state->meshes[app_state->mesh_count];
-    resource car_mesh_resource = {};
-    if (!resource_system_load("falcon", RESOURCE_TYPE_MESH, &car_mesh_resource)) {
-        KERROR("Failed to load car test mesh!");
-    } else {
-        geometry_config* configs = (geometry_config*)car_mesh_resource.data;
-        car_mesh->geometry_count = car_mesh_resource.data_size;
-        car_mesh->geometries = kallocate(sizeof(geometry*) * car_mesh->geometry_count, MEMORY_TAG_ARRAY);
-        for (u32 i = 0; i < car_mesh->geometry_count; ++i) {
-            car_mesh->geometries[i] = geometry_system_acquire_from_config(configs[i], true);
-        }
-        car_mesh->transform = transform_from_position((vec3){15.0f, 0.0f, 1.0f});
-        resource_system_unload(&car_mesh_resource);
-        app_state->mesh_count++;
-    }
-
-    // Test mesh loaded from file.
-    mesh* sponza_mesh = &app_state->meshes[app_state->mesh_count];
-    resource sponza_mesh_resource = {};
-    if (!resource_system_load("sponza", RESOURCE_TYPE_MESH, &sponza_mesh_resource)) {
-        KERROR("Failed to load sponza mesh!");
-    } else {
-        geometry_config* sponza_configs = (geometry_config*)sponza_mesh_resource.data;
-        sponza_mesh->geometry_count = sponza_mesh_resource.data_size;
-        sponza_mesh->geometries = kallocate(sizeof(mesh*) * sponza_mesh->geometry_count, MEMORY_TAG_ARRAY);
-        for (u32 i = 0; i < sponza_mesh->geometry_count; ++i) {
-            sponza_mesh->geometries[i] = geometry_system_acquire_from_config(sponza_configs[i], true);
-        }
-        sponza_mesh->transform = transform_from_position_rotation_scale((vec3){15.0f, 0.0f, 1.0f}, quat_identity(), (vec3){0.05f, 0.05f, 0.05f});
-        resource_system_unload(&sponza_mesh_resource);
-        app_state->mesh_count++;
-    }
-
     // Load up some test UI geometry.
-    geometry_config ui_config;
+    geometry_config ui_config = {};
     ui_config.vertex_size = sizeof(vertex_2d);
     ui_config.vertex_count = 4;
-    ui_config.index_size = sizeof(u32);
+    ui_config.index_size = sizeof(u16);
     ui_config.index_count = 6;
     string_ncopy(ui_config.material_name, "test_ui_material", MATERIAL_NAME_MAX_LENGTH);
     string_ncopy(ui_config.name, "test_ui_geometry", GEOMETRY_NAME_MAX_LENGTH);
@@ -357,11 +590,66 @@ b8 application_create(game* game_inst) {
     ui_config.vertices = uiverts;
 
     // Indices - counter-clockwise
-    u32 uiindices[6] = {2, 1, 0, 3, 0, 1};
+    u16 uiindices[6] = {2, 1, 0, 3, 0, 1};
     ui_config.indices = uiindices;
 
     // Get UI geometry from config.
     app_state->test_ui_geometry = geometry_system_acquire_from_config(ui_config, true);
+    startup_phase_end("Test geometry");
+
+    // Test meshes loaded from file. Their loads were started earlier, so may well be done.
+    resource_system_load_batch_end(&app_state->startup_mesh_batch);
+    startup_phase_end("Wait for mesh import");
+
+    // Decode the textures of every material used in parallel, so only uploads are left.
+    u32 material_name_capacity = 0;
+    for (u32 i = 0; i < APPLICATION_STARTUP_MESH_COUNT; ++i) {
+        resource_load_request* load = &app_state->startup_mesh_loads[i];
+        startup_phase_record(load->name, load->seconds, true);
+        if (load->loaded) {
+            material_name_capacity += load->resource.data_size;
+        }
+    }
+    if (material_name_capacity > 0) {
+        const char** material_names = kallocate(sizeof(const char*) * material_name_capacity, MEMORY_TAG_ARRAY);
+        u32 material_name_count = 0;
+        for (u32 i = 0; i < APPLICATION_STARTUP_MESH_COUNT; ++i) {
+            resource_load_request* load = &app_state->startup_mesh_loads[i];
+            geometry_config* configs = load->loaded ? (geometry_config*)load->resource.data : 0;
+            for (u32 j = 0; load->loaded && j < load->resource.data_size; ++j) {
+                b8 duplicate = configs[j].material_name[0] == 0;
+                for (u32 k = 0; k < material_name_count && !duplicate; ++k) {
+                    duplicate = strings_equali(material_names[k], configs[j].material_name);
+                }
+                if (!duplicate) {
+                    material_names[material_name_count++] = configs[j].material_name;
+                }
+            }
+        }
+        material_system_prefetch(material_name_count, material_names);
+        kfree(material_names, sizeof(const char*) * material_name_capacity, MEMORY_TAG_ARRAY);
+    }
+    startup_phase_end("Material and texture decode");
+
+    for (u32 i = 0; i < APPLICATION_STARTUP_MESH_COUNT; ++i) {
+        resource_load_request* load = &app_state->startup_mesh_loads[i];
+        if (!load->loaded) {
+            KERROR("Failed to load mesh '%s'!", load->name);
+            continue;
+        }
+        mesh* m = &app_state->meshes[app_state->mesh_count];
+        geometry_config* configs = (geometry_config*)load->resource.data;
+        m->geometry_count = load->resource.data_size;
+        m->geometries = kallocate(sizeof(geometry*) * m->geometry_count, MEMORY_TAG_ARRAY);
+        m->geometry_lods = kallocate(sizeof(u8) * m->geometry_count, MEMORY_TAG_ARRAY);
+        for (u32 j = 0; j < m->geometry_count; ++j) {
+            m->geometries[j] = geometry_system_acquire_from_config(configs[j], true);
+        }
+        m->transform = app_state->startup_mesh_transforms[i];
+        resource_system_unload(&load->resource);
+        app_state->mesh_count++;
+    }
+    startup_phase_end("Mesh and texture upload");
 
     // Load up default geometry.
     // app_state->test_geometry = geometry_system_get_default();
@@ -372,6 +660,7 @@ b8 application_create(game* game_inst) {
         KFATAL("Game failed to initialize.");
         return false;
     }
+    startup_phase_end("Game initialize");
 
     // Call resize once to ensure the proper size has been set.
     app_state->game_inst->on_resize(app_state->game_inst, app_state->width, app_state->height);
@@ -384,40 +673,104 @@ b8 application_run() {
     clock_start(&app_state->clock);
     clock_update(&app_state->clock);
     app_state->last_time = app_state->clock.elapsed;
-    // f64 running_time = 0;
-    u8 frame_count = 0;
-    f64 target_frame_seconds = 1.0f / 60;
+
+    u32 benchmark_frame_count = app_state->game_inst->app_config.benchmark_frame_count;
+    if (benchmark_frame_count > 0) {
+        // Benchmark frames are unpaced, and the window holds every recorded frame.
+        KINFO("Benchmark mode: running %u frames.", benchmark_frame_count);
+        frame_pacer_create(0, &app_state->frame_pacer);
+        frame_stats_create(benchmark_frame_count, &app_state->frame_stats);
+    } else {
+        frame_pacer_create(app_state->game_inst->app_config.target_frame_rate, &app_state->frame_pacer);
+        frame_stats_create(APPLICATION_FRAME_STATS_WINDOW, &app_state->frame_stats);
+    }
+    // Always render the first frames, even when rendering on demand.
+    application_request_redraw();
 
     KINFO(get_memory_usage_str());
 
     while (app_state->is_running) {
-        if (!platform_pump_messages()) {
-            app_state->is_running = false;
+        profiler_frame_mark();
+        PROFILE_SCOPE("Frame");
+        f64 frame_start_time = platform_get_absolute_time();
+
+        {
+            PROFILE_SCOPE("Pump messages");
+            if (!platform_pump_messages()) {
+                app_state->is_running = false;
+            }
+        }
+
+        // When rendering on demand and nothing has changed, skip the frame and block
+        // until something may have. Any platform message counts, e.g. an exposed window.
+        if (can_idle_now()) {
+            PROFILE_SCOPE("Idle wait");
+            app_state->is_idle = true;
+            if (!app_state->is_suspended && filesystem_async_pump() > 0) {
+                application_request_redraw();
+            } else if (platform_wait_messages(APPLICATION_IDLE_WAIT_TIMEOUT)) {
+                application_request_redraw();
+            }
+            continue;
         }
 
         if (!app_state->is_suspended) {
             // Update clock and get delta time.
             clock_update(&app_state->clock);
+            if (app_state->is_idle) {
+                // Resume as if the idle time never happened, rather than with one long frame.
+                app_state->is_idle = false;
+                app_state->last_time = app_state->clock.elapsed;
+                frame_pacer_restart(&app_state->frame_pacer);
+            }
             f64 current_time = app_state->clock.elapsed;
             f64 delta = (current_time - app_state->last_time);
-            f64 frame_start_time = platform_get_absolute_time();
+            if (benchmark_frame_count > 0) {
+                delta = APPLICATION_BENCHMARK_DELTA_TIME;
+            }
+            // When replaying an input journal, use the recorded delta so the run is reproduced exactly.
+            f64 replay_delta = 0;
+            if (input_journal_frame_delta(&replay_delta)) {
+                delta = replay_delta;
+            }
+            // Start follow-up work for outstanding file reads, and run the callbacks of completed ones.
+            {
+                PROFILE_SCOPE("Async file reads");
+                if (filesystem_async_pump() > 0) {
+                    // Completed reads may have changed resources.
+                    application_request_redraw();
+                }
+            }
 
-            if (!app_state->game_inst->update(app_state->game_inst, (f32)delta)) {
-                KFATAL("Game update failed, shutting down.");
-                app_state->is_running = false;
-                break;
+            f64 update_start_time = platform_get_absolute_time();
+            {
+                PROFILE_SCOPE("Game update");
+                if (!app_state->game_inst->update(app_state->game_inst, (f32)delta)) {
+                    KFATAL("Game update failed, shutting down.");
+                    app_state->is_running = false;
+                    break;
+                }
             }
 
+            f64 render_start_time = platform_get_absolute_time();
+
             // Call the game's render routine.
-            if (!app_state->game_inst->render(app_state->game_inst, (f32)delta)) {
-                KFATAL("Game render failed, shutting down.");
-                app_state->is_running = false;
-                break;
+            {
+                PROFILE_SCOPE("Game render");
+                if (!app_state->game_inst->render(app_state->game_inst, (f32)delta)) {
+                    KFATAL("Game render failed, shutting down.");
+                    app_state->is_running = false;
+                    break;
+                }
             }
 
             // TODO: refactor packet creation
             render_packet packet = {};
             packet.delta_time = delta;
+            // The latest input pumped since the last frame, if any, to measure its latency.
+            if (!input_take_event_time(&packet.input_time)) {
+                packet.input_time = 0;
+            }
             packet.geometry_count = 0;
 
             // NOTE: Yes, I know this allocates/frees every framr. No, it doesn't matter because
@@ -439,6 +792,9 @@ b8 application_run() {
                     transform_rotate(&app_state->meshes[2].transform, rotation);
                 }
 
+                // The rotation is an animation, so keeps frames coming when rendering on demand.
+                application_request_redraw();
+
                 // Iterate all meshes and add them to the packet's geometries collection
                 for (u32 i = 0; i < app_state->mesh_count; ++i) {
                     mesh* m = &app_state->meshes[i];
@@ -446,6 +802,11 @@ b8 application_run() {
                         geometry_render_data data;
                         data.geometry = m->geometries[j];
                         data.model = transform_get_world(&m->transform);
+                        // Picked by the renderer, from the projected size.
+                        data.lod = 0;
+                        data.previous_lod = &m->geometry_lods[j];
+                        data.index_offset = 0;
+                        data.index_count = 0;
                         darray_push(packet.geometries, data);
                         packet.geometry_count++;
                     }
@@ -455,11 +816,19 @@ b8 application_run() {
             geometry_render_data test_ui_render;
             test_ui_render.geometry = app_state->test_ui_geometry;
             test_ui_render.model = mat4_translation((vec3){0, 0, 0});
+            test_ui_render.lod = 0;
+            test_ui_render.previous_lod = 0;
+            test_ui_render.index_offset = 0;
+            test_ui_render.index_count = 0;
             packet.ui_geometry_count = 1;
             packet.ui_geometries = &test_ui_render;
             // TODO: end temp
 
             renderer_draw_frame(&packet);
+            if (!app_state->startup_reported) {
+                startup_phase_end("First frame");
+                startup_report();
+            }
 
             // TODO: temp
             // Cleanup the packet.
@@ -469,22 +838,37 @@ b8 application_run() {
             }
             // TODO: end temp
 
-            // Figure out how long the frame took and, if below
-            f64 frame_end_time = platform_get_absolute_time();
-            f64 frame_elapsed_time = frame_end_time - frame_start_time;
-            // running_time += frame_elapsed_time;
-            f64 remaining_seconds = target_frame_seconds - frame_elapsed_time;
-
-            if (remaining_seconds > 0) {
-                u64 remaining_ms = (remaining_seconds * 1000);
+            if (app_state->redraw_frames_remaining > 0) {
+                app_state->redraw_frames_remaining--;
+            }
 
-                // If there is time left, give it back to the OS.
-                b8 limit_frames = false;
-                if (remaining_ms > 0 && limit_frames) {
-                    platform_sleep(remaining_ms - 1);
+            f64 frame_end_time = platform_get_absolute_time();
+            if (benchmark_frame_count == 0 || app_state->benchmark_frames_run >= APPLICATION_BENCHMARK_WARMUP_FRAMES) {
+                frame_stats_record(
+                    &app_state->frame_stats,
+                    frame_end_time - frame_start_time,
+                    render_start_time - update_start_time,
+                    frame_end_time - render_start_time);
+
+                f64 latency;
+                if (renderer_present_latency_get(&latency)) {
+                    frame_stats_record_sample(&app_state->frame_stats, FRAME_STAT_METRIC_INPUT_TO_PRESENT, latency);
+                }
+                while (renderer_display_latency_take(&latency)) {
+                    frame_stats_record_sample(&app_state->frame_stats, FRAME_STAT_METRIC_INPUT_TO_DISPLAY, latency);
                 }
+            }
+            if (benchmark_frame_count > 0) {
+                app_state->benchmark_frames_run++;
+                if (app_state->benchmark_frames_run >= benchmark_frame_count + APPLICATION_BENCHMARK_WARMUP_FRAMES) {
+                    app_state->is_running = false;
+                }
+            }
 
-                frame_count++;
+            // Hold the loop to the target frame rate, giving any time left back to the OS.
+            {
+                PROFILE_SCOPE("Frame pacing wait");
+                frame_pacer_wait(&app_state->frame_pacer);
             }
 
             // NOTE: Input update/state copying should always be handled
@@ -500,14 +884,46 @@ b8 application_run() {
 
     app_state->is_running = false;
 
+    frame_pacing_stats* pacing = &app_state->frame_pacer.stats;
+    if (pacing->paced_frame_count > 0 || pacing->missed_frame_count > 0) {
+        KINFO("Frame pacing: %llu frames paced, %llu missed, error avg %.3fms, max %.3fms.",
+              pacing->paced_frame_count,
+              pacing->missed_frame_count,
+              frame_pacer_average_error(&app_state->frame_pacer) * 1000.0,
+              pacing->max_absolute_error * 1000.0);
+    }
+
+    log_frame_stats();
+    if (benchmark_frame_count > 0) {
+        write_benchmark_summary();
+    }
+    frame_stats_destroy(&app_state->frame_stats);
+
     // Shutdown event system.
     event_unregister(EVENT_CODE_APPLICATION_QUIT, 0, application_on_event);
     event_unregister(EVENT_CODE_KEY_PRESSED, 0, application_on_key);
     event_unregister(EVENT_CODE_KEY_RELEASED, 0, application_on_key);
+    event_unregister(EVENT_CODE_KEY_PRESSED, 0, application_on_activity);
+    event_unregister(EVENT_CODE_KEY_RELEASED, 0, application_on_activity);
+    event_unregister(EVENT_CODE_BUTTON_PRESSED, 0, application_on_activity);
+    event_unregister(EVENT_CODE_BUTTON_RELEASED, 0, application_on_activity);
+    event_unregister(EVENT_CODE_MOUSE_MOVED, 0, application_on_activity);
+    event_unregister(EVENT_CODE_MOUSE_WHEEL, 0, application_on_activity);
+    event_unregister(EVENT_CODE_RESIZED, 0, application_on_activity);
     // TODO: temp
     event_unregister(EVENT_CODE_DEBUG0, 0, event_on_debug_event);
     // TODO: end temp
 
+    // Free the test meshes. Their geometries are released along with the geometry system.
+    for (u32 i = 0; i < app_state->mesh_count; ++i) {
+        mesh* m = &app_state->meshes[i];
+        kfree(m->geometries, sizeof(geometry*) * m->geometry_count, MEMORY_TAG_ARRAY);
+        kfree(m->geometry_lods, sizeof(u8) * m->geometry_count, MEMORY_TAG_ARRAY);
+        m->geometries = 0;
+        m->geometry_lods = 0;
+    }
+    app_state->mesh_count = 0;
+
     input_system_shutdown(app_state->input_system_state);
 
     geometry_system_shutdown(app_state->geometry_system_state);
@@ -522,8 +938,17 @@ b8 application_run() {
 
     resource_system_shutdown(app_state->resource_system_state);
 
+    filesystem_async_shutdown(app_state->filesystem_async_state);
+
+    job_system_shutdown(app_state->job_system_state);
+
+    profiler_shutdown(app_state->profiler_state);
+
     platform_system_shutdown(app_state->platform_system_state);
 
+    // Writes out any queued log entries before the log file is closed.
+    shutdown_logging(app_state->logging_system_state);
+
     event_system_shutdown(app_state->event_system_state);
 
     memory_system_shutdown();
@@ -576,6 +1001,12 @@ b8 application_on_key(u16 code, void* sender, void* listener_inst, event_context
     return false;
 }
 
+b8 application_on_activity(u16 code, void* sender, void* listener_inst, event_context context) {
+    application_request_redraw();
+    // Event purposely not handled to allow other listeners to get this.
+    return false;
+}
+
 b8 application_on_resized(u16 code, void* sender, void* listener_inst, event_context context) {
     if (code == EVENT_CODE_RESIZED) {
         u16 width = context.data.u16[0];
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "defines.h"
+#include "renderer/renderer_types.inl"
 
 struct game;
 
@@ -36,8 +37,59 @@ typedef struct application_config {
 
     /** @brief The application name used in windowing, if applicable. */
     char* name;
+
+    /** @brief The frame rate the main loop is held to. 0 for unlimited. */
+    f32 target_frame_rate;
+
+    /** @brief The requested present mode. */
+    renderer_present_mode present_mode;
+
+    /** @brief The renderer backend to use. The null backend is required when headless. */
+    renderer_backend_type renderer_backend;
+
+    /**
+     * @brief Indicates if the application should run without a window or display, e.g. for
+     * benchmarking on build machines. The start width and height are used as the framebuffer size,
+     * and input can only come from an input journal replay.
+     */
+    b8 headless;
+
+    /**
+     * @brief The number of frames to run in benchmark mode, after which the application exits
+     * and writes a summary of its frame statistics. 0 disables benchmark mode. In benchmark mode,
+     * frames are unpaced and use a fixed delta time, so the game can follow a scripted path.
+     */
+    u32 benchmark_frame_count;
+
+    /**
+     * @brief The path the benchmark summary is written to, without extension. Both a .csv and a
+     * .json file are written. If not set, "benchmark" is used.
+     */
+    const char* benchmark_output_path;
+
+    /**
+     * @brief Indicates if frames should only be rendered when something may have changed: input,
+     * a resize, a completed file read or a call to application_request_redraw(). Otherwise the
+     * application idles, blocking on platform messages. Suited to tools showing static scenes.
+     * Anything animating must request a redraw every frame.
+     */
+    b8 render_on_demand;
 } application_config;
 
+/**
+ * @brief Applies engine-level command line arguments to the given configuration.
+ * Supported arguments are:
+ *   --benchmark <frame count>    Runs the given number of frames in benchmark mode.
+ *   --benchmark-output <path>    The path of the benchmark summary, without extension.
+ *   --render-on-demand           Only renders frames when something may have changed.
+ * Unrecognized arguments are left for the game.
+ * @param config A pointer to the configuration to be modified.
+ * @param argc The number of arguments, including the program name.
+ * @param argv The arguments, including the program name.
+ * @returns True on success; otherwise false, e.g. if an argument's value is missing or invalid.
+ */
+KAPI b8 application_parse_arguments(application_config* config, i32 argc, char** argv);
+
 /**
  * @brief Creates the application, standing up the platform layer and all
  * underlying subsystems.
@@ -52,6 +104,45 @@ KAPI b8 application_create(struct game* game_inst);
  */
 KAPI b8 application_run();
 
+/**
+ * @brief Indicates if the application is running in benchmark mode and, if so, how far through
+ * it is. Intended for driving a scripted camera path.
+ * @param out_progress A pointer to hold the progress, from 0 at the first frame to 1 at the last.
+ * @returns True if running in benchmark mode; otherwise false.
+ */
+KAPI b8 application_benchmark_progress(f32* out_progress);
+
+/**
+ * @brief Requests that frames continue to be rendered, when rendering on demand.
+ * Should be called whenever the game changes something visible other than in
+ * response to input, e.g. each frame of an animation. Has no effect otherwise.
+ */
+KAPI void application_request_redraw();
+
+/**
+ * @brief The state which decides whether a frame can be skipped when rendering on demand.
+ */
+typedef struct application_idle_state {
+    /** @brief Indicates if rendering on demand is enabled. */
+    b8 render_on_demand;
+    /** @brief Indicates if running in benchmark mode, which never idles. */
+    b8 benchmarking;
+    /** @brief Indicates if the application is suspended, e.g. minimized. */
+    b8 suspended;
+    /** @brief The number of frames still to be rendered after the last change. */
+    u32 redraw_frames_remaining;
+    /** @brief Indicates if input is driving change, i.e. keys or buttons are held or a journal is replaying. */
+    b8 input_active;
+} application_idle_state;
+
+/**
+ * @brief Indicates if frames can be skipped when rendering on demand, as nothing has
+ * changed or is about to. A suspended application always idles in this mode.
+ * @param state A pointer to the state to decide from.
+ * @returns True if the frame can be skipped; otherwise false.
+ */
+KAPI b8 application_can_idle(const application_idle_state* state);
+
 /**
  * @brief Obtains the framebuffer size of the application.
  * @deprecated NOTE: This is temporary, and should be removed once kvars are in place.
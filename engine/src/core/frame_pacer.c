@@ -0,0 +1,103 @@
+#include "frame_pacer.h"
+
+#include "core/kmemory.h"
+#include "platform/platform.h"
+
+// The initial time left for spinning, before any sleeps have been measured.
+#define FRAME_PACER_INITIAL_SPIN_MARGIN 0.001
+// Bounds for the spin margin, so one bad wake can't cause excessive spinning.
+#define FRAME_PACER_MIN_SPIN_MARGIN 0.00005
+#define FRAME_PACER_MAX_SPIN_MARGIN 0.004
+
+static void record_error(frame_pacing_stats* stats, f64 error) {
+    f64 absolute_error = error < 0 ? -error : error;
+    stats->paced_frame_count++;
+    stats->last_error = error;
+    stats->total_absolute_error += absolute_error;
+    if (absolute_error > stats->max_absolute_error) {
+        stats->max_absolute_error = absolute_error;
+    }
+}
+
+/**
+ * @brief Adapts the spin margin to the observed oversleep. Grows immediately so the next
+ * frame is not late as well, and shrinks slowly so spinning is only reduced once sleeps
+ * have been consistently accurate.
+ */
+static void adapt_spin_margin(frame_pacer* pacer, f64 oversleep) {
+    f64 required = oversleep * 1.25 + FRAME_PACER_MIN_SPIN_MARGIN;
+    if (required > pacer->spin_margin) {
+        pacer->spin_margin = required;
+    } else {
+        pacer->spin_margin = pacer->spin_margin * 0.99 + required * 0.01;
+    }
+    if (pacer->spin_margin < FRAME_PACER_MIN_SPIN_MARGIN) {
+        pacer->spin_margin = FRAME_PACER_MIN_SPIN_MARGIN;
+    } else if (pacer->spin_margin > FRAME_PACER_MAX_SPIN_MARGIN) {
+        pacer->spin_margin = FRAME_PACER_MAX_SPIN_MARGIN;
+    }
+}
+
+void frame_pacer_create(f64 target_frame_rate, frame_pacer* out_pacer) {
+    kzero_memory(out_pacer, sizeof(frame_pacer));
+    out_pacer->spin_margin = FRAME_PACER_INITIAL_SPIN_MARGIN;
+    frame_pacer_set_target(out_pacer, target_frame_rate);
+}
+
+void frame_pacer_set_target(frame_pacer* pacer, f64 target_frame_rate) {
+    pacer->target_frame_seconds = target_frame_rate > 0 ? 1.0 / target_frame_rate : 0;
+    frame_pacer_restart(pacer);
+}
+
+void frame_pacer_restart(frame_pacer* pacer) {
+    // The next frame is measured from whenever it waits.
+    pacer->next_deadline = 0;
+}
+
+void frame_pacer_wait(frame_pacer* pacer) {
+    f64 now = platform_get_absolute_time();
+    if (pacer->target_frame_seconds <= 0) {
+        return;
+    }
+    if (pacer->next_deadline == 0) {
+        // The first frame is measured from now.
+        pacer->next_deadline = now + pacer->target_frame_seconds;
+    }
+
+    f64 deadline = pacer->next_deadline;
+    if (now >= deadline) {
+        pacer->stats.missed_frame_count++;
+        // If more than a whole frame behind, start a new schedule rather than rushing to catch up.
+        pacer->next_deadline = (now - deadline > pacer->target_frame_seconds) ? now + pacer->target_frame_seconds : deadline + pacer->target_frame_seconds;
+        return;
+    }
+
+    // Sleep through most of the remaining time, giving it back to the OS.
+    f64 sleep_seconds = deadline - now - pacer->spin_margin;
+    if (sleep_seconds > 0) {
+        f64 sleep_start = now;
+        platform_sleep_precise(sleep_seconds);
+        now = platform_get_absolute_time();
+        adapt_spin_margin(pacer, (now - sleep_start) - sleep_seconds);
+    }
+
+    // Spin for the remainder, for precision.
+    while (now < deadline) {
+        platform_cpu_pause();
+        now = platform_get_absolute_time();
+    }
+
+    record_error(&pacer->stats, now - deadline);
+    pacer->next_deadline = deadline + pacer->target_frame_seconds;
+}
+
+f64 frame_pacer_average_error(const frame_pacer* pacer) {
+    if (pacer->stats.paced_frame_count == 0) {
+        return 0;
+    }
+    return pacer->stats.total_absolute_error / (f64)pacer->stats.paced_frame_count;
+}
+
+void frame_pacer_reset_stats(frame_pacer* pacer) {
+    kzero_memory(&pacer->stats, sizeof(frame_pacing_stats));
+}
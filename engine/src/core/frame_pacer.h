@@ -0,0 +1,91 @@
+/**
+ * @file frame_pacer.h
+ * @author Travis Vroman (travis@kohiengine.com)
+ * @brief This file contains the frame pacer, which holds the main loop to a target
+ * frame rate. It sleeps through most of the remaining frame time to give the CPU back
+ * to the OS, then spins for the final stretch, since OS sleeps routinely wake late.
+ * The amount of time left for spinning adapts to how late sleeps are observed to wake.
+ * @version 1.0
+ * @date 2022-06-09
+ *
+ * @copyright Kohi Game Engine is Copyright (c) Travis Vroman 2021-2022
+ *
+ */
+
+#pragma once
+
+#include "defines.h"
+
+/** @brief Statistics on how closely frames have been held to their deadlines. */
+typedef struct frame_pacing_stats {
+    /** @brief The number of frames which waited for their deadline. */
+    u64 paced_frame_count;
+    /** @brief The number of frames which had already passed their deadline, so did not wait. */
+    u64 missed_frame_count;
+    /** @brief The pacing error of the last paced frame in seconds. Positive if it woke late. */
+    f64 last_error;
+    /** @brief The sum of the absolute pacing errors of all paced frames, in seconds. */
+    f64 total_absolute_error;
+    /** @brief The largest absolute pacing error of any paced frame, in seconds. */
+    f64 max_absolute_error;
+} frame_pacing_stats;
+
+/** @brief Holds a loop to a target frame rate. */
+typedef struct frame_pacer {
+    /** @brief The target duration of a frame in seconds. 0 if unlimited. */
+    f64 target_frame_seconds;
+    /** @brief The absolute time at which the current frame should end. 0 if not yet started. */
+    f64 next_deadline;
+    /** @brief How long before a deadline sleeping stops and spinning starts, in seconds. */
+    f64 spin_margin;
+    /** @brief The pacing statistics since creation or the last reset. */
+    frame_pacing_stats stats;
+} frame_pacer;
+
+/**
+ * @brief Creates a frame pacer with the given target frame rate.
+ *
+ * @param target_frame_rate The target number of frames per second. 0 for unlimited.
+ * @param out_pacer A pointer to hold the frame pacer.
+ */
+KAPI void frame_pacer_create(f64 target_frame_rate, frame_pacer* out_pacer);
+
+/**
+ * @brief Changes the target frame rate of the given pacer. Takes effect from the next frame.
+ *
+ * @param pacer A pointer to the frame pacer.
+ * @param target_frame_rate The target number of frames per second. 0 for unlimited.
+ */
+KAPI void frame_pacer_set_target(frame_pacer* pacer, f64 target_frame_rate);
+
+/**
+ * @brief Restarts the schedule of the given pacer from the next frame, e.g. after the
+ * loop has been idle, so the time spent idle is not counted as missed frames.
+ *
+ * @param pacer A pointer to the frame pacer.
+ */
+KAPI void frame_pacer_restart(frame_pacer* pacer);
+
+/**
+ * @brief Blocks until the end of the current frame, as determined by the target frame rate.
+ * Should be called once per frame. Deadlines are kept on a fixed schedule, so time lost to an
+ * occasional long frame is made up, unless it ran over by more than a whole frame.
+ *
+ * @param pacer A pointer to the frame pacer.
+ */
+KAPI void frame_pacer_wait(frame_pacer* pacer);
+
+/**
+ * @brief Gets the average absolute pacing error of paced frames in seconds.
+ *
+ * @param pacer A pointer to the frame pacer.
+ * @return The average absolute error, or 0 if no frames have been paced.
+ */
+KAPI f64 frame_pacer_average_error(const frame_pacer* pacer);
+
+/**
+ * @brief Resets the pacing statistics of the given pacer.
+ *
+ * @param pacer A pointer to the frame pacer.
+ */
+KAPI void frame_pacer_reset_stats(frame_pacer* pacer);
@@ -0,0 +1,213 @@
+#include "frame_stats.h"
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/kstring.h"
+#include "platform/filesystem.h"
+
+// Histogram bucket upper bounds in milliseconds. Finer at the low end, where
+// unpaced frames land, with bounds at the common 60Hz and 30Hz frame times.
+static const f64 histogram_bucket_upper_ms[FRAME_STATS_HISTOGRAM_BUCKET_COUNT] = {
+    0.25, 0.5, 1.0, 2.0, 4.0, 6.0, 8.0, 10.0, 12.0, 14.0, 16.7, 20.0, 25.0, 33.4, 50.0, 0};
+
+static const char* metric_names[FRAME_STAT_METRIC_COUNT] = {
+    "frame",
+    "update",
+    "render",
+    "input_to_present",
+    "input_to_display"};
+
+static void sift_down(f64* values, u32 start, u32 end) {
+    u32 root = start;
+    while (root * 2 + 1 < end) {
+        u32 child = root * 2 + 1;
+        if (child + 1 < end && values[child] < values[child + 1]) {
+            child++;
+        }
+        if (values[root] >= values[child]) {
+            return;
+        }
+        f64 temp = values[root];
+        values[root] = values[child];
+        values[child] = temp;
+        root = child;
+    }
+}
+
+// Heapsort, so summarizing large windows neither recurses nor allocates.
+static void sort_ascending(f64* values, u32 count) {
+    if (count < 2) {
+        return;
+    }
+    for (u32 i = count / 2; i > 0; --i) {
+        sift_down(values, i - 1, count);
+    }
+    for (u32 end = count - 1; end > 0; --end) {
+        f64 temp = values[0];
+        values[0] = values[end];
+        values[end] = temp;
+        sift_down(values, 0, end);
+    }
+}
+
+// Nearest-rank percentile of sorted values.
+static f64 percentile(const f64* sorted, u32 count, u32 percent) {
+    u64 rank = ((u64)percent * count + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+static u32 histogram_bucket_index(f64 seconds) {
+    f64 ms = seconds * 1000.0;
+    for (u32 i = 0; i < FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1; ++i) {
+        if (ms < histogram_bucket_upper_ms[i]) {
+            return i;
+        }
+    }
+    return FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1;
+}
+
+b8 frame_stats_create(u32 window_size, frame_stats* out_stats) {
+    if (window_size == 0 || !out_stats) {
+        KERROR("frame_stats_create requires a nonzero window size and a valid pointer.");
+        return false;
+    }
+    kzero_memory(out_stats, sizeof(frame_stats));
+    out_stats->window_size = window_size;
+    // One block for every metric plus the scratch space.
+    f64* block = kallocate(sizeof(f64) * window_size * (FRAME_STAT_METRIC_COUNT + 1), MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < FRAME_STAT_METRIC_COUNT; ++i) {
+        out_stats->samples[i] = block + (u64)window_size * i;
+    }
+    out_stats->scratch = block + (u64)window_size * FRAME_STAT_METRIC_COUNT;
+    return true;
+}
+
+void frame_stats_destroy(frame_stats* stats) {
+    if (stats && stats->samples[0]) {
+        kfree(stats->samples[0], sizeof(f64) * stats->window_size * (FRAME_STAT_METRIC_COUNT + 1), MEMORY_TAG_ARRAY);
+        kzero_memory(stats, sizeof(frame_stats));
+    }
+}
+
+void frame_stats_record_sample(frame_stats* stats, frame_stat_metric metric, f64 seconds) {
+    if (metric >= FRAME_STAT_METRIC_COUNT) {
+        return;
+    }
+    stats->samples[metric][stats->next_index[metric]] = seconds;
+    stats->next_index[metric] = (stats->next_index[metric] + 1) % stats->window_size;
+    if (stats->sample_count[metric] < stats->window_size) {
+        stats->sample_count[metric]++;
+    }
+}
+
+void frame_stats_record(frame_stats* stats, f64 frame_seconds, f64 update_seconds, f64 render_seconds) {
+    frame_stats_record_sample(stats, FRAME_STAT_METRIC_FRAME, frame_seconds);
+    frame_stats_record_sample(stats, FRAME_STAT_METRIC_UPDATE, update_seconds);
+    frame_stats_record_sample(stats, FRAME_STAT_METRIC_RENDER, render_seconds);
+    stats->total_frame_count++;
+}
+
+b8 frame_stats_summarize(frame_stats* stats, frame_stat_metric metric, frame_stat_summary* out_summary) {
+    if (!stats || metric >= FRAME_STAT_METRIC_COUNT || !out_summary) {
+        return false;
+    }
+    kzero_memory(out_summary, sizeof(frame_stat_summary));
+    u32 count = stats->sample_count[metric];
+    if (count == 0) {
+        return false;
+    }
+
+    // Sort a copy so the window order is kept.
+    f64* sorted = stats->scratch;
+    kcopy_memory(sorted, stats->samples[metric], sizeof(f64) * count);
+    sort_ascending(sorted, count);
+
+    f64 total = 0;
+    for (u32 i = 0; i < count; ++i) {
+        total += sorted[i];
+        out_summary->histogram[histogram_bucket_index(sorted[i])]++;
+    }
+
+    out_summary->sample_count = count;
+    out_summary->min = sorted[0];
+    out_summary->max = sorted[count - 1];
+    out_summary->avg = total / (f64)count;
+    out_summary->p50 = percentile(sorted, count, 50);
+    out_summary->p95 = percentile(sorted, count, 95);
+    out_summary->p99 = percentile(sorted, count, 99);
+    return true;
+}
+
+f64 frame_stats_histogram_bucket_upper(u32 index) {
+    if (index >= FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1) {
+        // The last bucket is unbounded.
+        return 1.0e30;
+    }
+    return histogram_bucket_upper_ms[index] / 1000.0;
+}
+
+const char* frame_stats_metric_name(frame_stat_metric metric) {
+    if (metric >= FRAME_STAT_METRIC_COUNT) {
+        return "unknown";
+    }
+    return metric_names[metric];
+}
+
+b8 frame_stats_write_csv(frame_stats* stats, const char* path) {
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_WRITE, false, &f)) {
+        KERROR("frame_stats_write_csv failed to open '%s' for writing.", path);
+        return false;
+    }
+
+    filesystem_write_text(&f, "metric,samples,min_ms,avg_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+    char line[256];
+    for (u32 i = 0; i < FRAME_STAT_METRIC_COUNT; ++i) {
+        frame_stat_summary s;
+        frame_stats_summarize(stats, i, &s);
+        string_format(line, "%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                      metric_names[i], s.sample_count,
+                      s.min * 1000.0, s.avg * 1000.0, s.p50 * 1000.0, s.p95 * 1000.0, s.p99 * 1000.0, s.max * 1000.0);
+        filesystem_write_text(&f, line);
+    }
+    filesystem_close(&f);
+    return true;
+}
+
+b8 frame_stats_write_json(frame_stats* stats, const char* path) {
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_WRITE, false, &f)) {
+        KERROR("frame_stats_write_json failed to open '%s' for writing.", path);
+        return false;
+    }
+
+    char line[256];
+    string_format(line, "{\n\"total_frame_count\":%llu,\n\"window_size\":%u,\n\"histogram_upper_ms\":[", stats->total_frame_count, stats->window_size);
+    filesystem_write_text(&f, line);
+    for (u32 b = 0; b < FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1; ++b) {
+        string_format(line, "%s%.2f", b ? "," : "", histogram_bucket_upper_ms[b]);
+        filesystem_write_text(&f, line);
+    }
+    // The last bucket is unbounded.
+    filesystem_write_text(&f, ",null],\n\"metrics\":{");
+
+    for (u32 i = 0; i < FRAME_STAT_METRIC_COUNT; ++i) {
+        frame_stat_summary s;
+        frame_stats_summarize(stats, i, &s);
+        string_format(line, "%s\n\"%s\":{\"samples\":%u,\"min_ms\":%.4f,\"avg_ms\":%.4f,\"p50_ms\":%.4f,\"p95_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f,\"histogram\":[",
+                      i ? "," : "", metric_names[i], s.sample_count,
+                      s.min * 1000.0, s.avg * 1000.0, s.p50 * 1000.0, s.p95 * 1000.0, s.p99 * 1000.0, s.max * 1000.0);
+        filesystem_write_text(&f, line);
+        for (u32 b = 0; b < FRAME_STATS_HISTOGRAM_BUCKET_COUNT; ++b) {
+            string_format(line, "%s%u", b ? "," : "", s.histogram[b]);
+            filesystem_write_text(&f, line);
+        }
+        filesystem_write_text(&f, "]}");
+    }
+    filesystem_write_text(&f, "\n}\n}\n");
+    filesystem_close(&f);
+    return true;
+}
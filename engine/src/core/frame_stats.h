@@ -0,0 +1,157 @@
+/**
+ * @file frame_stats.h
+ * @author Travis Vroman (travis@kohiengine.com)
+ * @brief This file contains frame statistics, which keep the timings of the most
+ * recent frames in a rolling window and summarize them as min/avg/percentiles/max
+ * and a histogram. Summaries can be written out as CSV or JSON, so runs of different
+ * builds can be compared numerically.
+ * @version 1.0
+ * @date 2022-06-12
+ *
+ * @copyright Kohi Game Engine is Copyright (c) Travis Vroman 2021-2022
+ *
+ */
+
+#pragma once
+
+#include "defines.h"
+
+/** @brief The number of buckets in a frame statistics histogram. */
+#define FRAME_STATS_HISTOGRAM_BUCKET_COUNT 16
+
+/** @brief The timings recorded for each frame. */
+typedef enum frame_stat_metric {
+    /** @brief The CPU time of the whole frame, excluding any time spent waiting on the frame pacer. */
+    FRAME_STAT_METRIC_FRAME,
+    /** @brief The time spent in the game's update. */
+    FRAME_STAT_METRIC_UPDATE,
+    /** @brief The time spent in the game's render and submitting the frame to the renderer. */
+    FRAME_STAT_METRIC_RENDER,
+    /**
+     * @brief The time from the latest input event to the frame presenting it being handed to
+     * the swapchain. Only recorded for frames with new input.
+     */
+    FRAME_STAT_METRIC_INPUT_TO_PRESENT,
+    /**
+     * @brief The time from the latest input event to the frame presenting it actually being
+     * displayed. Only recorded where the renderer backend can report display times.
+     */
+    FRAME_STAT_METRIC_INPUT_TO_DISPLAY,
+
+    FRAME_STAT_METRIC_COUNT
+} frame_stat_metric;
+
+/** @brief A summary of one metric over the samples in a frame statistics window. All times are in seconds. */
+typedef struct frame_stat_summary {
+    /** @brief The number of samples summarized. */
+    u32 sample_count;
+    f64 min;
+    f64 avg;
+    f64 p50;
+    f64 p95;
+    f64 p99;
+    f64 max;
+    /** @brief The number of samples in each bucket. See frame_stats_histogram_bucket_upper(). */
+    u32 histogram[FRAME_STATS_HISTOGRAM_BUCKET_COUNT];
+} frame_stat_summary;
+
+/**
+ * @brief Holds the timings of the most recent frames. Not every metric is recorded every
+ * frame, so each metric keeps its own window of samples.
+ */
+typedef struct frame_stats {
+    /** @brief The maximum number of samples held per metric. Older samples are replaced by newer ones. */
+    u32 window_size;
+    /** @brief The number of samples currently held for each metric. */
+    u32 sample_count[FRAME_STAT_METRIC_COUNT];
+    /** @brief The index the next sample of each metric is written to. */
+    u32 next_index[FRAME_STAT_METRIC_COUNT];
+    /** @brief The total number of frames ever recorded. */
+    u64 total_frame_count;
+    /** @brief The samples of each metric, in seconds. */
+    f64* samples[FRAME_STAT_METRIC_COUNT];
+    /** @brief Space for sorting the samples of one metric when summarizing. */
+    f64* scratch;
+} frame_stats;
+
+/**
+ * @brief Creates frame statistics holding the given number of frames.
+ *
+ * @param window_size The number of most recent frames to hold. Must be nonzero.
+ * @param out_stats A pointer to hold the frame statistics.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 frame_stats_create(u32 window_size, frame_stats* out_stats);
+
+/**
+ * @brief Destroys the given frame statistics, releasing their memory.
+ *
+ * @param stats A pointer to the frame statistics.
+ */
+KAPI void frame_stats_destroy(frame_stats* stats);
+
+/**
+ * @brief Records the timings of one frame, replacing the oldest frame if the window is full.
+ *
+ * @param stats A pointer to the frame statistics.
+ * @param frame_seconds The CPU time of the frame, in seconds.
+ * @param update_seconds The update time of the frame, in seconds.
+ * @param render_seconds The render time of the frame, in seconds.
+ */
+KAPI void frame_stats_record(frame_stats* stats, f64 frame_seconds, f64 update_seconds, f64 render_seconds);
+
+/**
+ * @brief Records a single sample of one metric, replacing its oldest sample if its window is full.
+ * Used for metrics which are not measured every frame.
+ *
+ * @param stats A pointer to the frame statistics.
+ * @param metric The metric to record.
+ * @param seconds The sample, in seconds.
+ */
+KAPI void frame_stats_record_sample(frame_stats* stats, frame_stat_metric metric, f64 seconds);
+
+/**
+ * @brief Summarizes one metric over the frames currently held. Percentiles use the nearest-rank method.
+ *
+ * @param stats A pointer to the frame statistics.
+ * @param metric The metric to summarize.
+ * @param out_summary A pointer to hold the summary.
+ * @return True on success; otherwise false, e.g. if no samples of the metric have been recorded.
+ */
+KAPI b8 frame_stats_summarize(frame_stats* stats, frame_stat_metric metric, frame_stat_summary* out_summary);
+
+/**
+ * @brief Gets the exclusive upper bound of the given histogram bucket, in seconds. The
+ * lower bound is the upper bound of the previous bucket, or 0 for the first. The last
+ * bucket is unbounded.
+ *
+ * @param index The bucket index.
+ * @return The upper bound in seconds.
+ */
+KAPI f64 frame_stats_histogram_bucket_upper(u32 index);
+
+/**
+ * @brief Gets the name of the given metric.
+ *
+ * @param metric The metric.
+ * @return The name of the metric.
+ */
+KAPI const char* frame_stats_metric_name(frame_stat_metric metric);
+
+/**
+ * @brief Writes a summary of every metric as CSV, with one row per metric and times in milliseconds.
+ *
+ * @param stats A pointer to the frame statistics.
+ * @param path The path of the file to write.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 frame_stats_write_csv(frame_stats* stats, const char* path);
+
+/**
+ * @brief Writes a summary of every metric, including histograms, as JSON with times in milliseconds.
+ *
+ * @param stats A pointer to the frame statistics.
+ * @param path The path of the file to write.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 frame_stats_write_json(frame_stats* stats, const char* path);
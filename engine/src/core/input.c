@@ -2,6 +2,14 @@
 #include "core/event.h"
 #include "core/kmemory.h"
 #include "core/logger.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+// Input journal file identifier ("KIJ1") and version.
+#define INPUT_JOURNAL_MAGIC 0x314A494B
+#define INPUT_JOURNAL_VERSION 1
+// The number of entries buffered before being written out while recording.
+#define INPUT_JOURNAL_BUFFER_ENTRIES 1024
 
 typedef struct keyboard_state {
     b8 keys[256];
@@ -13,11 +21,74 @@ typedef struct mouse_state {
     u8 buttons[BUTTON_MAX_BUTTONS];
 } mouse_state;
 
+typedef enum input_journal_entry_type {
+    INPUT_JOURNAL_ENTRY_TYPE_KEY = 1,
+    INPUT_JOURNAL_ENTRY_TYPE_BUTTON = 2,
+    INPUT_JOURNAL_ENTRY_TYPE_MOUSE_MOVE = 3,
+    INPUT_JOURNAL_ENTRY_TYPE_MOUSE_WHEEL = 4,
+    // Marks the end of a frame, and holds that frame's delta time.
+    INPUT_JOURNAL_ENTRY_TYPE_FRAME = 5
+} input_journal_entry_type;
+
+typedef struct input_journal_header {
+    u32 magic;
+    u16 version;
+    // The mouse position at the start of recording.
+    i16 mouse_x;
+    i16 mouse_y;
+    u16 reserved;
+} input_journal_header;
+
+typedef struct input_journal_entry {
+    u32 frame;
+    u8 type;
+    u8 reserved;
+    // The key or button code, if applicable.
+    u16 code;
+    union {
+        struct {
+            i16 x;
+            i16 y;
+        } position;
+        // Pressed state for keys/buttons, or z delta for the wheel.
+        i32 value;
+        // Delta time for frame entries.
+        f32 delta_time;
+    };
+} input_journal_entry;
+
+typedef enum input_journal_mode {
+    INPUT_JOURNAL_MODE_NONE,
+    INPUT_JOURNAL_MODE_RECORD,
+    INPUT_JOURNAL_MODE_REPLAY
+} input_journal_mode;
+
+typedef struct input_journal {
+    input_journal_mode mode;
+    // The index of the current frame relative to the start of recording/replay.
+    u32 frame;
+    // Recording
+    file_handle file;
+    u32 buffered_count;
+    input_journal_entry buffer[INPUT_JOURNAL_BUFFER_ENTRIES];
+    // Replay
+    u32 entry_count;
+    u32 cursor;
+    input_journal_entry* entries;
+    // Set while recorded entries are being dispatched, so live input can be rejected.
+    b8 dispatching;
+    b8 has_frame_delta;
+    f64 frame_delta;
+} input_journal;
+
 typedef struct input_state {
     keyboard_state keyboard_current;
     keyboard_state keyboard_previous;
     mouse_state mouse_current;
     mouse_state mouse_previous;
+    input_journal journal;
+    // The absolute time of the latest input event not yet taken, or 0 if none.
+    f64 latest_event_time;
 } input_state;
 
 // Internal input state pointer
@@ -35,10 +106,253 @@ void input_system_initialize(u64* memory_requirement, void* state) {
 }
 
 void input_system_shutdown(void* state) {
-    // TODO: Add shutdown routines when needed.
+    if (state_ptr) {
+        input_journal_stop();
+    }
     state_ptr = 0;
 }
 
+static b8 journal_flush(input_journal* journal) {
+    if (journal->buffered_count == 0) {
+        return true;
+    }
+    u64 size = sizeof(input_journal_entry) * journal->buffered_count;
+    u64 written = 0;
+    journal->buffered_count = 0;
+    if (!filesystem_write(&journal->file, size, journal->buffer, &written) || written != size) {
+        KERROR("Failed to write input journal entries. Recording will be incomplete.");
+        return false;
+    }
+    return true;
+}
+
+static void journal_record(input_journal_entry_type type, u16 code, i32 value) {
+    input_journal* journal = &state_ptr->journal;
+    input_journal_entry* entry = &journal->buffer[journal->buffered_count];
+    entry->frame = journal->frame;
+    entry->type = type;
+    entry->reserved = 0;
+    entry->code = code;
+    entry->value = value;
+    journal->buffered_count++;
+    if (journal->buffered_count == INPUT_JOURNAL_BUFFER_ENTRIES) {
+        journal_flush(journal);
+    }
+}
+
+static void journal_record_mouse_move(i16 x, i16 y) {
+    input_journal* journal = &state_ptr->journal;
+    input_journal_entry* entry = &journal->buffer[journal->buffered_count];
+    entry->frame = journal->frame;
+    entry->type = INPUT_JOURNAL_ENTRY_TYPE_MOUSE_MOVE;
+    entry->reserved = 0;
+    entry->code = 0;
+    entry->position.x = x;
+    entry->position.y = y;
+    journal->buffered_count++;
+    if (journal->buffered_count == INPUT_JOURNAL_BUFFER_ENTRIES) {
+        journal_flush(journal);
+    }
+}
+
+/**
+ * Processes all recorded entries for the current frame, up to and including
+ * the frame's end marker, which supplies the frame's delta time.
+ */
+static void journal_dispatch_frame() {
+    input_journal* journal = &state_ptr->journal;
+    journal->has_frame_delta = false;
+    journal->dispatching = true;
+    while (journal->cursor < journal->entry_count) {
+        input_journal_entry* entry = &journal->entries[journal->cursor];
+        if (entry->frame != journal->frame) {
+            break;
+        }
+        journal->cursor++;
+        switch (entry->type) {
+            case INPUT_JOURNAL_ENTRY_TYPE_KEY:
+                input_process_key((keys)entry->code, entry->value != 0);
+                break;
+            case INPUT_JOURNAL_ENTRY_TYPE_BUTTON:
+                input_process_button((buttons)entry->code, entry->value != 0);
+                break;
+            case INPUT_JOURNAL_ENTRY_TYPE_MOUSE_MOVE:
+                input_process_mouse_move(entry->position.x, entry->position.y);
+                break;
+            case INPUT_JOURNAL_ENTRY_TYPE_MOUSE_WHEEL:
+                input_process_mouse_wheel((i8)entry->value);
+                break;
+            case INPUT_JOURNAL_ENTRY_TYPE_FRAME:
+                journal->frame_delta = entry->delta_time;
+                journal->has_frame_delta = true;
+                break;
+            default:
+                KWARN("Unknown input journal entry type %u skipped.", entry->type);
+                break;
+        }
+    }
+    journal->dispatching = false;
+
+    if (journal->cursor >= journal->entry_count && !journal->has_frame_delta) {
+        KINFO("Input journal replay complete after %u frames. Returning to live input.", journal->frame);
+        input_journal_stop();
+    }
+}
+
+b8 input_journal_record_begin(const char* path) {
+    if (!state_ptr || !path) {
+        return false;
+    }
+    input_journal_stop();
+
+    input_journal* journal = &state_ptr->journal;
+    if (!filesystem_open(path, FILE_MODE_WRITE, true, &journal->file)) {
+        KERROR("input_journal_record_begin - Unable to open '%s' for writing.", path);
+        return false;
+    }
+
+    input_journal_header header = {0};
+    header.magic = INPUT_JOURNAL_MAGIC;
+    header.version = INPUT_JOURNAL_VERSION;
+    header.mouse_x = state_ptr->mouse_current.x;
+    header.mouse_y = state_ptr->mouse_current.y;
+    u64 written = 0;
+    if (!filesystem_write(&journal->file, sizeof(input_journal_header), &header, &written)) {
+        KERROR("input_journal_record_begin - Unable to write header to '%s'.", path);
+        filesystem_close(&journal->file);
+        return false;
+    }
+
+    journal->mode = INPUT_JOURNAL_MODE_RECORD;
+    journal->frame = 0;
+    journal->buffered_count = 0;
+
+    // Record keys and buttons already held so the replay starts from the same state.
+    for (u32 i = 0; i < 256; ++i) {
+        if (state_ptr->keyboard_current.keys[i]) {
+            journal_record(INPUT_JOURNAL_ENTRY_TYPE_KEY, (u16)i, true);
+        }
+    }
+    for (u32 i = 0; i < BUTTON_MAX_BUTTONS; ++i) {
+        if (state_ptr->mouse_current.buttons[i]) {
+            journal_record(INPUT_JOURNAL_ENTRY_TYPE_BUTTON, (u16)i, true);
+        }
+    }
+
+    KINFO("Input journal recording to '%s'.", path);
+    return true;
+}
+
+b8 input_journal_replay_begin(const char* path) {
+    if (!state_ptr || !path) {
+        return false;
+    }
+    input_journal_stop();
+
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_READ, true, &f)) {
+        KERROR("input_journal_replay_begin - Unable to open '%s' for reading.", path);
+        return false;
+    }
+
+    u64 file_size = 0;
+    input_journal_header header = {0};
+    u64 bytes_read = 0;
+    if (!filesystem_size(&f, &file_size) || file_size < sizeof(input_journal_header) ||
+        !filesystem_read(&f, sizeof(input_journal_header), &header, &bytes_read) ||
+        header.magic != INPUT_JOURNAL_MAGIC || header.version != INPUT_JOURNAL_VERSION) {
+        KERROR("input_journal_replay_begin - '%s' is not a valid input journal.", path);
+        filesystem_close(&f);
+        return false;
+    }
+
+    input_journal* journal = &state_ptr->journal;
+    u64 entry_count = (file_size - sizeof(input_journal_header)) / sizeof(input_journal_entry);
+    if (entry_count == 0) {
+        KWARN("input_journal_replay_begin - '%s' contains no input.", path);
+        filesystem_close(&f);
+        return false;
+    }
+    u64 entries_size = sizeof(input_journal_entry) * entry_count;
+    journal->entries = kallocate(entries_size, MEMORY_TAG_ARRAY);
+    if (!filesystem_read(&f, entries_size, journal->entries, &bytes_read) || bytes_read != entries_size) {
+        KERROR("input_journal_replay_begin - Failed to read entries from '%s'.", path);
+        kfree(journal->entries, entries_size, MEMORY_TAG_ARRAY);
+        journal->entries = 0;
+        filesystem_close(&f);
+        return false;
+    }
+    filesystem_close(&f);
+
+    journal->entry_count = (u32)entry_count;
+    journal->cursor = 0;
+    journal->frame = 0;
+    journal->mode = INPUT_JOURNAL_MODE_REPLAY;
+
+    // Start from the recorded state. Nothing is held down until the journal says so.
+    kzero_memory(&state_ptr->keyboard_current, sizeof(keyboard_state));
+    kzero_memory(&state_ptr->keyboard_previous, sizeof(keyboard_state));
+    kzero_memory(&state_ptr->mouse_current, sizeof(mouse_state));
+    state_ptr->mouse_current.x = header.mouse_x;
+    state_ptr->mouse_current.y = header.mouse_y;
+    kcopy_memory(&state_ptr->mouse_previous, &state_ptr->mouse_current, sizeof(mouse_state));
+
+    KINFO("Input journal replaying %u entries from '%s'.", journal->entry_count, path);
+    journal_dispatch_frame();
+    return true;
+}
+
+void input_journal_stop() {
+    if (!state_ptr) {
+        return;
+    }
+    input_journal* journal = &state_ptr->journal;
+    if (journal->mode == INPUT_JOURNAL_MODE_RECORD) {
+        journal_flush(journal);
+        filesystem_close(&journal->file);
+        KINFO("Input journal recording stopped after %u frames.", journal->frame);
+    } else if (journal->mode == INPUT_JOURNAL_MODE_REPLAY) {
+        if (journal->entries) {
+            kfree(journal->entries, sizeof(input_journal_entry) * journal->entry_count, MEMORY_TAG_ARRAY);
+            journal->entries = 0;
+        }
+        // Release anything the replay left held down so live input starts clean.
+        kzero_memory(&state_ptr->keyboard_current, sizeof(keyboard_state));
+        kzero_memory(&state_ptr->keyboard_previous, sizeof(keyboard_state));
+        kzero_memory(state_ptr->mouse_current.buttons, sizeof(state_ptr->mouse_current.buttons));
+        kzero_memory(state_ptr->mouse_previous.buttons, sizeof(state_ptr->mouse_previous.buttons));
+    }
+    journal->mode = INPUT_JOURNAL_MODE_NONE;
+    journal->entry_count = 0;
+    journal->cursor = 0;
+    journal->buffered_count = 0;
+    journal->has_frame_delta = false;
+}
+
+b8 input_journal_is_recording() {
+    return state_ptr && state_ptr->journal.mode == INPUT_JOURNAL_MODE_RECORD;
+}
+
+b8 input_journal_is_replaying() {
+    return state_ptr && state_ptr->journal.mode == INPUT_JOURNAL_MODE_REPLAY;
+}
+
+b8 input_journal_frame_delta(f64* out_delta_time) {
+    if (!input_journal_is_replaying() || !state_ptr->journal.has_frame_delta) {
+        return false;
+    }
+    *out_delta_time = state_ptr->journal.frame_delta;
+    return true;
+}
+
+/**
+ * Indicates whether input coming from the platform should be rejected, which is
+ * the case while replaying unless the input is being dispatched from the journal.
+ */
+static b8 journal_rejects_input() {
+    return state_ptr->journal.mode == INPUT_JOURNAL_MODE_REPLAY && !state_ptr->journal.dispatching;
+}
+
 void input_update(f64 delta_time) {
     if (!state_ptr) {
         return;
@@ -47,13 +361,71 @@ void input_update(f64 delta_time) {
     // Copy current states to previous states.
     kcopy_memory(&state_ptr->keyboard_previous, &state_ptr->keyboard_current, sizeof(keyboard_state));
     kcopy_memory(&state_ptr->mouse_previous, &state_ptr->mouse_current, sizeof(mouse_state));
+
+    input_journal* journal = &state_ptr->journal;
+    if (journal->mode == INPUT_JOURNAL_MODE_RECORD) {
+        // Close out the frame with its delta time.
+        input_journal_entry* entry = &journal->buffer[journal->buffered_count];
+        entry->frame = journal->frame;
+        entry->type = INPUT_JOURNAL_ENTRY_TYPE_FRAME;
+        entry->reserved = 0;
+        entry->code = 0;
+        entry->delta_time = (f32)delta_time;
+        journal->buffered_count++;
+        if (journal->buffered_count == INPUT_JOURNAL_BUFFER_ENTRIES) {
+            journal_flush(journal);
+        }
+        journal->frame++;
+    } else if (journal->mode == INPUT_JOURNAL_MODE_REPLAY) {
+        // Input for the next frame is applied now, in place of the platform's.
+        journal->frame++;
+        journal_dispatch_frame();
+    }
+}
+
+b8 input_is_any_down() {
+    if (!state_ptr) {
+        return false;
+    }
+    for (u32 i = 0; i < 256; ++i) {
+        if (state_ptr->keyboard_current.keys[i]) {
+            return true;
+        }
+    }
+    for (u32 i = 0; i < BUTTON_MAX_BUTTONS; ++i) {
+        if (state_ptr->mouse_current.buttons[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Timestamps an input event as it is pumped from the platform layer (or replayed).
+static void mark_event_time() {
+    state_ptr->latest_event_time = platform_get_absolute_time();
+}
+
+b8 input_take_event_time(f64* out_time) {
+    if (!state_ptr || state_ptr->latest_event_time == 0) {
+        return false;
+    }
+    *out_time = state_ptr->latest_event_time;
+    state_ptr->latest_event_time = 0;
+    return true;
 }
 
 void input_process_key(keys key, b8 pressed) {
+    if (!state_ptr || journal_rejects_input()) {
+        return;
+    }
+    mark_event_time();
     // Only handle this if the state actually changed.
-    if (state_ptr && state_ptr->keyboard_current.keys[key] != pressed) {
+    if (state_ptr->keyboard_current.keys[key] != pressed) {
         // Update internal state_ptr->
         state_ptr->keyboard_current.keys[key] = pressed;
+        if (state_ptr->journal.mode == INPUT_JOURNAL_MODE_RECORD) {
+            journal_record(INPUT_JOURNAL_ENTRY_TYPE_KEY, key, pressed);
+        }
 
         if (key == KEY_LALT) {
             KINFO("Left alt %s.", pressed ? "pressed" : "released");
@@ -81,9 +453,16 @@ void input_process_key(keys key, b8 pressed) {
 }
 
 void input_process_button(buttons button, b8 pressed) {
+    if (!state_ptr || journal_rejects_input()) {
+        return;
+    }
+    mark_event_time();
     // If the state changed, fire an event.
     if (state_ptr->mouse_current.buttons[button] != pressed) {
         state_ptr->mouse_current.buttons[button] = pressed;
+        if (state_ptr->journal.mode == INPUT_JOURNAL_MODE_RECORD) {
+            journal_record(INPUT_JOURNAL_ENTRY_TYPE_BUTTON, button, pressed);
+        }
 
         // Fire the event.
         event_context context;
@@ -93,6 +472,10 @@ void input_process_button(buttons button, b8 pressed) {
 }
 
 void input_process_mouse_move(i16 x, i16 y) {
+    if (!state_ptr || journal_rejects_input()) {
+        return;
+    }
+    mark_event_time();
     // Only process if actually different
     if (state_ptr->mouse_current.x != x || state_ptr->mouse_current.y != y) {
         // NOTE: Enable this if debugging.
@@ -101,6 +484,9 @@ void input_process_mouse_move(i16 x, i16 y) {
         // Update internal state_ptr->
         state_ptr->mouse_current.x = x;
         state_ptr->mouse_current.y = y;
+        if (state_ptr->journal.mode == INPUT_JOURNAL_MODE_RECORD) {
+            journal_record_mouse_move(x, y);
+        }
 
         // Fire the event.
         event_context context;
@@ -111,7 +497,14 @@ void input_process_mouse_move(i16 x, i16 y) {
 }
 
 void input_process_mouse_wheel(i8 z_delta) {
+    if (!state_ptr || journal_rejects_input()) {
+        return;
+    }
+    mark_event_time();
     // NOTE: no internal state to update.
+    if (state_ptr->journal.mode == INPUT_JOURNAL_MODE_RECORD) {
+        journal_record(INPUT_JOURNAL_ENTRY_TYPE_MOUSE_WHEEL, 0, z_delta);
+    }
 
     // Fire the event.
     event_context context;
@@ -308,6 +308,21 @@ void input_system_shutdown(void* state);
  */
 void input_update(f64 delta_time);
 
+/**
+ * @brief Indicates if any keyboard key or mouse button is currently held down.
+ * @returns True if any key or button is down; otherwise false.
+ */
+b8 input_is_any_down();
+
+/**
+ * @brief Takes the time at which the latest input event arrived from the platform layer,
+ * clearing it so each event time is only taken once.
+ *
+ * @param out_time A pointer to hold the absolute time of the latest input event.
+ * @returns True if an input event arrived since the last call; otherwise false.
+ */
+b8 input_take_event_time(f64* out_time);
+
 // keyboard input
 
 /**
@@ -407,3 +422,50 @@ void input_process_mouse_move(i16 x, i16 y);
  * @param z_delta The amount of scrolling which occurred on the z axis (mouse wheel)
  */
 void input_process_mouse_wheel(i8 z_delta);
+
+// input journal (record/replay)
+
+/**
+ * @brief Begins recording all processed input (keys, buttons, mouse movement and wheel)
+ * along with the frame index it occurred on and each frame's delta time to a compact
+ * binary journal file. Any recording or replay already in progress is stopped first.
+ * @param path The path of the journal file to be written. Overwritten if it exists.
+ * @returns True if recording started successfully; otherwise false.
+ */
+KAPI b8 input_journal_record_begin(const char* path);
+
+/**
+ * @brief Begins replaying the input journal at the given path. While replaying, live
+ * platform input is ignored and the recorded input is processed on the same frame
+ * indices it was recorded on. Returns to live input automatically once the end of
+ * the journal is reached. Any recording or replay already in progress is stopped first.
+ * @param path The path of the journal file to be replayed.
+ * @returns True if the replay started successfully; otherwise false.
+ */
+KAPI b8 input_journal_replay_begin(const char* path);
+
+/**
+ * @brief Stops any in-progress recording (flushing it to disk) or replay.
+ */
+KAPI void input_journal_stop();
+
+/**
+ * @brief Indicates if input is currently being recorded to a journal.
+ * @returns True if recording; otherwise false.
+ */
+KAPI b8 input_journal_is_recording();
+
+/**
+ * @brief Indicates if input is currently being replayed from a journal.
+ * @returns True if replaying; otherwise false.
+ */
+KAPI b8 input_journal_is_replaying();
+
+/**
+ * @brief Obtains the recorded delta time of the current frame while replaying, so
+ * that time-dependent updates (i.e. camera movement) are reproduced identically
+ * regardless of how long the frame actually took.
+ * @param out_delta_time A pointer to hold the recorded delta time in seconds.
+ * @returns True if replaying and a delta time was recorded for this frame; otherwise false.
+ */
+KAPI b8 input_journal_frame_delta(f64* out_delta_time);
@@ -42,6 +42,8 @@ typedef struct memory_system_state {
     u64 allocator_memory_requirement;
     dynamic_allocator allocator;
     void* allocator_block;
+    // Guards the allocator and stats, as allocations can be made from any thread.
+    kmutex allocation_mutex;
 } memory_system_state;
 
 // Pointer to system state.
@@ -81,12 +83,18 @@ b8 memory_system_initialize(memory_system_configuration config) {
         return false;
     }
 
+    if (!platform_mutex_create(&state_ptr->allocation_mutex)) {
+        KFATAL("Memory system is unable to create allocation mutex. Application cannot continue.");
+        return false;
+    }
+
     KDEBUG("Memory system successfully allocated %llu bytes.", config.total_alloc_size);
     return true;
 }
 
 void memory_system_shutdown() {
     if (state_ptr) {
+        platform_mutex_destroy(&state_ptr->allocation_mutex);
         dynamic_allocator_destroy(&state_ptr->allocator);
         // Free the entire block.
         platform_free(state_ptr, state_ptr->allocator_memory_requirement + sizeof(memory_system_state));
@@ -103,11 +111,13 @@ void* kallocate(u64 size, memory_tag tag) {
     // really happen.
     void* block = 0;
     if (state_ptr) {
+        platform_mutex_lock(&state_ptr->allocation_mutex);
         state_ptr->stats.total_allocated += size;
         state_ptr->stats.tagged_allocations[tag] += size;
         state_ptr->alloc_count++;
 
         block = dynamic_allocator_allocate(&state_ptr->allocator, size);
+        platform_mutex_unlock(&state_ptr->allocation_mutex);
     } else {
         // If the system is not up yet, warn about it but give memory for now.
         KWARN("kallocate called before the memory system is initialized.");
@@ -129,9 +139,11 @@ void kfree(void* block, u64 size, memory_tag tag) {
         KWARN("kfree called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
     if (state_ptr) {
+        platform_mutex_lock(&state_ptr->allocation_mutex);
         state_ptr->stats.total_allocated -= size;
         state_ptr->stats.tagged_allocations[tag] -= size;
         b8 result = dynamic_allocator_free(&state_ptr->allocator, block, size);
+        platform_mutex_unlock(&state_ptr->allocation_mutex);
 
         // If the free failed, it's possible this is because the allocation was made
         // before this system was started up. Since this absolutely should be an exception
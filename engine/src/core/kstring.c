@@ -38,7 +38,7 @@ b8 strings_equali(const char* str0, const char* str1) {
 }
 
 b8 strings_nequal(const char* str0, const char* str1, u64 length) {
-    return strncmp(str0, str1, length);
+    return strncmp(str0, str1, length) == 0;
 }
 
 b8 strings_nequali(const char* str0, const char* str1, u64 length) {
@@ -61,16 +61,22 @@ i32 string_format(char* dest, const char* format, ...) {
 }
 
 i32 string_format_v(char* dest, const char* format, void* va_listp) {
-    if (dest) {
-        // Big, but can fit on the stack.
-        char buffer[32000];
-        i32 written = vsnprintf(buffer, 32000, format, va_listp);
-        buffer[written] = 0;
-        kcopy_memory(dest, buffer, written + 1);
+    // Formats directly into dest. The limit is the size of the stack buffer this used
+    // to format into before copying, which callers' buffers were already bound by.
+    return string_nformat_v(dest, 32000, format, va_listp);
+}
 
-        return written;
+i32 string_nformat_v(char* dest, u64 max_length, const char* format, void* va_listp) {
+    if (!dest || max_length == 0) {
+        return -1;
     }
-    return -1;
+    i32 written = vsnprintf(dest, max_length, format, va_listp);
+    if (written < 0) {
+        dest[0] = 0;
+        return -1;
+    }
+    // Clamp to what actually fit if the output was truncated.
+    return written < (i32)max_length ? written : (i32)max_length - 1;
 }
 
 char* string_empty(char* str) {
@@ -153,8 +159,7 @@ b8 string_to_vec4(char* str, vec4* out_vector) {
     }
 
     kzero_memory(out_vector, sizeof(vec4));
-    i32 result = sscanf(str, "%f %f %f %f", &out_vector->x, &out_vector->y, &out_vector->z, &out_vector->w);
-    return result != -1;
+    return string_view_to_f32_array(string_view_create(str), 4, out_vector->elements);
 }
 
 b8 string_to_vec3(char* str, vec3* out_vector) {
@@ -163,8 +168,7 @@ b8 string_to_vec3(char* str, vec3* out_vector) {
     }
 
     kzero_memory(out_vector, sizeof(vec3));
-    i32 result = sscanf(str, "%f %f %f", &out_vector->x, &out_vector->y, &out_vector->z);
-    return result != -1;
+    return string_view_to_f32_array(string_view_create(str), 3, out_vector->elements);
 }
 
 b8 string_to_vec2(char* str, vec2* out_vector) {
@@ -173,8 +177,7 @@ b8 string_to_vec2(char* str, vec2* out_vector) {
     }
 
     kzero_memory(out_vector, sizeof(vec2));
-    i32 result = sscanf(str, "%f %f", &out_vector->x, &out_vector->y);
-    return result != -1;
+    return string_view_to_f32_array(string_view_create(str), 2, out_vector->elements);
 }
 
 b8 string_to_f32(char* str, f32* f) {
@@ -183,8 +186,7 @@ b8 string_to_f32(char* str, f32* f) {
     }
 
     *f = 0;
-    i32 result = sscanf(str, "%f", f);
-    return result != -1;
+    return string_view_to_f32_array(string_view_create(str), 1, f);
 }
 
 b8 string_to_f64(char* str, f64* f) {
@@ -192,89 +194,93 @@ b8 string_to_f64(char* str, f64* f) {
         return false;
     }
 
-    *f = 0;
-    i32 result = sscanf(str, "%lf", f);
-    return result != -1;
+    string_view view = string_view_trim(string_view_create(str));
+    u64 parsed = string_view_parse_f64(view, f);
+    return parsed > 0 && parsed == view.length;
 }
 
-b8 string_to_i8(char* str, i8* i) {
+// Parses the whole of str, ignoring surrounding whitespace, as a signed integer within [min, max].
+static b8 string_to_integer(const char* str, i64 min, i64 max, i64* out_value) {
+    *out_value = 0;
     if (!str) {
         return false;
     }
 
-    *i = 0;
-    i32 result = sscanf(str, "%hhi", i);
-    return result != -1;
+    string_view view = string_view_trim(string_view_create(str));
+    i64 value = 0;
+    u64 parsed = string_view_parse_i64(view, &value);
+    if (parsed == 0 || parsed != view.length || value < min || value > max) {
+        return false;
+    }
+    *out_value = value;
+    return true;
 }
 
-b8 string_to_i16(char* str, i16* i) {
+// Parses the whole of str, ignoring surrounding whitespace, as an unsigned integer no greater than max.
+static b8 string_to_unsigned(const char* str, u64 max, u64* out_value) {
+    *out_value = 0;
     if (!str) {
         return false;
     }
 
-    *i = 0;
-    i32 result = sscanf(str, "%hi", i);
-    return result != -1;
-}
-
-b8 string_to_i32(char* str, i32* i) {
-    if (!str) {
+    string_view view = string_view_trim(string_view_create(str));
+    u64 value = 0;
+    u64 parsed = string_view_parse_u64(view, &value);
+    if (parsed == 0 || parsed != view.length || value > max) {
         return false;
     }
+    *out_value = value;
+    return true;
+}
 
-    *i = 0;
-    i32 result = sscanf(str, "%i", i);
-    return result != -1;
+b8 string_to_i8(char* str, i8* i) {
+    i64 value;
+    b8 result = string_to_integer(str, -128, 127, &value);
+    *i = (i8)value;
+    return result;
 }
 
-b8 string_to_i64(char* str, i64* i) {
-    if (!str) {
-        return false;
-    }
+b8 string_to_i16(char* str, i16* i) {
+    i64 value;
+    b8 result = string_to_integer(str, -32768, 32767, &value);
+    *i = (i16)value;
+    return result;
+}
 
-    *i = 0;
-    i32 result = sscanf(str, "%lli", i);
-    return result != -1;
+b8 string_to_i32(char* str, i32* i) {
+    i64 value;
+    b8 result = string_to_integer(str, -2147483647LL - 1, 2147483647LL, &value);
+    *i = (i32)value;
+    return result;
 }
 
-b8 string_to_u8(char* str, u8* u) {
-    if (!str) {
-        return false;
-    }
+b8 string_to_i64(char* str, i64* i) {
+    return string_to_integer(str, -9223372036854775807LL - 1, 9223372036854775807LL, i);
+}
 
-    *u = 0;
-    i32 result = sscanf(str, "%hhu", u);
-    return result != -1;
+b8 string_to_u8(char* str, u8* u) {
+    u64 value;
+    b8 result = string_to_unsigned(str, 255, &value);
+    *u = (u8)value;
+    return result;
 }
 
 b8 string_to_u16(char* str, u16* u) {
-    if (!str) {
-        return false;
-    }
-
-    *u = 0;
-    i32 result = sscanf(str, "%hu", u);
-    return result != -1;
+    u64 value;
+    b8 result = string_to_unsigned(str, 65535, &value);
+    *u = (u16)value;
+    return result;
 }
 
 b8 string_to_u32(char* str, u32* u) {
-    if (!str) {
-        return false;
-    }
-
-    *u = 0;
-    i32 result = sscanf(str, "%u", u);
-    return result != -1;
+    u64 value;
+    b8 result = string_to_unsigned(str, 4294967295ULL, &value);
+    *u = (u32)value;
+    return result;
 }
 
 b8 string_to_u64(char* str, u64* u) {
-    if (!str) {
-        return false;
-    }
-
-    *u = 0;
-    i32 result = sscanf(str, "%llu", u);
-    return result != -1;
+    return string_to_unsigned(str, 18446744073709551615ULL, u);
 }
 
 b8 string_to_bool(char* str, b8* b) {
@@ -282,8 +288,7 @@ b8 string_to_bool(char* str, b8* b) {
         return false;
     }
 
-    *b = strings_equal(str, "1") || strings_equali(str, "true");
-    return *b;
+    return string_view_to_bool(string_view_create(str), b);
 }
 
 u32 string_split(const char* str, char delimiter, char*** str_darray, b8 trim_entries, b8 include_empty) {
@@ -291,72 +296,31 @@ u32 string_split(const char* str, char delimiter, char*** str_darray, b8 trim_en
         return 0;
     }
 
-    char* result = 0;
-    u32 trimmed_length = 0;
     u32 entry_count = 0;
-    u32 length = string_length(str);
-    char buffer[16384];  // If a single entry goes beyond this, well... just don't do that.
-    u32 current_length = 0;
-    // Iterate each character until a delimiter is reached.
-    for (u32 i = 0; i < length; ++i) {
-        char c = str[i];
-
-        // Found delimiter, finalize string.
-        if (c == delimiter) {
-            buffer[current_length] = 0;
-            result = buffer;
-            trimmed_length = current_length;
-            // Trim if applicable
-            if (trim_entries && current_length > 0) {
-                result = string_trim(result);
-                trimmed_length = string_length(result);
-            }
-            // Add new entry
-            if (trimmed_length > 0 || include_empty) {
-                char* entry = kallocate(sizeof(char) * (trimmed_length + 1), MEMORY_TAG_STRING);
-                if (trimmed_length == 0) {
-                    entry[0] = 0;
-                } else {
-                    string_ncopy(entry, result, trimmed_length);
-                    entry[trimmed_length] = 0;
-                }
-                char** a = *str_darray;
-                darray_push(a, entry);
-                *str_darray = a;
-                entry_count++;
-            }
-
-            // Clear the buffer.
-            kzero_memory(buffer, sizeof(char) * 16384);
-            current_length = 0;
-            continue;
+    const char* start = str;
+    while (true) {
+        // Find the end of the entry.
+        const char* end = start;
+        while (*end && *end != delimiter) {
+            end++;
         }
 
-        buffer[current_length] = c;
-        current_length++;
-    }
+        string_view entry = string_view_create_from_range(start, (u64)(end - start));
+        if (trim_entries) {
+            entry = string_view_trim(entry);
+        }
+        // Add new entry
+        if (entry.length > 0 || include_empty) {
+            char** a = *str_darray;
+            darray_push(a, string_view_duplicate(entry));
+            *str_darray = a;
+            entry_count++;
+        }
 
-    // At the end of the string. If any chars are queued up, read them.
-    result = buffer;
-    trimmed_length = current_length;
-    // Trim if applicable
-    if (trim_entries && current_length > 0) {
-        result = string_trim(result);
-        trimmed_length = string_length(result);
-    }
-    // Add new entry
-    if (trimmed_length > 0 || include_empty) {
-        char* entry = kallocate(sizeof(char) * (trimmed_length + 1), MEMORY_TAG_STRING);
-        if (trimmed_length == 0) {
-            entry[0] = 0;
-        } else {
-            string_ncopy(entry, result, trimmed_length);
-            entry[trimmed_length] = 0;
+        if (!*end) {
+            break;
         }
-        char** a = *str_darray;
-        darray_push(a, entry);
-        *str_darray = a;
-        entry_count++;
+        start = end + 1;
     }
 
     return entry_count;
@@ -435,3 +399,250 @@ void string_filename_no_extension_from_path(char* dest, const char* path) {
 
     string_mid(dest, path, start, end - start);
 }
+
+
+static b8 is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static b8 is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+string_view string_view_create(const char* str) {
+    string_view view;
+    view.data = str;
+    view.length = str ? string_length(str) : 0;
+    return view;
+}
+
+string_view string_view_create_from_range(const char* data, u64 length) {
+    string_view view;
+    view.data = data;
+    view.length = length;
+    return view;
+}
+
+string_view string_view_trim(string_view view) {
+    while (view.length > 0 && is_space(view.data[0])) {
+        view.data++;
+        view.length--;
+    }
+    while (view.length > 0 && is_space(view.data[view.length - 1])) {
+        view.length--;
+    }
+    return view;
+}
+
+string_view string_view_mid(string_view view, u64 start, u64 length) {
+    if (start >= view.length) {
+        return string_view_create_from_range(view.data + view.length, 0);
+    }
+    u64 available = view.length - start;
+    return string_view_create_from_range(view.data + start, length < available ? length : available);
+}
+
+i64 string_view_index_of(string_view view, char c) {
+    for (u64 i = 0; i < view.length; ++i) {
+        if (view.data[i] == c) {
+            return (i64)i;
+        }
+    }
+    return -1;
+}
+
+b8 string_view_equal(string_view view, const char* str) {
+    u64 i = 0;
+    for (; i < view.length; ++i) {
+        if (str[i] != view.data[i]) {
+            return false;
+        }
+    }
+    return str[i] == 0;
+}
+
+b8 string_view_equali(string_view view, const char* str) {
+    u64 i = 0;
+    for (; i < view.length; ++i) {
+        if (!str[i] || tolower((unsigned char)str[i]) != tolower((unsigned char)view.data[i])) {
+            return false;
+        }
+    }
+    return str[i] == 0;
+}
+
+b8 string_view_split_next(string_view* remaining, char delimiter, string_view* out_entry) {
+    if (remaining->length == 0) {
+        return false;
+    }
+    i64 index = string_view_index_of(*remaining, delimiter);
+    if (index == -1) {
+        *out_entry = *remaining;
+        remaining->data += remaining->length;
+        remaining->length = 0;
+    } else {
+        *out_entry = string_view_create_from_range(remaining->data, (u64)index);
+        remaining->data += index + 1;
+        remaining->length -= (u64)index + 1;
+    }
+    return true;
+}
+
+b8 string_view_token_next(string_view* remaining, string_view* out_token) {
+    const char* p = remaining->data;
+    const char* end = p + remaining->length;
+    while (p < end && is_space(*p)) {
+        p++;
+    }
+    const char* start = p;
+    while (p < end && !is_space(*p)) {
+        p++;
+    }
+    remaining->length = (u64)(end - p);
+    remaining->data = p;
+    *out_token = string_view_create_from_range(start, (u64)(p - start));
+    return out_token->length > 0;
+}
+
+u64 string_view_copy(char* dest, string_view view, u64 max_length) {
+    u64 length = view.length < max_length - 1 ? view.length : max_length - 1;
+    kcopy_memory(dest, view.data, length);
+    dest[length] = 0;
+    return length;
+}
+
+char* string_view_duplicate(string_view view) {
+    char* copy = kallocate(view.length + 1, MEMORY_TAG_STRING);
+    kcopy_memory(copy, view.data, view.length);
+    copy[view.length] = 0;
+    return copy;
+}
+
+u64 string_view_parse_f64(string_view view, f64* out_value) {
+    *out_value = 0;
+    const char* p = view.data;
+    const char* end = p + view.length;
+    b8 negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    u64 mantissa = 0;
+    i32 exponent = 0;
+    u32 digits = 0;
+    for (; p < end && is_digit(*p); ++p, ++digits) {
+        // Digits beyond what a u64 can hold only affect the magnitude.
+        if (mantissa < 1000000000000000000ULL) {
+            mantissa = mantissa * 10 + (u64)(*p - '0');
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        p++;
+        for (; p < end && is_digit(*p); ++p, ++digits) {
+            if (mantissa < 1000000000000000000ULL) {
+                mantissa = mantissa * 10 + (u64)(*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0) {
+        return 0;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        b8 exponent_negative = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            exponent_negative = *e == '-';
+            e++;
+        }
+        // The exponent only counts if it has digits; otherwise the 'e' is not part of the number.
+        if (e < end && is_digit(*e)) {
+            i32 value = 0;
+            for (; e < end && is_digit(*e); ++e) {
+                if (value < 10000) {
+                    value = value * 10 + (*e - '0');
+                }
+            }
+            exponent += exponent_negative ? -value : value;
+            p = e;
+        }
+    }
+
+    // Scale by powers of ten exactly representable as doubles. This is exact for the short
+    // decimals found in asset files, and within an ulp or so of correct rounding otherwise.
+    static const f64 powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16};
+    f64 value = (f64)mantissa;
+    i32 remaining = exponent < 0 ? -exponent : exponent;
+    while (remaining > 0 && value != 0) {
+        i32 step = remaining > 16 ? 16 : remaining;
+        value = exponent < 0 ? value / powers[step] : value * powers[step];
+        remaining -= step;
+    }
+    *out_value = negative ? -value : value;
+    return (u64)(p - view.data);
+}
+
+u64 string_view_parse_f32(string_view view, f32* out_value) {
+    f64 value;
+    u64 parsed = string_view_parse_f64(view, &value);
+    *out_value = (f32)value;
+    return parsed;
+}
+
+u64 string_view_parse_u64(string_view view, u64* out_value) {
+    *out_value = 0;
+    u64 value = 0;
+    u64 i = 0;
+    for (; i < view.length && is_digit(view.data[i]); ++i) {
+        u64 digit = (u64)(view.data[i] - '0');
+        if (value > (18446744073709551615ULL - digit) / 10) {
+            // Out of range.
+            return 0;
+        }
+        value = value * 10 + digit;
+    }
+    *out_value = value;
+    return i;
+}
+
+u64 string_view_parse_i64(string_view view, i64* out_value) {
+    *out_value = 0;
+    b8 negative = view.length > 0 && view.data[0] == '-';
+    u64 sign_length = (view.length > 0 && (view.data[0] == '-' || view.data[0] == '+')) ? 1 : 0;
+    u64 magnitude = 0;
+    u64 parsed = string_view_parse_u64(string_view_mid(view, sign_length, view.length), &magnitude);
+    if (parsed == 0) {
+        return 0;
+    }
+    if (negative) {
+        if (magnitude > 9223372036854775808ULL) {
+            return 0;
+        }
+        *out_value = (i64)(0 - magnitude);
+    } else {
+        if (magnitude > 9223372036854775807ULL) {
+            return 0;
+        }
+        *out_value = (i64)magnitude;
+    }
+    return sign_length + parsed;
+}
+
+b8 string_view_to_f32_array(string_view view, u32 count, f32* out_values) {
+    string_view token;
+    for (u32 i = 0; i < count; ++i) {
+        if (!string_view_token_next(&view, &token) || string_view_parse_f32(token, &out_values[i]) != token.length) {
+            return false;
+        }
+    }
+    // Anything left over means the count was wrong.
+    return !string_view_token_next(&view, &token);
+}
+
+b8 string_view_to_bool(string_view view, b8* out_value) {
+    view = string_view_trim(view);
+    *out_value = string_view_equal(view, "1") || string_view_equali(view, "true");
+    return *out_value;
+}
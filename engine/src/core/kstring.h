@@ -83,6 +83,18 @@ KAPI i32 string_format(char* dest, const char* format, ...);
  */
 KAPI i32 string_format_v(char* dest, const char* format, void* va_list);
 
+/**
+ * @brief Performs variadic string formatting directly to dest given format string and va_list,
+ * writing at most max_length bytes including the null terminator. Output that does not
+ * fit is truncated.
+ * @param dest The destination for the formatted string.
+ * @param max_length The size of dest in bytes.
+ * @param format The string to be formatted.
+ * @param va_list The variadic argument list.
+ * @returns The length of the string written to dest, not including the null terminator; or -1 on error.
+ */
+KAPI i32 string_nformat_v(char* dest, u64 max_length, const char* format, void* va_list);
+
 /**
  * @brief Empties the provided string by setting the first character to 0.
  *
@@ -353,3 +365,180 @@ KAPI void string_filename_from_path(char* dest, const char* path);
  * @param path The full path to extract from.
  */
 KAPI void string_filename_no_extension_from_path(char* dest, const char* path);
+
+/**
+ * @brief A non-owning view of a run of characters, such as a token within a larger
+ * string. The characters are not necessarily null-terminated, and must outlive the view.
+ * None of the string_view functions allocate unless noted otherwise.
+ */
+typedef struct string_view {
+    /** @brief The first character of the view. */
+    const char* data;
+    /** @brief The number of characters in the view. */
+    u64 length;
+} string_view;
+
+/**
+ * @brief Creates a view of the given null-terminated string.
+ *
+ * @param str The string to view. May be 0, which gives an empty view.
+ * @return The view.
+ */
+KAPI string_view string_view_create(const char* str);
+
+/**
+ * @brief Creates a view of the given number of characters.
+ *
+ * @param data The first character to view.
+ * @param length The number of characters to view.
+ * @return The view.
+ */
+KAPI string_view string_view_create_from_range(const char* data, u64 length);
+
+/**
+ * @brief Gets the given view without any whitespace at either end.
+ *
+ * @param view The view to be trimmed.
+ * @return The trimmed view.
+ */
+KAPI string_view string_view_trim(string_view view);
+
+/**
+ * @brief Gets a view of part of the given view, clamped to its end.
+ *
+ * @param view The view to take the part from.
+ * @param start The index of the first character of the part.
+ * @param length The maximum number of characters in the part.
+ * @return The view of the part, which is empty if start is past the end.
+ */
+KAPI string_view string_view_mid(string_view view, u64 start, u64 length);
+
+/**
+ * @brief Returns the index of the first occurance of c in the view; otherwise -1.
+ *
+ * @param view The view to be scanned.
+ * @param c The character to search for.
+ * @return The index of the first occurance of c; otherwise -1 if not found.
+ */
+KAPI i64 string_view_index_of(string_view view, char c);
+
+/**
+ * @brief Case-sensitive comparison of a view against a null-terminated string.
+ *
+ * @param view The view to be compared.
+ * @param str The string to be compared.
+ * @return True if the same, otherwise false.
+ */
+KAPI b8 string_view_equal(string_view view, const char* str);
+
+/**
+ * @brief Case-insensitive comparison of a view against a null-terminated string.
+ *
+ * @param view The view to be compared.
+ * @param str The string to be compared.
+ * @return True if the same, otherwise false.
+ */
+KAPI b8 string_view_equali(string_view view, const char* str);
+
+/**
+ * @brief Splits the next entry off the front of remaining, up to the given delimiter, which is
+ * consumed. Used to iterate the entries of a delimited string, such as the lines of a file.
+ * Entries are not trimmed, and may be empty.
+ *
+ * @param remaining A pointer to the view still to be split. Advanced past the entry and delimiter.
+ * @param delimiter The character to split by.
+ * @param out_entry A pointer to hold the entry.
+ * @return True if an entry was split off; otherwise false, if nothing remained.
+ */
+KAPI b8 string_view_split_next(string_view* remaining, char delimiter, string_view* out_entry);
+
+/**
+ * @brief Splits the next whitespace-separated token off the front of remaining. Runs of
+ * whitespace are skipped, so tokens are never empty.
+ *
+ * @param remaining A pointer to the view still to be tokenized. Advanced past the token.
+ * @param out_token A pointer to hold the token.
+ * @return True if a token was found; otherwise false.
+ */
+KAPI b8 string_view_token_next(string_view* remaining, string_view* out_token);
+
+/**
+ * @brief Copies the view into dest as a null-terminated string, truncating it if needed.
+ *
+ * @param dest The destination string.
+ * @param view The view to be copied.
+ * @param max_length The size of dest, including the null terminator. Must be nonzero.
+ * @return The number of characters copied, not including the null terminator.
+ */
+KAPI u64 string_view_copy(char* dest, string_view view, u64 max_length);
+
+/**
+ * @brief Duplicates the view as a null-terminated string. Note that this allocates new memory,
+ * which should be freed by the caller.
+ *
+ * @param view The view to be duplicated.
+ * @return A pointer to a newly-created character array (string).
+ */
+KAPI char* string_view_duplicate(string_view view);
+
+/**
+ * @brief Parses a 64-bit floating-point number from the start of the view, in plain decimal or
+ * exponent form (i.e. "-1.5" or "2.5e-3"). Parsing stops at the first character which is not
+ * part of the number, in the manner of std::from_chars. Leading whitespace is not skipped.
+ *
+ * @param view The view to parse from.
+ * @param out_value A pointer to hold the value. Set to 0 if nothing could be parsed.
+ * @return The number of characters parsed; 0 if the view does not start with a number.
+ */
+KAPI u64 string_view_parse_f64(string_view view, f64* out_value);
+
+/**
+ * @brief Parses a 32-bit floating-point number from the start of the view.
+ * See string_view_parse_f64().
+ *
+ * @param view The view to parse from.
+ * @param out_value A pointer to hold the value. Set to 0 if nothing could be parsed.
+ * @return The number of characters parsed; 0 if the view does not start with a number.
+ */
+KAPI u64 string_view_parse_f32(string_view view, f32* out_value);
+
+/**
+ * @brief Parses a 64-bit signed decimal integer, with an optional sign, from the start of the view.
+ * Parsing stops at the first character which is not a digit. Leading whitespace is not skipped.
+ *
+ * @param view The view to parse from.
+ * @param out_value A pointer to hold the value. Set to 0 if nothing could be parsed.
+ * @return The number of characters parsed; 0 if the view does not start with an integer or it is out of range.
+ */
+KAPI u64 string_view_parse_i64(string_view view, i64* out_value);
+
+/**
+ * @brief Parses a 64-bit unsigned decimal integer from the start of the view. Parsing stops at
+ * the first character which is not a digit. Leading whitespace is not skipped.
+ *
+ * @param view The view to parse from.
+ * @param out_value A pointer to hold the value. Set to 0 if nothing could be parsed.
+ * @return The number of characters parsed; 0 if the view does not start with an integer or it is out of range.
+ */
+KAPI u64 string_view_parse_u64(string_view view, u64* out_value);
+
+/**
+ * @brief Parses exactly the given number of whitespace-separated floats from the view,
+ * i.e. the components of a vector such as "1.0 2.0 3.0".
+ *
+ * @param view The view to parse from.
+ * @param count The number of floats expected.
+ * @param out_values An array of count floats to hold the values.
+ * @return True if exactly count floats were parsed; otherwise false.
+ */
+KAPI b8 string_view_to_f32_array(string_view view, u32 count, f32* out_values);
+
+/**
+ * @brief Parses a boolean from the view. "true" (in any case) or "1" are considered true;
+ * anything else is false. Surrounding whitespace is ignored.
+ *
+ * @param view The view to parse from.
+ * @param out_value A pointer to hold the value.
+ * @return True if the value is true; otherwise false.
+ */
+KAPI b8 string_view_to_bool(string_view view, b8* out_value);
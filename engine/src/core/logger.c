@@ -8,16 +8,119 @@
 // TODO: temporary
 #include <stdarg.h>
 
+// The number of entries the log queue can hold. Must be a power of 2.
+#define LOG_QUEUE_CAPACITY 1024
+// The maximum length of a single log entry, including the level prefix. Longer entries are truncated.
+#define LOG_ENTRY_MAX_LENGTH 2048
+// The size of the buffer used to batch writes to the log file.
+#define LOG_FILE_BATCH_SIZE 65536
+
+// Binary log file identifier ("KLOG") and version.
+#define BINARY_LOG_MAGIC 0x474F4C4B
+#define BINARY_LOG_VERSION 2
+// The maximum number of threads which can write to the binary log. Others log as text.
+#define BINARY_LOG_MAX_THREADS 32
+// The size of each thread's binary log buffer. Must be a power of 2.
+#define BINARY_LOG_BUFFER_SIZE 32768
+// The maximum size of a single binary log record. String arguments are truncated to fit.
+#define BINARY_LOG_MAX_RECORD_SIZE 1024
+// Marks a call site as currently being registered by another thread.
+#define BINARY_LOG_FORMAT_ID_PENDING (INVALID_ID - 1)
+
+typedef enum binary_log_record_type {
+    // Maps a format id to its format string, level and argument types.
+    BINARY_LOG_RECORD_TYPE_FORMAT = 1,
+    // A log entry, holding a binary_log_entry_header followed by the raw bytes of its arguments.
+    BINARY_LOG_RECORD_TYPE_ENTRY = 2
+} binary_log_record_type;
+
+typedef enum binary_log_argument_type {
+    BINARY_LOG_ARGUMENT_TYPE_I32 = 1,
+    BINARY_LOG_ARGUMENT_TYPE_I64 = 2,
+    BINARY_LOG_ARGUMENT_TYPE_F64 = 3,
+    BINARY_LOG_ARGUMENT_TYPE_POINTER = 4,
+    // Stored as a u16 length followed by the characters.
+    BINARY_LOG_ARGUMENT_TYPE_STRING = 5
+} binary_log_argument_type;
+
+typedef struct binary_log_header {
+    u32 magic;
+    u16 version;
+    u16 reserved;
+} binary_log_header;
+
+typedef struct binary_log_record_header {
+    u8 type;
+    u8 level;
+    u16 payload_size;
+    u32 format_id;
+} binary_log_record_header;
+
+// Starts the payload of every entry record, ahead of its arguments.
+typedef struct binary_log_entry_header {
+    // Taken from a counter shared by all threads, so entries can be put back in the
+    // order they were logged. Each thread's buffer is written out separately.
+    u64 sequence;
+    // The index of the binary log buffer of the thread which logged the entry.
+    u32 thread_index;
+    u32 reserved;
+} binary_log_entry_header;
+
+// A single-producer, single-consumer ring of binary log records, one per logging thread.
+typedef struct binary_log_buffer {
+    // Only advanced by the owning thread.
+    u64 write_position;
+    // Only advanced by the writer thread.
+    u64 read_position;
+    u8 data[BINARY_LOG_BUFFER_SIZE];
+} binary_log_buffer;
+
+typedef struct log_entry {
+    // Used to hand the entry between producers and the writer thread.
+    // When equal to the queue position it's free; when position + 1, it's ready to be written.
+    u64 sequence;
+    log_level level;
+    u32 length;
+    char message[LOG_ENTRY_MAX_LENGTH];
+} log_entry;
+
 typedef struct logger_system_state {
     file_handle log_file_handle;
+    kthread writer_thread;
+    // Signaled whenever an entry is queued, or when shutting down.
+    ksemaphore entries_available;
+    volatile u32 is_running;
+    // The next queue position to be claimed by a log call.
+    u64 enqueue_position;
+    // The next queue position to be consumed. Only used by the writer thread.
+    u64 dequeue_position;
+    // The number of entries which have been fully written out.
+    u64 written_position;
+    // Output for the log file, written once per batch of entries.
+    u64 file_batch_length;
+    char file_batch[LOG_FILE_BATCH_SIZE];
+    log_entry entries[LOG_QUEUE_CAPACITY];
+
+    // Binary mode
+    file_handle binary_log_file_handle;
+    volatile u32 binary_mode_enabled;
+    // Identifies this run of the logger, so threads don't use buffers claimed in a previous one.
+    u32 generation;
+    u32 next_format_id;
+    u64 next_entry_sequence;
+    u32 binary_buffer_count;
+    binary_log_buffer binary_buffers[BINARY_LOG_MAX_THREADS];
 } logger_system_state;
 
 static logger_system_state* state_ptr;
+static u32 logger_generation = 0;
+
+// The binary log buffer claimed by the current thread, if any.
+static KTHREAD_LOCAL binary_log_buffer* thread_binary_buffer = 0;
+static KTHREAD_LOCAL u32 thread_binary_buffer_generation = 0;
 
-void append_to_log_file(const char* message) {
+void append_to_log_file(const char* message, u64 length) {
     if (state_ptr && state_ptr->log_file_handle.is_valid) {
-        // Since the message already contains a '\n', just write the bytes directly.
-        u64 length = string_length(message);
         u64 written = 0;
         if (!filesystem_write(&state_ptr->log_file_handle, length, message, &written)) {
             platform_console_write_error("ERROR writing to console.log.", LOG_LEVEL_ERROR);
@@ -25,20 +128,140 @@ void append_to_log_file(const char* message) {
     }
 }
 
+static void flush_file_batch(logger_system_state* state) {
+    if (state->file_batch_length) {
+        append_to_log_file(state->file_batch, state->file_batch_length);
+        state->file_batch_length = 0;
+    }
+}
+
+/**
+ * Writes out every entry which is ready, in order. Console output is written per entry,
+ * while log file output is batched so the file is only written (and flushed) once per call.
+ */
+static void write_queued_entries(logger_system_state* state) {
+    while (true) {
+        log_entry* entry = &state->entries[state->dequeue_position & (LOG_QUEUE_CAPACITY - 1)];
+        if (platform_atomic_load_u64(&entry->sequence) != state->dequeue_position + 1) {
+            break;
+        }
+
+        if (entry->level < LOG_LEVEL_WARN) {
+            platform_console_write_error(entry->message, entry->level);
+        } else {
+            platform_console_write(entry->message, entry->level);
+        }
+
+        if (state->file_batch_length + entry->length > LOG_FILE_BATCH_SIZE) {
+            flush_file_batch(state);
+        }
+        kcopy_memory(state->file_batch + state->file_batch_length, entry->message, entry->length);
+        state->file_batch_length += entry->length;
+
+        // Release the entry to be reused on the next pass around the queue.
+        platform_atomic_store_u64(&entry->sequence, state->dequeue_position + LOG_QUEUE_CAPACITY);
+        state->dequeue_position++;
+    }
+
+    flush_file_batch(state);
+
+    // Write out whatever each thread has buffered for the binary log.
+    u32 buffer_count = platform_atomic_load_u32(&state->binary_buffer_count);
+    if (buffer_count > BINARY_LOG_MAX_THREADS) {
+        buffer_count = BINARY_LOG_MAX_THREADS;
+    }
+    for (u32 i = 0; i < buffer_count; ++i) {
+        binary_log_buffer* buffer = &state->binary_buffers[i];
+        u64 read = buffer->read_position;
+        u64 write = platform_atomic_load_u64(&buffer->write_position);
+        while (read < write) {
+            // Write up to the end of the ring, then from the start if it wraps.
+            u64 offset = read & (BINARY_LOG_BUFFER_SIZE - 1);
+            u64 size = KMIN(write - read, BINARY_LOG_BUFFER_SIZE - offset);
+            u64 written = 0;
+            if (!filesystem_write(&state->binary_log_file_handle, size, buffer->data + offset, &written)) {
+                platform_console_write_error("ERROR writing to console.klog.", LOG_LEVEL_ERROR);
+            }
+            read += size;
+        }
+        platform_atomic_store_u64(&buffer->read_position, read);
+    }
+
+    platform_atomic_store_u64(&state->written_position, state->dequeue_position);
+}
+
+static u32 log_writer_thread(void* params) {
+    logger_system_state* state = params;
+    while (true) {
+        platform_semaphore_wait(&state->entries_available);
+        b8 is_running = platform_atomic_load_u32(&state->is_running);
+        write_queued_entries(state);
+        if (!is_running) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Creates new/wipes the existing binary log file, opens it and writes its header. Only done
+ * once binary mode is first enabled, so runs which never use it leave no binary log behind.
+ */
+static b8 open_binary_log(logger_system_state* state) {
+    if (state->binary_log_file_handle.is_valid) {
+        return true;
+    }
+    if (!filesystem_open("console.klog", FILE_MODE_WRITE, true, &state->binary_log_file_handle)) {
+        platform_console_write_error("ERROR: Unable to open console.klog for writing. Binary log mode is unavailable.", LOG_LEVEL_ERROR);
+        return false;
+    }
+    binary_log_header header = {BINARY_LOG_MAGIC, BINARY_LOG_VERSION, 0};
+    u64 written = 0;
+    filesystem_write(&state->binary_log_file_handle, sizeof(binary_log_header), &header, &written);
+    return true;
+}
+
 b8 initialize_logging(u64* memory_requirement, void* state) {
     *memory_requirement = sizeof(logger_system_state);
     if (state == 0) {
         return true;
     }
 
-    state_ptr = state;
+    logger_system_state* new_state = state;
+    kzero_memory(new_state, sizeof(logger_system_state));
+    for (u64 i = 0; i < LOG_QUEUE_CAPACITY; ++i) {
+        new_state->entries[i].sequence = i;
+    }
 
     // Create new/wipe existing log file, then open it.
-    if (!filesystem_open("console.log", FILE_MODE_WRITE, false, &state_ptr->log_file_handle)) {
+    if (!filesystem_open("console.log", FILE_MODE_WRITE, false, &new_state->log_file_handle)) {
         platform_console_write_error("ERROR: Unable to open console.log for writing.", LOG_LEVEL_ERROR);
         return false;
     }
 
+    if (!platform_semaphore_create(0, &new_state->entries_available)) {
+        platform_console_write_error("ERROR: Unable to create log writer semaphore.", LOG_LEVEL_ERROR);
+        filesystem_close(&new_state->log_file_handle);
+        return false;
+    }
+
+    new_state->is_running = true;
+    if (!platform_thread_create(log_writer_thread, new_state, &new_state->writer_thread)) {
+        platform_console_write_error("ERROR: Unable to create log writer thread.", LOG_LEVEL_ERROR);
+        platform_semaphore_destroy(&new_state->entries_available);
+        filesystem_close(&new_state->log_file_handle);
+        return false;
+    }
+
+    new_state->generation = ++logger_generation;
+    new_state->next_format_id = 1;
+#if KRELEASE == 1
+    new_state->binary_mode_enabled = open_binary_log(new_state);
+#endif
+
+    // Only start queueing entries once the writer is running.
+    state_ptr = new_state;
+
     // TODO: Remove this
     KFATAL("A test message: %f", 3.14f);
     KERROR("A test message: %f", 3.14f);
@@ -47,50 +270,659 @@ b8 initialize_logging(u64* memory_requirement, void* state) {
     KDEBUG("A test message: %f", 3.14f);
     KTRACE("A test message: %f", 3.14f);
 
-    // TODO: create log file.
     return true;
 }
 
 void shutdown_logging(void* state) {
-    // TODO: cleanup logging/write queued entries.
+    if (!state_ptr) {
+        return;
+    }
+
+    // Have the writer write out everything still queued, then exit.
+    platform_atomic_store_u32(&state_ptr->is_running, false);
+    platform_semaphore_signal(&state_ptr->entries_available);
+    platform_thread_join(&state_ptr->writer_thread);
+
+    platform_semaphore_destroy(&state_ptr->entries_available);
+    filesystem_close(&state_ptr->log_file_handle);
+    if (state_ptr->binary_log_file_handle.is_valid) {
+        filesystem_close(&state_ptr->binary_log_file_handle);
+    }
     state_ptr = 0;
 }
 
-void log_output(log_level level, const char* message, ...) {
-    // TODO: These string operations are all pretty slow. This needs to be
-    // moved to another thread eventually, along with the file writes, to
-    // avoid slowing things down while the engine is trying to run.
+void log_binary_mode_set(b8 enabled) {
+    if (state_ptr) {
+        // The file is opened before binary mode is enabled, as the writer thread writes to it once records are buffered.
+        if (enabled && !open_binary_log(state_ptr)) {
+            KWARN("Binary log mode is unavailable as console.klog could not be opened.");
+            return;
+        }
+        platform_atomic_store_u32(&state_ptr->binary_mode_enabled, enabled);
+    }
+}
+
+/**
+ * Formats the level prefix, message and trailing newline into dest,
+ * which must be LOG_ENTRY_MAX_LENGTH in size. Returns the length written.
+ */
+static u32 format_entry(char* dest, log_level level, const char* message, void* arg_ptr) {
     const char* level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
-    b8 is_error = level < LOG_LEVEL_WARN;
+    const u32 prefix_length = 9;
+    kcopy_memory(dest, level_strings[level], prefix_length);
+
+    // Leave room for the newline.
+    i32 length = string_nformat_v(dest + prefix_length, LOG_ENTRY_MAX_LENGTH - prefix_length - 1, message, arg_ptr);
+    if (length < 0) {
+        length = 0;
+    }
+    u32 total = prefix_length + length;
+    dest[total++] = '\n';
+    dest[total] = 0;
+    return total;
+}
+
+/**
+ * Claims the next free entry in the queue, waiting for the writer thread to
+ * make room if the queue is full.
+ */
+static log_entry* claim_entry(u64* out_position) {
+    u64 position = platform_atomic_load_u64(&state_ptr->enqueue_position);
+    while (true) {
+        log_entry* entry = &state_ptr->entries[position & (LOG_QUEUE_CAPACITY - 1)];
+        u64 sequence = platform_atomic_load_u64(&entry->sequence);
+        i64 difference = (i64)sequence - (i64)position;
+        if (difference == 0) {
+            // The entry is free. Try to take it; on failure position is reloaded.
+            if (platform_atomic_compare_exchange_u64(&state_ptr->enqueue_position, &position, position + 1)) {
+                *out_position = position;
+                return entry;
+            }
+        } else if (difference < 0) {
+            // The queue is full. Give the writer thread a chance to catch up.
+            platform_semaphore_signal(&state_ptr->entries_available);
+            platform_sleep(0);
+            position = platform_atomic_load_u64(&state_ptr->enqueue_position);
+        } else {
+            // Another thread claimed this entry first.
+            position = platform_atomic_load_u64(&state_ptr->enqueue_position);
+        }
+    }
+}
+
+static void log_output_v(log_level level, const char* message, void* arg_ptr) {
+    if (!state_ptr) {
+        // Before startup or after shutdown there is no writer, so just print directly.
+        char out_message[LOG_ENTRY_MAX_LENGTH];
+        format_entry(out_message, level, message, arg_ptr);
+        if (level < LOG_LEVEL_WARN) {
+            platform_console_write_error(out_message, level);
+        } else {
+            platform_console_write(out_message, level);
+        }
+        return;
+    }
+
+    // Format straight into the queue, then hand off to the writer thread.
+    u64 position;
+    log_entry* entry = claim_entry(&position);
+    entry->level = level;
+    entry->length = format_entry(entry->message, level, message, arg_ptr);
+    platform_atomic_store_u64(&entry->sequence, position + 1);
+    platform_semaphore_signal(&state_ptr->entries_available);
 
-    // Technically imposes a 32k character limit on a single log entry, but...
-    // DON'T DO THAT!
-    char out_message[32000];
-    kzero_memory(out_message, sizeof(out_message));
+    // Errors are written out before returning, as the application may be about to go down.
+    if (level < LOG_LEVEL_WARN) {
+        while (platform_atomic_load_u64(&state_ptr->written_position) <= position) {
+            platform_sleep(0);
+        }
+    }
+}
 
-    // Format original message.
+void log_output(log_level level, const char* message, ...) {
     // NOTE: Oddly enough, MS's headers override the GCC/Clang va_list type with a "typedef char* va_list" in some
     // cases, and as a result throws a strange error here. The workaround for now is to just use __builtin_va_list,
     // which is the type GCC/Clang's va_start expects.
     __builtin_va_list arg_ptr;
     va_start(arg_ptr, message);
-    string_format_v(out_message, message, arg_ptr);
+    log_output_v(level, message, arg_ptr);
     va_end(arg_ptr);
+}
+
+/**
+ * Determines the type of each argument consumed by the given format string.
+ * Returns false if the format string can't be deferred, in which case it is
+ * logged as text instead.
+ */
+static b8 parse_format_arguments(const char* format, u8* out_types, u8* out_count) {
+    u8 count = 0;
+    for (const char* c = format; *c; ++c) {
+        if (*c != '%') {
+            continue;
+        }
+        c++;
+        if (*c == '%') {
+            continue;
+        }
+        // Flags, width and precision. Widths/precisions passed as arguments aren't supported.
+        while (*c && string_index_of("-+ #0123456789.", *c) != -1) {
+            c++;
+        }
+        if (*c == '*') {
+            return false;
+        }
+        // Length modifiers.
+        u8 size = 4;
+        if (*c == 'h') {
+            c += (c[1] == 'h') ? 2 : 1;
+        } else if (*c == 'l') {
+            size = (c[1] == 'l') ? sizeof(long long) : sizeof(long);
+            c += (c[1] == 'l') ? 2 : 1;
+        } else if (*c == 'z' || *c == 't' || *c == 'j') {
+            size = 8;
+            c++;
+        } else if (*c == 'L') {
+            return false;
+        }
 
-    // Prepend log level to message.
-    string_format(out_message, "%s%s\n", level_strings[level], out_message);
+        if (count == LOG_BINARY_MAX_ARGUMENTS) {
+            return false;
+        }
+        switch (*c) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+                out_types[count++] = size == 8 ? BINARY_LOG_ARGUMENT_TYPE_I64 : BINARY_LOG_ARGUMENT_TYPE_I32;
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                out_types[count++] = BINARY_LOG_ARGUMENT_TYPE_F64;
+                break;
+            case 's':
+                out_types[count++] = BINARY_LOG_ARGUMENT_TYPE_STRING;
+                break;
+            case 'p':
+                out_types[count++] = BINARY_LOG_ARGUMENT_TYPE_POINTER;
+                break;
+            default:
+                // Includes %n and anything malformed.
+                return false;
+        }
+    }
+    *out_count = count;
+    return true;
+}
+
+/**
+ * Obtains the current thread's binary log buffer, claiming one the first time
+ * the thread logs. Returns 0 if none are left.
+ */
+static binary_log_buffer* get_thread_binary_buffer() {
+    if (thread_binary_buffer_generation == state_ptr->generation) {
+        return thread_binary_buffer;
+    }
+    thread_binary_buffer_generation = state_ptr->generation;
+    u32 index = platform_atomic_fetch_add_u32(&state_ptr->binary_buffer_count, 1);
+    thread_binary_buffer = index < BINARY_LOG_MAX_THREADS ? &state_ptr->binary_buffers[index] : 0;
+    return thread_binary_buffer;
+}
 
-    // Print accordingly
-    if (is_error) {
-        platform_console_write_error(out_message, level);
+/**
+ * Copies a record into the given thread's buffer, waiting for the writer
+ * thread to make room if the buffer is full.
+ */
+static void write_binary_record(binary_log_buffer* buffer, const u8* record, u64 size) {
+    u64 write = buffer->write_position;
+    while (BINARY_LOG_BUFFER_SIZE - (write - platform_atomic_load_u64(&buffer->read_position)) < size) {
+        platform_semaphore_signal(&state_ptr->entries_available);
+        platform_sleep(0);
+    }
+
+    u64 offset = write & (BINARY_LOG_BUFFER_SIZE - 1);
+    u64 first_size = KMIN(size, BINARY_LOG_BUFFER_SIZE - offset);
+    kcopy_memory(buffer->data + offset, record, first_size);
+    if (first_size < size) {
+        kcopy_memory(buffer->data, record + first_size, size - first_size);
+    }
+
+    u64 used_before = write - buffer->read_position;
+    platform_atomic_store_u64(&buffer->write_position, write + size);
+
+    // Wake the writer once the buffer passes a quarter full, rather than on every record.
+    // Anything less is written out along with the next text entry, or at shutdown.
+    const u64 wake_threshold = BINARY_LOG_BUFFER_SIZE / 4;
+    if (used_before <= wake_threshold && used_before + size > wake_threshold) {
+        platform_semaphore_signal(&state_ptr->entries_available);
+    }
+}
+
+/**
+ * Obtains the format id of the given call site, registering it and writing its
+ * format record to the binary log on first use. Returns INVALID_ID if the site
+ * should be logged as text.
+ */
+static u32 get_format_id(binary_log_buffer* buffer, log_level level, log_format_site* site, const char* message) {
+    u32 id = platform_atomic_load_u32(&site->format_id);
+    if (id != 0) {
+        return id == BINARY_LOG_FORMAT_ID_PENDING ? INVALID_ID : id;
+    }
+
+    // Claim the registration, so concurrent first uses don't race to fill in the site.
+    u32 expected = 0;
+    if (!platform_atomic_compare_exchange_u32(&site->format_id, &expected, BINARY_LOG_FORMAT_ID_PENDING)) {
+        return expected == BINARY_LOG_FORMAT_ID_PENDING ? INVALID_ID : expected;
+    }
+
+    u64 format_length = string_length(message);
+    u64 payload_size = 1 + LOG_BINARY_MAX_ARGUMENTS + format_length;
+    if (sizeof(binary_log_record_header) + payload_size > BINARY_LOG_MAX_RECORD_SIZE ||
+        !parse_format_arguments(message, site->argument_types, &site->argument_count)) {
+        platform_atomic_store_u32(&site->format_id, INVALID_ID);
+        return INVALID_ID;
+    }
+    id = platform_atomic_fetch_add_u32(&state_ptr->next_format_id, 1);
+
+    // Write the format record: argument count, argument types, then the format string.
+    u8 record[BINARY_LOG_MAX_RECORD_SIZE];
+    payload_size = 1 + site->argument_count + format_length;
+    binary_log_record_header header = {BINARY_LOG_RECORD_TYPE_FORMAT, level, (u16)payload_size, id};
+    u8* payload = record + sizeof(binary_log_record_header);
+    kcopy_memory(record, &header, sizeof(binary_log_record_header));
+    payload[0] = site->argument_count;
+    kcopy_memory(payload + 1, site->argument_types, site->argument_count);
+    kcopy_memory(payload + 1 + site->argument_count, message, format_length);
+    write_binary_record(buffer, record, sizeof(binary_log_record_header) + payload_size);
+
+    platform_atomic_store_u32(&site->format_id, id);
+    return id;
+}
+
+void log_output_deferred(log_level level, log_format_site* site, const char* message, ...) {
+    __builtin_va_list arg_ptr;
+    va_start(arg_ptr, message);
+
+    binary_log_buffer* buffer = 0;
+    u32 id = INVALID_ID;
+    if (state_ptr && platform_atomic_load_u32(&state_ptr->binary_mode_enabled)) {
+        buffer = get_thread_binary_buffer();
+        if (buffer) {
+            id = get_format_id(buffer, level, site, message);
+        }
+    }
+
+    if (id == INVALID_ID) {
+        log_output_v(level, message, arg_ptr);
+        va_end(arg_ptr);
+        return;
+    }
+
+    // Capture the raw argument bytes, leaving formatting to the decoder.
+    u8 record[BINARY_LOG_MAX_RECORD_SIZE];
+    u8* payload = record + sizeof(binary_log_record_header);
+    const u64 max_payload_size = BINARY_LOG_MAX_RECORD_SIZE - sizeof(binary_log_record_header);
+    u64 payload_size = sizeof(binary_log_entry_header);
+    for (u8 i = 0; i < site->argument_count; ++i) {
+        switch (site->argument_types[i]) {
+            case BINARY_LOG_ARGUMENT_TYPE_I32: {
+                i32 value = va_arg(arg_ptr, i32);
+                kcopy_memory(payload + payload_size, &value, sizeof(i32));
+                payload_size += sizeof(i32);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_I64: {
+                i64 value = va_arg(arg_ptr, i64);
+                kcopy_memory(payload + payload_size, &value, sizeof(i64));
+                payload_size += sizeof(i64);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_F64: {
+                f64 value = va_arg(arg_ptr, f64);
+                kcopy_memory(payload + payload_size, &value, sizeof(f64));
+                payload_size += sizeof(f64);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_POINTER: {
+                u64 value = (u64)va_arg(arg_ptr, void*);
+                kcopy_memory(payload + payload_size, &value, sizeof(u64));
+                payload_size += sizeof(u64);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_STRING: {
+                const char* value = va_arg(arg_ptr, const char*);
+                if (!value) {
+                    value = "(null)";
+                }
+                // Leave room for the remaining arguments, which are at most 8 bytes each.
+                u64 remaining = max_payload_size - payload_size - sizeof(u16) - (site->argument_count - i - 1) * sizeof(u64);
+                u16 length = (u16)KMIN(string_length(value), remaining);
+                kcopy_memory(payload + payload_size, &length, sizeof(u16));
+                kcopy_memory(payload + payload_size + sizeof(u16), value, length);
+                payload_size += sizeof(u16) + length;
+            } break;
+        }
+    }
+    va_end(arg_ptr);
+
+    binary_log_entry_header entry_header = {0};
+    entry_header.sequence = platform_atomic_fetch_add_u64(&state_ptr->next_entry_sequence, 1);
+    entry_header.thread_index = (u32)(buffer - state_ptr->binary_buffers);
+    kcopy_memory(payload, &entry_header, sizeof(binary_log_entry_header));
+
+    binary_log_record_header header = {BINARY_LOG_RECORD_TYPE_ENTRY, level, (u16)payload_size, id};
+    kcopy_memory(record, &header, sizeof(binary_log_record_header));
+    write_binary_record(buffer, record, sizeof(binary_log_record_header) + payload_size);
+}
+
+typedef struct binary_log_format {
+    u8 level;
+    u8 argument_count;
+    u8 argument_types[LOG_BINARY_MAX_ARGUMENTS];
+    // Null-terminated copy of the format string. 0 if not defined.
+    char* format;
+} binary_log_format;
+
+static i32 format_argument(char* dest, u64 max_length, const char* format, ...) {
+    __builtin_va_list arg_ptr;
+    va_start(arg_ptr, format);
+    i32 length = string_nformat_v(dest, max_length, format, arg_ptr);
+    va_end(arg_ptr);
+    return length < 0 ? 0 : length;
+}
+
+/**
+ * Renders a single entry as a line of text in the same form as the text log, prefixed
+ * with the thread which logged it. Returns the length written to dest, which must be
+ * LOG_ENTRY_MAX_LENGTH in size.
+ */
+static u32 render_binary_entry(const binary_log_format* format, u32 thread_index, const u8* payload, u64 payload_size, char* dest) {
+    const char* level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
+    // Leave room for the newline and terminator.
+    const u64 max_length = LOG_ENTRY_MAX_LENGTH - 2;
+    u64 length = string_format(dest, "[thread %u] ", thread_index);
+    kcopy_memory(dest + length, level_strings[format->level <= LOG_LEVEL_TRACE ? format->level : LOG_LEVEL_TRACE], 9);
+    length += 9;
+
+    u64 offset = 0;
+    u8 argument = 0;
+    for (const char* c = format->format; *c && length < max_length; ++c) {
+        if (*c != '%') {
+            dest[length++] = *c;
+            continue;
+        }
+        if (c[1] == '%') {
+            dest[length++] = '%';
+            c++;
+            continue;
+        }
+
+        // Isolate the conversion specification, i.e. "%-8.3f".
+        char spec[32];
+        u32 spec_length = 0;
+        while (*c && spec_length < sizeof(spec) - 1) {
+            spec[spec_length++] = *c;
+            if (spec_length > 1 && string_index_of("diuoxXcfFeEgGaAsp", *c) != -1) {
+                break;
+            }
+            c++;
+        }
+        spec[spec_length] = 0;
+        if (!*c) {
+            break;
+        }
+        if (argument >= format->argument_count) {
+            break;
+        }
+
+        char* out = dest + length;
+        u64 out_max = max_length - length + 1;
+        switch (format->argument_types[argument++]) {
+            case BINARY_LOG_ARGUMENT_TYPE_I32: {
+                i32 value = 0;
+                if (offset + sizeof(i32) <= payload_size) {
+                    kcopy_memory(&value, payload + offset, sizeof(i32));
+                }
+                offset += sizeof(i32);
+                length += format_argument(out, out_max, spec, value);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_I64: {
+                i64 value = 0;
+                if (offset + sizeof(i64) <= payload_size) {
+                    kcopy_memory(&value, payload + offset, sizeof(i64));
+                }
+                offset += sizeof(i64);
+                length += format_argument(out, out_max, spec, value);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_F64: {
+                f64 value = 0;
+                if (offset + sizeof(f64) <= payload_size) {
+                    kcopy_memory(&value, payload + offset, sizeof(f64));
+                }
+                offset += sizeof(f64);
+                length += format_argument(out, out_max, spec, value);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_POINTER: {
+                u64 value = 0;
+                if (offset + sizeof(u64) <= payload_size) {
+                    kcopy_memory(&value, payload + offset, sizeof(u64));
+                }
+                offset += sizeof(u64);
+                length += format_argument(out, out_max, spec, (void*)value);
+            } break;
+            case BINARY_LOG_ARGUMENT_TYPE_STRING: {
+                char value[BINARY_LOG_MAX_RECORD_SIZE];
+                u16 value_length = 0;
+                if (offset + sizeof(u16) <= payload_size) {
+                    kcopy_memory(&value_length, payload + offset, sizeof(u16));
+                }
+                offset += sizeof(u16);
+                if (offset + value_length > payload_size) {
+                    value_length = 0;
+                }
+                kcopy_memory(value, payload + offset, value_length);
+                value[value_length] = 0;
+                offset += value_length;
+                length += format_argument(out, out_max, spec, value);
+            } break;
+        }
+    }
+
+    if (length > max_length) {
+        length = max_length;
+    }
+    dest[length++] = '\n';
+    dest[length] = 0;
+    return length;
+}
+
+// An entry record in a binary log being decoded.
+typedef struct binary_log_entry_ref {
+    u64 sequence;
+    // The offset of the record header in the file.
+    u64 offset;
+} binary_log_entry_ref;
+
+static void entry_ref_sift_down(binary_log_entry_ref* refs, u64 start, u64 end) {
+    u64 root = start;
+    while (root * 2 + 1 < end) {
+        u64 child = root * 2 + 1;
+        // A max-heap, so the sort is ascending.
+        if (child + 1 < end && refs[child + 1].sequence > refs[child].sequence) {
+            child++;
+        }
+        if (refs[root].sequence >= refs[child].sequence) {
+            return;
+        }
+        binary_log_entry_ref temp = refs[root];
+        refs[root] = refs[child];
+        refs[child] = temp;
+        root = child;
+    }
+}
+
+// Heapsort by ascending sequence.
+static void entry_refs_sort(binary_log_entry_ref* refs, u64 count) {
+    if (count < 2) {
+        return;
+    }
+    for (u64 i = count / 2; i > 0; --i) {
+        entry_ref_sift_down(refs, i - 1, count);
+    }
+    for (u64 end = count - 1; end > 0; --end) {
+        binary_log_entry_ref temp = refs[0];
+        refs[0] = refs[end];
+        refs[end] = temp;
+        entry_ref_sift_down(refs, 0, end);
+    }
+}
+
+/**
+ * Reads the record header at the given offset of the binary log. Returns false
+ * if there isn't a complete record there.
+ */
+static b8 read_binary_log_record(const u8* data, u64 size, u64 offset, binary_log_record_header* out_header) {
+    if (size - offset < sizeof(binary_log_record_header)) {
+        return false;
+    }
+    kcopy_memory(out_header, data + offset, sizeof(binary_log_record_header));
+    return size - offset - sizeof(binary_log_record_header) >= out_header->payload_size;
+}
+
+b8 log_binary_decode(const char* binary_log_path, const char* text_log_path) {
+    file_handle in;
+    if (!filesystem_open(binary_log_path, FILE_MODE_READ, true, &in)) {
+        KERROR("log_binary_decode - Unable to open '%s' for reading.", binary_log_path);
+        return false;
+    }
+    u64 size = 0;
+    if (!filesystem_size(&in, &size) || size < sizeof(binary_log_header)) {
+        KERROR("log_binary_decode - '%s' is not a valid binary log.", binary_log_path);
+        filesystem_close(&in);
+        return false;
+    }
+    // The whole file is read in, as entries are rendered in a different order to how they are stored.
+    u8* data = kallocate(size, MEMORY_TAG_ARRAY);
+    u64 read = 0;
+    b8 read_result = filesystem_read(&in, size, data, &read) && read == size;
+    filesystem_close(&in);
+
+    binary_log_header file_header;
+    kcopy_memory(&file_header, data, sizeof(binary_log_header));
+    if (!read_result || file_header.magic != BINARY_LOG_MAGIC || file_header.version != BINARY_LOG_VERSION) {
+        KERROR("log_binary_decode - '%s' is not a valid binary log.", binary_log_path);
+        kfree(data, size, MEMORY_TAG_ARRAY);
+        return false;
+    }
+
+    // Gather format records and entries. Threads write their records independently,
+    // so an entry can appear in the file before the format record it refers to, and
+    // entries are grouped by thread rather than in the order they were logged.
+    u32 format_capacity = 256;
+    binary_log_format* formats = kallocate(sizeof(binary_log_format) * format_capacity, MEMORY_TAG_ARRAY);
+    u64 entry_capacity = 1024;
+    u64 entry_count = 0;
+    binary_log_entry_ref* entries = kallocate(sizeof(binary_log_entry_ref) * entry_capacity, MEMORY_TAG_ARRAY);
+    binary_log_record_header header;
+    for (u64 offset = sizeof(binary_log_header); read_binary_log_record(data, size, offset, &header);
+         offset += sizeof(binary_log_record_header) + header.payload_size) {
+        const u8* payload = data + offset + sizeof(binary_log_record_header);
+        if (header.type == BINARY_LOG_RECORD_TYPE_ENTRY) {
+            if (header.payload_size < sizeof(binary_log_entry_header)) {
+                continue;
+            }
+            if (entry_count == entry_capacity) {
+                binary_log_entry_ref* new_entries = kallocate(sizeof(binary_log_entry_ref) * entry_capacity * 2, MEMORY_TAG_ARRAY);
+                kcopy_memory(new_entries, entries, sizeof(binary_log_entry_ref) * entry_capacity);
+                kfree(entries, sizeof(binary_log_entry_ref) * entry_capacity, MEMORY_TAG_ARRAY);
+                entries = new_entries;
+                entry_capacity *= 2;
+            }
+            binary_log_entry_header entry_header;
+            kcopy_memory(&entry_header, payload, sizeof(binary_log_entry_header));
+            entries[entry_count].sequence = entry_header.sequence;
+            entries[entry_count].offset = offset;
+            entry_count++;
+            continue;
+        }
+        if (header.type != BINARY_LOG_RECORD_TYPE_FORMAT || header.payload_size < 1 || header.format_id == 0) {
+            continue;
+        }
+        if (header.format_id >= format_capacity) {
+            u32 new_capacity = format_capacity;
+            while (header.format_id >= new_capacity) {
+                new_capacity *= 2;
+            }
+            binary_log_format* new_formats = kallocate(sizeof(binary_log_format) * new_capacity, MEMORY_TAG_ARRAY);
+            kcopy_memory(new_formats, formats, sizeof(binary_log_format) * format_capacity);
+            kfree(formats, sizeof(binary_log_format) * format_capacity, MEMORY_TAG_ARRAY);
+            formats = new_formats;
+            format_capacity = new_capacity;
+        }
+        binary_log_format* format = &formats[header.format_id];
+        if (format->format) {
+            continue;
+        }
+        format->level = header.level;
+        format->argument_count = KMIN(payload[0], LOG_BINARY_MAX_ARGUMENTS);
+        if (1 + (u64)format->argument_count > header.payload_size) {
+            continue;
+        }
+        kcopy_memory(format->argument_types, payload + 1, format->argument_count);
+        u64 format_length = header.payload_size - 1 - format->argument_count;
+        format->format = kallocate(format_length + 1, MEMORY_TAG_STRING);
+        kcopy_memory(format->format, payload + 1 + format->argument_count, format_length);
+    }
+
+    // Put the entries of every thread back in the order they were logged, then render them.
+    entry_refs_sort(entries, entry_count);
+    b8 result = true;
+    file_handle out;
+    if (!filesystem_open(text_log_path, FILE_MODE_WRITE, false, &out)) {
+        KERROR("log_binary_decode - Unable to open '%s' for writing.", text_log_path);
+        result = false;
     } else {
-        platform_console_write(out_message, level);
+        char line[LOG_ENTRY_MAX_LENGTH];
+        for (u64 i = 0; i < entry_count; ++i) {
+            kcopy_memory(&header, data + entries[i].offset, sizeof(binary_log_record_header));
+            const u8* payload = data + entries[i].offset + sizeof(binary_log_record_header);
+            binary_log_entry_header entry_header;
+            kcopy_memory(&entry_header, payload, sizeof(binary_log_entry_header));
+            u32 length = 0;
+            if (header.format_id < format_capacity && formats[header.format_id].format) {
+                length = render_binary_entry(&formats[header.format_id], entry_header.thread_index, payload + sizeof(binary_log_entry_header),
+                                             header.payload_size - sizeof(binary_log_entry_header), line);
+            } else {
+                length = string_format(line, "[thread %u] [ERROR]: <unknown format id %u>\n", entry_header.thread_index, header.format_id);
+            }
+            u64 written = 0;
+            if (!filesystem_write(&out, length, line, &written)) {
+                KERROR("log_binary_decode - Failed to write to '%s'.", text_log_path);
+                result = false;
+                break;
+            }
+        }
+        filesystem_close(&out);
+        if (result) {
+            KINFO("Decoded %llu binary log entries from '%s' to '%s'.", entry_count, binary_log_path, text_log_path);
+        }
     }
 
-    // Queue a copy to be written to the log file.
-    append_to_log_file(out_message);
+    for (u32 i = 0; i < format_capacity; ++i) {
+        if (formats[i].format) {
+            kfree(formats[i].format, string_length(formats[i].format) + 1, MEMORY_TAG_STRING);
+        }
+    }
+    kfree(formats, sizeof(binary_log_format) * format_capacity, MEMORY_TAG_ARRAY);
+    kfree(entries, sizeof(binary_log_entry_ref) * entry_capacity, MEMORY_TAG_ARRAY);
+    kfree(data, size, MEMORY_TAG_ARRAY);
+    return result;
 }
 
 void report_assertion_failure(const char* expression, const char* message, const char* file, i32 line) {
     log_output(LOG_LEVEL_FATAL, "Assertion Failure: %s, message: '%s', in file: %s, line: %d\n", expression, message, file, line);
-}
\ No newline at end of file
+}
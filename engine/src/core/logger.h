@@ -21,13 +21,22 @@
 #define LOG_DEBUG_ENABLED 1
 /** @brief Indicates if trace level logging is enabled. */
 #define LOG_TRACE_ENABLED 1
+/**
+ * @brief Indicates if debug and trace level logging can be deferred to the binary log,
+ * where call sites store only a format id and raw arguments, leaving formatting to
+ * log_binary_decode() offline.
+ */
+#define LOG_BINARY_ENABLED 1
 
-// Disable debug and trace logging for release builds.
-#if KRELEASE == 1
+// Disable debug and trace logging for release builds, unless it can be deferred to the binary log.
+#if KRELEASE == 1 && LOG_BINARY_ENABLED != 1
 #define LOG_DEBUG_ENABLED 0
 #define LOG_TRACE_ENABLED 0
 #endif
 
+/** @brief The maximum number of arguments a deferred log call can have. */
+#define LOG_BINARY_MAX_ARGUMENTS 16
+
 /** @brief Represents levels of logging */
 typedef enum log_level {
     /** @brief Fatal log level, should be used to stop the application when hit. */
@@ -44,6 +53,20 @@ typedef enum log_level {
     LOG_LEVEL_TRACE = 5
 } log_level;
 
+/**
+ * @brief The binary log registration of a single deferred log call site. One of these
+ * is declared statically at each KDEBUG/KTRACE call site, so the format string only
+ * needs to be parsed and written to the binary log the first time the site is hit.
+ */
+typedef struct log_format_site {
+    /** @brief The identifier of the format string in the binary log. 0 if not yet registered. */
+    u32 format_id;
+    /** @brief The number of arguments the format string consumes. */
+    u8 argument_count;
+    /** @brief The type of each argument, used to capture raw argument bytes. */
+    u8 argument_types[LOG_BINARY_MAX_ARGUMENTS];
+} log_format_site;
+
 /**
  * @brief Initializes logging system. Call twice; once with state = 0 to get required memory size,
  * then a second time passing allocated memory to state.
@@ -52,13 +75,13 @@ typedef enum log_level {
  * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
  * @return b8 True on success; otherwise false.
  */
-b8 initialize_logging(u64* memory_requirement, void* state);
+KAPI b8 initialize_logging(u64* memory_requirement, void* state);
 
 /**
  * @brief Shuts down the logging system.
  * @param state A pointer to the system state.
  */
-void shutdown_logging(void* state);
+KAPI void shutdown_logging(void* state);
 
 /**
  * @brief Outputs logging at the given level.
@@ -68,6 +91,35 @@ void shutdown_logging(void* state);
  */
 KAPI void log_output(log_level level, const char* message, ...);
 
+/**
+ * @brief Outputs logging at the given level, deferring formatting to the binary log when
+ * binary mode is enabled. Falls back to log_output() behaviour when it is not, or when
+ * the format string cannot be deferred (i.e. it uses '*' widths).
+ * @param level The log level to use.
+ * @param site The statically-allocated registration of the call site.
+ * @param message The message to be logged. Must be a string literal.
+ * @param ... Any formatted data that should be included in the log entry.
+ */
+KAPI void log_output_deferred(log_level level, log_format_site* site, const char* message, ...);
+
+/**
+ * @brief Enables or disables binary mode. While enabled, debug and trace level log calls
+ * are written to console.klog unformatted instead of to the console and console.log.
+ * console.klog is created the first time binary mode is enabled. Enabled by default in release builds.
+ * @param enabled Indicates if binary mode should be enabled.
+ */
+KAPI void log_binary_mode_set(b8 enabled);
+
+/**
+ * @brief Renders a binary log written in binary mode to text, in the same form as console.log.
+ * Entries are put back in the order they were logged across all threads, and each line is
+ * prefixed with the index of the thread which logged it.
+ * @param binary_log_path The path of the binary log to read.
+ * @param text_log_path The path of the text log to write.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 log_binary_decode(const char* binary_log_path, const char* text_log_path);
+
 /** 
  * @brief Logs a fatal-level message. Should be used to stop the application when hit.
  * @param message The message to be logged. Can be a format string for additional parameters.
@@ -126,7 +178,15 @@ KAPI void log_output(log_level level, const char* message, ...);
  * @param message The message to be logged.
  * @param ... Any formatted data that should be included in the log entry.
  */
+#if LOG_BINARY_ENABLED == 1
+#define KDEBUG(message, ...)                                                        \
+    {                                                                               \
+        static log_format_site log_site = {0};                                      \
+        log_output_deferred(LOG_LEVEL_DEBUG, &log_site, message, ##__VA_ARGS__);    \
+    }
+#else
 #define KDEBUG(message, ...) log_output(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+#endif
 #else
 /** 
  * @brief Logs a debug-level message. Should be used for debugging purposes.
@@ -143,7 +203,15 @@ KAPI void log_output(log_level level, const char* message, ...);
  * @param message The message to be logged.
  * @param ... Any formatted data that should be included in the log entry.
  */
+#if LOG_BINARY_ENABLED == 1
+#define KTRACE(message, ...)                                                        \
+    {                                                                               \
+        static log_format_site log_site = {0};                                      \
+        log_output_deferred(LOG_LEVEL_TRACE, &log_site, message, ##__VA_ARGS__);    \
+    }
+#else
 #define KTRACE(message, ...) log_output(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+#endif
 #else
 /** 
  * @brief Logs a trace-level message. Should be used for verbose debugging purposes.
@@ -0,0 +1,333 @@
+#include "profiler.h"
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/kstring.h"
+#include "platform/platform.h"
+#include "platform/filesystem.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KPROFILER_USE_TSC 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#define PROFILER_PATH_MAX_LENGTH 256
+
+typedef enum profiler_event_type {
+    PROFILER_EVENT_TYPE_BEGIN,
+    PROFILER_EVENT_TYPE_END,
+    PROFILER_EVENT_TYPE_FRAME
+} profiler_event_type;
+
+typedef struct profiler_event {
+    u64 ticks;
+    /** @brief The zone name for begin events. Unused otherwise. */
+    const char* name;
+    profiler_event_type type;
+    /** @brief The frame number for frame events. Unused otherwise. */
+    u32 frame_number;
+} profiler_event;
+
+typedef struct profiler_thread_buffer {
+    u64 thread_id;
+    /** @brief The total number of events ever written. Only written by the owning thread. */
+    volatile u64 write_count;
+    /** @brief The write count when the current capture started. */
+    u64 capture_start;
+    profiler_event* events;
+} profiler_thread_buffer;
+
+typedef struct profiler_state {
+    profiler_config config;
+    u64 main_thread_id;
+    /** @brief The number of thread buffers claimed so far. */
+    volatile u32 thread_count;
+    profiler_thread_buffer* threads;
+
+    /** @brief Nonzero while zones are being recorded. */
+    volatile u32 recording;
+    /** @brief The number of frames requested by a capture which has not yet started. */
+    u32 pending_frame_count;
+    /** @brief The number of frames left to record in the current capture. */
+    u32 remaining_frame_count;
+    u32 frame_number;
+    char capture_path[PROFILER_PATH_MAX_LENGTH];
+
+    /** @brief Reference points used to convert ticks to seconds. */
+    u64 base_ticks;
+    f64 base_time;
+} profiler_state;
+
+static profiler_state* state_ptr;
+// Incremented on each initialization, so stale thread buffers are never used if the profiler is restarted.
+static u32 profiler_generation;
+// The calling thread's buffer, claimed on its first recorded zone.
+static KTHREAD_LOCAL profiler_thread_buffer* thread_buffer;
+// The profiler generation the above was claimed from.
+static KTHREAD_LOCAL u32 thread_buffer_generation;
+
+static u64 profiler_ticks() {
+#ifdef KPROFILER_USE_TSC
+    // Far cheaper than querying the OS clock. Converted to time when a capture is written.
+    return __rdtsc();
+#else
+    return (u64)(platform_get_absolute_time() * 1000000000.0);
+#endif
+}
+
+static profiler_thread_buffer* acquire_thread_buffer() {
+    if (thread_buffer && thread_buffer_generation == profiler_generation) {
+        return thread_buffer;
+    }
+    u32 index = platform_atomic_fetch_add_u32(&state_ptr->thread_count, 1);
+    if (index >= state_ptr->config.max_thread_count) {
+        if (index == state_ptr->config.max_thread_count) {
+            KWARN("Profiler supports up to %u threads. Zones on further threads are not recorded.", state_ptr->config.max_thread_count);
+        }
+        return 0;
+    }
+    thread_buffer = &state_ptr->threads[index];
+    thread_buffer_generation = profiler_generation;
+    thread_buffer->thread_id = platform_current_thread_id();
+    // Only events from the current capture onward are of interest.
+    thread_buffer->capture_start = thread_buffer->write_count;
+    return thread_buffer;
+}
+
+static void write_event(profiler_thread_buffer* buffer, profiler_event_type type, const char* name, u32 frame_number) {
+    u64 index = buffer->write_count;
+    profiler_event* e = &buffer->events[index % state_ptr->config.events_per_thread];
+    e->ticks = profiler_ticks();
+    e->name = name;
+    e->type = type;
+    e->frame_number = frame_number;
+    platform_atomic_store_u64(&buffer->write_count, index + 1);
+}
+
+b8 profiler_initialize(u64* memory_requirement, void* state, profiler_config config) {
+    if (config.events_per_thread == 0 || config.max_thread_count == 0) {
+        KERROR("profiler_initialize - config.events_per_thread and config.max_thread_count must be nonzero.");
+        return false;
+    }
+    u64 struct_requirement = sizeof(profiler_state);
+    u64 threads_requirement = sizeof(profiler_thread_buffer) * config.max_thread_count;
+    u64 events_requirement = sizeof(profiler_event) * config.events_per_thread * config.max_thread_count;
+    *memory_requirement = struct_requirement + threads_requirement + events_requirement;
+    if (!state) {
+        return true;
+    }
+
+    kzero_memory(state, *memory_requirement);
+    state_ptr = state;
+    profiler_generation++;
+    state_ptr->config = config;
+    state_ptr->threads = (void*)((u8*)state + struct_requirement);
+    profiler_event* events = (void*)((u8*)state + struct_requirement + threads_requirement);
+    for (u32 i = 0; i < config.max_thread_count; ++i) {
+        state_ptr->threads[i].events = events + (u64)i * config.events_per_thread;
+    }
+    state_ptr->main_thread_id = platform_current_thread_id();
+    state_ptr->base_ticks = profiler_ticks();
+    state_ptr->base_time = platform_get_absolute_time();
+
+    KINFO("Profiler initialized with %u events for each of up to %u threads.", config.events_per_thread, config.max_thread_count);
+    return true;
+}
+
+void profiler_shutdown(void* state) {
+    if (state_ptr) {
+        platform_atomic_store_u32(&state_ptr->recording, 0);
+    }
+    state_ptr = 0;
+}
+
+b8 profiler_zone_begin(const char* name) {
+    if (!state_ptr || !platform_atomic_load_u32(&state_ptr->recording)) {
+        return false;
+    }
+    profiler_thread_buffer* buffer = acquire_thread_buffer();
+    if (!buffer) {
+        return false;
+    }
+    write_event(buffer, PROFILER_EVENT_TYPE_BEGIN, name, 0);
+    return true;
+}
+
+void profiler_zone_end() {
+    // Always recorded, even if the capture has since stopped, so recorded zones stay balanced.
+    if (state_ptr && thread_buffer && thread_buffer_generation == profiler_generation) {
+        write_event(thread_buffer, PROFILER_EVENT_TYPE_END, 0, 0);
+    }
+}
+
+static void write_json_string(file_handle* f, const char* str) {
+    char escaped[256];
+    u32 length = 0;
+    for (const char* c = str; *c && length < sizeof(escaped) - 2; ++c) {
+        if (*c == '"' || *c == '\\') {
+            escaped[length++] = '\\';
+        }
+        escaped[length++] = *c;
+    }
+    u64 written = 0;
+    filesystem_write(f, 1, "\"", &written);
+    filesystem_write(f, length, escaped, &written);
+    filesystem_write(f, 1, "\"", &written);
+}
+
+/**
+ * @brief Writes the events of one thread recorded between its capture start and end. Zones
+ * whose beginning was lost, to the start of the capture or to the ring buffer wrapping, are
+ * skipped, and zones still open at the end of the capture are closed at end_ticks.
+ */
+static u64 write_thread_events(file_handle* f, u32 tid, const profiler_thread_buffer* buffer, u64 end_count, u64 end_ticks, f64 seconds_per_tick, b8* first) {
+    u64 start = buffer->capture_start;
+    if (end_count - start > state_ptr->config.events_per_thread) {
+        start = end_count - state_ptr->config.events_per_thread;
+    }
+
+    char line[128];
+    u32 depth = 0;
+    u64 written_count = 0;
+    for (u64 i = start; i < end_count; ++i) {
+        const profiler_event* e = &buffer->events[i % state_ptr->config.events_per_thread];
+        if (e->type == PROFILER_EVENT_TYPE_END && depth == 0) {
+            continue;
+        }
+        f64 us = (f64)(i64)(e->ticks - state_ptr->base_ticks) * seconds_per_tick * 1000000.0;
+        filesystem_write_text(f, *first ? "\n" : ",\n");
+        *first = false;
+        switch (e->type) {
+            case PROFILER_EVENT_TYPE_BEGIN:
+                filesystem_write_text(f, "{\"name\":");
+                write_json_string(f, e->name);
+                string_format(line, ",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", us, tid);
+                depth++;
+                break;
+            case PROFILER_EVENT_TYPE_END:
+                string_format(line, "{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", us, tid);
+                depth--;
+                break;
+            case PROFILER_EVENT_TYPE_FRAME:
+                string_format(line, "{\"name\":\"Frame %u\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", e->frame_number, us, tid);
+                break;
+        }
+        filesystem_write_text(f, line);
+        written_count++;
+    }
+
+    f64 end_us = (f64)(i64)(end_ticks - state_ptr->base_ticks) * seconds_per_tick * 1000000.0;
+    for (; depth > 0; --depth) {
+        string_format(line, ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", end_us, tid);
+        filesystem_write_text(f, line);
+    }
+    return written_count;
+}
+
+static b8 write_capture(u64 end_ticks) {
+    f64 end_time = platform_get_absolute_time();
+#ifdef KPROFILER_USE_TSC
+    // Calibrate the tick rate against the OS clock, over the whole time since initialization.
+    f64 seconds_per_tick = (end_time - state_ptr->base_time) / (f64)(end_ticks - state_ptr->base_ticks);
+#else
+    f64 seconds_per_tick = 1.0 / 1000000000.0;
+#endif
+
+    file_handle f;
+    if (!filesystem_open(state_ptr->capture_path, FILE_MODE_WRITE, false, &f)) {
+        KERROR("Profiler failed to open '%s' for writing.", state_ptr->capture_path);
+        return false;
+    }
+
+    filesystem_write_text(&f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    b8 first = true;
+    u64 event_count = 0;
+    char line[128];
+    u32 thread_count = platform_atomic_load_u32(&state_ptr->thread_count);
+    if (thread_count > state_ptr->config.max_thread_count) {
+        thread_count = state_ptr->config.max_thread_count;
+    }
+    for (u32 i = 0; i < thread_count; ++i) {
+        profiler_thread_buffer* buffer = &state_ptr->threads[i];
+        u64 end_count = platform_atomic_load_u64(&buffer->write_count);
+        // Name the thread.
+        filesystem_write_text(&f, first ? "\n" : ",\n");
+        first = false;
+        if (buffer->thread_id == state_ptr->main_thread_id) {
+            string_format(line, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Main\"}}", i);
+        } else {
+            string_format(line, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %llu\"}}", i, buffer->thread_id);
+        }
+        filesystem_write_text(&f, line);
+        event_count += write_thread_events(&f, i, buffer, end_count, end_ticks, seconds_per_tick, &first);
+    }
+    filesystem_write_text(&f, "\n]}\n");
+    filesystem_close(&f);
+
+    KINFO("Profiler capture of %llu events written to '%s'.", event_count, state_ptr->capture_path);
+    return true;
+}
+
+void profiler_frame_mark() {
+    if (!state_ptr) {
+        return;
+    }
+    state_ptr->frame_number++;
+
+    if (platform_atomic_load_u32(&state_ptr->recording)) {
+        state_ptr->remaining_frame_count--;
+        if (state_ptr->remaining_frame_count == 0) {
+            u64 end_ticks = profiler_ticks();
+            platform_atomic_store_u32(&state_ptr->recording, 0);
+            write_capture(end_ticks);
+            return;
+        }
+    } else if (state_ptr->pending_frame_count) {
+        // Start the capture. Events recorded before now are excluded.
+        u32 thread_count = platform_atomic_load_u32(&state_ptr->thread_count);
+        for (u32 i = 0; i < thread_count && i < state_ptr->config.max_thread_count; ++i) {
+            state_ptr->threads[i].capture_start = platform_atomic_load_u64(&state_ptr->threads[i].write_count);
+        }
+        state_ptr->remaining_frame_count = state_ptr->pending_frame_count;
+        state_ptr->pending_frame_count = 0;
+        platform_atomic_store_u32(&state_ptr->recording, 1);
+    }
+
+    if (platform_atomic_load_u32(&state_ptr->recording)) {
+        profiler_thread_buffer* buffer = acquire_thread_buffer();
+        if (buffer) {
+            write_event(buffer, PROFILER_EVENT_TYPE_FRAME, 0, state_ptr->frame_number);
+        }
+    }
+}
+
+b8 profiler_capture(u32 frame_count, const char* path) {
+    if (!state_ptr) {
+        KERROR("profiler_capture called before the profiler was initialized.");
+        return false;
+    }
+    if (frame_count == 0 || !path) {
+        KERROR("profiler_capture requires a nonzero frame count and a path.");
+        return false;
+    }
+    if (profiler_is_capturing()) {
+        KWARN("A profiler capture is already in progress.");
+        return false;
+    }
+    if (string_length(path) >= PROFILER_PATH_MAX_LENGTH) {
+        KERROR("profiler_capture - path is too long: '%s'.", path);
+        return false;
+    }
+    string_ncopy(state_ptr->capture_path, path, PROFILER_PATH_MAX_LENGTH);
+    state_ptr->pending_frame_count = frame_count;
+    KINFO("Profiler capturing %u frames to '%s'.", frame_count, path);
+    return true;
+}
+
+b8 profiler_is_capturing() {
+    return state_ptr && (state_ptr->pending_frame_count || platform_atomic_load_u32(&state_ptr->recording));
+}
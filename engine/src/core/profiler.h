@@ -0,0 +1,122 @@
+/**
+ * @file profiler.h
+ * @author Travis Vroman (travis@kohiengine.com)
+ * @brief This file contains a hierarchical CPU profiler. Code is instrumented with
+ * named zones, which record begin and end timestamps into a ring buffer owned by
+ * the calling thread, so recording never takes a lock. Nothing is recorded unless a
+ * capture is in progress, in which case the zones of a given number of frames are
+ * written out as Chrome trace event JSON, which can be viewed in Perfetto
+ * (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Zones are compiled out entirely if KPROFILER_DISABLED is defined.
+ * @version 1.0
+ * @date 2022-06-11
+ *
+ * @copyright Kohi Game Engine is Copyright (c) Travis Vroman 2021-2022
+ *
+ */
+
+#pragma once
+
+#include "defines.h"
+
+/** @brief The configuration for the profiler. */
+typedef struct profiler_config {
+    /**
+     * @brief The number of events each thread's ring buffer can hold. Every zone uses two.
+     * If a thread records more during a capture, its oldest events are lost.
+     */
+    u32 events_per_thread;
+    /** @brief The maximum number of threads which can record. Zones on any further threads are ignored. */
+    u8 max_thread_count;
+} profiler_config;
+
+/**
+ * @brief Initializes the profiler. Should be called twice; once to get the memory requirement
+ * (passing state=0), and a second time passing an allocated block of memory to actually initialize
+ * the system. The calling thread is treated as the main thread.
+ *
+ * @param memory_requirement A pointer to hold the memory requirement as it is calculated.
+ * @param state A block of memory to hold the state or, if gathering the memory requirement, 0.
+ * @param config The configuration for this system.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 profiler_initialize(u64* memory_requirement, void* state, profiler_config config);
+
+/**
+ * @brief Shuts down the profiler. Any capture in progress is discarded.
+ *
+ * @param state The state block of memory for this system.
+ */
+KAPI void profiler_shutdown(void* state);
+
+/**
+ * @brief Marks the boundary between frames. Starts and finishes captures, so should be
+ * called once per frame, from the main thread.
+ */
+KAPI void profiler_frame_mark();
+
+/**
+ * @brief Requests a capture of the given number of frames, starting at the next frame
+ * boundary. Once complete, the capture is written to the given path as Chrome trace event JSON.
+ *
+ * @param frame_count The number of frames to capture.
+ * @param path The path of the file to write.
+ * @return True if the capture was requested; otherwise false, e.g. if one is already in progress.
+ */
+KAPI b8 profiler_capture(u32 frame_count, const char* path);
+
+/**
+ * @brief Indicates if a capture is requested or in progress.
+ *
+ * @return True if capturing; otherwise false.
+ */
+KAPI b8 profiler_is_capturing();
+
+/**
+ * @brief Begins a zone on the calling thread. Prefer the PROFILE_ macros to calling this directly.
+ *
+ * @param name The name of the zone. Must remain valid until the capture is written, so should be a string literal.
+ * @return True if the zone was recorded, in which case profiler_zone_end() must be called; otherwise false.
+ */
+KAPI b8 profiler_zone_begin(const char* name);
+
+/**
+ * @brief Ends the innermost zone on the calling thread.
+ */
+KAPI void profiler_zone_end();
+
+/**
+ * @brief Ends the zone begun by PROFILE_SCOPE when it goes out of scope.
+ * @param recorded A pointer to the result of profiler_zone_begin().
+ */
+KINLINE void profiler_scope_cleanup(b8* recorded) {
+    if (*recorded) {
+        profiler_zone_end();
+    }
+}
+
+#define KPROFILE_CONCAT_INNER(a, b) a##b
+#define KPROFILE_CONCAT(a, b) KPROFILE_CONCAT_INNER(a, b)
+
+#if !defined(KPROFILER_DISABLED)
+#if defined(__clang__) || defined(__GNUC__)
+/**
+ * @brief Profiles the remainder of the enclosing scope as a zone with the given name,
+ * including across early returns.
+ */
+#define PROFILE_SCOPE(name) \
+    __attribute__((cleanup(profiler_scope_cleanup))) b8 KPROFILE_CONCAT(kprofile_zone_, __LINE__) = profiler_zone_begin(name)
+#else
+// Scoped zones require the cleanup attribute. Use PROFILE_BEGIN/PROFILE_END instead.
+#define PROFILE_SCOPE(name)
+#endif
+/** @brief Begins a named zone, which must be ended with PROFILE_END(name) in the same scope. */
+#define PROFILE_BEGIN(name) b8 KPROFILE_CONCAT(kprofile_zone_, name) = profiler_zone_begin(#name)
+/** @brief Ends a zone begun with PROFILE_BEGIN(name). */
+#define PROFILE_END(name) profiler_scope_cleanup(&KPROFILE_CONCAT(kprofile_zone_, name))
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_BEGIN(name)
+#define PROFILE_END(name)
+#endif
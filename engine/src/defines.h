@@ -187,6 +187,22 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #define KCLAMP(value, min, max) (value <= min) ? min : (value >= max) ? max \
                                                                       : value;
 
+/**
+ * @brief Gets the smaller of two values.
+ * @param x The first value.
+ * @param y The second value.
+ * @returns The smaller of the two values.
+ */
+#define KMIN(x, y) ((x) < (y) ? (x) : (y))
+
+/**
+ * @brief Gets the larger of two values.
+ * @param x The first value.
+ * @param y The second value.
+ * @returns The larger of the two values.
+ */
+#define KMAX(x, y) ((x) > (y) ? (x) : (y))
+
 // Inlining
 #if defined(__clang__) || defined(__gcc__)
 /** @brief Inline qualifier */
@@ -210,6 +226,15 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #define KNOINLINE
 #endif
 
+// Thread-local storage
+#if defined(_MSC_VER) && !defined(__clang__)
+/** @brief Thread-local qualifier. Gives each thread its own instance of a static or global variable. */
+#define KTHREAD_LOCAL __declspec(thread)
+#else
+/** @brief Thread-local qualifier. Gives each thread its own instance of a static or global variable. */
+#define KTHREAD_LOCAL _Thread_local
+#endif
+
 /** @brief Gets the number of bytes from amount of gibibytes (GiB) (1024*1024*1024) */
 #define GIBIBYTES(amount) amount * 1024 * 1024 * 1024
 /** @brief Gets the number of bytes from amount of mebibytes (MiB) (1024*1024) */
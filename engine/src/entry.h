@@ -29,11 +29,14 @@ extern b8 create_game(game* out_game);
 
 /**
  * @brief The main entry point of the application.
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
  * @returns 0 on successful execution; nonzero on error.
  */
-int main(void) {
+int main(int argc, char** argv) {
     // Request the game instance from the application.
-    game game_inst;
+    // Zeroed, so any configuration not set by the game is left at its default.
+    game game_inst = {0};
     if (!create_game(&game_inst)) {
         KFATAL("Could not create game!");
         return -1;
@@ -45,6 +48,12 @@ int main(void) {
         return -2;
     }
 
+    // Command line arguments override the game's configuration.
+    if (!application_parse_arguments(&game_inst.app_config, argc, argv)) {
+        KFATAL("Invalid command line arguments!");
+        return -3;
+    }
+
     // Initialization.
     if (!application_create(&game_inst)) {
         KFATAL("Application failed to create!.");
@@ -2,6 +2,7 @@
 
 #include "kmath.h"
 #include "core/logger.h"
+#include "core/profiler.h"
 
 void geometry_generate_normals(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices) {
     for (u32 i = 0; i < index_count; i += 3) {
@@ -64,42 +65,150 @@ b8 vertex3d_equal(vertex_3d vert_0, vertex_3d vert_1) {
            vec4_compare(vert_0.tangent, vert_1.tangent, K_FLOAT_EPSILON);
 }
 
-void reassign_index(u32 index_count, u32* indices, u32 from, u32 to) {
-    for (u32 i = 0; i < index_count; ++i) {
-        if (indices[i] == from) {
-            indices[i] = to;
-        } else if (indices[i] > from) {
-            // Pull in all indicies higher than 'from' by 1.
-            indices[i]--;
+// The size of the grid cells vertices are bucketed into by position when welding. Much larger
+// than the weld tolerance, so a vertex's matches are almost always within its own cell.
+#define WELD_CELL_SIZE (1024.0 * K_FLOAT_EPSILON)
+// Cell coordinates are clamped to this, well inside the range of an i64. Positions this far out
+// share the outermost cells, which only costs extra comparisons.
+#define WELD_CELL_COORD_LIMIT 4.0e18
+
+typedef struct weld_cell {
+    i64 x;
+    i64 y;
+    i64 z;
+    // The most recently added unique vertex in this cell, or INVALID_ID if the slot is empty.
+    u32 head;
+} weld_cell;
+
+typedef struct weld_grid {
+    u32 capacity;
+    weld_cell* cells;
+    // For each unique vertex, the next unique vertex in the same cell, or INVALID_ID.
+    u32* next;
+} weld_grid;
+
+static i64 weld_cell_coord(f64 value) {
+    f64 scaled = value / WELD_CELL_SIZE;
+    // Converting a value out of the range of an i64 is undefined, so clamp first.
+    // Non-finite positions are never welded, so NaN doesn't get here.
+    if (scaled < -WELD_CELL_COORD_LIMIT) {
+        return (i64)-WELD_CELL_COORD_LIMIT;
+    }
+    if (scaled > WELD_CELL_COORD_LIMIT) {
+        return (i64)WELD_CELL_COORD_LIMIT;
+    }
+    i64 coord = (i64)scaled;
+    // Round toward negative infinity.
+    if ((f64)coord > scaled) {
+        coord--;
+    }
+    return coord;
+}
+
+// x - x is NaN for both infinities and NaN.
+static b8 weld_position_finite(vec3 p) {
+    return p.x - p.x == 0.0f && p.y - p.y == 0.0f && p.z - p.z == 0.0f;
+}
+
+static weld_cell* weld_grid_find(weld_grid* grid, i64 x, i64 y, i64 z) {
+    u64 hash = ((u64)x * 73856093ULL) ^ ((u64)y * 19349663ULL) ^ ((u64)z * 83492791ULL);
+    hash ^= hash >> 29;
+    u32 mask = grid->capacity - 1;
+    u32 slot = (u32)hash & mask;
+    // The grid is at most half full, so this always finds the cell or an empty slot.
+    while (grid->cells[slot].head != INVALID_ID) {
+        weld_cell* cell = &grid->cells[slot];
+        if (cell->x == x && cell->y == y && cell->z == z) {
+            return cell;
         }
+        slot = (slot + 1) & mask;
     }
+    return &grid->cells[slot];
 }
 
 void geometry_deduplicate_vertices(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices, u32* out_vertex_count, vertex_3d** out_vertices) {
+    PROFILE_SCOPE("geometry_deduplicate_vertices");
     // Create new arrays for the collection to sit in.
     vertex_3d* unique_verts = kallocate(sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    u32* remap = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
     *out_vertex_count = 0;
 
-    u32 found_count = 0;
+    // Unique vertices are bucketed by position into a hash grid, so each vertex is only
+    // compared against the unique vertices near it.
+    weld_grid grid;
+    grid.capacity = 16;
+    while (grid.capacity < (u64)vertex_count * 2) {
+        grid.capacity <<= 1;
+    }
+    grid.cells = kallocate(sizeof(weld_cell) * grid.capacity, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < grid.capacity; ++i) {
+        grid.cells[i].head = INVALID_ID;
+    }
+    grid.next = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+
+    // Anything within the tolerance may lie in a neighbouring cell, so the range of cells covered by
+    // the position plus or minus the tolerance is searched. This is almost always just one cell.
+    // Twice the tolerance is used to be safe against rounding in the comparison.
+    const f64 reach = 2.0 * K_FLOAT_EPSILON;
     for (u32 v = 0; v < vertex_count; ++v) {
-        b8 found = false;
-        for (u32 u = 0; u < *out_vertex_count; ++u) {
-            if (vertex3d_equal(vertices[v], unique_verts[u])) {
-                // Reassign indices, do _not_ copy
-                reassign_index(index_count, indices, v - found_count, u);
-                found = true;
-                found_count++;
-                break;
+        vec3 p = vertices[v].position;
+        // Non-finite positions, i.e. from a malformed file, have no cell, so are kept as they are.
+        if (!weld_position_finite(p)) {
+            unique_verts[*out_vertex_count] = vertices[v];
+            remap[v] = *out_vertex_count;
+            (*out_vertex_count)++;
+            continue;
+        }
+        i64 min_x = weld_cell_coord((f64)p.x - reach), max_x = weld_cell_coord((f64)p.x + reach);
+        i64 min_y = weld_cell_coord((f64)p.y - reach), max_y = weld_cell_coord((f64)p.y + reach);
+        i64 min_z = weld_cell_coord((f64)p.z - reach), max_z = weld_cell_coord((f64)p.z + reach);
+
+        // Match the earliest equal unique vertex, as a linear search of them would.
+        u32 match = INVALID_ID;
+        for (i64 x = min_x; x <= max_x; ++x) {
+            for (i64 y = min_y; y <= max_y; ++y) {
+                for (i64 z = min_z; z <= max_z; ++z) {
+                    weld_cell* cell = weld_grid_find(&grid, x, y, z);
+                    for (u32 u = cell->head; u != INVALID_ID; u = grid.next[u]) {
+                        if (u < match && vertex3d_equal(vertices[v], unique_verts[u])) {
+                            match = u;
+                        }
+                    }
+                }
             }
         }
 
-        if (!found) {
-            // Copy over to unique.
-            unique_verts[*out_vertex_count] = vertices[v];
-            (*out_vertex_count)++;
+        if (match != INVALID_ID) {
+            remap[v] = match;
+            continue;
+        }
+
+        // Copy over to unique and add it to the cell containing it.
+        u32 u = *out_vertex_count;
+        unique_verts[u] = vertices[v];
+        remap[v] = u;
+        (*out_vertex_count)++;
+
+        i64 x = weld_cell_coord(p.x), y = weld_cell_coord(p.y), z = weld_cell_coord(p.z);
+        weld_cell* cell = weld_grid_find(&grid, x, y, z);
+        if (cell->head == INVALID_ID) {
+            cell->x = x;
+            cell->y = y;
+            cell->z = z;
         }
+        grid.next[u] = cell->head;
+        cell->head = u;
     }
 
+    // Rewrite the indices once.
+    for (u32 i = 0; i < index_count; ++i) {
+        indices[i] = remap[indices[i]];
+    }
+
+    kfree(grid.cells, sizeof(weld_cell) * grid.capacity, MEMORY_TAG_ARRAY);
+    kfree(grid.next, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(remap, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+
     // Allocate new vertices array
     *out_vertices = kallocate(sizeof(vertex_3d) * (*out_vertex_count), MEMORY_TAG_ARRAY);
     // Copy over unique
@@ -110,3 +219,1065 @@ void geometry_deduplicate_vertices(u32 vertex_count, vertex_3d* vertices, u32 in
     u32 removed_count = vertex_count - *out_vertex_count;
     KDEBUG("geometry_deduplicate_vertices: removed %d vertices, orig/now %d/%d.", removed_count, vertex_count, *out_vertex_count);
 }
+
+void geometry_analyze_vertex_cache(u32 vertex_count, u32 index_count, const u32* indices, u32 cache_size, geometry_vertex_cache_stats* out_stats) {
+    out_stats->acmr = 0;
+    out_stats->atvr = 0;
+    if (vertex_count == 0 || index_count < 3 || cache_size == 0) {
+        return;
+    }
+
+    // The time each vertex was last loaded into the cache, counted in misses. A vertex is still
+    // in a FIFO cache if fewer than cache_size vertices have been loaded since. Starting the clock
+    // past the cache size makes every vertex initially absent.
+    u32* cache_time = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    u32 time = cache_size + 1;
+    u32 misses = 0;
+    for (u32 i = 0; i < index_count; ++i) {
+        u32 v = indices[i];
+        if (time - cache_time[v] > cache_size) {
+            cache_time[v] = time;
+            time++;
+            misses++;
+        }
+    }
+
+    u32 referenced_count = 0;
+    for (u32 v = 0; v < vertex_count; ++v) {
+        if (cache_time[v]) {
+            referenced_count++;
+        }
+    }
+    kfree(cache_time, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+
+    out_stats->acmr = (f32)misses / (f32)(index_count / 3);
+    out_stats->atvr = (f32)misses / (f32)referenced_count;
+}
+
+typedef struct triangle_cluster {
+    u32 first_triangle;
+    u32 triangle_count;
+    f32 sort_key;
+} triangle_cluster;
+
+static void cluster_sift_down(triangle_cluster* clusters, u32 start, u32 end) {
+    u32 root = start;
+    while (root * 2 + 1 < end) {
+        u32 child = root * 2 + 1;
+        // A min-heap, so the sort is descending.
+        if (child + 1 < end && clusters[child + 1].sort_key < clusters[child].sort_key) {
+            child++;
+        }
+        if (clusters[root].sort_key <= clusters[child].sort_key) {
+            return;
+        }
+        triangle_cluster temp = clusters[root];
+        clusters[root] = clusters[child];
+        clusters[child] = temp;
+        root = child;
+    }
+}
+
+// Heapsort by descending sort key.
+static void clusters_sort(triangle_cluster* clusters, u32 count) {
+    if (count < 2) {
+        return;
+    }
+    for (u32 i = count / 2; i > 0; --i) {
+        cluster_sift_down(clusters, i - 1, count);
+    }
+    for (u32 end = count - 1; end > 0; --end) {
+        triangle_cluster temp = clusters[0];
+        clusters[0] = clusters[end];
+        clusters[end] = temp;
+        cluster_sift_down(clusters, 0, end);
+    }
+}
+
+void geometry_optimize_vertex_cache(u32 vertex_count, const vertex_3d* vertices, u32 index_count, u32* indices, u32 cache_size) {
+    PROFILE_SCOPE("geometry_optimize_vertex_cache");
+    u32 triangle_count = index_count / 3;
+    if (vertex_count == 0 || triangle_count < 2) {
+        return;
+    }
+
+    // The triangles using each vertex, as ranges of one array, and how many are still to be emitted.
+    u32* live_count = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    u32* adjacency_offsets = kallocate(sizeof(u32) * (vertex_count + 1), MEMORY_TAG_ARRAY);
+    u32* adjacency = kallocate(sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < triangle_count * 3; ++i) {
+        live_count[indices[i]]++;
+    }
+    for (u32 v = 0; v < vertex_count; ++v) {
+        adjacency_offsets[v + 1] = adjacency_offsets[v] + live_count[v];
+    }
+    // Used as the fill cursor for each vertex's range, then as the cache simulation below.
+    u32* cache_time = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < triangle_count * 3; ++i) {
+        u32 v = indices[i];
+        adjacency[adjacency_offsets[v] + cache_time[v]] = i / 3;
+        cache_time[v]++;
+    }
+    kzero_memory(cache_time, sizeof(u32) * vertex_count);
+
+    u8* emitted = kallocate(sizeof(u8) * triangle_count, MEMORY_TAG_ARRAY);
+    // Vertices of recently emitted triangles, to resume from when a fan has no good successor.
+    u32* dead_end_stack = kallocate(sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    u32 dead_end_count = 0;
+    // The vertices of the triangles emitted by the current fan.
+    u32* candidates = kallocate(sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    u32* output = kallocate(sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    u32 output_count = 0;
+    triangle_cluster* clusters = kallocate(sizeof(triangle_cluster) * triangle_count, MEMORY_TAG_ARRAY);
+    u32 cluster_count = 1;
+
+    u32 time = cache_size + 1;
+    u32 scan_cursor = 0;
+    u32 fan = indices[0];
+    while (fan != INVALID_ID) {
+        // Emit every remaining triangle around the fan vertex.
+        u32 candidate_count = 0;
+        for (u32 a = adjacency_offsets[fan]; a < adjacency_offsets[fan + 1]; ++a) {
+            u32 t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            for (u32 c = 0; c < 3; ++c) {
+                u32 v = indices[t * 3 + c];
+                output[output_count++] = v;
+                dead_end_stack[dead_end_count++] = v;
+                candidates[candidate_count++] = v;
+                live_count[v]--;
+                if (time - cache_time[v] > cache_size) {
+                    cache_time[v] = time;
+                    time++;
+                }
+            }
+        }
+
+        // Fan next around the vertex which has been in the cache longest, of those which will
+        // still be in it once their own remaining triangles are emitted.
+        u32 next = INVALID_ID;
+        i64 best_priority = -1;
+        for (u32 i = 0; i < candidate_count; ++i) {
+            u32 v = candidates[i];
+            if (live_count[v] == 0) {
+                continue;
+            }
+            i64 priority = 0;
+            if (time - cache_time[v] + 2 * live_count[v] <= cache_size) {
+                priority = time - cache_time[v];
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                next = v;
+            }
+        }
+
+        if (next == INVALID_ID) {
+            // A dead end. Resume from the most recently used vertex with triangles left. If that has
+            // dropped out of the cache, nothing carries over, so a new cluster starts there.
+            while (dead_end_count > 0 && next == INVALID_ID) {
+                u32 v = dead_end_stack[--dead_end_count];
+                if (live_count[v] > 0) {
+                    next = v;
+                    if (time - cache_time[v] > cache_size) {
+                        clusters[cluster_count++].first_triangle = output_count / 3;
+                    }
+                }
+            }
+            // Failing that, this part of the mesh is done. Resume from the next vertex in order
+            // with triangles left, which shares nothing with the cache, so starts a new cluster.
+            while (next == INVALID_ID && scan_cursor < vertex_count) {
+                if (live_count[scan_cursor] > 0) {
+                    next = scan_cursor;
+                    clusters[cluster_count++].first_triangle = output_count / 3;
+                } else {
+                    scan_cursor++;
+                }
+            }
+        }
+        fan = next;
+    }
+
+    // Sort the clusters so those facing away from the center of the mesh are drawn first.
+    vec3 mesh_center = vec3_zero();
+    for (u32 i = 0; i < output_count; ++i) {
+        mesh_center = vec3_add(mesh_center, vertices[output[i]].position);
+    }
+    mesh_center = vec3_mul_scalar(mesh_center, 1.0f / (f32)output_count);
+    for (u32 c = 0; c < cluster_count; ++c) {
+        triangle_cluster* cluster = &clusters[c];
+        u32 end = c + 1 < cluster_count ? clusters[c + 1].first_triangle : output_count / 3;
+        cluster->triangle_count = end - cluster->first_triangle;
+        // Area-weighted, so slivers count for little.
+        vec3 center = vec3_zero();
+        vec3 normal = vec3_zero();
+        f32 area = 0;
+        for (u32 t = cluster->first_triangle; t < end; ++t) {
+            vec3 p0 = vertices[output[t * 3 + 0]].position;
+            vec3 p1 = vertices[output[t * 3 + 1]].position;
+            vec3 p2 = vertices[output[t * 3 + 2]].position;
+            vec3 cross = vec3_cross(vec3_sub(p1, p0), vec3_sub(p2, p0));
+            f32 weight = vec3_length(cross);
+            center = vec3_add(center, vec3_mul_scalar(vec3_add(vec3_add(p0, p1), p2), weight / 3.0f));
+            normal = vec3_add(normal, cross);
+            area += weight;
+        }
+        cluster->sort_key = 0;
+        f32 normal_length = vec3_length(normal);
+        if (area > 0 && normal_length > 0) {
+            center = vec3_mul_scalar(center, 1.0f / area);
+            cluster->sort_key = vec3_dot(vec3_sub(center, mesh_center), vec3_mul_scalar(normal, 1.0f / normal_length));
+        }
+    }
+    clusters_sort(clusters, cluster_count);
+
+    u32 written = 0;
+    for (u32 c = 0; c < cluster_count; ++c) {
+        u32 count = clusters[c].triangle_count * 3;
+        kcopy_memory(indices + written, output + clusters[c].first_triangle * 3, sizeof(u32) * count);
+        written += count;
+    }
+
+    kfree(clusters, sizeof(triangle_cluster) * triangle_count, MEMORY_TAG_ARRAY);
+    kfree(output, sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    kfree(candidates, sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    kfree(dead_end_stack, sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    kfree(emitted, sizeof(u8) * triangle_count, MEMORY_TAG_ARRAY);
+    kfree(cache_time, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(adjacency, sizeof(u32) * triangle_count * 3, MEMORY_TAG_ARRAY);
+    kfree(adjacency_offsets, sizeof(u32) * (vertex_count + 1), MEMORY_TAG_ARRAY);
+    kfree(live_count, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+}
+
+void geometry_optimize_vertex_fetch(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices) {
+    PROFILE_SCOPE("geometry_optimize_vertex_fetch");
+    if (vertex_count == 0) {
+        return;
+    }
+
+    // Number vertices in the order they are first used, then any unused ones.
+    u32* remap = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    for (u32 v = 0; v < vertex_count; ++v) {
+        remap[v] = INVALID_ID;
+    }
+    u32 next = 0;
+    for (u32 i = 0; i < index_count; ++i) {
+        u32 v = indices[i];
+        if (remap[v] == INVALID_ID) {
+            remap[v] = next++;
+        }
+        indices[i] = remap[v];
+    }
+    for (u32 v = 0; v < vertex_count; ++v) {
+        if (remap[v] == INVALID_ID) {
+            remap[v] = next++;
+        }
+    }
+
+    vertex_3d* reordered = kallocate(sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    for (u32 v = 0; v < vertex_count; ++v) {
+        reordered[remap[v]] = vertices[v];
+    }
+    kcopy_memory(vertices, reordered, sizeof(vertex_3d) * vertex_count);
+
+    kfree(reordered, sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(remap, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+}
+
+void geometry_indices_narrow_u16(u32 index_count, const u32* indices, u16* out_indices) {
+    for (u32 i = 0; i < index_count; ++i) {
+        out_indices[i] = (u16)indices[i];
+    }
+}
+
+static i16 pack_snorm16(f32 value) {
+    value = KMAX(KMIN(value, 1.0f), -1.0f) * 32767.0f;
+    return (i16)(value >= 0.0f ? value + 0.5f : value - 0.5f);
+}
+
+static f32 unpack_snorm16(i16 value) {
+    return KMAX((f32)value / 32767.0f, -1.0f);
+}
+
+static u8 pack_unorm8(f32 value) {
+    return (u8)(KMAX(KMIN(value, 1.0f), 0.0f) * 255.0f + 0.5f);
+}
+
+// Converts to a half float, rounding to nearest even. Values too large become infinity.
+static u16 pack_half(f32 value) {
+    union {
+        f32 f;
+        u32 u;
+    } bits = {value};
+    u32 sign = (bits.u >> 16) & 0x8000;
+    u32 exponent = (bits.u >> 23) & 0xff;
+    u32 mantissa = bits.u & 0x7fffff;
+
+    if (exponent == 0xff) {
+        // Infinity or NaN, keeping NaNs quiet.
+        return (u16)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+    i32 half_exponent = (i32)exponent - 127 + 15;
+    if (half_exponent >= 31) {
+        return (u16)(sign | 0x7c00);
+    }
+    if (half_exponent <= 0) {
+        // Subnormal, or too small to represent.
+        if (half_exponent < -10) {
+            return (u16)sign;
+        }
+        mantissa |= 0x800000;
+        u32 shift = (u32)(14 - half_exponent);
+        u32 half_mantissa = mantissa >> shift;
+        u32 remainder = mantissa & ((1u << shift) - 1);
+        u32 halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half_mantissa & 1))) {
+            half_mantissa++;
+        }
+        return (u16)(sign | half_mantissa);
+    }
+    u32 half = sign | ((u32)half_exponent << 10) | (mantissa >> 13);
+    u32 remainder = mantissa & 0x1fff;
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity.
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return (u16)half;
+}
+
+static f32 unpack_half(u16 value) {
+    u32 sign = ((u32)value & 0x8000) << 16;
+    u32 exponent = ((u32)value >> 10) & 0x1f;
+    u32 mantissa = (u32)value & 0x3ff;
+    union {
+        u32 u;
+        f32 f;
+    } bits;
+    if (exponent == 0x1f) {
+        bits.u = sign | 0x7f800000 | (mantissa << 13);
+    } else if (exponent == 0) {
+        // Zero or subnormal, which is mantissa * 2^-24.
+        bits.f = (f32)mantissa * (1.0f / 16777216.0f);
+        bits.u |= sign;
+    } else {
+        bits.u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    return bits.f;
+}
+
+// Maps a unit vector onto the octahedron, then folds the lower half over the upper.
+static vec2 octahedral_encode(vec3 n) {
+    f32 sum = kabs(n.x) + kabs(n.y) + kabs(n.z);
+    if (sum == 0.0f) {
+        return (vec2){0.0f, 0.0f};
+    }
+    vec2 e = (vec2){n.x / sum, n.y / sum};
+    if (n.z < 0.0f) {
+        f32 x = e.x;
+        e.x = (1.0f - kabs(e.y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        e.y = (1.0f - kabs(x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return e;
+}
+
+// Must match the decode in the material shader.
+static vec3 octahedral_decode(vec2 e) {
+    vec3 n = (vec3){e.x, e.y, 1.0f - kabs(e.x) - kabs(e.y)};
+    f32 t = KMAX(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return vec3_normalized(n);
+}
+
+// A continuous orthonormal basis around the normal n, which must match the one in the material
+// shader. See Duff et al., "Building an Orthonormal Basis, Revisited".
+static void tangent_basis(vec3 n, vec3* out_b1, vec3* out_b2) {
+    f32 sign = n.z >= 0.0f ? 1.0f : -1.0f;
+    f32 a = -1.0f / (sign + n.z);
+    f32 b = n.x * n.y * a;
+    *out_b1 = (vec3){1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x};
+    *out_b2 = (vec3){b, sign + n.y * n.y * a, -n.y};
+}
+
+void geometry_pack_vertices(u32 vertex_count, const vertex_3d* vertices, vertex_3d_packed* out_vertices) {
+    PROFILE_SCOPE("geometry_pack_vertices");
+    for (u32 i = 0; i < vertex_count; ++i) {
+        const vertex_3d* v = &vertices[i];
+        vertex_3d_packed* p = &out_vertices[i];
+        p->position = v->position;
+
+        vec2 e = octahedral_encode(v->normal);
+        p->normal_tangent[0] = pack_snorm16(e.x);
+        p->normal_tangent[1] = pack_snorm16(e.y);
+
+        // The tangent angle is measured around the normal as it will be decoded, so the
+        // quantization error of the normal is not carried into the tangent.
+        vec3 n = octahedral_decode((vec2){unpack_snorm16(p->normal_tangent[0]), unpack_snorm16(p->normal_tangent[1])});
+        vec3 b1, b2;
+        tangent_basis(n, &b1, &b2);
+        vec3 t = (vec3){v->tangent.x, v->tangent.y, v->tangent.z};
+        p->normal_tangent[2] = pack_snorm16(katan2(vec3_dot(t, b2), vec3_dot(t, b1)) / K_PI);
+        p->normal_tangent[3] = v->tangent.w < 0.0f ? -32767 : 32767;
+
+        p->texcoord[0] = pack_half(v->texcoord.x);
+        p->texcoord[1] = pack_half(v->texcoord.y);
+        p->colour[0] = pack_unorm8(v->colour.r);
+        p->colour[1] = pack_unorm8(v->colour.g);
+        p->colour[2] = pack_unorm8(v->colour.b);
+        p->colour[3] = pack_unorm8(v->colour.a);
+    }
+}
+
+void geometry_unpack_vertices(u32 vertex_count, const vertex_3d_packed* vertices, vertex_3d* out_vertices) {
+    for (u32 i = 0; i < vertex_count; ++i) {
+        const vertex_3d_packed* p = &vertices[i];
+        vertex_3d* v = &out_vertices[i];
+        v->position = p->position;
+
+        v->normal = octahedral_decode((vec2){unpack_snorm16(p->normal_tangent[0]), unpack_snorm16(p->normal_tangent[1])});
+        vec3 b1, b2;
+        tangent_basis(v->normal, &b1, &b2);
+        f32 angle = unpack_snorm16(p->normal_tangent[2]) * K_PI;
+        vec3 t = vec3_add(vec3_mul_scalar(b1, kcos(angle)), vec3_mul_scalar(b2, ksin(angle)));
+        v->tangent = (vec4){t.x, t.y, t.z, p->normal_tangent[3] < 0 ? -1.0f : 1.0f};
+
+        v->texcoord = (vec2){unpack_half(p->texcoord[0]), unpack_half(p->texcoord[1])};
+        v->colour = (vec4){p->colour[0] / 255.0f, p->colour[1] / 255.0f, p->colour[2] / 255.0f, p->colour[3] / 255.0f};
+    }
+}
+
+// How much more a vertex moving off an open border costs than moving off a face.
+#define SIMPLIFY_BORDER_WEIGHT 10.0
+
+typedef enum simplify_vertex_kind {
+    // An interior vertex, which can collapse onto any neighbour.
+    SIMPLIFY_VERTEX_MANIFOLD,
+    // A vertex on an open border, which can only collapse along the border.
+    SIMPLIFY_VERTEX_BORDER,
+    // A vertex on a UV or normal seam. Both copies collapse along the seam together.
+    SIMPLIFY_VERTEX_SEAM,
+    // Anything else, such as where seams meet, which never moves.
+    SIMPLIFY_VERTEX_LOCKED
+} simplify_vertex_kind;
+
+// The sum of squared distances to a set of planes, as p^T A p + 2 b.p + c.
+typedef struct simplify_quadric {
+    f64 a00, a11, a22, a01, a02, a12;
+    f64 b0, b1, b2;
+    f64 c;
+} simplify_quadric;
+
+typedef struct simplify_collapse {
+    u32 from;
+    u32 to;
+    f32 cost;
+} simplify_collapse;
+
+typedef struct simplify_context {
+    u32 vertex_count;
+    u32 index_count;
+    u32* indices;
+    // Positions scaled to the unit cube, so errors are relative to the size of the mesh.
+    vec3* positions;
+    // The first vertex with the same position as each vertex.
+    u32* remap;
+    // The next vertex with the same position, forming a ring.
+    u32* wedge;
+    u8* kinds;
+    // The triangles using each vertex, as ranges of triangle_ids.
+    u32* triangle_offsets;
+    u32* triangle_ids;
+} simplify_context;
+
+static void quadric_add_plane(simplify_quadric* q, vec3 n, f32 d, f64 weight) {
+    q->a00 += weight * n.x * n.x;
+    q->a11 += weight * n.y * n.y;
+    q->a22 += weight * n.z * n.z;
+    q->a01 += weight * n.x * n.y;
+    q->a02 += weight * n.x * n.z;
+    q->a12 += weight * n.y * n.z;
+    q->b0 += weight * n.x * d;
+    q->b1 += weight * n.y * d;
+    q->b2 += weight * n.z * d;
+    q->c += weight * d * d;
+}
+
+static void quadric_add(simplify_quadric* q, const simplify_quadric* other) {
+    q->a00 += other->a00;
+    q->a11 += other->a11;
+    q->a22 += other->a22;
+    q->a01 += other->a01;
+    q->a02 += other->a02;
+    q->a12 += other->a12;
+    q->b0 += other->b0;
+    q->b1 += other->b1;
+    q->b2 += other->b2;
+    q->c += other->c;
+}
+
+static f64 quadric_error(const simplify_quadric* q, vec3 p) {
+    f64 x = p.x, y = p.y, z = p.z;
+    f64 error = q->a00 * x * x + q->a11 * y * y + q->a22 * z * z +
+                2.0 * (q->a01 * x * y + q->a02 * x * z + q->a12 * y * z) +
+                2.0 * (q->b0 * x + q->b1 * y + q->b2 * z) + q->c;
+    return error > 0.0 ? error : 0.0;
+}
+
+static void simplify_build_adjacency(simplify_context* ctx) {
+    kzero_memory(ctx->triangle_offsets, sizeof(u32) * (ctx->vertex_count + 1));
+    for (u32 i = 0; i < ctx->index_count; ++i) {
+        ctx->triangle_offsets[ctx->indices[i] + 1]++;
+    }
+    for (u32 v = 0; v < ctx->vertex_count; ++v) {
+        ctx->triangle_offsets[v + 1] += ctx->triangle_offsets[v];
+    }
+    // Fill using the end of each range as a cursor, then shift the offsets back.
+    for (u32 i = 0; i < ctx->index_count; ++i) {
+        ctx->triangle_ids[ctx->triangle_offsets[ctx->indices[i]]++] = i / 3;
+    }
+    for (u32 v = ctx->vertex_count; v > 0; --v) {
+        ctx->triangle_offsets[v] = ctx->triangle_offsets[v - 1];
+    }
+    ctx->triangle_offsets[0] = 0;
+}
+
+// Gets the corner of the triangle which uses vertex v.
+static u32 simplify_corner(const simplify_context* ctx, u32 triangle, u32 v) {
+    const u32* t = &ctx->indices[triangle * 3];
+    return t[0] == v ? 0 : (t[1] == v ? 1 : 2);
+}
+
+// Checks for a half-edge from a to b. If exact, the vertices must match; otherwise only their positions.
+static b8 simplify_has_edge(const simplify_context* ctx, u32 a, u32 b, b8 exact) {
+    u32 w = a;
+    do {
+        for (u32 i = ctx->triangle_offsets[w]; i < ctx->triangle_offsets[w + 1]; ++i) {
+            u32 triangle = ctx->triangle_ids[i];
+            u32 next = ctx->indices[triangle * 3 + (simplify_corner(ctx, triangle, w) + 1) % 3];
+            if (exact ? next == b : ctx->remap[next] == ctx->remap[b]) {
+                return true;
+            }
+        }
+        w = ctx->wedge[w];
+    } while (!exact && w != a);
+    return false;
+}
+
+static void simplify_classify(simplify_context* ctx) {
+    for (u32 v = 0; v < ctx->vertex_count; ++v) {
+        if (ctx->remap[v] != v) {
+            continue;
+        }
+
+        // Count the half-edges around the position with no opposite, in and out.
+        u32 wedge_count = 0;
+        u32 open_out = 0;
+        u32 open_in = 0;
+        u32 w = v;
+        do {
+            wedge_count++;
+            for (u32 i = ctx->triangle_offsets[w]; i < ctx->triangle_offsets[w + 1]; ++i) {
+                u32 triangle = ctx->triangle_ids[i];
+                u32 corner = simplify_corner(ctx, triangle, w);
+                u32 next = ctx->indices[triangle * 3 + (corner + 1) % 3];
+                u32 prev = ctx->indices[triangle * 3 + (corner + 2) % 3];
+                open_out += !simplify_has_edge(ctx, next, w, false);
+                open_in += !simplify_has_edge(ctx, w, prev, false);
+            }
+            w = ctx->wedge[w];
+        } while (w != v);
+
+        simplify_vertex_kind kind = SIMPLIFY_VERTEX_LOCKED;
+        if (wedge_count == 1) {
+            if (open_out == 0 && open_in == 0) {
+                kind = SIMPLIFY_VERTEX_MANIFOLD;
+            } else if (open_out == 1 && open_in == 1) {
+                kind = SIMPLIFY_VERTEX_BORDER;
+            }
+        } else if (wedge_count == 2 && open_out == 0 && open_in == 0) {
+            // Closed by position, so each copy must be open on exactly one edge each way, along the seam.
+            kind = SIMPLIFY_VERTEX_SEAM;
+            w = v;
+            do {
+                u32 seam_out = 0;
+                u32 seam_in = 0;
+                for (u32 i = ctx->triangle_offsets[w]; i < ctx->triangle_offsets[w + 1]; ++i) {
+                    u32 triangle = ctx->triangle_ids[i];
+                    u32 corner = simplify_corner(ctx, triangle, w);
+                    seam_out += !simplify_has_edge(ctx, ctx->indices[triangle * 3 + (corner + 1) % 3], w, true);
+                    seam_in += !simplify_has_edge(ctx, w, ctx->indices[triangle * 3 + (corner + 2) % 3], true);
+                }
+                if (seam_out != 1 || seam_in != 1) {
+                    kind = SIMPLIFY_VERTEX_LOCKED;
+                }
+                w = ctx->wedge[w];
+            } while (w != v);
+        }
+
+        w = v;
+        do {
+            ctx->kinds[w] = kind;
+            w = ctx->wedge[w];
+        } while (w != v);
+    }
+}
+
+static b8 simplify_can_collapse(const simplify_context* ctx, u32 from, u32 to) {
+    if (ctx->remap[from] == ctx->remap[to]) {
+        return false;
+    }
+    switch (ctx->kinds[from]) {
+        case SIMPLIFY_VERTEX_MANIFOLD:
+            return true;
+        case SIMPLIFY_VERTEX_BORDER:
+            // Only along the border, so it is not pulled inward.
+            return ctx->kinds[to] != SIMPLIFY_VERTEX_MANIFOLD &&
+                   (!simplify_has_edge(ctx, to, from, false) || !simplify_has_edge(ctx, from, to, false));
+        case SIMPLIFY_VERTEX_SEAM:
+            // Only along the seam, so the attributes either side of it are kept.
+            return (ctx->kinds[to] == SIMPLIFY_VERTEX_SEAM || ctx->kinds[to] == SIMPLIFY_VERTEX_LOCKED) &&
+                   (!simplify_has_edge(ctx, to, from, true) || !simplify_has_edge(ctx, from, to, true));
+        default:
+            return false;
+    }
+}
+
+// Finds the copy of a seam collapse on the other side of the seam: the other copy of from, and
+// the vertex at the position of to which it shares a seam edge with.
+static b8 simplify_find_seam_pair(const simplify_context* ctx, u32 from, u32 to, u32* out_from, u32* out_to) {
+    u32 other = ctx->wedge[from];
+    for (u32 i = ctx->triangle_offsets[other]; i < ctx->triangle_offsets[other + 1]; ++i) {
+        u32 triangle = ctx->triangle_ids[i];
+        for (u32 k = 0; k < 3; ++k) {
+            u32 candidate = ctx->indices[triangle * 3 + k];
+            if (ctx->remap[candidate] == ctx->remap[to] &&
+                (!simplify_has_edge(ctx, candidate, other, true) || !simplify_has_edge(ctx, other, candidate, true))) {
+                *out_from = other;
+                *out_to = candidate;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Checks if moving from onto to would flip any triangle which is not removed by the collapse.
+static b8 simplify_flips(const simplify_context* ctx, u32 from, u32 to) {
+    vec3 target = ctx->positions[to];
+    for (u32 i = ctx->triangle_offsets[from]; i < ctx->triangle_offsets[from + 1]; ++i) {
+        u32 triangle = ctx->triangle_ids[i];
+        const u32* t = &ctx->indices[triangle * 3];
+        u32 corner = simplify_corner(ctx, triangle, from);
+        u32 b = t[(corner + 1) % 3];
+        u32 c = t[(corner + 2) % 3];
+        if (ctx->remap[b] == ctx->remap[to] || ctx->remap[c] == ctx->remap[to]) {
+            continue;
+        }
+        vec3 pa = ctx->positions[from];
+        vec3 pb = ctx->positions[b];
+        vec3 pc = ctx->positions[c];
+        vec3 before = vec3_cross(vec3_sub(pb, pa), vec3_sub(pc, pa));
+        vec3 after = vec3_cross(vec3_sub(pb, target), vec3_sub(pc, target));
+        if (vec3_dot(before, after) <= 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Counts the triangles using from which a collapse onto to removes.
+static u32 simplify_removed_triangles(const simplify_context* ctx, u32 from, u32 to) {
+    u32 count = 0;
+    for (u32 i = ctx->triangle_offsets[from]; i < ctx->triangle_offsets[from + 1]; ++i) {
+        const u32* t = &ctx->indices[ctx->triangle_ids[i] * 3];
+        count += ctx->remap[t[0]] == ctx->remap[to] || ctx->remap[t[1]] == ctx->remap[to] || ctx->remap[t[2]] == ctx->remap[to];
+    }
+    return count;
+}
+
+static void simplify_lock_neighbours(const simplify_context* ctx, u32 v, b8* locked) {
+    locked[ctx->remap[v]] = true;
+    for (u32 i = ctx->triangle_offsets[v]; i < ctx->triangle_offsets[v + 1]; ++i) {
+        const u32* t = &ctx->indices[ctx->triangle_ids[i] * 3];
+        locked[ctx->remap[t[0]]] = true;
+        locked[ctx->remap[t[1]]] = true;
+        locked[ctx->remap[t[2]]] = true;
+    }
+}
+
+static void collapse_sift_down(simplify_collapse* collapses, u32 start, u32 end) {
+    u32 root = start;
+    while (root * 2 + 1 < end) {
+        u32 child = root * 2 + 1;
+        if (child + 1 < end && collapses[child + 1].cost > collapses[child].cost) {
+            child++;
+        }
+        if (collapses[root].cost >= collapses[child].cost) {
+            return;
+        }
+        simplify_collapse temp = collapses[root];
+        collapses[root] = collapses[child];
+        collapses[child] = temp;
+        root = child;
+    }
+}
+
+// Heapsort by ascending cost.
+static void collapses_sort(simplify_collapse* collapses, u32 count) {
+    if (count < 2) {
+        return;
+    }
+    for (u32 i = count / 2; i > 0; --i) {
+        collapse_sift_down(collapses, i - 1, count);
+    }
+    for (u32 end = count - 1; end > 0; --end) {
+        simplify_collapse temp = collapses[0];
+        collapses[0] = collapses[end];
+        collapses[end] = temp;
+        collapse_sift_down(collapses, 0, end);
+    }
+}
+
+static b8 simplify_same_position(const vec3* a, const vec3* b) {
+    const u32* a_bits = (const u32*)a;
+    const u32* b_bits = (const u32*)b;
+    return a_bits[0] == b_bits[0] && a_bits[1] == b_bits[1] && a_bits[2] == b_bits[2];
+}
+
+// Links vertices with identical positions into rings, and points each at the first of its ring.
+static void simplify_build_wedges(simplify_context* ctx) {
+    u32 capacity = 16;
+    while (capacity < (u64)ctx->vertex_count * 2) {
+        capacity <<= 1;
+    }
+    u32* table = kallocate(sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < capacity; ++i) {
+        table[i] = INVALID_ID;
+    }
+    for (u32 v = 0; v < ctx->vertex_count; ++v) {
+        const u32* bits = (const u32*)&ctx->positions[v];
+        u32 hash = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        u32 slot = (hash ^ (hash >> 15)) & (capacity - 1);
+        while (table[slot] != INVALID_ID && !simplify_same_position(&ctx->positions[table[slot]], &ctx->positions[v])) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == INVALID_ID) {
+            table[slot] = v;
+            ctx->remap[v] = v;
+            ctx->wedge[v] = v;
+        } else {
+            u32 first = table[slot];
+            ctx->remap[v] = first;
+            ctx->wedge[v] = ctx->wedge[first];
+            ctx->wedge[first] = v;
+        }
+    }
+    kfree(table, sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+}
+
+u32 geometry_simplify(u32 vertex_count, const vertex_3d* vertices, u32 index_count, const u32* indices, u32 target_index_count, f32 target_error, u32* out_indices, f32* out_error) {
+    PROFILE_SCOPE("geometry_simplify");
+    *out_error = 0.0f;
+    kcopy_memory(out_indices, indices, sizeof(u32) * index_count);
+    if (vertex_count == 0 || index_count <= target_index_count) {
+        return index_count;
+    }
+
+    simplify_context ctx;
+    ctx.vertex_count = vertex_count;
+    ctx.index_count = index_count;
+    ctx.indices = out_indices;
+    ctx.positions = kallocate(sizeof(vec3) * vertex_count, MEMORY_TAG_ARRAY);
+    ctx.remap = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    ctx.wedge = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    ctx.kinds = kallocate(sizeof(u8) * vertex_count, MEMORY_TAG_ARRAY);
+    ctx.triangle_offsets = kallocate(sizeof(u32) * (vertex_count + 1), MEMORY_TAG_ARRAY);
+    ctx.triangle_ids = kallocate(sizeof(u32) * index_count, MEMORY_TAG_ARRAY);
+
+    // Scale positions into the unit cube.
+    vec3 min = vertices[0].position;
+    vec3 max = vertices[0].position;
+    for (u32 v = 1; v < vertex_count; ++v) {
+        for (u32 k = 0; k < 3; ++k) {
+            min.elements[k] = KMIN(min.elements[k], vertices[v].position.elements[k]);
+            max.elements[k] = KMAX(max.elements[k], vertices[v].position.elements[k]);
+        }
+    }
+    f32 extent = KMAX(max.x - min.x, KMAX(max.y - min.y, max.z - min.z));
+    f32 scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+    for (u32 v = 0; v < vertex_count; ++v) {
+        ctx.positions[v] = vec3_mul_scalar(vec3_sub(vertices[v].position, min), scale);
+    }
+
+    simplify_build_wedges(&ctx);
+    simplify_build_adjacency(&ctx);
+    simplify_classify(&ctx);
+
+    // Each position accumulates the planes of its triangles, weighted by area, plus planes
+    // perpendicular to any open border edges so borders keep their shape.
+    simplify_quadric* quadrics = kallocate(sizeof(simplify_quadric) * vertex_count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < index_count; i += 3) {
+        u32 corners[3] = {out_indices[i], out_indices[i + 1], out_indices[i + 2]};
+        vec3 p0 = ctx.positions[corners[0]];
+        vec3 normal = vec3_cross(vec3_sub(ctx.positions[corners[1]], p0), vec3_sub(ctx.positions[corners[2]], p0));
+        f32 length = vec3_length(normal);
+        if (length == 0.0f) {
+            continue;
+        }
+        normal = vec3_mul_scalar(normal, 1.0f / length);
+        for (u32 k = 0; k < 3; ++k) {
+            quadric_add_plane(&quadrics[ctx.remap[corners[k]]], normal, -vec3_dot(normal, p0), 0.5 * length);
+        }
+        for (u32 k = 0; k < 3; ++k) {
+            u32 a = corners[k];
+            u32 b = corners[(k + 1) % 3];
+            if (simplify_has_edge(&ctx, b, a, false)) {
+                continue;
+            }
+            vec3 edge = vec3_sub(ctx.positions[b], ctx.positions[a]);
+            vec3 border_normal = vec3_cross(edge, normal);
+            f32 border_length = vec3_length(border_normal);
+            if (border_length == 0.0f) {
+                continue;
+            }
+            border_normal = vec3_mul_scalar(border_normal, 1.0f / border_length);
+            f32 d = -vec3_dot(border_normal, ctx.positions[a]);
+            f64 weight = SIMPLIFY_BORDER_WEIGHT * vec3_length_squared(edge);
+            quadric_add_plane(&quadrics[ctx.remap[a]], border_normal, d, weight);
+            quadric_add_plane(&quadrics[ctx.remap[b]], border_normal, d, weight);
+        }
+    }
+
+    // Collapse edges in passes. Each pass applies the cheapest collapses which do not touch
+    // each other, so every collapse in a pass is judged against an up to date mesh.
+    simplify_collapse* collapses = kallocate(sizeof(simplify_collapse) * index_count * 2, MEMORY_TAG_ARRAY);
+    u32* collapse_remap = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    b8* locked = kallocate(sizeof(b8) * vertex_count, MEMORY_TAG_ARRAY);
+    f64 max_cost = (f64)target_error * target_error;
+    f64 result_cost = 0.0;
+    while (ctx.index_count > target_index_count) {
+        u32 collapse_count = 0;
+        for (u32 i = 0; i < ctx.index_count; ++i) {
+            u32 a = out_indices[i];
+            u32 b = out_indices[i - i % 3 + (i + 1) % 3];
+            u32 pair[2][2] = {{a, b}, {b, a}};
+            for (u32 k = 0; k < 2; ++k) {
+                u32 from = pair[k][0];
+                u32 to = pair[k][1];
+                if (!simplify_can_collapse(&ctx, from, to)) {
+                    continue;
+                }
+                f64 cost = quadric_error(&quadrics[ctx.remap[from]], ctx.positions[to]);
+                if (cost <= max_cost) {
+                    collapses[collapse_count++] = (simplify_collapse){from, to, (f32)cost};
+                }
+            }
+        }
+        if (collapse_count == 0) {
+            break;
+        }
+        collapses_sort(collapses, collapse_count);
+
+        for (u32 v = 0; v < vertex_count; ++v) {
+            collapse_remap[v] = v;
+            locked[v] = false;
+        }
+        u32 goal = (ctx.index_count - target_index_count) / 3;
+        u32 removed = 0;
+        u32 applied = 0;
+        for (u32 i = 0; i < collapse_count && removed < goal; ++i) {
+            u32 from = collapses[i].from;
+            u32 to = collapses[i].to;
+            if (locked[ctx.remap[from]] || locked[ctx.remap[to]]) {
+                continue;
+            }
+            b8 seam = ctx.kinds[from] == SIMPLIFY_VERTEX_SEAM;
+            u32 seam_from = INVALID_ID;
+            u32 seam_to = INVALID_ID;
+            if (seam && !simplify_find_seam_pair(&ctx, from, to, &seam_from, &seam_to)) {
+                continue;
+            }
+            if (simplify_flips(&ctx, from, to) || (seam && simplify_flips(&ctx, seam_from, seam_to))) {
+                continue;
+            }
+
+            collapse_remap[from] = to;
+            removed += simplify_removed_triangles(&ctx, from, to);
+            simplify_lock_neighbours(&ctx, from, locked);
+            if (seam) {
+                collapse_remap[seam_from] = seam_to;
+                removed += simplify_removed_triangles(&ctx, seam_from, seam_to);
+                simplify_lock_neighbours(&ctx, seam_from, locked);
+            }
+            quadric_add(&quadrics[ctx.remap[to]], &quadrics[ctx.remap[from]]);
+            result_cost = KMAX(result_cost, collapses[i].cost);
+            applied++;
+        }
+        if (applied == 0) {
+            break;
+        }
+
+        // Apply the collapses, dropping triangles which are now degenerate.
+        u32 write = 0;
+        for (u32 i = 0; i < ctx.index_count; i += 3) {
+            u32 a = collapse_remap[out_indices[i]];
+            u32 b = collapse_remap[out_indices[i + 1]];
+            u32 c = collapse_remap[out_indices[i + 2]];
+            if (ctx.remap[a] != ctx.remap[b] && ctx.remap[b] != ctx.remap[c] && ctx.remap[a] != ctx.remap[c]) {
+                out_indices[write++] = a;
+                out_indices[write++] = b;
+                out_indices[write++] = c;
+            }
+        }
+        ctx.index_count = write;
+        simplify_build_adjacency(&ctx);
+    }
+
+    kfree(collapses, sizeof(simplify_collapse) * index_count * 2, MEMORY_TAG_ARRAY);
+    kfree(collapse_remap, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(locked, sizeof(b8) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(quadrics, sizeof(simplify_quadric) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(ctx.positions, sizeof(vec3) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(ctx.remap, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(ctx.wedge, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(ctx.kinds, sizeof(u8) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(ctx.triangle_offsets, sizeof(u32) * (vertex_count + 1), MEMORY_TAG_ARRAY);
+    kfree(ctx.triangle_ids, sizeof(u32) * index_count, MEMORY_TAG_ARRAY);
+
+    *out_error = (f32)ksqrt((f32)result_cost);
+    return ctx.index_count;
+}
+
+u8 geometry_select_lod(u8 lod_count, const f32* screen_sizes, f32 hysteresis, f32 screen_size, u8 previous_lod) {
+    if (lod_count < 2) {
+        return 0;
+    }
+    u8 lod = KMIN(previous_lod, lod_count - 1);
+    while (lod + 1 < lod_count && screen_sizes[lod] > 0.0f && screen_size < screen_sizes[lod] * (1.0f - hysteresis)) {
+        lod++;
+    }
+    while (lod > 0 && screen_size > screen_sizes[lod - 1] * (1.0f + hysteresis)) {
+        lod--;
+    }
+    return lod;
+}
+
+u32 geometry_meshlet_count_bound(u32 index_count, u32 max_vertices, u32 max_triangles) {
+    // A meshlet is only closed when the next triangle does not fit, and every triangle adds at
+    // most 3 vertices, so every meshlet but the last holds at least this many triangles.
+    u32 min_triangles = KMAX(1, KMIN(max_triangles, max_vertices / 3));
+    return index_count / 3 / min_triangles + 1;
+}
+
+// Finds the bounding sphere and normal cone of a meshlet.
+static void meshlet_compute_bounds(const vertex_3d* vertices, const u32* indices, geometry_meshlet* meshlet) {
+    const u32* meshlet_indices = indices + meshlet->index_offset;
+    vec3 min = vertices[meshlet_indices[0]].position;
+    vec3 max = min;
+    vec3 axis = vec3_zero();
+    for (u32 i = 0; i < meshlet->index_count; ++i) {
+        vec3 p = vertices[meshlet_indices[i]].position;
+        min = vec3_create(KMIN(min.x, p.x), KMIN(min.y, p.y), KMIN(min.z, p.z));
+        max = vec3_create(KMAX(max.x, p.x), KMAX(max.y, p.y), KMAX(max.z, p.z));
+    }
+    vec3 center = vec3_mul_scalar(vec3_add(min, max), 0.5f);
+    f32 radius = 0.0f;
+    for (u32 i = 0; i < meshlet->index_count; ++i) {
+        radius = KMAX(radius, vec3_distance(center, vertices[meshlet_indices[i]].position));
+    }
+    meshlet->center = center;
+    meshlet->radius = radius;
+
+    // The cone axis is the average of the triangle normals.
+    for (u32 i = 0; i < meshlet->index_count; i += 3) {
+        vec3 p0 = vertices[meshlet_indices[i]].position;
+        vec3 n = vec3_cross(vec3_sub(vertices[meshlet_indices[i + 1]].position, p0), vec3_sub(vertices[meshlet_indices[i + 2]].position, p0));
+        f32 length = vec3_length(n);
+        if (length > 0.0f) {
+            axis = vec3_add(axis, vec3_mul_scalar(n, 1.0f / length));
+        }
+    }
+    meshlet->cone_apex = center;
+    meshlet->cone_axis = vec3_create(0, 0, 1);
+    meshlet->cone_cutoff = 1.0f;
+    f32 axis_length = vec3_length(axis);
+    if (axis_length == 0.0f) {
+        return;
+    }
+    axis = vec3_mul_scalar(axis, 1.0f / axis_length);
+
+    // The widest normal sets the cone angle, and the apex is moved back until every
+    // triangle's plane is in front of it.
+    f32 min_dot = 1.0f;
+    f32 max_t = 0.0f;
+    for (u32 i = 0; i < meshlet->index_count; i += 3) {
+        vec3 p0 = vertices[meshlet_indices[i]].position;
+        vec3 n = vec3_cross(vec3_sub(vertices[meshlet_indices[i + 1]].position, p0), vec3_sub(vertices[meshlet_indices[i + 2]].position, p0));
+        f32 length = vec3_length(n);
+        if (length == 0.0f) {
+            continue;
+        }
+        n = vec3_mul_scalar(n, 1.0f / length);
+        f32 d = vec3_dot(n, axis);
+        min_dot = KMIN(min_dot, d);
+        if (d > 0.0f) {
+            max_t = KMAX(max_t, vec3_dot(vec3_sub(center, p0), n) / d);
+        }
+    }
+    meshlet->cone_axis = axis;
+    // Cones wider than a hemisphere, give or take, never face away from the viewer.
+    if (min_dot <= 0.1f) {
+        return;
+    }
+    meshlet->cone_apex = vec3_sub(center, vec3_mul_scalar(axis, max_t));
+    meshlet->cone_cutoff = ksqrt(1.0f - min_dot * min_dot);
+}
+
+u32 geometry_build_meshlets(u32 vertex_count, const vertex_3d* vertices, u32 index_count, const u32* indices, u32 max_vertices, u32 max_triangles, geometry_meshlet* out_meshlets) {
+    PROFILE_SCOPE("geometry_build_meshlets");
+    if (index_count < 3 || max_vertices < 3 || max_triangles == 0) {
+        return 0;
+    }
+
+    // The meshlet each vertex was last counted in, so each is only counted once per meshlet.
+    u32* last_meshlet = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    for (u32 v = 0; v < vertex_count; ++v) {
+        last_meshlet[v] = INVALID_ID;
+    }
+
+    // Triangles are taken in order, so the index buffer keeps its vertex cache order and each
+    // meshlet is a contiguous range of it.
+    u32 meshlet_count = 0;
+    geometry_meshlet* current = &out_meshlets[0];
+    kzero_memory(current, sizeof(geometry_meshlet));
+    u32 current_vertex_count = 0;
+    for (u32 i = 0; i + 2 < index_count; i += 3) {
+        u32 new_vertices = 0;
+        for (u32 k = 0; k < 3; ++k) {
+            new_vertices += last_meshlet[indices[i + k]] != meshlet_count;
+        }
+        if (current->index_count > 0 && (current_vertex_count + new_vertices > max_vertices || current->index_count / 3 + 1 > max_triangles)) {
+            meshlet_compute_bounds(vertices, indices, current);
+            meshlet_count++;
+            current = &out_meshlets[meshlet_count];
+            kzero_memory(current, sizeof(geometry_meshlet));
+            current->index_offset = i;
+            current_vertex_count = 0;
+        }
+        for (u32 k = 0; k < 3; ++k) {
+            if (last_meshlet[indices[i + k]] != meshlet_count) {
+                last_meshlet[indices[i + k]] = meshlet_count;
+                current_vertex_count++;
+            }
+        }
+        current->index_count += 3;
+    }
+    meshlet_compute_bounds(vertices, indices, current);
+    meshlet_count++;
+
+    kfree(last_meshlet, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    return meshlet_count;
+}
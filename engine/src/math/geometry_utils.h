@@ -27,6 +27,11 @@ void geometry_generate_tangents(u32 vertex_count, vertex_3d* vertices, u32 index
  * Allocates a new array in out_vertices. Modifies indices in-place. Original
  * vertex array should be freed by caller.
  *
+ * Vertices are equal if every attribute is within K_FLOAT_EPSILON. Unique vertices keep the
+ * order in which they first appear, and each duplicate is mapped to the earliest unique vertex
+ * it equals. Vertices with a non-finite position are always kept. Runs in roughly linear time,
+ * using a hash grid over vertex positions.
+ *
  * @param vertex_count The number of vertices in the array.
  * @param vertices The original array of vertices to be de-duplicated. Not modified.
  * @param index_count The number of indices in the array.
@@ -34,4 +39,159 @@ void geometry_generate_tangents(u32 vertex_count, vertex_3d* vertices, u32 index
  * @param out_vertex_count A pointer to hold the final vertex count.
  * @param out_vertices A pointer to hold the array of de-duplicated vertices.
  */
-void geometry_deduplicate_vertices(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices, u32* out_vertex_count, vertex_3d** out_vertices);
+KAPI void geometry_deduplicate_vertices(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices, u32* out_vertex_count, vertex_3d** out_vertices);
+
+/** @brief The post-transform vertex cache size meshes are optimized for and measured against. */
+#define GEOMETRY_VERTEX_CACHE_SIZE 16
+
+/** @brief How well an index buffer uses a simulated FIFO post-transform vertex cache. */
+typedef struct geometry_vertex_cache_stats {
+    /** @brief Average cache miss ratio: vertex shader invocations per triangle. 0.5 at best, 3 at worst. */
+    f32 acmr;
+    /** @brief Average transform to vertex ratio: vertex shader invocations per referenced vertex. 1 at best. */
+    f32 atvr;
+} geometry_vertex_cache_stats;
+
+/**
+ * @brief Measures how well the given indices use a FIFO post-transform vertex cache of the
+ * given size.
+ *
+ * @param vertex_count The number of vertices the indices refer to.
+ * @param index_count The number of indices.
+ * @param indices The array of indices.
+ * @param cache_size The number of vertices the simulated cache holds.
+ * @param out_stats A pointer to hold the measurements.
+ */
+KAPI void geometry_analyze_vertex_cache(u32 vertex_count, u32 index_count, const u32* indices, u32 cache_size, geometry_vertex_cache_stats* out_stats);
+
+/**
+ * @brief Reorders triangles for the post-transform vertex cache, then reorders the resulting
+ * clusters of triangles to reduce overdraw. Modifies indices in place; each triangle keeps its
+ * winding. Vertices are not modified.
+ *
+ * Triangles are ordered with Tipsify (Sander et al., "Fast Triangle Reordering for Vertex Locality
+ * and Reduced Overdraw"), which fans around vertices likely to still be in the cache, and runs in
+ * linear time. Each time it has to jump to a vertex which is not in the cache, a new cluster is
+ * started. The clusters are then sorted so those facing away from the center of the mesh come
+ * first, as they are the most likely to occlude others from any viewpoint.
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices The array of vertices, used for the overdraw ordering.
+ * @param index_count The number of indices. Must be a multiple of 3.
+ * @param indices The array of indices. Modified in-place.
+ * @param cache_size The size of the vertex cache to optimize for.
+ */
+KAPI void geometry_optimize_vertex_cache(u32 vertex_count, const vertex_3d* vertices, u32 index_count, u32* indices, u32 cache_size);
+
+/**
+ * @brief Reorders vertices into the order in which the indices first refer to them, so vertex
+ * fetches walk memory sequentially. Should be run after the triangle order is final. Modifies
+ * vertices and indices in place. Any unreferenced vertices are moved to the end, so the vertex
+ * count is unchanged.
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices The array of vertices. Modified in-place.
+ * @param index_count The number of indices.
+ * @param indices The array of indices. Modified in-place.
+ */
+KAPI void geometry_optimize_vertex_fetch(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices);
+
+/** @brief The most vertices a geometry can have and still be indexed with 16-bit indices. */
+#define GEOMETRY_U16_INDEX_VERTEX_LIMIT 65536
+
+/**
+ * @brief Narrows 32-bit indices to 16-bit. Every index must be less than GEOMETRY_U16_INDEX_VERTEX_LIMIT.
+ *
+ * @param index_count The number of indices.
+ * @param indices The array of 32-bit indices.
+ * @param out_indices An array of index_count 16-bit indices to hold the result.
+ */
+KAPI void geometry_indices_narrow_u16(u32 index_count, const u32* indices, u16* out_indices);
+
+/**
+ * @brief Packs vertices into the compact vertex_3d_packed form. Positions are kept as floats.
+ * Normals are octahedral-encoded, and tangents are stored as an angle around the normal plus
+ * the bitangent handedness, all as signed normalized 16-bit values. Texture coordinates become
+ * half floats and colours unsigned normalized 8-bit values, clamped to [0, 1].
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices The array of vertices to be packed.
+ * @param out_vertices An array of vertex_count packed vertices to hold the result.
+ */
+KAPI void geometry_pack_vertices(u32 vertex_count, const vertex_3d* vertices, vertex_3d_packed* out_vertices);
+
+/**
+ * @brief Unpacks vertices from the compact vertex_3d_packed form, decoding them the same way
+ * the material shader does.
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices The array of packed vertices.
+ * @param out_vertices An array of vertex_count vertices to hold the result.
+ */
+KAPI void geometry_unpack_vertices(u32 vertex_count, const vertex_3d_packed* vertices, vertex_3d* out_vertices);
+
+/**
+ * @brief Simplifies a triangle list using quadric error metrics, collapsing edges onto existing
+ * vertices so the result can share the original vertex buffer. Vertices on open borders only
+ * move along the border, and vertices on UV or normal seams (split vertices with the same
+ * position) only move along the seam, with both sides collapsing together, so seams stay closed.
+ * Errors are relative to the largest extent of the mesh.
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices The array of vertices.
+ * @param index_count The number of indices.
+ * @param indices The array of indices to simplify.
+ * @param target_index_count The number of indices to stop at. May not be reached if target_error is.
+ * @param target_error The maximum error of any collapse, relative to the size of the mesh.
+ * @param out_indices An array of index_count indices to hold the result.
+ * @param out_error A pointer to hold the largest error of any collapse made.
+ * @return The number of indices written to out_indices.
+ */
+KAPI u32 geometry_simplify(u32 vertex_count, const vertex_3d* vertices, u32 index_count, const u32* indices, u32 target_index_count, f32 target_error, u32* out_indices, f32* out_error);
+
+/**
+ * @brief Selects a level of detail from a projected size on screen, starting from the previously
+ * selected level. A level only changes once the size moves past its threshold by the given
+ * fraction, so sizes near a threshold do not switch back and forth.
+ *
+ * @param lod_count The number of levels of detail.
+ * @param screen_sizes The lod_count - 1 sizes below which each coarser level is used. A threshold of 0 or less stops at its level.
+ * @param hysteresis The fraction a size must move past a threshold to change level.
+ * @param screen_size The projected size to select a level for.
+ * @param previous_lod The previously selected level of detail.
+ * @return The selected level of detail.
+ */
+KAPI u8 geometry_select_lod(u8 lod_count, const f32* screen_sizes, f32 hysteresis, f32 screen_size, u8 previous_lod);
+
+/** @brief The most vertices a meshlet built at import can use. */
+#define GEOMETRY_MESHLET_MAX_VERTICES 64
+/** @brief The most triangles a meshlet built at import can hold. */
+#define GEOMETRY_MESHLET_MAX_TRIANGLES 124
+
+/**
+ * @brief Gets the most meshlets geometry_build_meshlets() can produce for the given limits.
+ *
+ * @param index_count The number of indices.
+ * @param max_vertices The most vertices a meshlet can use.
+ * @param max_triangles The most triangles a meshlet can hold.
+ * @return The most meshlets which can be produced.
+ */
+KAPI u32 geometry_meshlet_count_bound(u32 index_count, u32 max_vertices, u32 max_triangles);
+
+/**
+ * @brief Splits a triangle list into meshlets, small clusters of triangles which can be culled
+ * individually. Triangles are kept in order, so each meshlet is a contiguous range of the
+ * indices, and a new meshlet is started whenever the next triangle would exceed either limit.
+ * Indices should already be optimized for the vertex cache, so neighbouring triangles are
+ * close together. Each meshlet gets a bounding sphere and a cone enclosing its normals.
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices The array of vertices.
+ * @param index_count The number of indices.
+ * @param indices The array of indices.
+ * @param max_vertices The most vertices a meshlet can use. Must be at least 3.
+ * @param max_triangles The most triangles a meshlet can hold.
+ * @param out_meshlets An array of at least geometry_meshlet_count_bound() meshlets to hold the result.
+ * @return The number of meshlets written to out_meshlets.
+ */
+KAPI u32 geometry_build_meshlets(u32 vertex_count, const vertex_3d* vertices, u32 index_count, const u32* indices, u32 max_vertices, u32 max_triangles, geometry_meshlet* out_meshlets);
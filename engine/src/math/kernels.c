@@ -0,0 +1,252 @@
+#include "kernels.h"
+
+#include "kmath.h"
+#include "core/logger.h"
+#include "core/kstring.h"
+#include "platform/cpu_features.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+// SSE2 is part of the x86-64 baseline, so it is always available there.
+#define KKERNELS_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC allows any intrinsic to be used without changing compiler flags.
+#define KERNEL_TARGET_AVX2
+#else
+// Allows AVX2 code to be compiled in these functions only, without raising the baseline.
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+typedef b8 (*pfn_rgba8_has_transparency)(const u8* pixels, u64 pixel_count);
+typedef void (*pfn_vertex_3d_extents)(u32 vertex_count, const vertex_3d* vertices, vec3* out_min_extents, vec3* out_max_extents);
+
+/** @brief A set of kernel implementations. */
+typedef struct kernel_table {
+    pfn_rgba8_has_transparency rgba8_has_transparency;
+    pfn_vertex_3d_extents vertex_3d_extents;
+} kernel_table;
+
+static const char* kernel_set_names[KERNEL_SET_MAX] = {"scalar", "sse2", "avx2"};
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+static b8 rgba8_has_transparency_scalar(const u8* pixels, u64 pixel_count) {
+    for (u64 i = 0; i < pixel_count; ++i) {
+        if (pixels[i * 4 + 3] < 255) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void vertex_3d_extents_scalar(u32 vertex_count, const vertex_3d* vertices, vec3* out_min_extents, vec3* out_max_extents) {
+    if (vertex_count == 0) {
+        *out_min_extents = vec3_zero();
+        *out_max_extents = vec3_zero();
+        return;
+    }
+    vec3 min = vertices[0].position;
+    vec3 max = vertices[0].position;
+    for (u32 i = 1; i < vertex_count; ++i) {
+        const vec3* p = &vertices[i].position;
+        for (u8 e = 0; e < 3; ++e) {
+            if (p->elements[e] < min.elements[e]) {
+                min.elements[e] = p->elements[e];
+            }
+            if (p->elements[e] > max.elements[e]) {
+                max.elements[e] = p->elements[e];
+            }
+        }
+    }
+    *out_min_extents = min;
+    *out_max_extents = max;
+}
+
+static const kernel_table scalar_table = {
+    rgba8_has_transparency_scalar,
+    vertex_3d_extents_scalar};
+
+#ifdef KKERNELS_X64
+// ---------------------------------------------------------------------------
+// SSE2
+// ---------------------------------------------------------------------------
+
+static b8 rgba8_has_transparency_sse2(const u8* pixels, u64 pixel_count) {
+    // Forces the colour bytes to 0xFF, so the only bytes which can differ from 0xFF are alpha.
+    const __m128i colour_mask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i opaque = _mm_set1_epi32(-1);
+    u64 i = 0;
+    // 16 pixels per iteration. The loads are combined before testing to keep branches out of the loop body.
+    for (; i + 16 <= pixel_count; i += 16) {
+        const u8* p = pixels + i * 4;
+        __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i*)p), _mm_loadu_si128((const __m128i*)(p + 16)));
+        __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i*)(p + 32)), _mm_loadu_si128((const __m128i*)(p + 48)));
+        __m128i v = _mm_or_si128(_mm_and_si128(a, b), colour_mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, opaque)) != 0xFFFF) {
+            return true;
+        }
+    }
+    return rgba8_has_transparency_scalar(pixels + i * 4, pixel_count - i);
+}
+
+static void vertex_3d_extents_sse2(u32 vertex_count, const vertex_3d* vertices, vec3* out_min_extents, vec3* out_max_extents) {
+    if (vertex_count == 0) {
+        *out_min_extents = vec3_zero();
+        *out_max_extents = vec3_zero();
+        return;
+    }
+    // NOTE: Each load takes the position plus the first element of the normal, which
+    // stays within the vertex. The 4th lane is simply ignored.
+    __m128 min = _mm_loadu_ps(vertices[0].position.elements);
+    __m128 max = min;
+    for (u32 i = 1; i < vertex_count; ++i) {
+        __m128 p = _mm_loadu_ps(vertices[i].position.elements);
+        min = _mm_min_ps(min, p);
+        max = _mm_max_ps(max, p);
+    }
+    f32 min_out[4];
+    f32 max_out[4];
+    _mm_storeu_ps(min_out, min);
+    _mm_storeu_ps(max_out, max);
+    *out_min_extents = vec3_create(min_out[0], min_out[1], min_out[2]);
+    *out_max_extents = vec3_create(max_out[0], max_out[1], max_out[2]);
+}
+
+static const kernel_table sse2_table = {
+    rgba8_has_transparency_sse2,
+    vertex_3d_extents_sse2};
+
+// ---------------------------------------------------------------------------
+// AVX2
+// ---------------------------------------------------------------------------
+
+KERNEL_TARGET_AVX2 static b8 rgba8_has_transparency_avx2(const u8* pixels, u64 pixel_count) {
+    const __m256i colour_mask = _mm256_set1_epi32(0x00FFFFFF);
+    const __m256i opaque = _mm256_set1_epi32(-1);
+    u64 i = 0;
+    // 32 pixels per iteration.
+    for (; i + 32 <= pixel_count; i += 32) {
+        const u8* p = pixels + i * 4;
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)p), _mm256_loadu_si256((const __m256i*)(p + 32)));
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(p + 64)), _mm256_loadu_si256((const __m256i*)(p + 96)));
+        __m256i v = _mm256_or_si256(_mm256_and_si256(a, b), colour_mask);
+        if ((u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, opaque)) != 0xFFFFFFFF) {
+            return true;
+        }
+    }
+    return rgba8_has_transparency_sse2(pixels + i * 4, pixel_count - i);
+}
+
+KERNEL_TARGET_AVX2 static void vertex_3d_extents_avx2(u32 vertex_count, const vertex_3d* vertices, vec3* out_min_extents, vec3* out_max_extents) {
+    if (vertex_count < 4) {
+        vertex_3d_extents_sse2(vertex_count, vertices, out_min_extents, out_max_extents);
+        return;
+    }
+    // Two vertices per register, with two independent accumulators to hide latency.
+    __m256 min0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(vertices[0].position.elements)), _mm_loadu_ps(vertices[1].position.elements), 1);
+    __m256 min1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(vertices[2].position.elements)), _mm_loadu_ps(vertices[3].position.elements), 1);
+    __m256 max0 = min0;
+    __m256 max1 = min1;
+    u32 i = 4;
+    for (; i + 4 <= vertex_count; i += 4) {
+        __m256 p0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(vertices[i + 0].position.elements)), _mm_loadu_ps(vertices[i + 1].position.elements), 1);
+        __m256 p1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(vertices[i + 2].position.elements)), _mm_loadu_ps(vertices[i + 3].position.elements), 1);
+        min0 = _mm256_min_ps(min0, p0);
+        max0 = _mm256_max_ps(max0, p0);
+        min1 = _mm256_min_ps(min1, p1);
+        max1 = _mm256_max_ps(max1, p1);
+    }
+    min0 = _mm256_min_ps(min0, min1);
+    max0 = _mm256_max_ps(max0, max1);
+    __m128 min = _mm_min_ps(_mm256_castps256_ps128(min0), _mm256_extractf128_ps(min0, 1));
+    __m128 max = _mm_max_ps(_mm256_castps256_ps128(max0), _mm256_extractf128_ps(max0, 1));
+    for (; i < vertex_count; ++i) {
+        __m128 p = _mm_loadu_ps(vertices[i].position.elements);
+        min = _mm_min_ps(min, p);
+        max = _mm_max_ps(max, p);
+    }
+    f32 min_out[4];
+    f32 max_out[4];
+    _mm_storeu_ps(min_out, min);
+    _mm_storeu_ps(max_out, max);
+    *out_min_extents = vec3_create(min_out[0], min_out[1], min_out[2]);
+    *out_max_extents = vec3_create(max_out[0], max_out[1], max_out[2]);
+}
+
+static const kernel_table avx2_table = {
+    rgba8_has_transparency_avx2,
+    vertex_3d_extents_avx2};
+
+static const kernel_table* kernel_tables[KERNEL_SET_MAX] = {&scalar_table, &sse2_table, &avx2_table};
+static kernel_set active_set = KERNEL_SET_SSE2;
+static const kernel_table* active_table = &sse2_table;
+#else
+static const kernel_table* kernel_tables[KERNEL_SET_MAX] = {&scalar_table, 0, 0};
+static kernel_set active_set = KERNEL_SET_SCALAR;
+static const kernel_table* active_table = &scalar_table;
+#endif
+
+static b8 kernel_set_supported(kernel_set set, cpu_feature_flags features) {
+    switch (set) {
+        case KERNEL_SET_SCALAR:
+            return true;
+        case KERNEL_SET_SSE2:
+            return kernel_tables[set] != 0 && (features & CPU_FEATURE_SSE2);
+        case KERNEL_SET_AVX2:
+            return kernel_tables[set] != 0 && (features & CPU_FEATURE_AVX2);
+        default:
+            return false;
+    }
+}
+
+void kernels_initialize() {
+    cpu_feature_flags features = platform_get_cpu_features();
+
+    char feature_string[256] = "";
+    u64 length = 0;
+    for (u32 i = 0; i < CPU_FEATURE_COUNT; ++i) {
+        if (features & (1u << i)) {
+            length += string_format(feature_string + length, " %s", platform_cpu_feature_name((cpu_feature_flag_bits)(1u << i)));
+        }
+    }
+    KINFO("CPU features:%s", length ? feature_string : " none detected");
+
+    // Pick the best supported set.
+    for (i32 set = KERNEL_SET_MAX - 1; set >= 0; --set) {
+        if (kernels_select((kernel_set)set)) {
+            break;
+        }
+    }
+    KINFO("Active kernel set: %s", kernels_set_name(active_set));
+}
+
+b8 kernels_select(kernel_set set) {
+    if (set >= KERNEL_SET_MAX || !kernel_set_supported(set, platform_get_cpu_features())) {
+        return false;
+    }
+    active_set = set;
+    active_table = kernel_tables[set];
+    return true;
+}
+
+kernel_set kernels_active_set() {
+    return active_set;
+}
+
+const char* kernels_set_name(kernel_set set) {
+    if (set >= KERNEL_SET_MAX) {
+        return "unknown";
+    }
+    return kernel_set_names[set];
+}
+
+b8 kernel_rgba8_has_transparency(const u8* pixels, u64 pixel_count) {
+    return active_table->rgba8_has_transparency(pixels, pixel_count);
+}
+
+void kernel_vertex_3d_extents(u32 vertex_count, const vertex_3d* vertices, vec3* out_min_extents, vec3* out_max_extents) {
+    active_table->vertex_3d_extents(vertex_count, vertices, out_min_extents, out_max_extents);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file kernels.h
+ * @author Travis Vroman (travis@kohiengine.com)
+ * @brief This file contains hot-loop kernels which have multiple implementations
+ * targeting different instruction set extensions. The engine is compiled for the
+ * baseline instruction set only; the best implementation supported by the host
+ * CPU is selected once at startup via kernels_initialize() and all calls are
+ * routed through a dispatch table. Until then, the baseline implementation is used.
+ * @version 1.0
+ * @date 2022-06-07
+ *
+ * @copyright Kohi Game Engine is Copyright (c) Travis Vroman 2021-2022
+ *
+ */
+
+#pragma once
+
+#include "math_types.h"
+
+/** @brief The available kernel implementation sets. */
+typedef enum kernel_set {
+    /** @brief Plain C. Used on non-x86 platforms. */
+    KERNEL_SET_SCALAR = 0,
+    /** @brief SSE2. The baseline on x86-64. */
+    KERNEL_SET_SSE2 = 1,
+    /** @brief AVX2. */
+    KERNEL_SET_AVX2 = 2,
+    KERNEL_SET_MAX
+} kernel_set;
+
+/**
+ * @brief Detects the features of the host CPU, selects the best supported kernel
+ * set and logs both. Should be called once at startup, before kernels are used
+ * from multiple threads.
+ */
+KAPI void kernels_initialize();
+
+/**
+ * @brief Selects the given kernel set, if supported by the host CPU. Mainly used
+ * for testing and benchmarking the individual implementations.
+ *
+ * @param set The kernel set to select.
+ * @return True if the set is supported and was selected; otherwise false.
+ */
+KAPI b8 kernels_select(kernel_set set);
+
+/**
+ * @brief Gets the currently active kernel set.
+ *
+ * @return The active kernel set.
+ */
+KAPI kernel_set kernels_active_set();
+
+/**
+ * @brief Gets the name of the given kernel set.
+ *
+ * @param set The kernel set.
+ * @return The name of the kernel set.
+ */
+KAPI const char* kernels_set_name(kernel_set set);
+
+/**
+ * @brief Indicates if any pixel in the given tightly-packed RGBA8 image has an
+ * alpha value other than 255.
+ *
+ * @param pixels The pixel data, 4 bytes per pixel.
+ * @param pixel_count The number of pixels.
+ * @return True if any pixel is not fully opaque; otherwise false.
+ */
+KAPI b8 kernel_rgba8_has_transparency(const u8* pixels, u64 pixel_count);
+
+/**
+ * @brief Calculates the minimum and maximum extents of the positions of the given vertices.
+ * If vertex_count is 0, both extents are set to zero.
+ *
+ * @param vertex_count The number of vertices.
+ * @param vertices An array of vertices.
+ * @param out_min_extents A pointer to hold the minimum extents.
+ * @param out_max_extents A pointer to hold the maximum extents.
+ */
+KAPI void kernel_vertex_3d_extents(u32 vertex_count, const vertex_3d* vertices, vec3* out_min_extents, vec3* out_max_extents);
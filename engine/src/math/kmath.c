@@ -26,6 +26,10 @@ f32 kacos(f32 x) {
     return acosf(x);
 }
 
+f32 katan2(f32 y, f32 x) {
+    return atan2f(y, x);
+}
+
 f32 ksqrt(f32 x) {
     return sqrtf(x);
 }
@@ -100,6 +100,15 @@ KAPI f32 ktan(f32 x);
  */
 KAPI f32 kacos(f32 x);
 
+/**
+ * @brief Calculates the arc tangent of y/x, using the signs of both to find the quadrant.
+ * 
+ * @param y The y coordinate.
+ * @param x The x coordinate.
+ * @return The angle in radians, in the range [-pi, pi].
+ */
+KAPI f32 katan2(f32 y, f32 x);
+
 /**
  * @brief Calculates the square root of x.
  * 
@@ -1527,6 +1536,60 @@ KINLINE quat quat_slerp(quat q_0, quat q_1, f32 percentage) {
         (v0.w * s0) + (v1.w * s1)};
 }
 
+/**
+ * @brief Extracts the view frustum of the given matrix, normally a view matrix multiplied by
+ * a projection. The frustum is in the space the matrix transforms from, so passing
+ * model * view * projection gives a frustum in model space. The near plane is placed at a
+ * depth of -1, so it is conservative for projections which map depth to [0, 1].
+ *
+ * @param matrix The matrix to extract the frustum from.
+ * @return The frustum, with normalized planes.
+ */
+KINLINE frustum frustum_from_matrix(mat4 matrix) {
+    const f32* m = matrix.data;
+    // The columns of the matrix, as points are row vectors.
+    vec4 x = vec4_create(m[0], m[4], m[8], m[12]);
+    vec4 y = vec4_create(m[1], m[5], m[9], m[13]);
+    vec4 z = vec4_create(m[2], m[6], m[10], m[14]);
+    vec4 w = vec4_create(m[3], m[7], m[11], m[15]);
+
+    frustum f;
+    f.planes[0] = vec4_add(w, x);
+    f.planes[1] = vec4_sub(w, x);
+    f.planes[2] = vec4_add(w, y);
+    f.planes[3] = vec4_sub(w, y);
+    f.planes[4] = vec4_add(w, z);
+    f.planes[5] = vec4_sub(w, z);
+    for (u32 i = 0; i < 6; ++i) {
+        vec4* p = &f.planes[i];
+        f32 length = ksqrt(p->x * p->x + p->y * p->y + p->z * p->z);
+        if (length > 0.0f) {
+            f32 inverse_length = 1.0f / length;
+            *p = vec4_create(p->x * inverse_length, p->y * inverse_length, p->z * inverse_length, p->w * inverse_length);
+        }
+    }
+    return f;
+}
+
+/**
+ * @brief Indicates if a sphere is at least partly inside the given frustum. May report spheres
+ * just outside a corner of the frustum as inside.
+ *
+ * @param f A pointer to the frustum.
+ * @param center The center of the sphere.
+ * @param radius The radius of the sphere.
+ * @return True if the sphere may be inside the frustum; otherwise false.
+ */
+KINLINE b8 frustum_intersects_sphere(const frustum* f, vec3 center, f32 radius) {
+    for (u32 i = 0; i < 6; ++i) {
+        const vec4* p = &f->planes[i];
+        if (p->x * center.x + p->y * center.y + p->z * center.z + p->w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * @brief Converts provided degrees to radians.
  * 
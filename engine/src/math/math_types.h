@@ -152,6 +152,25 @@ typedef struct vertex_3d {
     vec4 tangent;
 } vertex_3d;
 
+/**
+ * @brief A compact form of vertex_3d, which is what 3D geometry is uploaded to the GPU as.
+ * See geometry_pack_vertices() for the encoding.
+ */
+typedef struct vertex_3d_packed {
+    /** @brief The position of the vertex. */
+    vec3 position;
+    /**
+     * @brief The tangent frame, as signed normalized 16-bit values: the octahedral-encoded
+     * normal (x, y), the angle of the tangent around the normal (z) and the handedness of
+     * the bitangent (w).
+     */
+    i16 normal_tangent[4];
+    /** @brief The texture coordinate of the vertex, as half floats. */
+    u16 texcoord[2];
+    /** @brief The colour of the vertex, as unsigned normalized 8-bit values. */
+    u8 colour[4];
+} vertex_3d_packed;
+
 /**
  * @brief Represents a single vertex in 2D space.
  */
@@ -162,6 +181,39 @@ typedef struct vertex_2d {
     vec2 texcoord;
 } vertex_2d;
 
+/**
+ * @brief A cluster of a geometry's triangles, stored as a range of its indices, with bounds
+ * for culling the cluster as a whole.
+ */
+typedef struct geometry_meshlet {
+    /** @brief The first index of the meshlet. */
+    u32 index_offset;
+    /** @brief The number of indices in the meshlet. */
+    u32 index_count;
+    /** @brief The center of a sphere enclosing the meshlet. */
+    vec3 center;
+    /** @brief The radius of a sphere enclosing the meshlet. */
+    f32 radius;
+    /** @brief The apex of a cone enclosing the normals of the meshlet's triangles. */
+    vec3 cone_apex;
+    /** @brief The axis of the normal cone. */
+    vec3 cone_axis;
+    /**
+     * @brief The sine of the normal cone's half angle. The meshlet faces away from a viewer at p
+     * if dot(normalize(cone_apex - p), cone_axis) >= cone_cutoff. 1 if it never does.
+     */
+    f32 cone_cutoff;
+} geometry_meshlet;
+
+/**
+ * @brief A view frustum, as six planes whose normals point inward: left, right, bottom, top,
+ * near and far. Each plane is a normal (x, y, z) and distance (w), so a point p is inside a
+ * plane if dot(normal, p) + w >= 0.
+ */
+typedef struct frustum {
+    vec4 planes[6];
+} frustum;
+
 /**
  * @brief Represents the transform of an object in the world.
  * Transforms can have a parent whose own transform is then
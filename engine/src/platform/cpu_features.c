@@ -0,0 +1,148 @@
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KCPU_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+static const char* feature_names[CPU_FEATURE_COUNT] = {
+    "sse2", "sse3", "ssse3", "sse4.1", "sse4.2", "popcnt", "avx", "f16c",
+    "fma", "avx2", "bmi1", "bmi2", "avx512f", "avx512dq", "avx512bw", "avx512vl"};
+
+// Detection is idempotent, so a race between threads on first use is harmless.
+static b8 features_detected = false;
+static cpu_feature_flags detected_features = 0;
+
+#ifdef KCPU_X86
+static void cpuid(u32 leaf, u32 subleaf, u32 out_registers[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuidex((int*)out_registers, (int)leaf, (int)subleaf);
+#else
+    __cpuid_count(leaf, subleaf, out_registers[0], out_registers[1], out_registers[2], out_registers[3]);
+#endif
+}
+
+static u64 xgetbv(u32 index) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(index);
+#else
+    u32 eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return ((u64)edx << 32) | eax;
+#endif
+}
+
+// Maps a cpuid register bit to a feature flag.
+typedef struct cpuid_feature_bit {
+    // The register index within the cpuid output (0=eax, 1=ebx, 2=ecx, 3=edx).
+    u8 reg;
+    u8 bit;
+    cpu_feature_flag_bits feature;
+} cpuid_feature_bit;
+
+// Leaf 1, no extended register state required.
+static const cpuid_feature_bit leaf1_base_bits[] = {
+    {3, 26, CPU_FEATURE_SSE2},
+    {2, 0, CPU_FEATURE_SSE3},
+    {2, 9, CPU_FEATURE_SSSE3},
+    {2, 19, CPU_FEATURE_SSE41},
+    {2, 20, CPU_FEATURE_SSE42},
+    {2, 23, CPU_FEATURE_POPCNT}};
+
+// Leaf 1, requires OS support for YMM state.
+static const cpuid_feature_bit leaf1_avx_bits[] = {
+    {2, 28, CPU_FEATURE_AVX},
+    {2, 29, CPU_FEATURE_F16C},
+    {2, 12, CPU_FEATURE_FMA}};
+
+// Leaf 7, no extended register state required.
+static const cpuid_feature_bit leaf7_base_bits[] = {
+    {1, 3, CPU_FEATURE_BMI1},
+    {1, 8, CPU_FEATURE_BMI2}};
+
+// Leaf 7, requires OS support for YMM state.
+static const cpuid_feature_bit leaf7_avx_bits[] = {
+    {1, 5, CPU_FEATURE_AVX2}};
+
+// Leaf 7, requires OS support for opmask and ZMM state.
+static const cpuid_feature_bit leaf7_avx512_bits[] = {
+    {1, 16, CPU_FEATURE_AVX512F},
+    {1, 17, CPU_FEATURE_AVX512DQ},
+    {1, 30, CPU_FEATURE_AVX512BW},
+    {1, 31, CPU_FEATURE_AVX512VL}};
+
+static cpu_feature_flags test_bits(const u32 registers[4], const cpuid_feature_bit* bits, u32 count) {
+    cpu_feature_flags flags = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (registers[bits[i].reg] & (1u << bits[i].bit)) {
+            flags |= bits[i].feature;
+        }
+    }
+    return flags;
+}
+
+static cpu_feature_flags detect_features() {
+    // eax, ebx, ecx, edx
+    u32 r[4] = {0};
+    cpuid(0, 0, r);
+    u32 max_leaf = r[0];
+    if (max_leaf < 1) {
+        return 0;
+    }
+
+    cpuid(1, 0, r);
+    cpu_feature_flags flags = test_bits(r, leaf1_base_bits, sizeof(leaf1_base_bits) / sizeof(cpuid_feature_bit));
+
+    // AVX and later need the OS to save the extended register state (OSXSAVE + XCR0).
+    b8 os_avx = false;
+    b8 os_avx512 = false;
+    if (r[2] & (1u << 27)) {
+        u64 xcr0 = xgetbv(0);
+        // XMM and YMM state.
+        os_avx = (xcr0 & 0x6) == 0x6;
+        // Opmask, upper ZMM and high ZMM state.
+        os_avx512 = os_avx && (xcr0 & 0xE0) == 0xE0;
+    }
+    if (os_avx) {
+        flags |= test_bits(r, leaf1_avx_bits, sizeof(leaf1_avx_bits) / sizeof(cpuid_feature_bit));
+    }
+
+    if (max_leaf >= 7) {
+        cpuid(7, 0, r);
+        flags |= test_bits(r, leaf7_base_bits, sizeof(leaf7_base_bits) / sizeof(cpuid_feature_bit));
+        if (os_avx) {
+            flags |= test_bits(r, leaf7_avx_bits, sizeof(leaf7_avx_bits) / sizeof(cpuid_feature_bit));
+        }
+        if (os_avx512) {
+            flags |= test_bits(r, leaf7_avx512_bits, sizeof(leaf7_avx512_bits) / sizeof(cpuid_feature_bit));
+        }
+    }
+
+    return flags;
+}
+#else
+static cpu_feature_flags detect_features() {
+    return 0;
+}
+#endif
+
+cpu_feature_flags platform_get_cpu_features() {
+    if (!features_detected) {
+        detected_features = detect_features();
+        features_detected = true;
+    }
+    return detected_features;
+}
+
+const char* platform_cpu_feature_name(cpu_feature_flag_bits feature) {
+    for (u32 i = 0; i < CPU_FEATURE_COUNT; ++i) {
+        if ((u32)feature == (1u << i)) {
+            return feature_names[i];
+        }
+    }
+    return "unknown";
+}
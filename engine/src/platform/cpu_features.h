@@ -0,0 +1,61 @@
+/**
+ * @file cpu_features.h
+ * @author Travis Vroman (travis@kohiengine.com)
+ * @brief This file contains runtime detection of the instruction set extensions
+ * supported by the host CPU (and enabled by the OS). This allows optimized code
+ * paths to be selected at startup without raising the baseline the engine is
+ * compiled for.
+ * @version 1.0
+ * @date 2022-06-07
+ *
+ * @copyright Kohi Game Engine is Copyright (c) Travis Vroman 2021-2022
+ *
+ */
+
+#pragma once
+
+#include "defines.h"
+
+/** @brief Instruction set extensions which may be reported by platform_get_cpu_features(). */
+typedef enum cpu_feature_flag_bits {
+    CPU_FEATURE_SSE2 = 0x0001,
+    CPU_FEATURE_SSE3 = 0x0002,
+    CPU_FEATURE_SSSE3 = 0x0004,
+    CPU_FEATURE_SSE41 = 0x0008,
+    CPU_FEATURE_SSE42 = 0x0010,
+    CPU_FEATURE_POPCNT = 0x0020,
+    CPU_FEATURE_AVX = 0x0040,
+    CPU_FEATURE_F16C = 0x0080,
+    CPU_FEATURE_FMA = 0x0100,
+    CPU_FEATURE_AVX2 = 0x0200,
+    CPU_FEATURE_BMI1 = 0x0400,
+    CPU_FEATURE_BMI2 = 0x0800,
+    CPU_FEATURE_AVX512F = 0x1000,
+    CPU_FEATURE_AVX512DQ = 0x2000,
+    CPU_FEATURE_AVX512BW = 0x4000,
+    CPU_FEATURE_AVX512VL = 0x8000,
+    /** @brief The number of feature bits. Not a feature itself. */
+    CPU_FEATURE_COUNT = 16
+} cpu_feature_flag_bits;
+
+/** @brief A combination of cpu_feature_flag_bits. */
+typedef u32 cpu_feature_flags;
+
+/**
+ * @brief Gets the instruction set extensions which are supported by the host CPU
+ * and usable under the current OS. Features requiring extended register state
+ * (AVX and later) are only reported if the OS saves that state on context switches.
+ * Detection is performed once; subsequent calls return the cached result.
+ * On non-x86 platforms, this returns 0.
+ *
+ * @return The supported features as a combination of cpu_feature_flag_bits.
+ */
+KAPI cpu_feature_flags platform_get_cpu_features();
+
+/**
+ * @brief Gets a short, human-readable name for the given feature bit (e.g. "avx2").
+ *
+ * @param feature A single cpu_feature_flag_bits value.
+ * @return The name of the feature, or "unknown" if not a single known feature bit.
+ */
+KAPI const char* platform_cpu_feature_name(cpu_feature_flag_bits feature);
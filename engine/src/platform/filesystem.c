@@ -7,6 +7,14 @@
 #include <string.h>
 #include <sys/stat.h>
 
+#if KPLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 b8 filesystem_exists(const char* path) {
 #ifdef _MSC_VER
     struct _stat buffer;
@@ -90,6 +98,11 @@ b8 filesystem_write_line(file_handle* handle, const char* text) {
     return false;
 }
 
+b8 filesystem_write_text(file_handle* handle, const char* text) {
+    u64 written = 0;
+    return filesystem_write(handle, strlen(text), text, &written);
+}
+
 b8 filesystem_read(file_handle* handle, u64 data_size, void* out_data, u64* out_bytes_read) {
     if (handle->handle && out_data) {
         *out_bytes_read = fread(out_data, 1, data_size, (FILE*)handle->handle);
@@ -140,3 +153,92 @@ b8 filesystem_write(file_handle* handle, u64 data_size, const void* data, u64* o
     }
     return false;
 }
+
+b8 filesystem_map(const char* path, file_map_hints hints, file_mapping* out_mapping) {
+    out_mapping->data = 0;
+    out_mapping->size = 0;
+
+#if KPLATFORM_WINDOWS
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (hints & FILE_MAP_HINT_SEQUENTIAL) {
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    }
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, flags, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        KERROR("Error opening file for mapping: '%s'", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        KERROR("Unable to get size of file for mapping: '%s'", path);
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        // Empty files cannot be mapped, but are still valid.
+        CloseHandle(file);
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    // The view keeps the file and mapping object alive, so the handles are no longer needed.
+    CloseHandle(file);
+    if (!mapping) {
+        KERROR("Error creating file mapping: '%s'", path);
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data) {
+        KERROR("Error mapping view of file: '%s'", path);
+        return false;
+    }
+    out_mapping->data = data;
+    out_mapping->size = (u64)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        KERROR("Error opening file for mapping: '%s'", path);
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        KERROR("Unable to get size of file for mapping: '%s'", path);
+        close(fd);
+        return false;
+    }
+    if (file_stat.st_size == 0) {
+        // Empty files cannot be mapped, but are still valid.
+        close(fd);
+        return true;
+    }
+    void* data = mmap(0, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file.
+    close(fd);
+    if (data == MAP_FAILED) {
+        KERROR("Error mapping file: '%s'", path);
+        return false;
+    }
+    // Hints are advisory only, so failures are ignored.
+    if (hints & FILE_MAP_HINT_SEQUENTIAL) {
+        madvise(data, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+    }
+    if (hints & FILE_MAP_HINT_WILL_NEED) {
+        madvise(data, (size_t)file_stat.st_size, MADV_WILLNEED);
+    }
+    out_mapping->data = data;
+    out_mapping->size = (u64)file_stat.st_size;
+#endif
+    return true;
+}
+
+void filesystem_unmap(file_mapping* mapping) {
+    if (mapping->data) {
+#if KPLATFORM_WINDOWS
+        UnmapViewOfFile(mapping->data);
+#else
+        munmap((void*)mapping->data, (size_t)mapping->size);
+#endif
+        mapping->data = 0;
+        mapping->size = 0;
+    }
+}
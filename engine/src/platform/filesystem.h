@@ -30,6 +30,49 @@ typedef enum file_modes {
     FILE_MODE_WRITE = 0x2
 } file_modes;
 
+/** @brief Access pattern hints for mapped files. Can be combined. */
+typedef enum file_map_hints {
+    /** @brief No hints; the default paging behaviour is used. */
+    FILE_MAP_HINT_NONE = 0x0,
+    /** @brief The contents will be read front to back, so aggressive read-ahead is useful. */
+    FILE_MAP_HINT_SEQUENTIAL = 0x1,
+    /** @brief The contents will be needed soon, so paging in should start immediately. */
+    FILE_MAP_HINT_WILL_NEED = 0x2
+} file_map_hints;
+
+/**
+ * @brief A read-only view of the contents of a file, mapped into the address space.
+ * The view is page-aligned and remains valid until unmapped, even after the file is
+ * modified or deleted.
+ */
+typedef struct file_mapping {
+    /** @brief The contents of the file. 0 if the file is empty. */
+    const void* data;
+    /** @brief The size of the contents in bytes. */
+    u64 size;
+} file_mapping;
+
+/**
+ * @brief A function invoked when an asynchronous read completes. Always invoked on the
+ * thread which calls filesystem_async_pump().
+ * @param path The path of the file which was read.
+ * @param dest The destination buffer which was passed to filesystem_read_async().
+ * @param bytes_read The number of bytes actually read into dest.
+ * @param success True if all of the requested bytes were read; otherwise false.
+ * @param user_data The user data which was passed to filesystem_read_async().
+ */
+typedef void (*pfn_filesystem_read_callback)(const char* path, void* dest, u64 bytes_read, b8 success, void* user_data);
+
+/** @brief The configuration for asynchronous file reads. */
+typedef struct filesystem_async_config {
+    /** @brief The maximum number of reads which can be outstanding at once. */
+    u32 max_requests;
+    /** @brief The number of threads used when io_uring is unavailable. 0 uses a default. */
+    u8 worker_thread_count;
+    /** @brief Forces the worker thread backend, even when io_uring is available. */
+    b8 force_worker_threads;
+} filesystem_async_config;
+
 /**
  * @brief Checks if a file with the given path exists.
  * @param path The path of the file to be checked.
@@ -80,6 +123,14 @@ KAPI b8 filesystem_read_line(file_handle* handle, u64 max_length, char** line_bu
  */
 KAPI b8 filesystem_write_line(file_handle* handle, const char* text);
 
+/**
+ * @brief Writes text to the provided file, without appending anything.
+ * @param handle A pointer to a file_handle structure.
+ * @param text The null-terminated text to be written.
+ * @returns True if successful; otherwise false.
+ */
+KAPI b8 filesystem_write_text(file_handle* handle, const char* text);
+
 /** 
  * @brief Reads up to data_size bytes of data into out_bytes_read. 
  * Allocates *out_data, which must be freed by the caller.
@@ -118,3 +169,74 @@ KAPI b8 filesystem_read_all_text(file_handle* handle, char* out_text, u64* out_b
  * @returns True if successful; otherwise false.
  */
 KAPI b8 filesystem_write(file_handle* handle, u64 data_size, const void* data, u64* out_bytes_written);
+
+/**
+ * @brief Maps the contents of the file at the given path into memory as a read-only view,
+ * which may be parsed in place. Pages are read from disk on first access, without
+ * intermediate copies or per-read system calls.
+ * @param path The path of the file to be mapped.
+ * @param hints Access pattern hints for the mapping. See file_map_hints.
+ * @param out_mapping A pointer to hold the mapping.
+ * @returns True if mapped successfully; otherwise false.
+ */
+KAPI b8 filesystem_map(const char* path, file_map_hints hints, file_mapping* out_mapping);
+
+/**
+ * @brief Unmaps a view created by filesystem_map. The data must not be accessed afterward.
+ * @param mapping A pointer to the mapping to be unmapped.
+ */
+KAPI void filesystem_unmap(file_mapping* mapping);
+
+/**
+ * @brief Initializes asynchronous file reads. On Linux, reads are issued through io_uring
+ * where the kernel supports it; otherwise they are performed by a small pool of worker threads.
+ * Should be called twice; once to get the memory requirement (passing state=0), and a second
+ * time passing an allocated block of memory to actually initialize the system.
+ * @param memory_requirement A pointer to hold the memory requirement as it is calculated.
+ * @param state A block of memory to hold the state or, if gathering the memory requirement, 0.
+ * @param config The configuration for asynchronous reads.
+ * @returns True on success; otherwise false.
+ */
+KAPI b8 filesystem_async_initialize(u64* memory_requirement, void* state, filesystem_async_config config);
+
+/**
+ * @brief Shuts down asynchronous file reads. Reads already issued are allowed to finish, so
+ * their destination buffers are no longer written to afterward, but their callbacks are not invoked.
+ * @param state The state block of memory.
+ */
+KAPI void filesystem_async_shutdown(void* state);
+
+/**
+ * @brief Starts reading size bytes at offset from the file at path into dest, without blocking.
+ * The callback is invoked from filesystem_async_pump() once the read completes. Must be called
+ * from the same thread as filesystem_async_pump(). If asynchronous reads are not initialized,
+ * the read is performed immediately and the callback invoked before returning.
+ * @param path The path of the file to be read. Copied, so need not outlive the call.
+ * @param offset The offset in bytes from the start of the file to read from.
+ * @param size The number of bytes to read.
+ * @param dest The buffer to read into. Must hold size bytes and remain valid until the callback is invoked.
+ * @param callback The function to invoke once the read completes.
+ * @param user_data Data to be passed to the callback.
+ * @returns True if the read was started; false if too many reads are outstanding or the arguments are invalid.
+ */
+KAPI b8 filesystem_read_async(const char* path, u64 offset, u64 size, void* dest, pfn_filesystem_read_callback callback, void* user_data);
+
+/**
+ * @brief Issues further work for outstanding reads and invokes the callbacks of those which
+ * have completed. Never blocks. Should be called once per frame.
+ * @returns The number of reads completed by this call.
+ */
+KAPI u32 filesystem_async_pump();
+
+/**
+ * @brief As filesystem_async_pump(), but blocks until at least one outstanding read completes.
+ * Used by loads which cannot continue until their reads are done.
+ * @returns The number of reads completed by this call. 0 only if none are outstanding.
+ */
+KAPI u32 filesystem_async_wait();
+
+/**
+ * @brief Gets the number of reads which have been started, but whose callbacks have not yet been invoked.
+ * @returns The number of outstanding reads.
+ */
+KAPI u32 filesystem_async_outstanding_count();
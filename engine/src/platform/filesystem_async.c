@@ -0,0 +1,631 @@
+#include "filesystem.h"
+
+#include "platform/platform.h"
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/kstring.h"
+
+#include <stdio.h>
+
+#if KPLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define KASYNC_IO_URING 1
+#endif
+
+// The maximum length of a path for an asynchronous read, including the terminator.
+#define ASYNC_READ_PATH_MAX 512
+// The number of worker threads used when none is configured.
+#define ASYNC_DEFAULT_WORKER_THREADS 2
+// The default and maximum number of outstanding reads.
+#define ASYNC_DEFAULT_MAX_REQUESTS 256
+#define ASYNC_MAX_REQUESTS 4096
+// The largest single read issued to the kernel. Larger reads are split.
+#define ASYNC_READ_CHUNK_MAX 0x40000000
+
+typedef enum async_read_stage {
+    ASYNC_READ_STAGE_FREE = 0,
+    // Waiting for, or being processed by, a worker thread.
+    ASYNC_READ_STAGE_QUEUED,
+    // Worker thread finished; waiting for the callback to be invoked.
+    ASYNC_READ_STAGE_COMPLETE,
+    // io_uring stages.
+    ASYNC_READ_STAGE_OPENING,
+    ASYNC_READ_STAGE_READING,
+    // The callback has been invoked; waiting for the file to be closed.
+    ASYNC_READ_STAGE_CLOSING
+} async_read_stage;
+
+typedef struct async_read_request {
+    char path[ASYNC_READ_PATH_MAX];
+    u64 offset;
+    u64 size;
+    void* dest;
+    pfn_filesystem_read_callback callback;
+    void* user_data;
+    u64 bytes_read;
+    b8 success;
+    async_read_stage stage;
+    i32 fd;
+} async_read_request;
+
+#ifdef KASYNC_IO_URING
+typedef struct io_uring_ring {
+    i32 fd;
+    void* sq_ring;
+    u64 sq_ring_size;
+    void* cq_ring;
+    u64 cq_ring_size;
+    u64 sqes_size;
+
+    // Submission queue. The tail is only written by us, the head only by the kernel.
+    volatile u32* sq_head;
+    volatile u32* sq_tail;
+    u32 sq_mask;
+    u32 sq_entries;
+    u32* sq_array;
+    struct io_uring_sqe* sqes;
+    // The number of entries pushed, but not yet consumed by the kernel.
+    u32 to_submit;
+
+    // Completion queue. The head is only written by us, the tail only by the kernel.
+    volatile u32* cq_head;
+    volatile u32* cq_tail;
+    u32 cq_mask;
+    struct io_uring_cqe* cqes;
+} io_uring_ring;
+#endif
+
+typedef struct filesystem_async_state {
+    u32 max_requests;
+    async_read_request* requests;
+    // Indices of free requests. Only used by the pumping thread.
+    u32* free_indices;
+    u32 free_count;
+    // Requests whose callbacks have not yet been invoked.
+    u32 outstanding_count;
+    // False while shutting down, at which point callbacks are no longer invoked.
+    volatile u32 is_running;
+
+    b8 use_io_uring;
+#ifdef KASYNC_IO_URING
+    io_uring_ring ring;
+#endif
+
+    // Worker thread backend.
+    kthread* workers;
+    u32 worker_count;
+    kmutex queue_mutex;
+    // Signaled once per queued request, and once per worker at shutdown.
+    ksemaphore work_available;
+    // Signaled whenever a worker completes a request.
+    kcondition work_completed;
+    // Ring of request indices waiting for a worker. Guarded by queue_mutex.
+    u32* work_queue;
+    u32 work_head;
+    u32 work_count;
+    // Request indices completed by workers. Guarded by queue_mutex.
+    u32* completed;
+    u32 completed_count;
+    // Scratch space for the pump to take completed indices out from under the lock.
+    u32* pump_indices;
+} filesystem_async_state;
+
+static filesystem_async_state* state_ptr;
+
+/**
+ * @brief Reads synchronously through stdio. Used by worker threads, and when asynchronous
+ * reads are not initialized.
+ */
+static b8 read_file_range(const char* path, u64 offset, u64 size, void* dest, u64* out_bytes_read) {
+    *out_bytes_read = 0;
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+#if KPLATFORM_WINDOWS
+    i32 seek_result = _fseeki64(file, (i64)offset, SEEK_SET);
+#else
+    i32 seek_result = fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+    if (seek_result == 0) {
+        *out_bytes_read = fread(dest, 1, size, file);
+    }
+    fclose(file);
+    return *out_bytes_read == size;
+}
+
+static void release_request(u32 index) {
+    state_ptr->requests[index].stage = ASYNC_READ_STAGE_FREE;
+    state_ptr->free_indices[state_ptr->free_count++] = index;
+}
+
+static void invoke_callback(async_read_request* r) {
+    state_ptr->outstanding_count--;
+    if (platform_atomic_load_u32(&state_ptr->is_running)) {
+        r->callback(r->path, r->dest, r->bytes_read, r->success, r->user_data);
+    }
+}
+
+static u32 async_worker_thread(void* params) {
+    filesystem_async_state* state = params;
+    while (true) {
+        platform_semaphore_wait(&state->work_available);
+        if (!platform_atomic_load_u32(&state->is_running)) {
+            break;
+        }
+
+        platform_mutex_lock(&state->queue_mutex);
+        u32 index = state->work_queue[state->work_head];
+        state->work_head = (state->work_head + 1) % state->max_requests;
+        state->work_count--;
+        platform_mutex_unlock(&state->queue_mutex);
+
+        async_read_request* r = &state->requests[index];
+        r->success = read_file_range(r->path, r->offset, r->size, r->dest, &r->bytes_read);
+
+        platform_mutex_lock(&state->queue_mutex);
+        r->stage = ASYNC_READ_STAGE_COMPLETE;
+        state->completed[state->completed_count++] = index;
+        platform_condition_signal(&state->work_completed);
+        platform_mutex_unlock(&state->queue_mutex);
+    }
+    return 0;
+}
+
+static u32 worker_pump() {
+    platform_mutex_lock(&state_ptr->queue_mutex);
+    u32 count = state_ptr->completed_count;
+    kcopy_memory(state_ptr->pump_indices, state_ptr->completed, sizeof(u32) * count);
+    state_ptr->completed_count = 0;
+    platform_mutex_unlock(&state_ptr->queue_mutex);
+
+    for (u32 i = 0; i < count; ++i) {
+        u32 index = state_ptr->pump_indices[i];
+        invoke_callback(&state_ptr->requests[index]);
+        release_request(index);
+    }
+    return count;
+}
+
+#ifdef KASYNC_IO_URING
+static b8 ring_supports_required_ops(i32 fd) {
+    // An io_uring_probe is followed by one io_uring_probe_op per opcode.
+    u64 buffer[(sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op)) / sizeof(u64)];
+    kzero_memory(buffer, sizeof(buffer));
+    struct io_uring_probe* probe = (struct io_uring_probe*)buffer;
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        return false;
+    }
+    const u8 required_ops[] = {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE};
+    for (u32 i = 0; i < sizeof(required_ops); ++i) {
+        u8 op = required_ops[i];
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void ring_destroy(io_uring_ring* ring) {
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    close(ring->fd);
+    kzero_memory(ring, sizeof(io_uring_ring));
+}
+
+static b8 ring_create(io_uring_ring* ring, u32 entries) {
+    kzero_memory(ring, sizeof(io_uring_ring));
+    struct io_uring_params params;
+    kzero_memory(&params, sizeof(params));
+    ring->fd = (i32)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        // Not supported by the kernel, or blocked (i.e. by a container's seccomp policy).
+        return false;
+    }
+    if (!ring_supports_required_ops(ring->fd)) {
+        close(ring->fd);
+        return false;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    b8 single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        ring->sq_ring_size = KMAX(ring->sq_ring_size, ring->cq_ring_size);
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(0, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = 0;
+        ring_destroy(ring);
+        return false;
+    }
+    if (single_mmap) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(0, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            ring->cq_ring = 0;
+            ring_destroy(ring);
+            return false;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(0, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = 0;
+        ring_destroy(ring);
+        return false;
+    }
+
+    u8* sq = ring->sq_ring;
+    ring->sq_head = (volatile u32*)(sq + params.sq_off.head);
+    ring->sq_tail = (volatile u32*)(sq + params.sq_off.tail);
+    ring->sq_mask = *(u32*)(sq + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_array = (u32*)(sq + params.sq_off.array);
+
+    u8* cq = ring->cq_ring;
+    ring->cq_head = (volatile u32*)(cq + params.cq_off.head);
+    ring->cq_tail = (volatile u32*)(cq + params.cq_off.tail);
+    ring->cq_mask = *(u32*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
+}
+
+static b8 ring_push(io_uring_ring* ring, const struct io_uring_sqe* sqe) {
+    u32 head = platform_atomic_load_u32(ring->sq_head);
+    u32 tail = *ring->sq_tail;
+    if (tail - head >= ring->sq_entries) {
+        return false;
+    }
+    u32 index = tail & ring->sq_mask;
+    ring->sqes[index] = *sqe;
+    ring->sq_array[index] = index;
+    // Publish the entry only once it is fully written.
+    platform_atomic_store_u32(ring->sq_tail, tail + 1);
+    ring->to_submit++;
+    return true;
+}
+
+static void ring_submit(io_uring_ring* ring, u32 wait_count) {
+    if (ring->to_submit == 0 && wait_count == 0) {
+        return;
+    }
+    u32 flags = wait_count ? IORING_ENTER_GETEVENTS : 0;
+    i32 result = (i32)syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait_count, flags, 0, 0);
+    if (result >= 0) {
+        ring->to_submit -= KMIN((u32)result, ring->to_submit);
+    } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        KERROR("io_uring_enter failed with error %i.", errno);
+    }
+    // Otherwise, it's retried on the next call.
+}
+
+static b8 queue_open(u32 index) {
+    async_read_request* r = &state_ptr->requests[index];
+    struct io_uring_sqe sqe;
+    kzero_memory(&sqe, sizeof(sqe));
+    sqe.opcode = IORING_OP_OPENAT;
+    sqe.fd = AT_FDCWD;
+    sqe.addr = (u64)r->path;
+    sqe.open_flags = O_RDONLY | O_CLOEXEC;
+    sqe.user_data = index;
+    r->stage = ASYNC_READ_STAGE_OPENING;
+    return ring_push(&state_ptr->ring, &sqe);
+}
+
+static b8 queue_read(u32 index) {
+    async_read_request* r = &state_ptr->requests[index];
+    struct io_uring_sqe sqe;
+    kzero_memory(&sqe, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = r->fd;
+    sqe.addr = (u64)((u8*)r->dest + r->bytes_read);
+    sqe.len = (u32)KMIN(r->size - r->bytes_read, (u64)ASYNC_READ_CHUNK_MAX);
+    sqe.off = r->offset + r->bytes_read;
+    sqe.user_data = index;
+    r->stage = ASYNC_READ_STAGE_READING;
+    return ring_push(&state_ptr->ring, &sqe);
+}
+
+static b8 queue_close(u32 index) {
+    async_read_request* r = &state_ptr->requests[index];
+    struct io_uring_sqe sqe;
+    kzero_memory(&sqe, sizeof(sqe));
+    sqe.opcode = IORING_OP_CLOSE;
+    sqe.fd = r->fd;
+    sqe.user_data = index;
+    r->stage = ASYNC_READ_STAGE_CLOSING;
+    return ring_push(&state_ptr->ring, &sqe);
+}
+
+/**
+ * @brief Finishes a read once no more data will be read, and starts closing the file.
+ * @return 1, for the read which was completed.
+ */
+static u32 finish_ring_read(u32 index) {
+    async_read_request* r = &state_ptr->requests[index];
+    r->success = r->bytes_read == r->size;
+    invoke_callback(r);
+    if (!queue_close(index)) {
+        // Can't happen, as each request only has one operation at a time, and the queue holds one per request.
+        close(r->fd);
+        release_request(index);
+    }
+    return 1;
+}
+
+static u32 process_ring_completion(u32 index, i32 result) {
+    async_read_request* r = &state_ptr->requests[index];
+    switch (r->stage) {
+        case ASYNC_READ_STAGE_OPENING:
+            if (result < 0) {
+                r->success = false;
+                invoke_callback(r);
+                release_request(index);
+                return 1;
+            }
+            r->fd = result;
+            if (r->size == 0 || !queue_read(index)) {
+                return finish_ring_read(index);
+            }
+            return 0;
+        case ASYNC_READ_STAGE_READING:
+            if (result == -EINTR || result == -EAGAIN) {
+                return queue_read(index) ? 0 : finish_ring_read(index);
+            }
+            if (result > 0) {
+                r->bytes_read += (u64)result;
+                if (r->bytes_read < r->size) {
+                    // Short read; continue from where it left off.
+                    return queue_read(index) ? 0 : finish_ring_read(index);
+                }
+            }
+            // An error, end of file, or everything was read.
+            return finish_ring_read(index);
+        case ASYNC_READ_STAGE_CLOSING:
+            release_request(index);
+            return 0;
+        default:
+            KWARN("Unexpected io_uring completion for request %u.", index);
+            return 0;
+    }
+}
+
+static u32 ring_pump(u32 wait_count) {
+    io_uring_ring* ring = &state_ptr->ring;
+    ring_submit(ring, wait_count);
+
+    u32 completed = 0;
+    u32 head = *ring->cq_head;
+    u32 tail = platform_atomic_load_u32(ring->cq_tail);
+    while (head != tail) {
+        struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+        u32 index = (u32)cqe->user_data;
+        i32 result = cqe->res;
+        head++;
+        completed += process_ring_completion(index, result);
+    }
+    // Hand the entries back to the kernel.
+    platform_atomic_store_u32(ring->cq_head, head);
+
+    // Submit any follow-up operations straight away.
+    ring_submit(ring, 0);
+    return completed;
+}
+#endif
+
+b8 filesystem_async_initialize(u64* memory_requirement, void* state, filesystem_async_config config) {
+    u32 max_requests = config.max_requests ? config.max_requests : ASYNC_DEFAULT_MAX_REQUESTS;
+    max_requests = KMIN(max_requests, ASYNC_MAX_REQUESTS);
+    u32 worker_count = config.worker_thread_count ? config.worker_thread_count : ASYNC_DEFAULT_WORKER_THREADS;
+
+    // The requests, index arrays and worker threads are in the same block of memory, after the state.
+    u64 requests_size = sizeof(async_read_request) * max_requests;
+    u64 indices_size = sizeof(u32) * max_requests;
+    *memory_requirement = sizeof(filesystem_async_state) + requests_size + indices_size * 4 + sizeof(kthread) * worker_count;
+    if (state == 0) {
+        return true;
+    }
+
+    kzero_memory(state, *memory_requirement);
+    filesystem_async_state* s = state;
+    u8* block = (u8*)state + sizeof(filesystem_async_state);
+    s->max_requests = max_requests;
+    s->requests = (async_read_request*)block;
+    block += requests_size;
+    s->free_indices = (u32*)block;
+    block += indices_size;
+    s->work_queue = (u32*)block;
+    block += indices_size;
+    s->completed = (u32*)block;
+    block += indices_size;
+    s->pump_indices = (u32*)block;
+    block += indices_size;
+    s->workers = (kthread*)block;
+
+    // Hand out lower indices first.
+    for (u32 i = 0; i < max_requests; ++i) {
+        s->free_indices[i] = max_requests - 1 - i;
+    }
+    s->free_count = max_requests;
+    s->is_running = true;
+
+#ifdef KASYNC_IO_URING
+    if (!config.force_worker_threads) {
+        s->use_io_uring = ring_create(&s->ring, max_requests);
+    }
+#endif
+
+    if (s->use_io_uring) {
+        KINFO("Asynchronous file reads using io_uring, with up to %u outstanding.", max_requests);
+    } else {
+        if (!platform_mutex_create(&s->queue_mutex) || !platform_semaphore_create(0, &s->work_available) || !platform_condition_create(&s->work_completed)) {
+            KERROR("Failed to create asynchronous file read synchronization objects.");
+            return false;
+        }
+        for (u32 i = 0; i < worker_count; ++i) {
+            if (!platform_thread_create(async_worker_thread, s, &s->workers[i])) {
+                KERROR("Failed to create asynchronous file read worker thread %u.", i);
+                break;
+            }
+            s->worker_count++;
+        }
+        if (s->worker_count == 0) {
+            platform_condition_destroy(&s->work_completed);
+            platform_semaphore_destroy(&s->work_available);
+            platform_mutex_destroy(&s->queue_mutex);
+            return false;
+        }
+        KINFO("Asynchronous file reads using %u worker threads, with up to %u outstanding.", s->worker_count, max_requests);
+    }
+
+    state_ptr = s;
+    return true;
+}
+
+void filesystem_async_shutdown(void* state) {
+    if (!state_ptr) {
+        return;
+    }
+
+    // Stop invoking callbacks; the reads themselves must still finish, as they write to caller memory.
+    platform_atomic_store_u32(&state_ptr->is_running, false);
+
+#ifdef KASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        while (state_ptr->free_count < state_ptr->max_requests) {
+            ring_pump(1);
+        }
+        ring_destroy(&state_ptr->ring);
+    }
+#endif
+
+    if (!state_ptr->use_io_uring) {
+        // Workers finish the read in progress, then exit. Reads not yet started are dropped.
+        for (u32 i = 0; i < state_ptr->worker_count; ++i) {
+            platform_semaphore_signal(&state_ptr->work_available);
+        }
+        for (u32 i = 0; i < state_ptr->worker_count; ++i) {
+            platform_thread_join(&state_ptr->workers[i]);
+        }
+        platform_condition_destroy(&state_ptr->work_completed);
+        platform_semaphore_destroy(&state_ptr->work_available);
+        platform_mutex_destroy(&state_ptr->queue_mutex);
+    }
+
+    state_ptr = 0;
+}
+
+b8 filesystem_read_async(const char* path, u64 offset, u64 size, void* dest, pfn_filesystem_read_callback callback, void* user_data) {
+    if (!path || !callback || (size && !dest)) {
+        KERROR("filesystem_read_async requires a path, a callback and, for a non-zero size, a destination.");
+        return false;
+    }
+    u64 path_length = string_length(path);
+    if (path_length >= ASYNC_READ_PATH_MAX) {
+        KERROR("filesystem_read_async - path is too long: '%s'.", path);
+        return false;
+    }
+
+    if (!state_ptr) {
+        u64 bytes_read = 0;
+        b8 success = read_file_range(path, offset, size, dest, &bytes_read);
+        callback(path, dest, bytes_read, success, user_data);
+        return true;
+    }
+
+    if (state_ptr->free_count == 0) {
+        KWARN("filesystem_read_async - too many reads outstanding (%u). Read of '%s' not started.", state_ptr->max_requests, path);
+        return false;
+    }
+
+    u32 index = state_ptr->free_indices[--state_ptr->free_count];
+    async_read_request* r = &state_ptr->requests[index];
+    kcopy_memory(r->path, path, path_length + 1);
+    r->offset = offset;
+    r->size = size;
+    r->dest = dest;
+    r->callback = callback;
+    r->user_data = user_data;
+    r->bytes_read = 0;
+    r->success = false;
+    r->fd = -1;
+    state_ptr->outstanding_count++;
+
+#ifdef KASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        if (!queue_open(index)) {
+            // Can't happen, as the queue holds one operation per request.
+            KERROR("filesystem_read_async - io_uring submission queue is full.");
+            state_ptr->outstanding_count--;
+            release_request(index);
+            return false;
+        }
+        // Start the open straight away, rather than waiting for the next pump.
+        ring_submit(&state_ptr->ring, 0);
+        return true;
+    }
+#endif
+
+    r->stage = ASYNC_READ_STAGE_QUEUED;
+    platform_mutex_lock(&state_ptr->queue_mutex);
+    u32 tail = (state_ptr->work_head + state_ptr->work_count) % state_ptr->max_requests;
+    state_ptr->work_queue[tail] = index;
+    state_ptr->work_count++;
+    platform_mutex_unlock(&state_ptr->queue_mutex);
+    platform_semaphore_signal(&state_ptr->work_available);
+    return true;
+}
+
+u32 filesystem_async_pump() {
+    if (!state_ptr) {
+        return 0;
+    }
+#ifdef KASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        return ring_pump(0);
+    }
+#endif
+    return worker_pump();
+}
+
+u32 filesystem_async_wait() {
+    if (!state_ptr || state_ptr->outstanding_count == 0) {
+        return 0;
+    }
+#ifdef KASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        // Some completions only move a read on to its next operation, so keep waiting until one finishes.
+        u32 completed = 0;
+        while (completed == 0) {
+            completed = ring_pump(1);
+        }
+        return completed;
+    }
+#endif
+    platform_mutex_lock(&state_ptr->queue_mutex);
+    while (state_ptr->completed_count == 0) {
+        platform_condition_wait(&state_ptr->work_completed, &state_ptr->queue_mutex);
+    }
+    platform_mutex_unlock(&state_ptr->queue_mutex);
+    return worker_pump();
+}
+
+u32 filesystem_async_outstanding_count() {
+    return state_ptr ? state_ptr->outstanding_count : 0;
+}
@@ -27,6 +27,11 @@
  * @param y The initial y position of the main window.
  * @param width The initial width of the main window.
  * @param height The initial height of the main window.
+ * @param headless Indicates if the platform should run without a window. No connection to a
+ * display is made, a single synthetic resize to the given width and height is fired on the first
+ * message pump, and no input is received from the OS; input can then only come from an input
+ * journal replay or be injected by the application. Timing, memory, threading and filesystem
+ * functions are unaffected.
  * @return True on success; otherwise false.
  */
 b8 platform_system_startup(
@@ -36,7 +41,8 @@ b8 platform_system_startup(
     i32 x,
     i32 y,
     i32 width,
-    i32 height);
+    i32 height,
+    b8 headless);
 
 /**
  * @brief Shuts down the platform layer.
@@ -53,6 +59,22 @@ void platform_system_shutdown(void* plat_state);
  */
 b8 platform_pump_messages();
 
+/**
+ * @brief Blocks until platform messages are available to be pumped, or the
+ * timeout elapses, whichever comes first. Used to idle without spinning.
+ *
+ * @param timeout_seconds The maximum time to wait, in seconds.
+ * @return True if messages may be available; otherwise false if the timeout elapsed.
+ */
+b8 platform_wait_messages(f64 timeout_seconds);
+
+/**
+ * @brief Indicates if the platform layer is running without a window.
+ *
+ * @return True if headless; otherwise false.
+ */
+b8 platform_is_headless();
+
 /**
  * @brief Performs platform-specific memory allocation of the given size.
  * 
@@ -132,3 +154,272 @@ f64 platform_get_absolute_time();
  * @param ms The number of milliseconds to sleep for.
  */
 void platform_sleep(u64 ms);
+
+/**
+ * @brief Sleep on the thread for approximately the provided number of seconds, using the
+ * highest-resolution sleep the OS provides. Like all OS sleeps, this may wake late; callers
+ * requiring precision should sleep for less than required and spin the remainder.
+ * Not exported, for the same reasons as platform_sleep().
+ *
+ * @param seconds The number of seconds to sleep for.
+ */
+void platform_sleep_precise(f64 seconds);
+
+/**
+ * @brief A function to be invoked as the entry point of a thread.
+ * @param params The parameters passed to platform_thread_create().
+ * @returns The exit code of the thread.
+ */
+typedef u32 (*pfn_thread_start)(void* params);
+
+/**
+ * @brief Represents a platform thread.
+ */
+typedef struct kthread {
+    /** @brief Platform-specific internal data. */
+    void* internal_data;
+    /** @brief The identifier of the thread. */
+    u64 thread_id;
+} kthread;
+
+/**
+ * @brief Represents a platform mutex.
+ */
+typedef struct kmutex {
+    /** @brief Platform-specific internal data. */
+    void* internal_data;
+} kmutex;
+
+/**
+ * @brief Represents a platform condition variable.
+ */
+typedef struct kcondition {
+    /** @brief Platform-specific internal data. */
+    void* internal_data;
+} kcondition;
+
+/**
+ * @brief Represents a platform counting semaphore.
+ */
+typedef struct ksemaphore {
+    /** @brief Platform-specific internal data. */
+    void* internal_data;
+} ksemaphore;
+
+/**
+ * @brief Creates and immediately starts a new thread.
+ *
+ * @param start_function The function to be invoked on the new thread.
+ * @param params Parameters to be passed to start_function.
+ * @param out_thread A pointer to hold the created thread.
+ * @return True if the thread was created successfully; otherwise false.
+ */
+KAPI b8 platform_thread_create(pfn_thread_start start_function, void* params, kthread* out_thread);
+
+/**
+ * @brief Blocks until the given thread has finished, then releases its resources.
+ *
+ * @param thread A pointer to the thread to be joined.
+ */
+KAPI void platform_thread_join(kthread* thread);
+
+/**
+ * @brief Gets the identifier of the calling thread.
+ *
+ * @return The identifier of the calling thread.
+ */
+KAPI u64 platform_current_thread_id();
+
+/**
+ * @brief Gets the number of logical processors available to the application.
+ *
+ * @return The number of logical processors. Always at least 1.
+ */
+KAPI i32 platform_get_processor_count();
+
+/**
+ * @brief Creates a mutex.
+ *
+ * @param out_mutex A pointer to hold the created mutex.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 platform_mutex_create(kmutex* out_mutex);
+
+/**
+ * @brief Destroys the given mutex. It must not be locked.
+ *
+ * @param mutex A pointer to the mutex to be destroyed.
+ */
+KAPI void platform_mutex_destroy(kmutex* mutex);
+
+/**
+ * @brief Locks the given mutex, blocking until it is available.
+ *
+ * @param mutex A pointer to the mutex to be locked.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 platform_mutex_lock(kmutex* mutex);
+
+/**
+ * @brief Unlocks the given mutex, which must be locked by the calling thread.
+ *
+ * @param mutex A pointer to the mutex to be unlocked.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 platform_mutex_unlock(kmutex* mutex);
+
+/**
+ * @brief Creates a condition variable.
+ *
+ * @param out_condition A pointer to hold the created condition variable.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 platform_condition_create(kcondition* out_condition);
+
+/**
+ * @brief Destroys the given condition variable. No threads may be waiting on it.
+ *
+ * @param condition A pointer to the condition variable to be destroyed.
+ */
+KAPI void platform_condition_destroy(kcondition* condition);
+
+/**
+ * @brief Atomically unlocks the given mutex and blocks until the condition variable is
+ * signaled, then locks the mutex again before returning. Wakeups may be spurious, so the
+ * awaited condition should always be re-checked in a loop.
+ *
+ * @param condition A pointer to the condition variable to wait on.
+ * @param mutex A pointer to the mutex, which must be locked by the calling thread.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 platform_condition_wait(kcondition* condition, kmutex* mutex);
+
+/**
+ * @brief Wakes one thread waiting on the given condition variable, if there are any.
+ *
+ * @param condition A pointer to the condition variable to signal.
+ */
+KAPI void platform_condition_signal(kcondition* condition);
+
+/**
+ * @brief Wakes all threads waiting on the given condition variable.
+ *
+ * @param condition A pointer to the condition variable to broadcast.
+ */
+KAPI void platform_condition_broadcast(kcondition* condition);
+
+/**
+ * @brief Creates a counting semaphore.
+ *
+ * @param initial_count The initial count of the semaphore.
+ * @param out_semaphore A pointer to hold the created semaphore.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 platform_semaphore_create(u32 initial_count, ksemaphore* out_semaphore);
+
+/**
+ * @brief Destroys the given semaphore.
+ *
+ * @param semaphore A pointer to the semaphore to be destroyed.
+ */
+KAPI void platform_semaphore_destroy(ksemaphore* semaphore);
+
+/**
+ * @brief Increments the count of the given semaphore, waking a waiting thread if there is one.
+ *
+ * @param semaphore A pointer to the semaphore to be signaled.
+ */
+KAPI void platform_semaphore_signal(ksemaphore* semaphore);
+
+/**
+ * @brief Blocks until the count of the given semaphore is non-zero, then decrements it.
+ *
+ * @param semaphore A pointer to the semaphore to wait on.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 platform_semaphore_wait(ksemaphore* semaphore);
+
+// Atomics
+// NOTE: Loads have acquire semantics, stores have release semantics and read-modify-write
+// operations have both. Use platform_atomic_fence() where sequential consistency is required.
+
+/** @brief Atomically loads the value at ptr. */
+KINLINE u32 platform_atomic_load_u32(volatile u32* ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Atomically stores value at ptr. */
+KINLINE void platform_atomic_store_u32(volatile u32* ptr, u32 value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/** @brief Atomically adds value to the value at ptr, returning the previous value. */
+KINLINE u32 platform_atomic_fetch_add_u32(volatile u32* ptr, u32 value) {
+    return __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * @brief Atomically replaces the value at ptr with desired if it is equal to *expected.
+ * On failure, *expected is updated with the current value.
+ * @returns True if the value was replaced; otherwise false.
+ */
+KINLINE b8 platform_atomic_compare_exchange_u32(volatile u32* ptr, u32* expected, u32 desired) {
+    return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Atomically loads the value at ptr. */
+KINLINE u64 platform_atomic_load_u64(volatile u64* ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Atomically stores value at ptr. */
+KINLINE void platform_atomic_store_u64(volatile u64* ptr, u64 value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/** @brief Atomically adds value to the value at ptr, returning the previous value. */
+KINLINE u64 platform_atomic_fetch_add_u64(volatile u64* ptr, u64 value) {
+    return __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * @brief Atomically replaces the value at ptr with desired if it is equal to *expected.
+ * On failure, *expected is updated with the current value.
+ * @returns True if the value was replaced; otherwise false.
+ */
+KINLINE b8 platform_atomic_compare_exchange_u64(volatile u64* ptr, u64* expected, u64 desired) {
+    return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Atomically loads the pointer at ptr. */
+KINLINE void* platform_atomic_load_ptr(void* volatile* ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Atomically stores the pointer value at ptr. */
+KINLINE void platform_atomic_store_ptr(void* volatile* ptr, void* value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Atomically replaces the pointer at ptr with desired if it is equal to *expected.
+ * On failure, *expected is updated with the current value.
+ * @returns True if the pointer was replaced; otherwise false.
+ */
+KINLINE b8 platform_atomic_compare_exchange_ptr(void* volatile* ptr, void** expected, void* desired) {
+    return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/** @brief A full, sequentially-consistent memory fence. */
+KINLINE void platform_atomic_fence() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/** @brief Hints to the processor that the calling thread is spin-waiting. */
+KINLINE void platform_cpu_pause() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
@@ -15,6 +15,11 @@
 #include <X11/Xlib.h>
 #include <X11/Xlib-xcb.h>  // sudo apt-get install libxkbcommon-x11-dev libx11-xcb-dev
 #include <sys/time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <unistd.h>  // sysconf
+#include <poll.h>
 
 #if _POSIX_C_SOURCE >= 199309L
 #include <time.h>  // nanosleep
@@ -39,6 +44,12 @@ typedef struct platform_state {
     xcb_atom_t wm_protocols;
     xcb_atom_t wm_delete_win;
     VkSurfaceKHR surface;
+    // Headless mode. No connection to X is made, so all of the above is unused.
+    b8 headless;
+    // Set until the synthetic resize has been fired by the first message pump.
+    b8 headless_resize_pending;
+    u16 headless_width;
+    u16 headless_height;
 } platform_state;
 
 static platform_state* state_ptr;
@@ -53,16 +64,31 @@ b8 platform_system_startup(
     i32 x,
     i32 y,
     i32 width,
-    i32 height) {
+    i32 height,
+    b8 headless) {
     *memory_requirement = sizeof(platform_state);
     if (state == 0) {
         return true;
     }
 
     state_ptr = state;
+    memset(state_ptr, 0, sizeof(platform_state));
+
+    if (headless) {
+        state_ptr->headless = true;
+        state_ptr->headless_resize_pending = true;
+        state_ptr->headless_width = (u16)width;
+        state_ptr->headless_height = (u16)height;
+        KINFO("Platform layer started headless (%ix%i). No window will be created.", width, height);
+        return true;
+    }
 
     // Connect to X
     state_ptr->display = XOpenDisplay(NULL);
+    if (!state_ptr->display) {
+        KFATAL("Failed to open X display. Set the application to headless to run without one.");
+        return false;
+    }
 
     // Turn off key repeats.
     XAutoRepeatOff(state_ptr->display);
@@ -179,7 +205,7 @@ b8 platform_system_startup(
 }
 
 void platform_system_shutdown(void* plat_state) {
-    if (state_ptr) {
+    if (state_ptr && !state_ptr->headless) {
         // Turn key repeats back on since this is global for the OS... just... wow.
         XAutoRepeatOn(state_ptr->display);
 
@@ -188,6 +214,17 @@ void platform_system_shutdown(void* plat_state) {
 }
 
 b8 platform_pump_messages() {
+    if (state_ptr && state_ptr->headless) {
+        // There is no window to be sized by the OS, so size it once as requested at startup.
+        if (state_ptr->headless_resize_pending) {
+            state_ptr->headless_resize_pending = false;
+            event_context context;
+            context.data.u16[0] = state_ptr->headless_width;
+            context.data.u16[1] = state_ptr->headless_height;
+            event_fire(EVENT_CODE_RESIZED, 0, context);
+        }
+        return true;
+    }
     if (state_ptr) {
         xcb_generic_event_t* event;
         xcb_client_message_event_t* cm;
@@ -279,6 +316,32 @@ b8 platform_pump_messages() {
     return true;
 }
 
+b8 platform_wait_messages(f64 timeout_seconds) {
+    if (!state_ptr) {
+        return false;
+    }
+    if (state_ptr->headless) {
+        // Nothing can arrive except the synthetic resize.
+        if (state_ptr->headless_resize_pending) {
+            return true;
+        }
+        platform_sleep_precise(timeout_seconds);
+        return false;
+    }
+
+    // Requests must be sent before blocking, as the replies may be what is waited on.
+    xcb_flush(state_ptr->connection);
+
+    // Events already read are queued by the pump, which drains the queue, so only the connection needs to be waited on.
+    struct pollfd fd;
+    fd.fd = xcb_get_file_descriptor(state_ptr->connection);
+    fd.events = POLLIN;
+    fd.revents = 0;
+    i32 timeout_ms = (i32)(timeout_seconds * 1000.0);
+    i32 result = poll(&fd, 1, timeout_ms);
+    return result != 0;
+}
+
 void* platform_allocate(u64 size, b8 aligned) {
     return malloc(size);
 }
@@ -326,7 +389,194 @@ void platform_sleep(u64 ms) {
 #endif
 }
 
+void platform_sleep_precise(f64 seconds) {
+    if (seconds <= 0) {
+        return;
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (f64)ts.tv_sec) * 1000000000.0);
+    // Resume after signal interruptions with whatever time is left.
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR) {
+    }
+}
+
+typedef struct linux_thread_start_params {
+    pfn_thread_start start_function;
+    void* params;
+} linux_thread_start_params;
+
+static void* linux_thread_start(void* start_params) {
+    linux_thread_start_params p = *(linux_thread_start_params*)start_params;
+    platform_free(start_params, false);
+    return (void*)(u64)p.start_function(p.params);
+}
+
+b8 platform_thread_create(pfn_thread_start start_function, void* params, kthread* out_thread) {
+    if (!start_function || !out_thread) {
+        return false;
+    }
+    // Freed by the new thread once it has started.
+    linux_thread_start_params* start_params = platform_allocate(sizeof(linux_thread_start_params), false);
+    start_params->start_function = start_function;
+    start_params->params = params;
+
+    pthread_t thread;
+    i32 result = pthread_create(&thread, 0, linux_thread_start, start_params);
+    if (result != 0) {
+        KERROR("platform_thread_create failed with error %i.", result);
+        platform_free(start_params, false);
+        return false;
+    }
+    out_thread->thread_id = (u64)thread;
+    out_thread->internal_data = 0;
+    return true;
+}
+
+void platform_thread_join(kthread* thread) {
+    if (thread && thread->thread_id) {
+        pthread_join((pthread_t)thread->thread_id, 0);
+        thread->thread_id = 0;
+    }
+}
+
+u64 platform_current_thread_id() {
+    return (u64)pthread_self();
+}
+
+i32 platform_get_processor_count() {
+    i64 count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (i32)count : 1;
+}
+
+b8 platform_mutex_create(kmutex* out_mutex) {
+    if (!out_mutex) {
+        return false;
+    }
+    pthread_mutex_t* mutex = platform_allocate(sizeof(pthread_mutex_t), false);
+    i32 result = pthread_mutex_init(mutex, 0);
+    if (result != 0) {
+        KERROR("platform_mutex_create failed with error %i.", result);
+        platform_free(mutex, false);
+        return false;
+    }
+    out_mutex->internal_data = mutex;
+    return true;
+}
+
+void platform_mutex_destroy(kmutex* mutex) {
+    if (mutex && mutex->internal_data) {
+        pthread_mutex_destroy(mutex->internal_data);
+        platform_free(mutex->internal_data, false);
+        mutex->internal_data = 0;
+    }
+}
+
+b8 platform_mutex_lock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return false;
+    }
+    return pthread_mutex_lock(mutex->internal_data) == 0;
+}
+
+b8 platform_mutex_unlock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return false;
+    }
+    return pthread_mutex_unlock(mutex->internal_data) == 0;
+}
+
+b8 platform_condition_create(kcondition* out_condition) {
+    if (!out_condition) {
+        return false;
+    }
+    pthread_cond_t* condition = platform_allocate(sizeof(pthread_cond_t), false);
+    i32 result = pthread_cond_init(condition, 0);
+    if (result != 0) {
+        KERROR("platform_condition_create failed with error %i.", result);
+        platform_free(condition, false);
+        return false;
+    }
+    out_condition->internal_data = condition;
+    return true;
+}
+
+void platform_condition_destroy(kcondition* condition) {
+    if (condition && condition->internal_data) {
+        pthread_cond_destroy(condition->internal_data);
+        platform_free(condition->internal_data, false);
+        condition->internal_data = 0;
+    }
+}
+
+b8 platform_condition_wait(kcondition* condition, kmutex* mutex) {
+    if (!condition || !condition->internal_data || !mutex || !mutex->internal_data) {
+        return false;
+    }
+    return pthread_cond_wait(condition->internal_data, mutex->internal_data) == 0;
+}
+
+void platform_condition_signal(kcondition* condition) {
+    if (condition && condition->internal_data) {
+        pthread_cond_signal(condition->internal_data);
+    }
+}
+
+void platform_condition_broadcast(kcondition* condition) {
+    if (condition && condition->internal_data) {
+        pthread_cond_broadcast(condition->internal_data);
+    }
+}
+
+b8 platform_semaphore_create(u32 initial_count, ksemaphore* out_semaphore) {
+    if (!out_semaphore) {
+        return false;
+    }
+    sem_t* semaphore = platform_allocate(sizeof(sem_t), false);
+    if (sem_init(semaphore, 0, initial_count) != 0) {
+        KERROR("platform_semaphore_create failed with error %i.", errno);
+        platform_free(semaphore, false);
+        return false;
+    }
+    out_semaphore->internal_data = semaphore;
+    return true;
+}
+
+void platform_semaphore_destroy(ksemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        sem_destroy(semaphore->internal_data);
+        platform_free(semaphore->internal_data, false);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platform_semaphore_signal(ksemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        sem_post(semaphore->internal_data);
+    }
+}
+
+b8 platform_semaphore_wait(ksemaphore* semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return false;
+    }
+    // Retry if interrupted by a signal.
+    while (sem_wait(semaphore->internal_data) != 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+b8 platform_is_headless() {
+    return state_ptr && state_ptr->headless;
+}
+
 void platform_get_required_extension_names(const char*** names_darray) {
+    if (platform_is_headless()) {
+        return;
+    }
     darray_push(*names_darray, &"VK_KHR_xcb_surface");  // VK_KHR_xlib_surface?
 }
 
@@ -335,6 +585,10 @@ b8 platform_create_vulkan_surface(vulkan_context* context) {
     if(!state_ptr) {
         return false;
     }
+    if (state_ptr->headless) {
+        KERROR("Cannot create a Vulkan surface while headless, as there is no window.");
+        return false;
+    }
 
     VkXcbSurfaceCreateInfoKHR create_info = {VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR};
     create_info.connection = state_ptr->connection;
@@ -10,6 +10,11 @@
 
 #include <mach/mach_time.h>
 #include <crt_externs.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dispatch/dispatch.h>
 
 #import <Foundation/Foundation.h>
 #import <Cocoa/Cocoa.h>
@@ -264,12 +269,19 @@ b8 platform_system_startup(
     i32 x,
     i32 y,
     i32 width,
-    i32 height) {
+    i32 height,
+    b8 headless) {
     *memory_requirement = sizeof(platform_state);
     if (state == 0) {
         return true;
     }
 
+    // TODO: headless mode is not yet supported on macOS.
+    if (headless) {
+        KERROR("Headless mode is not supported on macOS. Unset KOHI_HEADLESS to run with a window.");
+        return false;
+    }
+
     state_ptr = state;
 
     @autoreleasepool {
@@ -387,6 +399,25 @@ b8 platform_pump_messages(platform_state *plat_state) {
     return true;
 }
 
+b8 platform_wait_messages(f64 timeout_seconds) {
+    if (!state_ptr) {
+        return false;
+    }
+    b8 has_event = false;
+    @autoreleasepool {
+
+    // Peek without dequeuing so the event is left for platform_pump_messages.
+    NSEvent* event = [NSApp
+        nextEventMatchingMask:NSEventMaskAny
+        untilDate:[NSDate dateWithTimeIntervalSinceNow:(timeout_seconds > 0 ? timeout_seconds : 0)]
+        inMode:NSDefaultRunLoopMode
+        dequeue:NO];
+    has_event = event != nil;
+
+    } // autoreleasepool
+    return has_event;
+}
+
 void* platform_allocate(u64 size, b8 aligned) {
     return malloc(size);
 }
@@ -437,6 +468,184 @@ void platform_sleep(u64 ms) {
 #endif
 }
 
+void platform_sleep_precise(f64 seconds) {
+    if (seconds <= 0) {
+        return;
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (f64)ts.tv_sec) * 1000000000.0);
+    // macOS has no clock_nanosleep. nanosleep writes the time left into the second
+    // argument when a signal interrupts it, so resume with that.
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+    }
+}
+
+typedef struct macos_thread_start_params {
+    pfn_thread_start start_function;
+    void* params;
+} macos_thread_start_params;
+
+static void* macos_thread_start(void* start_params) {
+    macos_thread_start_params p = *(macos_thread_start_params*)start_params;
+    platform_free(start_params, false);
+    return (void*)(u64)p.start_function(p.params);
+}
+
+b8 platform_thread_create(pfn_thread_start start_function, void* params, kthread* out_thread) {
+    if (!start_function || !out_thread) {
+        return false;
+    }
+    // Freed by the new thread once it has started.
+    macos_thread_start_params* start_params = platform_allocate(sizeof(macos_thread_start_params), false);
+    start_params->start_function = start_function;
+    start_params->params = params;
+
+    pthread_t thread;
+    i32 result = pthread_create(&thread, 0, macos_thread_start, start_params);
+    if (result != 0) {
+        KERROR("platform_thread_create failed with error %i.", result);
+        platform_free(start_params, false);
+        return false;
+    }
+    out_thread->thread_id = (u64)thread;
+    out_thread->internal_data = 0;
+    return true;
+}
+
+void platform_thread_join(kthread* thread) {
+    if (thread && thread->thread_id) {
+        pthread_join((pthread_t)thread->thread_id, 0);
+        thread->thread_id = 0;
+    }
+}
+
+u64 platform_current_thread_id() {
+    return (u64)pthread_self();
+}
+
+i32 platform_get_processor_count() {
+    i64 count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (i32)count : 1;
+}
+
+b8 platform_mutex_create(kmutex* out_mutex) {
+    if (!out_mutex) {
+        return false;
+    }
+    pthread_mutex_t* mutex = platform_allocate(sizeof(pthread_mutex_t), false);
+    i32 result = pthread_mutex_init(mutex, 0);
+    if (result != 0) {
+        KERROR("platform_mutex_create failed with error %i.", result);
+        platform_free(mutex, false);
+        return false;
+    }
+    out_mutex->internal_data = mutex;
+    return true;
+}
+
+void platform_mutex_destroy(kmutex* mutex) {
+    if (mutex && mutex->internal_data) {
+        pthread_mutex_destroy(mutex->internal_data);
+        platform_free(mutex->internal_data, false);
+        mutex->internal_data = 0;
+    }
+}
+
+b8 platform_mutex_lock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return false;
+    }
+    return pthread_mutex_lock(mutex->internal_data) == 0;
+}
+
+b8 platform_mutex_unlock(kmutex* mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return false;
+    }
+    return pthread_mutex_unlock(mutex->internal_data) == 0;
+}
+
+b8 platform_condition_create(kcondition* out_condition) {
+    if (!out_condition) {
+        return false;
+    }
+    pthread_cond_t* condition = platform_allocate(sizeof(pthread_cond_t), false);
+    i32 result = pthread_cond_init(condition, 0);
+    if (result != 0) {
+        KERROR("platform_condition_create failed with error %i.", result);
+        platform_free(condition, false);
+        return false;
+    }
+    out_condition->internal_data = condition;
+    return true;
+}
+
+void platform_condition_destroy(kcondition* condition) {
+    if (condition && condition->internal_data) {
+        pthread_cond_destroy(condition->internal_data);
+        platform_free(condition->internal_data, false);
+        condition->internal_data = 0;
+    }
+}
+
+b8 platform_condition_wait(kcondition* condition, kmutex* mutex) {
+    if (!condition || !condition->internal_data || !mutex || !mutex->internal_data) {
+        return false;
+    }
+    return pthread_cond_wait(condition->internal_data, mutex->internal_data) == 0;
+}
+
+void platform_condition_signal(kcondition* condition) {
+    if (condition && condition->internal_data) {
+        pthread_cond_signal(condition->internal_data);
+    }
+}
+
+void platform_condition_broadcast(kcondition* condition) {
+    if (condition && condition->internal_data) {
+        pthread_cond_broadcast(condition->internal_data);
+    }
+}
+
+// NOTE: Unnamed POSIX semaphores (sem_init) are not implemented on macOS, so dispatch semaphores are used instead.
+b8 platform_semaphore_create(u32 initial_count, ksemaphore* out_semaphore) {
+    if (!out_semaphore) {
+        return false;
+    }
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create((long)initial_count);
+    if (!semaphore) {
+        KERROR("platform_semaphore_create failed.");
+        return false;
+    }
+    out_semaphore->internal_data = (void*)semaphore;
+    return true;
+}
+
+void platform_semaphore_destroy(ksemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        dispatch_release((dispatch_semaphore_t)semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platform_semaphore_signal(ksemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        dispatch_semaphore_signal((dispatch_semaphore_t)semaphore->internal_data);
+    }
+}
+
+b8 platform_semaphore_wait(ksemaphore* semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return false;
+    }
+    return dispatch_semaphore_wait((dispatch_semaphore_t)semaphore->internal_data, DISPATCH_TIME_FOREVER) == 0;
+}
+
+b8 platform_is_headless() {
+    return false;
+}
+
 void platform_get_required_extension_names(const char ***names_darray) {
     darray_push(*names_darray, &"VK_EXT_metal_surface");
 }
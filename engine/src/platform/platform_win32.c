@@ -22,7 +22,12 @@ typedef struct platform_state {
     HINSTANCE h_instance;
     HWND hwnd;
     VkSurfaceKHR surface;
-
+    // Headless mode. No window is created, so all of the above is unused.
+    b8 headless;
+    // Set until the synthetic resize has been fired by the first message pump.
+    b8 headless_resize_pending;
+    u16 headless_width;
+    u16 headless_height;
 } platform_state;
 
 static platform_state *state_ptr;
@@ -47,12 +52,25 @@ b8 platform_system_startup(
     i32 x,
     i32 y,
     i32 width,
-    i32 height) {
+    i32 height,
+    b8 headless) {
     *memory_requirement = sizeof(platform_state);
     if (state == 0) {
         return true;
     }
     state_ptr = state;
+    memset(state_ptr, 0, sizeof(platform_state));
+
+    if (headless) {
+        state_ptr->headless = true;
+        state_ptr->headless_resize_pending = true;
+        state_ptr->headless_width = (u16)width;
+        state_ptr->headless_height = (u16)height;
+        clock_setup();
+        KINFO("Platform layer started headless (%ix%i). No window will be created.", width, height);
+        return true;
+    }
+
     state_ptr->h_instance = GetModuleHandleA(0);
 
     // Setup and register window class.
@@ -139,6 +157,17 @@ void platform_system_shutdown(void *plat_state) {
 }
 
 b8 platform_pump_messages() {
+    if (state_ptr && state_ptr->headless) {
+        // There is no window to be sized by the OS, so size it once as requested at startup.
+        if (state_ptr->headless_resize_pending) {
+            state_ptr->headless_resize_pending = false;
+            event_context context;
+            context.data.u16[0] = state_ptr->headless_width;
+            context.data.u16[1] = state_ptr->headless_height;
+            event_fire(EVENT_CODE_RESIZED, 0, context);
+        }
+        return true;
+    }
     if (state_ptr) {
         MSG message;
         while (PeekMessageA(&message, NULL, 0, 0, PM_REMOVE)) {
@@ -149,6 +178,24 @@ b8 platform_pump_messages() {
     return true;
 }
 
+b8 platform_wait_messages(f64 timeout_seconds) {
+    if (!state_ptr) {
+        return false;
+    }
+    if (state_ptr->headless) {
+        // Nothing can arrive except the synthetic resize.
+        if (state_ptr->headless_resize_pending) {
+            return true;
+        }
+        platform_sleep_precise(timeout_seconds);
+        return false;
+    }
+
+    // Also wakes for messages which arrived before the call but were not yet pumped.
+    DWORD timeout_ms = (DWORD)(timeout_seconds * 1000.0);
+    return MsgWaitForMultipleObjectsEx(0, 0, timeout_ms, QS_ALLINPUT, MWMO_INPUTAVAILABLE) != WAIT_TIMEOUT;
+}
+
 void *platform_allocate(u64 size, b8 aligned) {
     return malloc(size);
 }
@@ -205,7 +252,196 @@ void platform_sleep(u64 ms) {
     Sleep(ms);
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void platform_sleep_precise(f64 seconds) {
+    if (seconds <= 0) {
+        return;
+    }
+    // High-resolution timers are available from Windows 10 1803. One is kept per thread.
+    static KTHREAD_LOCAL HANDLE timer = 0;
+    static KTHREAD_LOCAL b8 timer_unavailable = false;
+    if (!timer && !timer_unavailable) {
+        timer = CreateWaitableTimerExW(0, 0, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        timer_unavailable = timer == 0;
+    }
+    if (timer) {
+        LARGE_INTEGER due_time;
+        // Negative values are relative, in 100 nanosecond intervals.
+        due_time.QuadPart = -(LONGLONG)(seconds * 10000000.0);
+        if (SetWaitableTimerEx(timer, &due_time, 0, 0, 0, 0, 0)) {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+    // Millisecond granularity at best.
+    Sleep((DWORD)(seconds * 1000.0));
+}
+
+typedef struct win32_thread_start_params {
+    pfn_thread_start start_function;
+    void *params;
+} win32_thread_start_params;
+
+static DWORD WINAPI win32_thread_start(LPVOID start_params) {
+    win32_thread_start_params p = *(win32_thread_start_params *)start_params;
+    platform_free(start_params, false);
+    return p.start_function(p.params);
+}
+
+b8 platform_thread_create(pfn_thread_start start_function, void *params, kthread *out_thread) {
+    if (!start_function || !out_thread) {
+        return false;
+    }
+    // Freed by the new thread once it has started.
+    win32_thread_start_params *start_params = platform_allocate(sizeof(win32_thread_start_params), false);
+    start_params->start_function = start_function;
+    start_params->params = params;
+
+    DWORD thread_id = 0;
+    HANDLE handle = CreateThread(0, 0, win32_thread_start, start_params, 0, &thread_id);
+    if (!handle) {
+        KERROR("platform_thread_create failed with error %u.", GetLastError());
+        platform_free(start_params, false);
+        return false;
+    }
+    out_thread->internal_data = handle;
+    out_thread->thread_id = thread_id;
+    return true;
+}
+
+void platform_thread_join(kthread *thread) {
+    if (thread && thread->internal_data) {
+        WaitForSingleObject(thread->internal_data, INFINITE);
+        CloseHandle(thread->internal_data);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+u64 platform_current_thread_id() {
+    return (u64)GetCurrentThreadId();
+}
+
+i32 platform_get_processor_count() {
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return system_info.dwNumberOfProcessors > 0 ? (i32)system_info.dwNumberOfProcessors : 1;
+}
+
+b8 platform_mutex_create(kmutex *out_mutex) {
+    if (!out_mutex) {
+        return false;
+    }
+    SRWLOCK *lock = platform_allocate(sizeof(SRWLOCK), false);
+    InitializeSRWLock(lock);
+    out_mutex->internal_data = lock;
+    return true;
+}
+
+void platform_mutex_destroy(kmutex *mutex) {
+    if (mutex && mutex->internal_data) {
+        // SRW locks don't need to be explicitly destroyed.
+        platform_free(mutex->internal_data, false);
+        mutex->internal_data = 0;
+    }
+}
+
+b8 platform_mutex_lock(kmutex *mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return false;
+    }
+    AcquireSRWLockExclusive(mutex->internal_data);
+    return true;
+}
+
+b8 platform_mutex_unlock(kmutex *mutex) {
+    if (!mutex || !mutex->internal_data) {
+        return false;
+    }
+    ReleaseSRWLockExclusive(mutex->internal_data);
+    return true;
+}
+
+b8 platform_condition_create(kcondition *out_condition) {
+    if (!out_condition) {
+        return false;
+    }
+    CONDITION_VARIABLE *condition = platform_allocate(sizeof(CONDITION_VARIABLE), false);
+    InitializeConditionVariable(condition);
+    out_condition->internal_data = condition;
+    return true;
+}
+
+void platform_condition_destroy(kcondition *condition) {
+    if (condition && condition->internal_data) {
+        // Condition variables don't need to be explicitly destroyed.
+        platform_free(condition->internal_data, false);
+        condition->internal_data = 0;
+    }
+}
+
+b8 platform_condition_wait(kcondition *condition, kmutex *mutex) {
+    if (!condition || !condition->internal_data || !mutex || !mutex->internal_data) {
+        return false;
+    }
+    return SleepConditionVariableSRW(condition->internal_data, mutex->internal_data, INFINITE, 0) != 0;
+}
+
+void platform_condition_signal(kcondition *condition) {
+    if (condition && condition->internal_data) {
+        WakeConditionVariable(condition->internal_data);
+    }
+}
+
+void platform_condition_broadcast(kcondition *condition) {
+    if (condition && condition->internal_data) {
+        WakeAllConditionVariable(condition->internal_data);
+    }
+}
+
+b8 platform_semaphore_create(u32 initial_count, ksemaphore *out_semaphore) {
+    if (!out_semaphore) {
+        return false;
+    }
+    out_semaphore->internal_data = CreateSemaphore(0, initial_count, 0x7FFFFFFF, 0);
+    if (!out_semaphore->internal_data) {
+        KERROR("platform_semaphore_create failed with error %u.", GetLastError());
+        return false;
+    }
+    return true;
+}
+
+void platform_semaphore_destroy(ksemaphore *semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        CloseHandle(semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platform_semaphore_signal(ksemaphore *semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        ReleaseSemaphore(semaphore->internal_data, 1, 0);
+    }
+}
+
+b8 platform_semaphore_wait(ksemaphore *semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return false;
+    }
+    return WaitForSingleObject(semaphore->internal_data, INFINITE) == WAIT_OBJECT_0;
+}
+
+b8 platform_is_headless() {
+    return state_ptr && state_ptr->headless;
+}
+
 void platform_get_required_extension_names(const char ***names_darray) {
+    if (platform_is_headless()) {
+        return;
+    }
     darray_push(*names_darray, &"VK_KHR_win32_surface");
 }
 
@@ -214,6 +450,10 @@ b8 platform_create_vulkan_surface(vulkan_context *context) {
     if (!state_ptr) {
         return false;
     }
+    if (state_ptr->headless) {
+        KERROR("Cannot create a Vulkan surface while headless, as there is no window.");
+        return false;
+    }
     VkWin32SurfaceCreateInfoKHR create_info = {VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR};
     create_info.hinstance = state_ptr->h_instance;
     create_info.hwnd = state_ptr->hwnd;
@@ -0,0 +1,465 @@
+#include "null_backend.h"
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/kstring.h"
+#include "containers/hashtable.h"
+#include "systems/shader_system.h"
+#include "systems/texture_system.h"
+
+// Matched to the Vulkan backend, so the same content fits in both.
+#define NULL_MAX_GEOMETRY_COUNT 4096
+#define NULL_MAX_MATERIAL_COUNT 1024
+#define NULL_MAX_REGISTERED_RENDERPASSES 31
+// Triple-buffered, like a typical swapchain, so the frontend cycles through render targets as usual.
+#define NULL_WINDOW_RENDER_TARGET_COUNT 3
+// A typical minimum uniform buffer offset alignment.
+#define NULL_UBO_ALIGNMENT 256
+
+/** @brief What is kept of an uploaded geometry. */
+typedef struct null_geometry_data {
+    /** @brief The geometry's internal id, or INVALID_ID if the slot is free. */
+    u32 id;
+    /** @brief The number of elements drawn per draw call. Indices if present; otherwise vertices. */
+    u32 element_count;
+} null_geometry_data;
+
+/** @brief The internal data of a shader. */
+typedef struct null_shader {
+    /** @brief Indicates which instance ids are taken. */
+    b8 instances_used[NULL_MAX_MATERIAL_COUNT];
+} null_shader;
+
+typedef struct null_backend_state {
+    u32 framebuffer_width;
+    u32 framebuffer_height;
+    u8 image_index;
+
+    void (*on_rendertarget_refresh_required)();
+
+    renderpass registered_passes[NULL_MAX_REGISTERED_RENDERPASSES];
+    void* renderpass_table_block;
+    hashtable renderpass_table;
+
+    texture window_attachments[NULL_WINDOW_RENDER_TARGET_COUNT];
+    texture depth_attachment;
+
+    null_geometry_data geometries[NULL_MAX_GEOMETRY_COUNT];
+
+    /** @brief Stats of the frame in progress, including anything done since the last frame ended. */
+    renderer_frame_stats current;
+    renderer_frame_stats last_frame;
+    renderer_frame_stats totals;
+} null_backend_state;
+
+static null_backend_state state;
+
+static void stats_accumulate(renderer_frame_stats* totals, const renderer_frame_stats* frame) {
+    totals->frame_count += frame->frame_count;
+    totals->draw_count += frame->draw_count;
+    totals->element_count += frame->element_count;
+    totals->renderpass_count += frame->renderpass_count;
+    totals->shader_use_count += frame->shader_use_count;
+    totals->shader_bind_count += frame->shader_bind_count;
+    totals->shader_apply_count += frame->shader_apply_count;
+    totals->uniform_set_count += frame->uniform_set_count;
+    totals->uniform_bytes += frame->uniform_bytes;
+    totals->texture_create_count += frame->texture_create_count;
+    totals->geometry_create_count += frame->geometry_create_count;
+    totals->bytes_uploaded += frame->bytes_uploaded;
+}
+
+static void resize_window_attachments(u32 width, u32 height) {
+    for (u8 i = 0; i < NULL_WINDOW_RENDER_TARGET_COUNT; ++i) {
+        state.window_attachments[i].width = width;
+        state.window_attachments[i].height = height;
+        state.window_attachments[i].generation++;
+    }
+    state.depth_attachment.width = width;
+    state.depth_attachment.height = height;
+    state.depth_attachment.generation++;
+}
+
+b8 null_renderer_backend_initialize(renderer_backend* backend, const renderer_backend_config* config, u8* out_window_render_target_count) {
+    kzero_memory(&state, sizeof(null_backend_state));
+    state.framebuffer_width = 1280;
+    state.framebuffer_height = 720;
+    state.on_rendertarget_refresh_required = config->on_rendertarget_refresh_required;
+
+    // Stand-ins for the swapchain images and depth buffer.
+    for (u8 i = 0; i < NULL_WINDOW_RENDER_TARGET_COUNT; ++i) {
+        string_format(state.window_attachments[i].name, "__null_window_attachment_%u__", i);
+        state.window_attachments[i].id = INVALID_ID;
+        state.window_attachments[i].channel_count = 4;
+        state.window_attachments[i].generation = INVALID_ID;
+    }
+    string_ncopy(state.depth_attachment.name, "__null_depth_attachment__", TEXTURE_NAME_MAX_LENGTH);
+    state.depth_attachment.id = INVALID_ID;
+    state.depth_attachment.channel_count = 4;
+    state.depth_attachment.generation = INVALID_ID;
+    resize_window_attachments(state.framebuffer_width, state.framebuffer_height);
+    *out_window_render_target_count = NULL_WINDOW_RENDER_TARGET_COUNT;
+
+    for (u32 i = 0; i < NULL_MAX_GEOMETRY_COUNT; ++i) {
+        state.geometries[i].id = INVALID_ID;
+    }
+
+    // Hold registered renderpasses.
+    for (u32 i = 0; i < NULL_MAX_REGISTERED_RENDERPASSES; ++i) {
+        state.registered_passes[i].id = INVALID_ID_U16;
+    }
+
+    // The renderpass table will be a lookup of array indices. Start off every index with an invalid id.
+    state.renderpass_table_block = kallocate(sizeof(u32) * NULL_MAX_REGISTERED_RENDERPASSES, MEMORY_TAG_RENDERER);
+    hashtable_create(sizeof(u32), NULL_MAX_REGISTERED_RENDERPASSES, state.renderpass_table_block, false, &state.renderpass_table);
+    u32 value = INVALID_ID;
+    hashtable_fill(&state.renderpass_table, &value);
+
+    for (u32 i = 0; i < config->renderpass_count; ++i) {
+        u32 id = INVALID_ID;
+        hashtable_get(&state.renderpass_table, config->pass_configs[i].name, &id);
+        if (id != INVALID_ID) {
+            KERROR("Collision with renderpass named '%s'. Initialization failed.", config->pass_configs[i].name);
+            return false;
+        }
+        for (u32 j = 0; j < NULL_MAX_REGISTERED_RENDERPASSES; ++j) {
+            if (state.registered_passes[j].id == INVALID_ID_U16) {
+                state.registered_passes[j].id = j;
+                id = j;
+                break;
+            }
+        }
+        if (id == INVALID_ID) {
+            KERROR("No space was found for a new renderpass. Increase NULL_MAX_REGISTERED_RENDERPASSES. Initialization failed.");
+            return false;
+        }
+
+        state.registered_passes[id].clear_flags = config->pass_configs[i].clear_flags;
+        state.registered_passes[id].clear_colour = config->pass_configs[i].clear_colour;
+        state.registered_passes[id].render_area = config->pass_configs[i].render_area;
+        null_renderpass_create(&state.registered_passes[id], 1.0f, 0, config->pass_configs[i].prev_name != 0, config->pass_configs[i].next_name != 0);
+
+        hashtable_set(&state.renderpass_table, config->pass_configs[i].name, &id);
+    }
+
+    KINFO("Null renderer initialized. No rendering will be performed.");
+    return true;
+}
+
+void null_renderer_backend_shutdown(renderer_backend* backend) {
+    renderer_frame_stats* t = &state.totals;
+    if (t->frame_count) {
+        KINFO("Null renderer: %llu frames, %llu draws (%.1f/frame), %llu renderpasses, %llu shader uses, %llu binds, %llu applies, %llu uniform sets (%llu bytes).",
+              t->frame_count, t->draw_count, (f64)t->draw_count / t->frame_count, t->renderpass_count,
+              t->shader_use_count, t->shader_bind_count, t->shader_apply_count, t->uniform_set_count, t->uniform_bytes);
+        KINFO("Null renderer: %llu textures and %llu geometries created, %llu bytes uploaded.",
+              t->texture_create_count, t->geometry_create_count, t->bytes_uploaded);
+    }
+
+    if (state.renderpass_table_block) {
+        hashtable_destroy(&state.renderpass_table);
+        kfree(state.renderpass_table_block, sizeof(u32) * NULL_MAX_REGISTERED_RENDERPASSES, MEMORY_TAG_RENDERER);
+        state.renderpass_table_block = 0;
+    }
+}
+
+void null_renderer_backend_on_resized(renderer_backend* backend, u16 width, u16 height) {
+    state.framebuffer_width = width;
+    state.framebuffer_height = height;
+    resize_window_attachments(width, height);
+    // As with a recreated swapchain, the render targets must be regenerated.
+    if (state.on_rendertarget_refresh_required) {
+        state.on_rendertarget_refresh_required();
+    }
+}
+
+b8 null_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time) {
+    return true;
+}
+
+b8 null_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time) {
+    state.current.frame_count = 1;
+    state.last_frame = state.current;
+    stats_accumulate(&state.totals, &state.current);
+    kzero_memory(&state.current, sizeof(renderer_frame_stats));
+
+    state.image_index = (state.image_index + 1) % NULL_WINDOW_RENDER_TARGET_COUNT;
+    return true;
+}
+
+b8 null_renderer_begin_renderpass(struct renderer_backend* backend, renderpass* pass, render_target* target) {
+    state.current.renderpass_count++;
+    return true;
+}
+
+b8 null_renderer_end_renderpass(struct renderer_backend* backend, renderpass* pass) {
+    return true;
+}
+
+renderpass* null_renderer_renderpass_get(const char* name) {
+    if (!name || name[0] == 0) {
+        KERROR("null_renderer_renderpass_get requires a name. Nothing will be returned.");
+        return 0;
+    }
+
+    u32 id = INVALID_ID;
+    hashtable_get(&state.renderpass_table, name, &id);
+    if (id == INVALID_ID) {
+        KWARN("There is no registered renderpass named '%s'.", name);
+        return 0;
+    }
+
+    return &state.registered_passes[id];
+}
+
+void null_renderer_draw_geometry(geometry_render_data data) {
+    // Ignore missing and non-uploaded geometries.
+    if (!data.geometry || data.geometry->internal_id == INVALID_ID) {
+        return;
+    }
+    state.current.draw_count++;
+    // Non-indexed geometries have no index ranges, and are always drawn whole.
+    if (data.index_count > 0) {
+        state.current.element_count += data.index_count;
+    } else if (data.lod < data.geometry->lod_count && data.geometry->lods[data.lod].index_count > 0) {
+        state.current.element_count += data.geometry->lods[data.lod].index_count;
+    } else {
+        state.current.element_count += state.geometries[data.geometry->internal_id].element_count;
+    }
+}
+
+void null_renderer_texture_create(const u8* pixels, texture* t) {
+    state.current.texture_create_count++;
+    state.current.bytes_uploaded += (u64)t->width * t->height * t->channel_count;
+    t->internal_data = 0;
+    t->generation++;
+}
+
+void null_renderer_texture_destroy(texture* t) {
+    t->internal_data = 0;
+}
+
+void null_renderer_texture_create_writeable(texture* t) {
+    state.current.texture_create_count++;
+    t->internal_data = 0;
+    t->generation++;
+}
+
+void null_renderer_texture_resize(texture* t, u32 new_width, u32 new_height) {
+    if (t) {
+        t->width = new_width;
+        t->height = new_height;
+        t->generation++;
+    }
+}
+
+void null_renderer_texture_write_data(texture* t, u32 offset, u32 size, const u8* pixels) {
+    state.current.bytes_uploaded += size;
+    t->generation++;
+}
+
+b8 null_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vertex_count, const void* vertices, u32 index_size, u32 index_count, const void* indices) {
+    if (!vertex_count || !vertices) {
+        KERROR("null_renderer_create_geometry requires vertex data, and none was supplied. vertex_count=%d, vertices=%p", vertex_count, vertices);
+        return false;
+    }
+
+    null_geometry_data* internal_data = 0;
+    if (geometry->internal_id != INVALID_ID) {
+        // A re-upload, which reuses the existing slot.
+        internal_data = &state.geometries[geometry->internal_id];
+    } else {
+        for (u32 i = 0; i < NULL_MAX_GEOMETRY_COUNT; ++i) {
+            if (state.geometries[i].id == INVALID_ID) {
+                geometry->internal_id = i;
+                state.geometries[i].id = i;
+                internal_data = &state.geometries[i];
+                break;
+            }
+        }
+    }
+    if (!internal_data) {
+        KFATAL("null_renderer_create_geometry failed to find a free index for a new geometry upload. Adjust config to allow for more.");
+        return false;
+    }
+
+    internal_data->element_count = index_count > 0 ? index_count : vertex_count;
+    state.current.geometry_create_count++;
+    state.current.bytes_uploaded += (u64)vertex_size * vertex_count + (u64)index_size * index_count;
+    return true;
+}
+
+void null_renderer_destroy_geometry(geometry* geometry) {
+    if (geometry && geometry->internal_id != INVALID_ID) {
+        state.geometries[geometry->internal_id].id = INVALID_ID;
+        state.geometries[geometry->internal_id].element_count = 0;
+    }
+}
+
+b8 null_renderer_shader_create(shader* s, renderpass* pass, u8 stage_count, const char** stage_filenames, shader_stage* stages) {
+    // Shader stage binaries are not loaded, since there is nothing to compile them for.
+    s->internal_data = kallocate(sizeof(null_shader), MEMORY_TAG_RENDERER);
+    return true;
+}
+
+void null_renderer_shader_destroy(shader* s) {
+    if (s && s->internal_data) {
+        kfree(s->internal_data, sizeof(null_shader), MEMORY_TAG_RENDERER);
+        s->internal_data = 0;
+    }
+}
+
+b8 null_renderer_shader_initialize(shader* s) {
+    // Lay out uniform buffer space as a GPU backend would, so offsets seen by the frontend are realistic.
+    s->required_ubo_alignment = NULL_UBO_ALIGNMENT;
+    s->global_ubo_stride = get_aligned(s->global_ubo_size, s->required_ubo_alignment);
+    s->ubo_stride = get_aligned(s->ubo_size, s->required_ubo_alignment);
+    s->global_ubo_offset = 0;
+    return true;
+}
+
+b8 null_renderer_shader_use(shader* s) {
+    state.current.shader_use_count++;
+    return true;
+}
+
+b8 null_renderer_shader_bind_globals(shader* s) {
+    if (!s) {
+        return false;
+    }
+    state.current.shader_bind_count++;
+    s->bound_ubo_offset = s->global_ubo_offset;
+    return true;
+}
+
+b8 null_renderer_shader_bind_instance(shader* s, u32 instance_id) {
+    if (!s) {
+        KERROR("null_renderer_shader_bind_instance requires a valid pointer to a shader.");
+        return false;
+    }
+    state.current.shader_bind_count++;
+    s->bound_instance_id = instance_id;
+    s->bound_ubo_offset = s->global_ubo_stride + instance_id * s->ubo_stride;
+    return true;
+}
+
+b8 null_renderer_shader_apply_globals(shader* s) {
+    state.current.shader_apply_count++;
+    return true;
+}
+
+b8 null_renderer_shader_apply_instance(shader* s, b8 needs_update) {
+    state.current.shader_apply_count++;
+    return true;
+}
+
+b8 null_renderer_shader_acquire_instance_resources(shader* s, texture_map** maps, u32* out_instance_id) {
+    null_shader* internal = s->internal_data;
+    *out_instance_id = INVALID_ID;
+    for (u32 i = 0; i < NULL_MAX_MATERIAL_COUNT; ++i) {
+        if (!internal->instances_used[i]) {
+            internal->instances_used[i] = true;
+            *out_instance_id = i;
+            break;
+        }
+    }
+    if (*out_instance_id == INVALID_ID) {
+        KERROR("null_renderer_shader_acquire_instance_resources failed to acquire new id");
+        return false;
+    }
+
+    // Set unassigned texture pointers to default until assigned, as the other backends do.
+    texture* default_texture = texture_system_get_default_texture();
+    for (u32 i = 0; i < s->instance_texture_count; ++i) {
+        if (!maps[i]->texture) {
+            maps[i]->texture = default_texture;
+        }
+    }
+    return true;
+}
+
+b8 null_renderer_shader_release_instance_resources(shader* s, u32 instance_id) {
+    null_shader* internal = s->internal_data;
+    if (instance_id >= NULL_MAX_MATERIAL_COUNT) {
+        return false;
+    }
+    internal->instances_used[instance_id] = false;
+    return true;
+}
+
+b8 null_renderer_set_uniform(shader* s, shader_uniform* uniform, const void* value) {
+    state.current.uniform_set_count++;
+    if (uniform->type == SHADER_UNIFORM_TYPE_SAMPLER) {
+        if (uniform->scope == SHADER_SCOPE_GLOBAL) {
+            s->global_texture_maps[uniform->location] = (texture_map*)value;
+        }
+    } else {
+        state.current.uniform_bytes += uniform->size;
+    }
+    return true;
+}
+
+b8 null_renderer_texture_map_acquire_resources(texture_map* map) {
+    map->internal_data = 0;
+    return true;
+}
+
+void null_renderer_texture_map_release_resources(texture_map* map) {
+    if (map) {
+        map->internal_data = 0;
+    }
+}
+
+void null_renderpass_create(renderpass* out_renderpass, f32 depth, u32 stencil, b8 has_prev_pass, b8 has_next_pass) {
+    out_renderpass->internal_data = 0;
+}
+
+void null_renderpass_destroy(renderpass* pass) {
+    if (pass) {
+        pass->internal_data = 0;
+    }
+}
+
+void null_renderer_render_target_create(u8 attachment_count, texture** attachments, renderpass* pass, u32 width, u32 height, render_target* out_target) {
+    // Kept the same as the other backends, since the frontend owns the attachment array.
+    out_target->attachment_count = attachment_count;
+    if (!out_target->attachments) {
+        out_target->attachments = kallocate(sizeof(texture*) * attachment_count, MEMORY_TAG_ARRAY);
+    }
+    kcopy_memory(out_target->attachments, attachments, sizeof(texture*) * attachment_count);
+    out_target->internal_framebuffer = 0;
+}
+
+void null_renderer_render_target_destroy(render_target* target, b8 free_internal_memory) {
+    if (target && free_internal_memory && target->attachments) {
+        kfree(target->attachments, sizeof(texture*) * target->attachment_count, MEMORY_TAG_ARRAY);
+        target->attachments = 0;
+        target->attachment_count = 0;
+    }
+}
+
+texture* null_renderer_window_attachment_get(u8 index) {
+    if (index >= NULL_WINDOW_RENDER_TARGET_COUNT) {
+        KFATAL("Attempting to get attachment index out of range: %d. Attachment count: %d", index, NULL_WINDOW_RENDER_TARGET_COUNT);
+        return 0;
+    }
+    return &state.window_attachments[index];
+}
+
+texture* null_renderer_depth_attachment_get() {
+    return &state.depth_attachment;
+}
+
+u8 null_renderer_window_attachment_index_get() {
+    return state.image_index;
+}
+
+b8 null_renderer_frame_stats_get(renderer_frame_stats* out_last_frame, renderer_frame_stats* out_totals) {
+    if (out_last_frame) {
+        *out_last_frame = state.last_frame;
+    }
+    if (out_totals) {
+        *out_totals = state.totals;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file null_backend.h
+ * @author Travis Vroman (travis@kohiengine.com)
+ * @brief This file contains the null implementation of the renderer backend.
+ * It makes no graphics API calls at all, and instead counts the calls made
+ * to it each frame. This allows the CPU cost of the renderer frontend and the
+ * systems built on it to be measured without a GPU or driver, e.g. when the
+ * platform layer is running headless.
+ * @version 1.0
+ * @date 2022-06-10
+ *
+ * @copyright Kohi Game Engine is Copyright (c) Travis Vroman 2021-2022
+ *
+ */
+
+#pragma once
+
+#include "renderer/renderer_backend.h"
+#include "resources/resource_types.h"
+
+struct shader;
+struct shader_uniform;
+
+KAPI b8 null_renderer_backend_initialize(renderer_backend* backend, const renderer_backend_config* config, u8* out_window_render_target_count);
+KAPI void null_renderer_backend_shutdown(renderer_backend* backend);
+void null_renderer_backend_on_resized(renderer_backend* backend, u16 width, u16 height);
+b8 null_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time);
+KAPI b8 null_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time);
+b8 null_renderer_begin_renderpass(struct renderer_backend* backend, renderpass* pass, render_target* target);
+b8 null_renderer_end_renderpass(struct renderer_backend* backend, renderpass* pass);
+renderpass* null_renderer_renderpass_get(const char* name);
+
+KAPI void null_renderer_draw_geometry(geometry_render_data data);
+KAPI void null_renderer_texture_create(const u8* pixels, texture* texture);
+void null_renderer_texture_destroy(texture* texture);
+void null_renderer_texture_create_writeable(texture* t);
+void null_renderer_texture_resize(texture* t, u32 new_width, u32 new_height);
+void null_renderer_texture_write_data(texture* t, u32 offset, u32 size, const u8* pixels);
+KAPI b8 null_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vertex_count, const void* vertices, u32 index_size, u32 index_count, const void* indices);
+KAPI void null_renderer_destroy_geometry(geometry* geometry);
+
+b8 null_renderer_shader_create(struct shader* shader, renderpass* pass, u8 stage_count, const char** stage_filenames, shader_stage* stages);
+void null_renderer_shader_destroy(struct shader* shader);
+
+b8 null_renderer_shader_initialize(struct shader* shader);
+b8 null_renderer_shader_use(struct shader* shader);
+b8 null_renderer_shader_bind_globals(struct shader* s);
+b8 null_renderer_shader_bind_instance(struct shader* s, u32 instance_id);
+b8 null_renderer_shader_apply_globals(struct shader* s);
+b8 null_renderer_shader_apply_instance(struct shader* s, b8 needs_update);
+b8 null_renderer_shader_acquire_instance_resources(struct shader* s, texture_map** maps, u32* out_instance_id);
+b8 null_renderer_shader_release_instance_resources(struct shader* s, u32 instance_id);
+b8 null_renderer_set_uniform(struct shader* frontend_shader, struct shader_uniform* uniform, const void* value);
+
+b8 null_renderer_texture_map_acquire_resources(texture_map* map);
+void null_renderer_texture_map_release_resources(texture_map* map);
+
+void null_renderpass_create(renderpass* out_renderpass, f32 depth, u32 stencil, b8 has_prev_pass, b8 has_next_pass);
+void null_renderpass_destroy(renderpass* pass);
+
+void null_renderer_render_target_create(u8 attachment_count, texture** attachments, renderpass* pass, u32 width, u32 height, render_target* out_target);
+void null_renderer_render_target_destroy(render_target* target, b8 free_internal_memory);
+
+texture* null_renderer_window_attachment_get(u8 index);
+texture* null_renderer_depth_attachment_get();
+u8 null_renderer_window_attachment_index_get();
+
+KAPI b8 null_renderer_frame_stats_get(renderer_frame_stats* out_last_frame, renderer_frame_stats* out_totals);
@@ -1,6 +1,7 @@
 #include "renderer_backend.h"
 
 #include "vulkan/vulkan_backend.h"
+#include "null/null_backend.h"
 #include "core/kmemory.h"
 
 b8 renderer_backend_create(renderer_backend_type type, renderer_backend* out_renderer_backend) {
@@ -46,6 +47,55 @@ b8 renderer_backend_create(renderer_backend_type type, renderer_backend* out_ren
         out_renderer_backend->window_attachment_get = vulkan_renderer_window_attachment_get;
         out_renderer_backend->depth_attachment_get = vulkan_renderer_depth_attachment_get;
         out_renderer_backend->window_attachment_index_get = vulkan_renderer_window_attachment_index_get;
+        out_renderer_backend->frame_stats_get = 0;
+        out_renderer_backend->present_timing_take = vulkan_renderer_present_timing_take;
+
+        return true;
+    } else if (type == RENDERER_BACKEND_TYPE_NULL) {
+        out_renderer_backend->initialize = null_renderer_backend_initialize;
+        out_renderer_backend->shutdown = null_renderer_backend_shutdown;
+        out_renderer_backend->begin_frame = null_renderer_backend_begin_frame;
+        out_renderer_backend->end_frame = null_renderer_backend_end_frame;
+        out_renderer_backend->begin_renderpass = null_renderer_begin_renderpass;
+        out_renderer_backend->end_renderpass = null_renderer_end_renderpass;
+        out_renderer_backend->resized = null_renderer_backend_on_resized;
+        out_renderer_backend->draw_geometry = null_renderer_draw_geometry;
+        out_renderer_backend->texture_create = null_renderer_texture_create;
+        out_renderer_backend->texture_destroy = null_renderer_texture_destroy;
+        out_renderer_backend->texture_create_writeable = null_renderer_texture_create_writeable;
+        out_renderer_backend->texture_resize = null_renderer_texture_resize;
+        out_renderer_backend->texture_write_data = null_renderer_texture_write_data;
+        out_renderer_backend->create_geometry = null_renderer_create_geometry;
+        out_renderer_backend->destroy_geometry = null_renderer_destroy_geometry;
+
+        out_renderer_backend->shader_create = null_renderer_shader_create;
+        out_renderer_backend->shader_destroy = null_renderer_shader_destroy;
+        out_renderer_backend->shader_set_uniform = null_renderer_set_uniform;
+        out_renderer_backend->shader_initialize = null_renderer_shader_initialize;
+        out_renderer_backend->shader_use = null_renderer_shader_use;
+        out_renderer_backend->shader_bind_globals = null_renderer_shader_bind_globals;
+        out_renderer_backend->shader_bind_instance = null_renderer_shader_bind_instance;
+
+        out_renderer_backend->shader_apply_globals = null_renderer_shader_apply_globals;
+        out_renderer_backend->shader_apply_instance = null_renderer_shader_apply_instance;
+        out_renderer_backend->shader_acquire_instance_resources = null_renderer_shader_acquire_instance_resources;
+        out_renderer_backend->shader_release_instance_resources = null_renderer_shader_release_instance_resources;
+
+        out_renderer_backend->texture_map_acquire_resources = null_renderer_texture_map_acquire_resources;
+        out_renderer_backend->texture_map_release_resources = null_renderer_texture_map_release_resources;
+
+        out_renderer_backend->render_target_create = null_renderer_render_target_create;
+        out_renderer_backend->render_target_destroy = null_renderer_render_target_destroy;
+
+        out_renderer_backend->renderpass_create = null_renderpass_create;
+        out_renderer_backend->renderpass_destroy = null_renderpass_destroy;
+        out_renderer_backend->renderpass_get = null_renderer_renderpass_get;
+        out_renderer_backend->window_attachment_get = null_renderer_window_attachment_get;
+        out_renderer_backend->depth_attachment_get = null_renderer_depth_attachment_get;
+        out_renderer_backend->window_attachment_index_get = null_renderer_window_attachment_index_get;
+        out_renderer_backend->frame_stats_get = null_renderer_frame_stats_get;
+        // Nothing is ever displayed.
+        out_renderer_backend->present_timing_take = 0;
 
         return true;
     }
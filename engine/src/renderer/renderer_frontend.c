@@ -4,6 +4,8 @@
 
 #include "core/logger.h"
 #include "core/kmemory.h"
+#include "core/profiler.h"
+#include "platform/platform.h"
 #include "math/kmath.h"
 
 #include "resources/resource_types.h"
@@ -11,6 +13,7 @@
 #include "systems/texture_system.h"
 #include "systems/material_system.h"
 #include "systems/shader_system.h"
+#include "systems/geometry_system.h"
 
 // TODO: temporary
 #include "core/kstring.h"
@@ -18,6 +21,16 @@
 
 // TODO: end temporary
 
+// The number of presented frames whose input time is kept, to be matched with display times.
+#define RENDERER_PRESENTED_INPUT_COUNT 16
+
+typedef struct presented_input {
+    // The lower 32 bits of the frame number, which is how backends identify presents.
+    u32 frame_number;
+    // The absolute time of the latest input event shown by the frame.
+    f64 input_time;
+} presented_input;
+
 typedef struct renderer_system_state {
     renderer_backend backend;
     mat4 projection;
@@ -47,12 +60,41 @@ typedef struct renderer_system_state {
     // The current number of frames since the last resize operation.'
     // Only set if resizing = true. Otherwise 0.
     u8 frames_since_resize;
+    // The latest input time of packets not yet presented, such as those skipped while resizing. 0 if none.
+    f64 pending_input_time;
+    // The input-to-present latency of the last presented frame, or 0 if it had no new input.
+    f64 last_present_latency;
+    // A ring of the input times of recently presented frames.
+    presented_input presented_inputs[RENDERER_PRESENTED_INPUT_COUNT];
+    u32 presented_input_index;
+    // Scratch space for the index ranges of a geometry's meshlets which survive culling.
+    geometry_index_range* meshlet_ranges;
+    u32 meshlet_range_capacity;
 } renderer_system_state;
 
 static renderer_system_state* state_ptr;
 
 void regenerate_render_targets();
 
+static void draw_visible_meshlets(geometry_render_data data, const mat4* view_projection) {
+    geometry* g = data.geometry;
+    if (g->meshlet_count > state_ptr->meshlet_range_capacity) {
+        if (state_ptr->meshlet_ranges) {
+            kfree(state_ptr->meshlet_ranges, sizeof(geometry_index_range) * state_ptr->meshlet_range_capacity, MEMORY_TAG_RENDERER);
+        }
+        state_ptr->meshlet_range_capacity = g->meshlet_count;
+        state_ptr->meshlet_ranges = kallocate(sizeof(geometry_index_range) * state_ptr->meshlet_range_capacity, MEMORY_TAG_RENDERER);
+    }
+
+    // Each run of surviving meshlets is one draw of its range of indices.
+    u32 range_count = geometry_system_cull_meshlets(g, &data.model, view_projection, state_ptr->view_position, state_ptr->meshlet_ranges);
+    for (u32 i = 0; i < range_count; ++i) {
+        data.index_offset = state_ptr->meshlet_ranges[i].index_offset;
+        data.index_count = state_ptr->meshlet_ranges[i].index_count;
+        state_ptr->backend.draw_geometry(data);
+    }
+}
+
 b8 renderer_on_event(u16 code, void* sender, void* listener_inst, event_context context) {
     switch (code) {
         case EVENT_CODE_SET_RENDER_MODE: {
@@ -86,7 +128,7 @@ b8 renderer_on_event(u16 code, void* sender, void* listener_inst, event_context
         return false;          \
     }
 
-b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name) {
+b8 renderer_system_initialize(u64* memory_requirement, void* state, renderer_system_config config) {
     *memory_requirement = sizeof(renderer_system_state);
     if (state == 0) {
         return true;
@@ -99,15 +141,18 @@ b8 renderer_system_initialize(u64* memory_requirement, void* state, const char*
     state_ptr->resizing = false;
     state_ptr->frames_since_resize = 0;
 
-    // TODO: make this configurable.
-    renderer_backend_create(RENDERER_BACKEND_TYPE_VULKAN, &state_ptr->backend);
+    if (!renderer_backend_create(config.backend_type, &state_ptr->backend)) {
+        KERROR("Renderer backend type %u is not supported.", config.backend_type);
+        return false;
+    }
     state_ptr->backend.frame_number = 0;
     state_ptr->render_mode = RENDERER_VIEW_MODE_DEFAULT;
 
     event_register(EVENT_CODE_SET_RENDER_MODE, state, renderer_on_event);
 
     renderer_backend_config renderer_config = {};
-    renderer_config.application_name = application_name;
+    renderer_config.application_name = config.application_name;
+    renderer_config.present_mode = config.present_mode;
     renderer_config.on_rendertarget_refresh_required = regenerate_render_targets;
 
     // Renderpasses. TODO: read config from file.
@@ -159,14 +204,14 @@ b8 renderer_system_initialize(u64* memory_requirement, void* state, const char*
 
     // Shaders
     resource config_resource;
-    shader_config* config = 0;
+    shader_config* shader_cfg = 0;
 
     // Builtin material shader.
     CRITICAL_INIT(
         resource_system_load(BUILTIN_SHADER_NAME_MATERIAL, RESOURCE_TYPE_SHADER, &config_resource),
         "Failed to load builtin material shader.");
-    config = (shader_config*)config_resource.data;
-    CRITICAL_INIT(shader_system_create(config), "Failed to load builtin material shader.");
+    shader_cfg = (shader_config*)config_resource.data;
+    CRITICAL_INIT(shader_system_create(shader_cfg), "Failed to load builtin material shader.");
     resource_system_unload(&config_resource);
     state_ptr->material_shader_id = shader_system_get_id(BUILTIN_SHADER_NAME_MATERIAL);
 
@@ -174,8 +219,8 @@ b8 renderer_system_initialize(u64* memory_requirement, void* state, const char*
     CRITICAL_INIT(
         resource_system_load(BUILTIN_SHADER_NAME_UI, RESOURCE_TYPE_SHADER, &config_resource),
         "Failed to load builtin UI shader.");
-    config = (shader_config*)config_resource.data;
-    CRITICAL_INIT(shader_system_create(config), "Failed to load builtin UI shader.");
+    shader_cfg = (shader_config*)config_resource.data;
+    CRITICAL_INIT(shader_system_create(shader_cfg), "Failed to load builtin UI shader.");
     resource_system_unload(&config_resource);
     state_ptr->ui_shader_id = shader_system_get_id(BUILTIN_SHADER_NAME_UI);
 
@@ -205,6 +250,12 @@ void renderer_system_shutdown(void* state) {
         }
 
         state_ptr->backend.shutdown(&state_ptr->backend);
+
+        if (state_ptr->meshlet_ranges) {
+            kfree(state_ptr->meshlet_ranges, sizeof(geometry_index_range) * state_ptr->meshlet_range_capacity, MEMORY_TAG_RENDERER);
+            state_ptr->meshlet_ranges = 0;
+            state_ptr->meshlet_range_capacity = 0;
+        }
     }
     state_ptr = 0;
 }
@@ -223,7 +274,14 @@ void renderer_on_resized(u16 width, u16 height) {
 }
 
 b8 renderer_draw_frame(render_packet* packet) {
+    PROFILE_SCOPE("renderer_draw_frame");
     state_ptr->backend.frame_number++;
+    state_ptr->last_present_latency = 0;
+
+    // Carry input over until a frame actually presents it.
+    if (packet->input_time > state_ptr->pending_input_time) {
+        state_ptr->pending_input_time = packet->input_time;
+    }
 
     // Make sure the window is not currently being resized by waiting a designated
     // number of frames after the last resize operation before performing the backend updates.
@@ -277,6 +335,7 @@ b8 renderer_draw_frame(render_packet* packet) {
         }
 
         // Draw geometries.
+        mat4 view_projection = mat4_mul(state_ptr->view, state_ptr->projection);
         u32 count = packet->geometry_count;
         for (u32 i = 0; i < count; ++i) {
             material* m = 0;
@@ -300,8 +359,19 @@ b8 renderer_draw_frame(render_packet* packet) {
             // Apply the locals
             material_system_apply_local(m, &packet->geometries[i].model);
 
-            // Draw it.
-            state_ptr->backend.draw_geometry(packet->geometries[i]);
+            // Draw it, with the level of detail its size on screen calls for. Up close, only the
+            // meshlets which are in view and facing the camera are drawn.
+            geometry_render_data* data = &packet->geometries[i];
+            u8 previous_lod = data->previous_lod ? *data->previous_lod : 0;
+            data->lod = geometry_system_select_lod(data->geometry, &data->model, state_ptr->view_position, state_ptr->projection.data[5], previous_lod);
+            if (data->previous_lod) {
+                *data->previous_lod = data->lod;
+            }
+            if (data->lod == 0 && data->geometry->meshlet_count > 0) {
+                draw_visible_meshlets(*data, &view_projection);
+            } else {
+                state_ptr->backend.draw_geometry(*data);
+            }
         }
 
         if (!state_ptr->backend.end_renderpass(&state_ptr->backend, state_ptr->world_renderpass)) {
@@ -361,17 +431,65 @@ b8 renderer_draw_frame(render_packet* packet) {
         // End UI renderpass
 
         // End the frame. If this fails, it is likely unrecoverable.
+        PROFILE_SCOPE("End frame");
         b8 result = state_ptr->backend.end_frame(&state_ptr->backend, packet->delta_time);
 
         if (!result) {
             KERROR("renderer_end_frame failed. Application shutting down...");
             return false;
         }
+
+        // The frame has been handed to the swapchain.
+        if (state_ptr->pending_input_time > 0) {
+            f64 input_time = state_ptr->pending_input_time;
+            state_ptr->last_present_latency = platform_get_absolute_time() - input_time;
+            state_ptr->pending_input_time = 0;
+
+            presented_input* presented = &state_ptr->presented_inputs[state_ptr->presented_input_index];
+            presented->frame_number = (u32)state_ptr->backend.frame_number;
+            presented->input_time = input_time;
+            state_ptr->presented_input_index = (state_ptr->presented_input_index + 1) % RENDERER_PRESENTED_INPUT_COUNT;
+        }
     }
 
     return true;
 }
 
+b8 renderer_present_latency_get(f64* out_seconds) {
+    if (!state_ptr || state_ptr->last_present_latency <= 0) {
+        return false;
+    }
+    *out_seconds = state_ptr->last_present_latency;
+    return true;
+}
+
+b8 renderer_display_latency_take(f64* out_seconds) {
+    if (!state_ptr || !state_ptr->backend.present_timing_take) {
+        return false;
+    }
+    u32 frame_number;
+    f64 display_time;
+    // Skip displayed frames which did not show new input.
+    while (state_ptr->backend.present_timing_take(&state_ptr->backend, &frame_number, &display_time)) {
+        for (u32 i = 0; i < RENDERER_PRESENTED_INPUT_COUNT; ++i) {
+            presented_input* presented = &state_ptr->presented_inputs[i];
+            if (presented->input_time > 0 && presented->frame_number == frame_number) {
+                *out_seconds = display_time - presented->input_time;
+                presented->input_time = 0;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+b8 renderer_frame_stats_get(renderer_frame_stats* out_last_frame, renderer_frame_stats* out_totals) {
+    if (!state_ptr || !state_ptr->backend.frame_stats_get) {
+        return false;
+    }
+    return state_ptr->backend.frame_stats_get(out_last_frame, out_totals);
+}
+
 void renderer_set_view(mat4 view, vec3 view_position) {
     state_ptr->view = view;
     state_ptr->view_position = view_position;
@@ -18,6 +18,16 @@
 struct shader;
 struct shader_uniform;
 
+/** @brief The configuration for the renderer system. */
+typedef struct renderer_system_config {
+    /** @brief The name of the application. */
+    const char* application_name;
+    /** @brief The requested present mode. */
+    renderer_present_mode present_mode;
+    /** @brief The type of backend to use. */
+    renderer_backend_type backend_type;
+} renderer_system_config;
+
 /**
  * @brief Initializes the renderer frontend/system. Should be called twice - once
  * to obtain the memory requirement (passing state=0), and a second time passing
@@ -25,10 +35,10 @@ struct shader_uniform;
  *
  * @param memory_requirement A pointer to hold the memory requirement for this system.
  * @param state A block of memory to hold state data, or 0 if obtaining memory requirement.
- * @param application_name The name of the application.
+ * @param config The configuration for the renderer system.
  * @return True on success; otherwise false.
  */
-b8 renderer_system_initialize(u64* memory_requirement, void* state, const char* application_name);
+b8 renderer_system_initialize(u64* memory_requirement, void* state, renderer_system_config config);
 
 /**
  * @brief Shuts the renderer system/frontend down.
@@ -53,6 +63,35 @@ void renderer_on_resized(u16 width, u16 height);
  */
 b8 renderer_draw_frame(render_packet* packet);
 
+/**
+ * @brief Obtains the call statistics of the renderer backend. Only backends which
+ * keep statistics support this, such as the null backend.
+ *
+ * @param out_last_frame A pointer to hold the stats of the last completed frame. Optional.
+ * @param out_totals A pointer to hold the stats accumulated over all completed frames. Optional.
+ * @return True if the backend keeps statistics; otherwise false.
+ */
+KAPI b8 renderer_frame_stats_get(renderer_frame_stats* out_last_frame, renderer_frame_stats* out_totals);
+
+/**
+ * @brief Obtains the time from the latest input event to the last drawn frame being handed
+ * to the swapchain for presentation.
+ *
+ * @param out_seconds A pointer to hold the latency in seconds.
+ * @return True if the last drawn frame presented new input; otherwise false.
+ */
+KAPI b8 renderer_present_latency_get(f64* out_seconds);
+
+/**
+ * @brief Takes the time from the latest input event to a previously presented frame actually
+ * being displayed, as reported by the backend. Display times arrive a few frames late, so this
+ * should be called repeatedly each frame until it returns false.
+ *
+ * @param out_seconds A pointer to hold the latency in seconds.
+ * @return True if a latency was taken; otherwise false, e.g. if the backend cannot report display times.
+ */
+KAPI b8 renderer_display_latency_take(f64* out_seconds);
+
 /**
  * @brief Sets the view matrix in the renderer. NOTE: exposed to public API.
  *
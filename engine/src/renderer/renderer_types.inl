@@ -13,12 +13,65 @@ struct shader_uniform;
 typedef enum renderer_backend_type {
     RENDERER_BACKEND_TYPE_VULKAN,
     RENDERER_BACKEND_TYPE_OPENGL,
-    RENDERER_BACKEND_TYPE_DIRECTX
+    RENDERER_BACKEND_TYPE_DIRECTX,
+    /** @brief Makes no graphics API calls, only counting them. Used for benchmarking and testing the frontend. */
+    RENDERER_BACKEND_TYPE_NULL
 } renderer_backend_type;
 
+/** @brief How rendered frames are presented to the window. */
+typedef enum renderer_present_mode {
+    /** @brief Let the backend decide. Prefers mailbox, falling back to fifo. */
+    RENDERER_PRESENT_MODE_DEFAULT = 0,
+    /** @brief Frames are queued and presented on vertical blank. Always available. Caps the frame rate to the display. */
+    RENDERER_PRESENT_MODE_FIFO = 1,
+    /** @brief Presented on vertical blank, but newer frames replace queued ones, so rendering is never blocked. */
+    RENDERER_PRESENT_MODE_MAILBOX = 2,
+    /** @brief Presented immediately, without waiting for vertical blank. May tear. */
+    RENDERER_PRESENT_MODE_IMMEDIATE = 3
+} renderer_present_mode;
+
+/** @brief Counts of the calls made to a renderer backend. */
+typedef struct renderer_frame_stats {
+    /** @brief The number of frames counted. */
+    u64 frame_count;
+    /** @brief The number of geometry draw calls. */
+    u64 draw_count;
+    /** @brief The number of indices drawn, or vertices for non-indexed geometry. */
+    u64 element_count;
+    /** @brief The number of renderpasses begun. */
+    u64 renderpass_count;
+    /** @brief The number of shaders put to use. */
+    u64 shader_use_count;
+    /** @brief The number of global and instance binds. */
+    u64 shader_bind_count;
+    /** @brief The number of global and instance applies. */
+    u64 shader_apply_count;
+    /** @brief The number of uniforms and samplers set. */
+    u64 uniform_set_count;
+    /** @brief The number of bytes of uniform data set. */
+    u64 uniform_bytes;
+    /** @brief The number of textures created, including writeable ones. */
+    u64 texture_create_count;
+    /** @brief The number of geometries created or reuploaded. */
+    u64 geometry_create_count;
+    /** @brief The number of bytes of texture and geometry data uploaded. */
+    u64 bytes_uploaded;
+} renderer_frame_stats;
+
 typedef struct geometry_render_data {
     mat4 model;
     geometry* geometry;
+    /** @brief The level of detail to draw. Levels past the geometry's lod_count draw it whole. */
+    u32 lod;
+    /**
+     * @brief Optional. Holds the level of detail selected for this draw last frame, to apply
+     * hysteresis from, and is updated with the one selected this frame.
+     */
+    u8* previous_lod;
+    /** @brief The first index of a range to draw instead of the level of detail. Used if index_count is nonzero. */
+    u32 index_offset;
+    /** @brief The number of indices in the range to draw, or 0 to draw the level of detail. */
+    u32 index_count;
 } geometry_render_data;
 
 typedef enum renderer_debug_view_mode {
@@ -103,6 +156,8 @@ typedef struct renderer_backend_config {
     renderpass_config* pass_configs;
     /** @brief A callback that will be made when the backend requires a refresh/regeneration of the render targets. */
     void (*on_rendertarget_refresh_required)();
+    /** @brief The requested present mode. If unavailable, the backend falls back to one which is. */
+    renderer_present_mode present_mode;
 } renderer_backend_config;
 
 
@@ -437,11 +492,39 @@ typedef struct renderer_backend {
      */
     u8 (*window_attachment_index_get)();
 
+    /**
+     * @brief Obtains the call statistics of the backend, if it keeps any. Optional; may be 0.
+     *
+     * @param out_last_frame A pointer to hold the stats of the last completed frame.
+     * @param out_totals A pointer to hold the stats accumulated over all completed frames.
+     * @return True if the backend keeps statistics; otherwise false.
+     */
+    b8 (*frame_stats_get)(renderer_frame_stats* out_last_frame, renderer_frame_stats* out_totals);
+
+    /**
+     * @brief Takes the next available present timing, which gives when a frame was actually
+     * displayed. Timings become available some frames after the frame was presented, and only
+     * if the backend supports present timing. Optional; may be 0.
+     *
+     * @param backend A pointer to the generic backend interface.
+     * @param out_frame_number A pointer to hold the lower 32 bits of the frame number of the displayed frame.
+     * @param out_display_time A pointer to hold the time the frame was displayed, in the time domain of platform_get_absolute_time().
+     * @return True if a timing was taken; otherwise false.
+     */
+    b8 (*present_timing_take)(struct renderer_backend* backend, u32* out_frame_number, f64* out_display_time);
+
 } renderer_backend;
 
 typedef struct render_packet {
     f32 delta_time;
 
+    /**
+     * @brief The time of the most recent input which this frame is the first to reflect,
+     * from platform_get_absolute_time(). 0 if there has been no input since the last frame.
+     * Used to measure input latency.
+     */
+    f64 input_time;
+
     u32 geometry_count;
     geometry_render_data* geometries;
 
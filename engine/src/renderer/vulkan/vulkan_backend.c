@@ -13,6 +13,7 @@
 #include "core/logger.h"
 #include "core/kstring.h"
 #include "core/kmemory.h"
+#include "core/profiler.h"
 
 #include "containers/darray.h"
 
@@ -42,8 +43,9 @@ b8 recreate_swapchain(renderer_backend* backend);
 b8 create_module(vulkan_shader* shader, vulkan_shader_stage_config config, vulkan_shader_stage* shader_stage);
 
 b8 upload_data_range(vulkan_context* context, VkCommandPool pool, VkFence fence, VkQueue queue, vulkan_buffer* buffer, u64* out_offset, u64 size, const void* data) {
-    // Allocate space in the buffer.
-    if (!vulkan_buffer_allocate(buffer, size, out_offset)) {
+    // Allocate space in the buffer. Ranges are kept 4-byte aligned so that 16- and 32-bit
+    // index data can share a buffer, as an index buffer must be bound at a multiple of its index size.
+    if (!vulkan_buffer_allocate(buffer, get_aligned(size, 4), out_offset)) {
         KERROR("upload_data_range failed to allocate from the given buffer!");
         return false;
     }
@@ -67,7 +69,7 @@ b8 upload_data_range(vulkan_context* context, VkCommandPool pool, VkFence fence,
 
 void free_data_range(vulkan_buffer* buffer, u64 offset, u64 size) {
     if (buffer) {
-        vulkan_buffer_free(buffer, size, offset);
+        vulkan_buffer_free(buffer, get_aligned(size, 4), offset);
     }
 }
 
@@ -79,6 +81,7 @@ b8 vulkan_renderer_backend_initialize(renderer_backend* backend, const renderer_
     context.allocator = 0;
 
     context.on_rendertarget_refresh_required = config->on_rendertarget_refresh_required;
+    context.requested_present_mode = config->present_mode;
 
     // Just set some default values for the framebuffer for now.
     // It doesn't really matyer what these are because they will be
@@ -386,6 +389,7 @@ void vulkan_renderer_backend_on_resized(renderer_backend* backend, u16 width, u1
 }
 
 b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time) {
+    PROFILE_SCOPE("vulkan_renderer_backend_begin_frame");
     context.frame_delta_time = delta_time;
     vulkan_device* device = &context.device;
 
@@ -419,7 +423,9 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
     }
 
     // Wait for the execution of the current frame to complete. The fence being free will allow this one to move on.
+    PROFILE_BEGIN(in_flight_fence_wait);
     VkResult result = vkWaitForFences(context.device.logical_device, 1, &context.in_flight_fences[context.current_frame], true, UINT64_MAX);
+    PROFILE_END(in_flight_fence_wait);
     if (!vulkan_result_is_success(result)) {
         KFATAL("In-flight fence wait failure! error: %s", vulkan_result_string(result, true));
         return false;
@@ -427,13 +433,16 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
 
     // Acquire the next image from the swap chain. Pass along the semaphore that should signaled when this completes.
     // This same semaphore will later be waited on by the queue submission to ensure this image is available.
-    if (!vulkan_swapchain_acquire_next_image_index(
-            &context,
-            &context.swapchain,
-            UINT64_MAX,
-            context.image_available_semaphores[context.current_frame],
-            0,
-            &context.image_index)) {
+    PROFILE_BEGIN(acquire_next_image);
+    b8 acquired = vulkan_swapchain_acquire_next_image_index(
+        &context,
+        &context.swapchain,
+        UINT64_MAX,
+        context.image_available_semaphores[context.current_frame],
+        0,
+        &context.image_index);
+    PROFILE_END(acquire_next_image);
+    if (!acquired) {
         KERROR("Failed to acquire next image index, booting.");
         return false;
     }
@@ -465,12 +474,14 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend* backend, f32 delta_time
 }
 
 b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time) {
+    PROFILE_SCOPE("vulkan_renderer_backend_end_frame");
     vulkan_command_buffer* command_buffer = &context.graphics_command_buffers[context.image_index];
 
     vulkan_command_buffer_end(command_buffer);
 
     // Make sure the previous frame is not using this image (i.e. its fence is being waited on)
     if (context.images_in_flight[context.image_index] != VK_NULL_HANDLE) {  // was frame
+        PROFILE_SCOPE("Image fence wait");
         VkResult result = vkWaitForFences(context.device.logical_device, 1, &context.images_in_flight[context.image_index], true, UINT64_MAX);
         if (!vulkan_result_is_success(result)) {
             KFATAL("vkWaitForFences error: %s", vulkan_result_string(result, true));
@@ -505,11 +516,13 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time)
     VkPipelineStageFlags flags[1] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     submit_info.pWaitDstStageMask = flags;
 
+    PROFILE_BEGIN(queue_submit);
     VkResult result = vkQueueSubmit(
         context.device.graphics_queue,
         1,
         &submit_info,
         context.in_flight_fences[context.current_frame]);
+    PROFILE_END(queue_submit);
     if (result != VK_SUCCESS) {
         KERROR("vkQueueSubmit failed with result: %s", vulkan_result_string(result, true));
         return false;
@@ -519,13 +532,15 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend* backend, f32 delta_time)
     // End queue submission
 
     // Give the image back to the swapchain.
+    PROFILE_SCOPE("Present");
     vulkan_swapchain_present(
         &context,
         &context.swapchain,
         context.device.graphics_queue,
         context.device.present_queue,
         context.queue_complete_semaphores[context.current_frame],
-        context.image_index);
+        context.image_index,
+        (u32)backend->frame_number);
 
     return true;
 }
@@ -722,8 +737,8 @@ b8 recreate_swapchain(renderer_backend* backend) {
 b8 create_buffers(vulkan_context* context) {
     VkMemoryPropertyFlagBits memory_property_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-    // Geometry vertex buffer
-    const u64 vertex_buffer_size = sizeof(vertex_3d) * 1024 * 1024;
+    // Geometry vertex buffer, sized for a million of the packed vertices 3D geometry is uploaded as.
+    const u64 vertex_buffer_size = sizeof(vertex_3d_packed) * 1024 * 1024;
     if (!vulkan_buffer_create(
             context,
             vertex_buffer_size,
@@ -918,6 +933,11 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
         return false;
     }
 
+    if (index_count && index_size != sizeof(u16) && index_size != sizeof(u32)) {
+        KERROR("vulkan_renderer_create_geometry requires 16- or 32-bit indices. index_size=%u", index_size);
+        return false;
+    }
+
     // Check if this is a re-upload. If it is, need to free old data afterward.
     b8 is_reupload = geometry->internal_id != INVALID_ID;
     vulkan_geometry_data old_range;
@@ -954,7 +974,7 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
 
     // Vertex data.
     internal_data->vertex_count = vertex_count;
-    internal_data->vertex_element_size = sizeof(vertex_3d);
+    internal_data->vertex_element_size = vertex_size;
     u32 total_size = vertex_count * vertex_size;
     if (!upload_data_range(
             &context,
@@ -972,7 +992,7 @@ b8 vulkan_renderer_create_geometry(geometry* geometry, u32 vertex_size, u32 vert
     // Index data, if applicable
     if (index_count && indices) {
         internal_data->index_count = index_count;
-        internal_data->index_element_size = sizeof(u32);
+        internal_data->index_element_size = index_size;
         total_size = index_count * index_size;
         if (!upload_data_range(
                 &context,
@@ -1043,10 +1063,17 @@ void vulkan_renderer_draw_geometry(geometry_render_data data) {
     // Draw indexed or non-indexed.
     if (buffer_data->index_count > 0) {
         // Bind index buffer at offset.
-        vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, buffer_data->index_buffer_offset, VK_INDEX_TYPE_UINT32);
-
-        // Issue the draw.
-        vkCmdDrawIndexed(command_buffer->handle, buffer_data->index_count, 1, 0, 0, 0);
+        vkCmdBindIndexBuffer(command_buffer->handle, context.object_index_buffer.handle, buffer_data->index_buffer_offset, buffer_data->index_element_size == sizeof(u16) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+
+        // Issue the draw, of just the given range or level of detail if there is one.
+        if (data.index_count > 0) {
+            vkCmdDrawIndexed(command_buffer->handle, data.index_count, 1, data.index_offset, 0, 0);
+        } else if (data.lod < data.geometry->lod_count) {
+            geometry_lod* lod = &data.geometry->lods[data.lod];
+            vkCmdDrawIndexed(command_buffer->handle, lod->index_count, 1, lod->index_offset, 0, 0);
+        } else {
+            vkCmdDrawIndexed(command_buffer->handle, buffer_data->index_count, 1, 0, 0, 0);
+        }
     } else {
         vkCmdDraw(command_buffer->handle, buffer_data->vertex_count, 1, 0, 0);
     }
@@ -1243,7 +1270,7 @@ b8 vulkan_renderer_shader_initialize(shader* shader) {
 
     // Static lookup table for our types->Vulkan ones.
     static VkFormat* types = 0;
-    static VkFormat t[11];
+    static VkFormat t[14];
     if (!types) {
         t[SHADER_ATTRIB_TYPE_FLOAT32] = VK_FORMAT_R32_SFLOAT;
         t[SHADER_ATTRIB_TYPE_FLOAT32_2] = VK_FORMAT_R32G32_SFLOAT;
@@ -1255,6 +1282,9 @@ b8 vulkan_renderer_shader_initialize(shader* shader) {
         t[SHADER_ATTRIB_TYPE_UINT16] = VK_FORMAT_R16_UINT;
         t[SHADER_ATTRIB_TYPE_INT32] = VK_FORMAT_R32_SINT;
         t[SHADER_ATTRIB_TYPE_UINT32] = VK_FORMAT_R32_UINT;
+        t[SHADER_ATTRIB_TYPE_FLOAT16_2] = VK_FORMAT_R16G16_SFLOAT;
+        t[SHADER_ATTRIB_TYPE_SNORM16_4] = VK_FORMAT_R16G16B16A16_SNORM;
+        t[SHADER_ATTRIB_TYPE_UNORM8_4] = VK_FORMAT_R8G8B8A8_UNORM;
         types = t;
     }
 
@@ -1981,4 +2011,35 @@ texture* vulkan_renderer_depth_attachment_get() {
 }
 u8 vulkan_renderer_window_attachment_index_get() {
     return (u8)context.image_index;
-}
\ No newline at end of file
+}
+
+b8 vulkan_renderer_present_timing_take(renderer_backend* backend, u32* out_frame_number, f64* out_display_time) {
+    if (!context.device.supports_display_timing) {
+        return false;
+    }
+
+    // Refill the cache once everything queried previously has been taken.
+    if (context.past_presentation_timing_index >= context.past_presentation_timing_count) {
+        context.past_presentation_timing_index = 0;
+        context.past_presentation_timing_count = VULKAN_MAX_PAST_PRESENTATION_TIMINGS;
+        VkResult result = context.device.get_past_presentation_timing(
+            context.device.logical_device,
+            context.swapchain.handle,
+            &context.past_presentation_timing_count,
+            context.past_presentation_timings);
+        // Incomplete just means more are available, which are picked up by the next refill.
+        if (result != VK_SUCCESS && result != VK_INCOMPLETE) {
+            context.past_presentation_timing_count = 0;
+            return false;
+        }
+        if (context.past_presentation_timing_count == 0) {
+            return false;
+        }
+    }
+
+    VkPastPresentationTimingGOOGLE* timing = &context.past_presentation_timings[context.past_presentation_timing_index++];
+    *out_frame_number = timing->presentID;
+    // Reported in nanoseconds, in the same clock domain as the platform's absolute time.
+    *out_display_time = (f64)timing->actualPresentTime / 1000000000.0;
+    return true;
+}
@@ -62,3 +62,5 @@ void vulkan_renderer_render_target_destroy(render_target* target, b8 free_intern
 texture* vulkan_renderer_window_attachment_get(u8 index);
 texture* vulkan_renderer_depth_attachment_get();
 u8 vulkan_renderer_window_attachment_index_get();
+
+b8 vulkan_renderer_present_timing_take(renderer_backend* backend, u32* out_frame_number, f64* out_display_time);
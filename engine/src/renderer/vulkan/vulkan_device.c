@@ -80,6 +80,7 @@ b8 vulkan_device_create(vulkan_context* context) {
     device_features.samplerAnisotropy = VK_TRUE;  // Request anistrophy
 
     b8 portability_required = false;
+    b8 display_timing_available = false;
     u32 available_extension_count = 0;
     VkExtensionProperties* available_extensions = 0;
     VK_CHECK(vkEnumerateDeviceExtensionProperties(context->device.physical_device, 0, &available_extension_count, 0));
@@ -90,16 +91,31 @@ b8 vulkan_device_create(vulkan_context* context) {
             if (strings_equal(available_extensions[i].extensionName, "VK_KHR_portability_subset")) {
                 KINFO("Adding required extension 'VK_KHR_portability_subset'.");
                 portability_required = true;
-                break;
+            } else if (strings_equal(available_extensions[i].extensionName, VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME)) {
+                display_timing_available = true;
             }
         }
     }
     kfree(available_extensions, sizeof(VkExtensionProperties) * available_extension_count, MEMORY_TAG_RENDERER);
 
-    u32 extension_count = portability_required ? 2 : 1;
-    const char** extension_names = portability_required
-                                       ? (const char* [2]){VK_KHR_SWAPCHAIN_EXTENSION_NAME, "VK_KHR_portability_subset"}
-                                       : (const char* [1]){VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    u32 extension_count = 0;
+    const char* extension_names[3];
+    extension_names[extension_count++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    if (portability_required) {
+        extension_names[extension_count++] = "VK_KHR_portability_subset";
+    }
+#if KPLATFORM_LINUX
+    // Display times are reported in the CLOCK_MONOTONIC domain on Linux, which is the same
+    // clock as the platform's absolute time, so they can be compared with input times.
+    context->device.supports_display_timing = display_timing_available;
+    if (display_timing_available) {
+        KINFO("Adding optional extension '%s'.", VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+        extension_names[extension_count++] = VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME;
+    }
+#else
+    (void)display_timing_available;
+    context->device.supports_display_timing = false;
+#endif
     VkDeviceCreateInfo device_create_info = {VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
     device_create_info.queueCreateInfoCount = index_count;
     device_create_info.pQueueCreateInfos = queue_create_infos;
@@ -120,6 +136,15 @@ b8 vulkan_device_create(vulkan_context* context) {
 
     KINFO("Logical device created.");
 
+    if (context->device.supports_display_timing) {
+        context->device.get_past_presentation_timing = (PFN_vkGetPastPresentationTimingGOOGLE)vkGetDeviceProcAddr(
+            context->device.logical_device, "vkGetPastPresentationTimingGOOGLE");
+        if (!context->device.get_past_presentation_timing) {
+            KWARN("Failed to load vkGetPastPresentationTimingGOOGLE. Display timing will be unavailable.");
+            context->device.supports_display_timing = false;
+        }
+    }
+
     // Get queues.
     vkGetDeviceQueue(
         context->device.logical_device,
@@ -71,7 +71,8 @@ void vulkan_swapchain_present(
     VkQueue graphics_queue,
     VkQueue present_queue,
     VkSemaphore render_complete_semaphore,
-    u32 present_image_index) {
+    u32 present_image_index,
+    u32 present_id) {
     // Return the image to the swapchain for presentation.
     VkPresentInfoKHR present_info = {VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
     present_info.waitSemaphoreCount = 1;
@@ -81,6 +82,16 @@ void vulkan_swapchain_present(
     present_info.pImageIndices = &present_image_index;
     present_info.pResults = 0;
 
+    // Tag the presentation so its actual display time can be queried later.
+    // A desired present time of 0 presents as soon as possible, as usual.
+    VkPresentTimeGOOGLE present_time = {present_id, 0};
+    VkPresentTimesInfoGOOGLE present_times_info = {VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE};
+    if (context->device.supports_display_timing) {
+        present_times_info.swapchainCount = 1;
+        present_times_info.pTimes = &present_time;
+        present_info.pNext = &present_times_info;
+    }
+
     VkResult result = vkQueuePresentKHR(present_queue, &present_info);
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
         // Swapchain is out of date, suboptimal or a framebuffer resize has occurred. Trigger swapchain recreation.
@@ -114,14 +125,33 @@ void create(vulkan_context* context, u32 width, u32 height, vulkan_swapchain* sw
         swapchain->image_format = context->device.swapchain_support.formats[0];
     }
 
+    // FIFO is the only mode which is required to be supported, so is the fallback.
     VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR;
+    VkPresentModeKHR requested_mode;
+    switch (context->requested_present_mode) {
+        case RENDERER_PRESENT_MODE_FIFO:
+            requested_mode = VK_PRESENT_MODE_FIFO_KHR;
+            break;
+        case RENDERER_PRESENT_MODE_IMMEDIATE:
+            requested_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            break;
+        case RENDERER_PRESENT_MODE_MAILBOX:
+        case RENDERER_PRESENT_MODE_DEFAULT:
+        default:
+            requested_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+    }
+    b8 present_mode_found = false;
     for (u32 i = 0; i < context->device.swapchain_support.present_mode_count; ++i) {
-        VkPresentModeKHR mode = context->device.swapchain_support.present_modes[i];
-        if (mode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            present_mode = mode;
+        if (context->device.swapchain_support.present_modes[i] == requested_mode) {
+            present_mode = requested_mode;
+            present_mode_found = true;
             break;
         }
     }
+    if (!present_mode_found && context->requested_present_mode != RENDERER_PRESENT_MODE_DEFAULT) {
+        KWARN("Requested present mode is not supported by the device. Falling back to FIFO.");
+    }
 
     // Requery swapchain support.
     vulkan_device_query_swapchain_support(
@@ -83,6 +83,7 @@ b8 vulkan_swapchain_acquire_next_image_index(
  * @param present_queue The presentation queue used for presentation.
  * @param render_complete_semaphore The semaphore that will be signaled when the presentation is complete.
  * @param present_image_index The image index to present.
+ * @param present_id An identifier for this presentation, reported back with its display time if display timing is supported.
  */
 void vulkan_swapchain_present(
     vulkan_context* context,
@@ -90,4 +91,5 @@ void vulkan_swapchain_present(
     VkQueue graphics_queue,
     VkQueue present_queue,
     VkSemaphore render_complete_semaphore,
-    u32 present_image_index);
+    u32 present_image_index,
+    u32 present_id);
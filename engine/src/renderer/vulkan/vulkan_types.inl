@@ -116,6 +116,14 @@ typedef struct vulkan_device {
     VkFormat depth_format;
     /** @brief The chosen depth format's number of channels.*/
     u8 depth_channel_count;
+
+    /**
+     * @brief Indicates if VK_GOOGLE_display_timing is enabled, so the actual display time of
+     * presented frames can be queried. Only enabled where its times share the platform clock's time domain.
+     */
+    b8 supports_display_timing;
+    /** @brief The function to query past display times. Only loaded if display timing is supported. */
+    PFN_vkGetPastPresentationTimingGOOGLE get_past_presentation_timing;
 } vulkan_device;
 
 /**
@@ -458,6 +466,9 @@ typedef struct vulkan_shader {
 
 #define VULKAN_MAX_REGISTERED_RENDERPASSES 31
 
+/** @brief The maximum number of past presentation timings queried from the swapchain at once. */
+#define VULKAN_MAX_PAST_PRESENTATION_TIMINGS 16
+
 /**
  * @brief The overall Vulkan context for the backend. Holds and maintains
  * global renderer backend state, Vulkan instance, etc.
@@ -533,6 +544,16 @@ typedef struct vulkan_context {
     /** @brief Indicates if the swapchain is currently being recreated. */
     b8 recreating_swapchain;
 
+    /** @brief The present mode requested in the renderer config. */
+    renderer_present_mode requested_present_mode;
+
+    /** @brief Display times queried from the swapchain, which have not yet been taken. */
+    VkPastPresentationTimingGOOGLE past_presentation_timings[VULKAN_MAX_PAST_PRESENTATION_TIMINGS];
+    /** @brief The number of past presentation timings queried. */
+    u32 past_presentation_timing_count;
+    /** @brief The index of the next past presentation timing to be taken. */
+    u32 past_presentation_timing_index;
+
     /** @brief The A collection of loaded geometries. @todo TODO: make dynamic */
     vulkan_geometry_data geometries[VULKAN_MAX_GEOMETRY_COUNT];
 
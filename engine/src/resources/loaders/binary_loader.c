@@ -3,6 +3,7 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "core/profiler.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
 #include "math/kmath.h"
@@ -11,6 +12,7 @@
 #include "loader_utils.h"
 
 b8 binary_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
+    PROFILE_SCOPE("binary_loader_load");
     if (!self || !name || !out_resource) {
         return false;
     }
@@ -19,41 +21,32 @@ b8 binary_loader_load(struct resource_loader* self, const char* name, resource*
     char full_file_path[512];
     string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, "");
 
-    file_handle f;
-    if (!filesystem_open(full_file_path, FILE_MODE_READ, true, &f)) {
-        KERROR("binary_loader_load - unable to open file for binary reading: '%s'.", full_file_path);
+    // Map the file rather than reading it, so the contents can be consumed without a copy.
+    file_mapping mapping;
+    if (!filesystem_map(full_file_path, FILE_MAP_HINT_SEQUENTIAL | FILE_MAP_HINT_WILL_NEED, &mapping)) {
+        KERROR("binary_loader_load - unable to map file for binary reading: '%s'.", full_file_path);
         return false;
     }
 
     // TODO: Should be using an allocator here.
     out_resource->full_path = string_duplicate(full_file_path);
 
-    u64 file_size = 0;
-    if (!filesystem_size(&f, &file_size)) {
-        KERROR("Unable to binary read file: %s.", full_file_path);
-        filesystem_close(&f);
-        return false;
-    }
-
-    // TODO: Should be using an allocator here.
-    u8* resource_data = kallocate(sizeof(u8) * file_size, MEMORY_TAG_ARRAY);
-    u64 read_size = 0;
-    if (!filesystem_read_all_bytes(&f, resource_data, &read_size)) {
-        KERROR("Unable to binary read file: %s.", full_file_path);
-        filesystem_close(&f);
-        return false;
-    }
-
-    filesystem_close(&f);
-
-    out_resource->data = resource_data;
-    out_resource->data_size = read_size;
+    // NOTE: The data is read-only, and must not be modified by the consumer.
+    out_resource->data = (void*)mapping.data;
+    out_resource->data_size = mapping.size;
     out_resource->name = name;
 
     return true;
 }
 
 void binary_loader_unload(struct resource_loader* self, resource* resource) {
+    if (resource) {
+        // The data is a mapped view, not an allocation.
+        file_mapping mapping = {resource->data, resource->data_size};
+        filesystem_unmap(&mapping);
+        resource->data = 0;
+        resource->data_size = 0;
+    }
     if (!resource_unload(self, resource, MEMORY_TAG_ARRAY)) {
         KWARN("binary_loader_unload called with nullptr for self or resource.");
     }
@@ -65,6 +58,8 @@ resource_loader binary_resource_loader_create() {
     loader.custom_type = 0;
     loader.load = binary_loader_load;
     loader.unload = binary_loader_unload;
+    loader.resolve_path = 0;
+    loader.load_from_memory = 0;
     loader.type_path = "";
 
     return loader;
@@ -3,6 +3,7 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "core/profiler.h"
 #include "platform/filesystem.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
@@ -13,32 +14,25 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "vendor/stb_image.h"
 
-b8 image_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
-    if (!self || !name || !out_resource) {
-        return false;
-    }
-
-    char* format_str = "%s/%s/%s%s";
-    const i32 required_channel_count = 4;
-    stbi_set_flip_vertically_on_load(true);
-    char full_file_path[512];
-
+b8 image_loader_resolve_path(struct resource_loader* self, const char* name, char* out_path) {
     // Try different extensions
     #define IMAGE_EXTENSION_COUNT 4
-    b8 found = false;
     char* extensions[IMAGE_EXTENSION_COUNT] = {".tga", ".png", ".jpg", ".bmp"};
     for (u32 i = 0; i < IMAGE_EXTENSION_COUNT; ++i) {
-        string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, extensions[i]);
-        if (filesystem_exists(full_file_path)) {
-            found = true;
-            break;
+        string_format(out_path, "%s/%s/%s%s", resource_system_base_path(), self->type_path, name, extensions[i]);
+        if (filesystem_exists(out_path)) {
+            return true;
         }
     }
+    return false;
+}
 
-    if (!found) {
-        KERROR("Image resource loader failed find file '%s' or with any supported extension.", full_file_path);
-        return false;
-    }
+/**
+ * @brief Decodes an image from the contents of its file, and fills out the resource.
+ */
+static b8 image_decode(const char* name, const char* full_file_path, const void* data, u64 size, resource* out_resource) {
+    const i32 required_channel_count = 4;
+    stbi_set_flip_vertically_on_load(true);
 
     i32 width;
     i32 height;
@@ -46,8 +40,9 @@ b8 image_loader_load(struct resource_loader* self, const char* name, resource* o
 
     // For now, assume 8 bits per channel, 4 channels.
     // TODO: extend this to make it configurable.
-    u8* data = stbi_load(
-        full_file_path,
+    u8* pixels = stbi_load_from_memory(
+        data,
+        (i32)size,
         &width,
         &height,
         &channel_count,
@@ -60,13 +55,13 @@ b8 image_loader_load(struct resource_loader* self, const char* name, resource* o
     //     // Clear the error so the next load doesn't fail.
     //     stbi__err(0, 0);
 
-    //     if (data) {
-    //         stbi_image_free(data);
+    //     if (pixels) {
+    //         stbi_image_free(pixels);
     //     }
     //     return false;
     // }
 
-    if (!data) {
+    if (!pixels) {
         KERROR("Image resource loader failed to load file '%s'.", full_file_path);
         return false;
     }
@@ -76,7 +71,7 @@ b8 image_loader_load(struct resource_loader* self, const char* name, resource* o
 
     // TODO: Should be using an allocator here.
     image_resource_data* resource_data = kallocate(sizeof(image_resource_data), MEMORY_TAG_TEXTURE);
-    resource_data->pixels = data;
+    resource_data->pixels = pixels;
     resource_data->width = width;
     resource_data->height = height;
     resource_data->channel_count = required_channel_count;
@@ -88,6 +83,36 @@ b8 image_loader_load(struct resource_loader* self, const char* name, resource* o
     return true;
 }
 
+b8 image_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
+    PROFILE_SCOPE("image_loader_load");
+    if (!self || !name || !out_resource) {
+        return false;
+    }
+
+    char full_file_path[RESOURCE_PATH_MAX_LENGTH];
+    if (!image_loader_resolve_path(self, name, full_file_path)) {
+        KERROR("Image resource loader failed find file '%s' or with any supported extension.", full_file_path);
+        return false;
+    }
+
+    // Decode straight from a mapped view of the file, rather than through stdio.
+    file_mapping mapping;
+    if (!filesystem_map(full_file_path, FILE_MAP_HINT_SEQUENTIAL | FILE_MAP_HINT_WILL_NEED, &mapping)) {
+        KERROR("Image resource loader failed to map file '%s'.", full_file_path);
+        return false;
+    }
+    b8 result = image_decode(name, full_file_path, mapping.data, mapping.size, out_resource);
+    filesystem_unmap(&mapping);
+    return result;
+}
+
+b8 image_loader_load_from_memory(struct resource_loader* self, const char* name, const char* full_path, void* data, u64 size, resource* out_resource) {
+    PROFILE_SCOPE("image_loader_load_from_memory");
+    b8 result = self && name && out_resource && image_decode(name, full_path, data, size, out_resource);
+    kfree(data, size, MEMORY_TAG_RESOURCE);
+    return result;
+}
+
 void image_loader_unload(struct resource_loader* self, resource* resource) {
     if (!resource_unload(self, resource, MEMORY_TAG_TEXTURE)) {
         KWARN("image_loader_unload called with nullptr for self or resource.");
@@ -100,6 +125,8 @@ resource_loader image_resource_loader_create() {
     loader.custom_type = 0;
     loader.load = image_loader_load;
     loader.unload = image_loader_unload;
+    loader.resolve_path = image_loader_resolve_path;
+    loader.load_from_memory = image_loader_load_from_memory;
     loader.type_path = "textures";
 
     return loader;
@@ -3,6 +3,7 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "core/profiler.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
 #include "math/kmath.h"
@@ -11,6 +12,7 @@
 #include "platform/filesystem.h"
 
 b8 material_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
+    PROFILE_SCOPE("material_loader_load");
     if (!self || !name || !out_resource) {
         return false;
     }
@@ -19,8 +21,9 @@ b8 material_loader_load(struct resource_loader* self, const char* name, resource
     char full_file_path[512];
     string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, ".kmt");
 
-    file_handle f;
-    if (!filesystem_open(full_file_path, FILE_MODE_READ, false, &f)) {
+    // The whole file is mapped and parsed in place through views, without copying each line.
+    file_mapping mapping;
+    if (!filesystem_map(full_file_path, FILE_MAP_HINT_SEQUENTIAL, &mapping)) {
         KERROR("material_loader_load - unable to open material file for reading: '%s'.", full_file_path);
         return false;
     }
@@ -40,78 +43,60 @@ b8 material_loader_load(struct resource_loader* self, const char* name, resource
     string_ncopy(resource_data->name, name, MATERIAL_NAME_MAX_LENGTH);
 
     // Read each line of the file.
-    char line_buf[512] = "";
-    char* p = &line_buf[0];
-    u64 line_length = 0;
-    u32 line_number = 1;
-    while (filesystem_read_line(&f, 511, &p, &line_length)) {
-        // Trim the string.
-        char* trimmed = string_trim(line_buf);
-
-        // Get the trimmed length.
-        line_length = string_length(trimmed);
+    string_view remaining = string_view_create_from_range(mapping.data, mapping.size);
+    string_view line;
+    u32 line_number = 0;
+    while (string_view_split_next(&remaining, '\n', &line)) {
+        line_number++;
+        // Trim the line.
+        line = string_view_trim(line);
 
         // Skip blank lines and comments.
-        if (line_length < 1 || trimmed[0] == '#') {
-            line_number++;
+        if (line.length < 1 || line.data[0] == '#') {
             continue;
         }
 
         // Split into var/value
-        i32 equal_index = string_index_of(trimmed, '=');
+        i64 equal_index = string_view_index_of(line, '=');
         if (equal_index == -1) {
-            KWARN("Potential formatting issue found in file '%s': '=' token not found. Skipping line %ui.", full_file_path, line_number);
-            line_number++;
+            KWARN("Potential formatting issue found in file '%s': '=' token not found. Skipping line %u.", full_file_path, line_number);
             continue;
         }
 
-        // Assume a max of 64 characters for the variable name.
-        char raw_var_name[64];
-        kzero_memory(raw_var_name, sizeof(char) * 64);
-        string_mid(raw_var_name, trimmed, 0, equal_index);
-        char* trimmed_var_name = string_trim(raw_var_name);
-
-        // Assume a max of 511-65 (446) for the max length of the value to account for the variable name and the '='.
-        char raw_value[446];
-        kzero_memory(raw_value, sizeof(char) * 446);
-        string_mid(raw_value, trimmed, equal_index + 1, -1);  // Read the rest of the line
-        char* trimmed_value = string_trim(raw_value);
+        string_view var_name = string_view_trim(string_view_mid(line, 0, (u64)equal_index));
+        string_view value = string_view_trim(string_view_mid(line, (u64)equal_index + 1, line.length));
 
         // Process the variable.
-        if (strings_equali(trimmed_var_name, "version")) {
+        if (string_view_equali(var_name, "version")) {
             // TODO: version
-        } else if (strings_equali(trimmed_var_name, "name")) {
-            string_ncopy(resource_data->name, trimmed_value, MATERIAL_NAME_MAX_LENGTH);
-        } else if (strings_equali(trimmed_var_name, "diffuse_map_name")) {
-            string_ncopy(resource_data->diffuse_map_name, trimmed_value, TEXTURE_NAME_MAX_LENGTH);
-        } else if (strings_equali(trimmed_var_name, "specular_map_name")) {
-            string_ncopy(resource_data->specular_map_name, trimmed_value, TEXTURE_NAME_MAX_LENGTH);
-        } else if (strings_equali(trimmed_var_name, "normal_map_name")) {
-            string_ncopy(resource_data->normal_map_name, trimmed_value, TEXTURE_NAME_MAX_LENGTH);
-        } else if (strings_equali(trimmed_var_name, "diffuse_colour")) {
+        } else if (string_view_equali(var_name, "name")) {
+            string_view_copy(resource_data->name, value, MATERIAL_NAME_MAX_LENGTH);
+        } else if (string_view_equali(var_name, "diffuse_map_name")) {
+            string_view_copy(resource_data->diffuse_map_name, value, TEXTURE_NAME_MAX_LENGTH);
+        } else if (string_view_equali(var_name, "specular_map_name")) {
+            string_view_copy(resource_data->specular_map_name, value, TEXTURE_NAME_MAX_LENGTH);
+        } else if (string_view_equali(var_name, "normal_map_name")) {
+            string_view_copy(resource_data->normal_map_name, value, TEXTURE_NAME_MAX_LENGTH);
+        } else if (string_view_equali(var_name, "diffuse_colour")) {
             // Parse the colour
-            if (!string_to_vec4(trimmed_value, &resource_data->diffuse_colour)) {
+            if (!string_view_to_f32_array(value, 4, resource_data->diffuse_colour.elements)) {
                 KWARN("Error parsing diffuse_colour in file '%s'. Using default of white instead.", full_file_path);
-                // NOTE: already assigned above, no need to have it here.
+                resource_data->diffuse_colour = vec4_one();
             }
-        } else if (strings_equali(trimmed_var_name, "shader")) {
+        } else if (string_view_equali(var_name, "shader")) {
             // Take a copy of the material name.
-            resource_data->shader_name = string_duplicate(trimmed_value);
-        } else if (strings_equali(trimmed_var_name, "shininess")) {
-            if(!string_to_f32(trimmed_value, &resource_data->shininess)) {
+            resource_data->shader_name = string_view_duplicate(value);
+        } else if (string_view_equali(var_name, "shininess")) {
+            if (!string_view_to_f32_array(value, 1, &resource_data->shininess)) {
                 KWARN("Error parsing shininess in file '%s'. Using default of 32.0 instead.", full_file_path);
                 resource_data->shininess = 32.0f;
             }
         }
 
         // TODO: more fields.
-
-        // Clear the line buffer.
-        kzero_memory(line_buf, sizeof(char) * 512);
-        line_number++;
     }
 
-    filesystem_close(&f);
+    filesystem_unmap(&mapping);
 
     out_resource->data = resource_data;
     out_resource->data_size = sizeof(material_config);
@@ -132,6 +117,8 @@ resource_loader material_resource_loader_create() {
     loader.custom_type = 0;
     loader.load = material_loader_load;
     loader.unload = material_loader_unload;
+    loader.resolve_path = 0;
+    loader.load_from_memory = 0;
     loader.type_path = "materials";
 
     return loader;
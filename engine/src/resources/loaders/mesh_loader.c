@@ -3,18 +3,19 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "core/profiler.h"
 #include "containers/darray.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
 #include "systems/geometry_system.h"
 #include "math/kmath.h"
 #include "math/geometry_utils.h"
+#include "math/kernels.h"
+#include "systems/job_system.h"
 #include "loader_utils.h"
 
 #include "platform/filesystem.h"
 
-#include <stdio.h>  //sscanf
-
 typedef enum mesh_file_type {
     MESH_FILE_TYPE_NOT_FOUND,
     MESH_FILE_TYPE_KSM,
@@ -27,36 +28,19 @@ typedef struct supported_mesh_filetype {
     b8 is_binary;
 } supported_mesh_filetype;
 
-typedef struct mesh_vertex_index_data {
-    u32 position_index;
-    u32 normal_index;
-    u32 texcoord_index;
-} mesh_vertex_index_data;
-
-typedef struct mesh_face_data {
-    mesh_vertex_index_data vertices[3];
-} mesh_face_data;
-
-typedef struct mesh_group_data {
-    // darray
-    mesh_face_data* faces;
-} mesh_group_data;
-
-b8 import_obj_file(file_handle* obj_file, const char* out_ksm_filename, geometry_config** out_geometries_darray);
-void process_subobject(vec3* positions, vec3* normals, vec2* tex_coords, mesh_face_data* faces, geometry_config* out_data);
+b8 import_obj_file(const char* obj_path, const char* out_ksm_filename, geometry_config** out_geometries_darray);
 b8 import_obj_material_library_file(const char* mtl_file_path);
 
-b8 load_ksm_file(file_handle* ksm_file, geometry_config** out_geometries_darray);
-b8 write_ksm_file(const char* path, const char* name, u32 geometry_count, geometry_config* geometries);
+static b8 parse_ksm(const char* path, const file_mapping* contents, geometry_config** out_geometries_darray, b8* out_in_place);
 b8 write_kmt_file(const char* directory, material_config* config);
 
 b8 mesh_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
+    PROFILE_SCOPE("mesh_loader_load");
     if (!self || !name || !out_resource) {
         return false;
     }
 
     char* format_str = "%s/%s/%s%s";
-    file_handle f;
     // Supported extensions. Note that these are in order of priority when looked up.
     // This is to prioritize the loading of a binary version of the mesh, followed by
     // importing various types of meshes to binary types, which would be loaded on the
@@ -73,12 +57,10 @@ b8 mesh_loader_load(struct resource_loader* self, const char* name, resource* ou
     // Try each supported extension.
     for (u32 i = 0; i < SUPPORTED_FILETYPE_COUNT; ++i) {
         string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, supported_filetypes[i].extension);
-        // If the file exists, open it and stop looking.
+        // If the file exists, stop looking. Files are mapped when loaded.
         if (filesystem_exists(full_file_path)) {
-            if (filesystem_open(full_file_path, FILE_MODE_READ, supported_filetypes[i].is_binary, &f)) {
-                type = supported_filetypes[i].type;
-                break;
-            }
+            type = supported_filetypes[i].type;
+            break;
         }
     }
 
@@ -88,6 +70,7 @@ b8 mesh_loader_load(struct resource_loader* self, const char* name, resource* ou
     }
 
     out_resource->full_path = string_duplicate(full_file_path);
+    out_resource->loader_data = 0;
 
     // The resource data is just an array of configs.
     geometry_config* resource_data = darray_create(geometry_config);
@@ -98,11 +81,11 @@ b8 mesh_loader_load(struct resource_loader* self, const char* name, resource* ou
             // Generate the ksm filename.
             char ksm_file_name[512];
             string_format(ksm_file_name, "%s/%s/%s%s", resource_system_base_path(), self->type_path, name, ".ksm");
-            result = import_obj_file(&f, ksm_file_name, &resource_data);
+            result = import_obj_file(full_file_path, ksm_file_name, &resource_data);
             break;
         }
         case MESH_FILE_TYPE_KSM:
-            result = load_ksm_file(&f, &resource_data);
+            result = load_ksm_file(full_file_path, &resource_data, (ksm_contents**)&out_resource->loader_data);
             break;
         default:
         case MESH_FILE_TYPE_NOT_FOUND:
@@ -111,8 +94,6 @@ b8 mesh_loader_load(struct resource_loader* self, const char* name, resource* ou
             break;
     }
 
-    filesystem_close(&f);
-
     if (!result) {
         KERROR("Failed to process mesh file '%s'.", full_file_path);
         darray_destroy(resource_data);
@@ -128,497 +109,1115 @@ b8 mesh_loader_load(struct resource_loader* self, const char* name, resource* ou
     return true;
 }
 
+b8 mesh_loader_resolve_path(struct resource_loader* self, const char* name, char* out_path) {
+    // Only binary meshes can be loaded from their contents alone, as importing writes files.
+    string_format(out_path, "%s/%s/%s%s", resource_system_base_path(), self->type_path, name, ".ksm");
+    return filesystem_exists(out_path);
+}
+
+b8 mesh_loader_load_from_memory(struct resource_loader* self, const char* name, const char* full_path, void* data, u64 size, resource* out_resource) {
+    PROFILE_SCOPE("mesh_loader_load_from_memory");
+    if (!self || !name || !out_resource) {
+        kfree(data, size, MEMORY_TAG_RESOURCE);
+        return false;
+    }
+
+    out_resource->full_path = string_duplicate(full_path);
+    out_resource->loader_data = 0;
+    geometry_config* resource_data = darray_create(geometry_config);
+    file_mapping contents = {data, size};
+    b8 in_place = false;
+    if (!parse_ksm(full_path, &contents, &resource_data, &in_place)) {
+        KERROR("Failed to process mesh file '%s'.", full_path);
+        kfree(data, size, MEMORY_TAG_RESOURCE);
+        darray_destroy(resource_data);
+        out_resource->data = 0;
+        out_resource->data_size = 0;
+        return false;
+    }
+
+    if (in_place) {
+        // The geometry data points into the contents, which are kept until the resource is unloaded.
+        ksm_contents* kept = kallocate(sizeof(ksm_contents), MEMORY_TAG_RESOURCE);
+        kept->contents = contents;
+        kept->allocated = true;
+        out_resource->loader_data = kept;
+    } else {
+        kfree(data, size, MEMORY_TAG_RESOURCE);
+    }
+    out_resource->data = resource_data;
+    // Use the data size as a count.
+    out_resource->data_size = darray_length(resource_data);
+    return true;
+}
+
 void mesh_loader_unload(struct resource_loader* self, resource* resource) {
+    // If the geometry data points into the file's contents, it is released along with them.
+    ksm_contents* contents = resource->loader_data;
     u32 count = darray_length(resource->data);
     for (u32 i = 0; i < count; ++i) {
         geometry_config* config = &((geometry_config*)resource->data)[i];
+        if (contents) {
+            config->vertices = 0;
+            config->indices = 0;
+        }
         geometry_system_config_dispose(config);
     }
     darray_destroy(resource->data);
+    if (contents) {
+        if (contents->allocated) {
+            kfree((void*)contents->contents.data, contents->contents.size, MEMORY_TAG_RESOURCE);
+        } else {
+            filesystem_unmap(&contents->contents);
+        }
+        kfree(contents, sizeof(ksm_contents), MEMORY_TAG_RESOURCE);
+        resource->loader_data = 0;
+    }
     resource->data = 0;
     resource->data_size = 0;
 }
 
-b8 load_ksm_file(file_handle* ksm_file, geometry_config** out_geometries_darray) {
-    // Version
-    u64 bytes_read = 0;
-    u16 version = 0;
-    filesystem_read(ksm_file, sizeof(u16), &version, &bytes_read);
+/*
+ * Ksm version 2 is a single blob laid out as a header, a geometry table, a string section
+ * and then the vertex and index data of each geometry, each starting on a KSM_SECTION_ALIGNMENT
+ * boundary. Offsets are from the start of the file. This lets a mapped file be used in place.
+ * Version 3 adds a table of levels of detail per geometry, after the geometry table, as ranges
+ * of the geometry's indices. Version 4 adds a table of meshlets per geometry after those.
+ * Version 1 files, which store each field in turn, can still be read.
+ */
+#define KSM_VERSION_1 0x0001U
+#define KSM_VERSION_2 0x0002U
+#define KSM_VERSION_3 0x0003U
+#define KSM_VERSION_4 0x0004U
+#define KSM_SECTION_ALIGNMENT 16
+
+/** @brief The header of a version 2 ksm file. */
+typedef struct ksm_header {
+    /** @brief The file version. First in every version. */
+    u16 version;
+    u16 reserved;
+    /** @brief The number of entries in the geometry table. */
+    u32 geometry_count;
+    /** @brief The offset and length, excluding the terminator, of the mesh name. */
+    u32 name_offset;
+    u32 name_length;
+    /** @brief The offset of the geometry table. */
+    u64 geometry_table_offset;
+} ksm_header;
+
+/** @brief An entry in the geometry table of a version 2 or later ksm file. */
+typedef struct ksm_geometry_entry {
+    u64 vertex_offset;
+    u64 index_offset;
+    u32 vertex_size;
+    u32 vertex_count;
+    u32 index_size;
+    u32 index_count;
+    /** @brief The offsets and lengths, excluding terminators, of the geometry and material names. */
+    u32 name_offset;
+    u32 name_length;
+    u32 material_name_offset;
+    u32 material_name_length;
+    vec3 center;
+    vec3 min_extents;
+    vec3 max_extents;
+    /** @brief The number of levels of detail. Version 3 onward. */
+    u32 lod_count;
+    /** @brief The offset of the level of detail table. Version 3 onward. */
+    u64 lod_table_offset;
+    /** @brief The number of meshlets. Version 4 onward. */
+    u32 meshlet_count;
+    u32 reserved;
+    /** @brief The offset of the meshlet table. Version 4 onward. */
+    u64 meshlet_table_offset;
+} ksm_geometry_entry;
+
+/** @brief A level of detail of a geometry in a version 3 ksm file, as a range of its indices. */
+typedef struct ksm_lod {
+    u32 index_offset;
+    u32 index_count;
+    f32 error;
+} ksm_lod;
+
+/** @brief A meshlet of a geometry in a version 4 ksm file, as a range of its full level of detail's indices. */
+typedef struct ksm_meshlet {
+    u32 index_offset;
+    u32 index_count;
+    vec3 center;
+    f32 radius;
+    vec3 cone_apex;
+    vec3 cone_axis;
+    f32 cone_cutoff;
+} ksm_meshlet;
+
+// Version 2 entries end before the level of detail fields, and version 3 entries before the meshlet fields.
+#define KSM_V2_GEOMETRY_ENTRY_SIZE 88
+#define KSM_V3_GEOMETRY_ENTRY_SIZE 96
+
+STATIC_ASSERT(sizeof(ksm_header) == 24, "Expected ksm_header to be 24 bytes.");
+STATIC_ASSERT(sizeof(ksm_geometry_entry) == 112, "Expected ksm_geometry_entry to be 112 bytes.");
+STATIC_ASSERT(sizeof(ksm_lod) == 12, "Expected ksm_lod to be 12 bytes.");
+STATIC_ASSERT(sizeof(ksm_meshlet) == 52, "Expected ksm_meshlet to be 52 bytes.");
+
+/**
+ * @brief A cursor over a block of mapped file data.
+ */
+typedef struct ksm_reader {
+    const u8* data;
+    u64 size;
+    u64 offset;
+} ksm_reader;
 
-    // Name length
-    u32 name_length = 0;
-    filesystem_read(ksm_file, sizeof(u32), &name_length, &bytes_read);
+/**
+ * @brief Copies size bytes from the reader into out_data, if available. If out_data
+ * is 0, the bytes are skipped. Fails without advancing if the data is truncated.
+ */
+static b8 ksm_read(ksm_reader* reader, u64 size, void* out_data) {
+    if (size > reader->size - reader->offset) {
+        return false;
+    }
+    if (out_data) {
+        kcopy_memory(out_data, reader->data + reader->offset, size);
+    }
+    reader->offset += size;
+    return true;
+}
+
+/**
+ * @brief Reads a length-prefixed string into out_str, which holds max_length characters.
+ */
+static b8 ksm_read_string(ksm_reader* reader, char* out_str, u32 max_length) {
+    u32 length = 0;
+    if (!ksm_read(reader, sizeof(u32), &length) || length > max_length) {
+        return false;
+    }
+    return ksm_read(reader, sizeof(char) * length, out_str);
+}
+
+static b8 load_ksm_v1(const char* path, ksm_reader* reader, geometry_config** out_geometries_darray) {
     // Name + terminator
     char name[256];
-    filesystem_read(ksm_file, sizeof(char) * name_length, name, &bytes_read);
-
     // Geometry count
     u32 geometry_count = 0;
-    filesystem_read(ksm_file, sizeof(u32), &geometry_count, &bytes_read);
+    if (!ksm_read_string(reader, name, 256) ||
+        !ksm_read(reader, sizeof(u32), &geometry_count)) {
+        KERROR("Ksm file '%s' has a malformed header.", path);
+        return false;
+    }
 
     // Each geometry
     for (u32 i = 0; i < geometry_count; ++i) {
         geometry_config g = {};
+        b8 valid = true;
 
         // Vertices (size/count/array)
-        filesystem_read(ksm_file, sizeof(u32), &g.vertex_size, &bytes_read);
-        filesystem_read(ksm_file, sizeof(u32), &g.vertex_count, &bytes_read);
-        g.vertices = kallocate(g.vertex_size * g.vertex_count, MEMORY_TAG_ARRAY);
-        filesystem_read(ksm_file, g.vertex_size * g.vertex_count, g.vertices, &bytes_read);
+        valid = valid && ksm_read(reader, sizeof(u32), &g.vertex_size);
+        valid = valid && ksm_read(reader, sizeof(u32), &g.vertex_count);
+        valid = valid && (g.vertex_size == sizeof(vertex_3d) || g.vertex_size == sizeof(vertex_3d_packed));
+        u64 vertex_data_size = (u64)g.vertex_size * g.vertex_count;
+        valid = valid && vertex_data_size <= reader->size - reader->offset;
+        if (valid) {
+            g.vertices = kallocate(vertex_data_size, MEMORY_TAG_ARRAY);
+            ksm_read(reader, vertex_data_size, g.vertices);
+        }
 
         // Indices (size/count/array)
-        filesystem_read(ksm_file, sizeof(u32), &g.index_size, &bytes_read);
-        filesystem_read(ksm_file, sizeof(u32), &g.index_count, &bytes_read);
-        g.indices = kallocate(g.index_size * g.index_count, MEMORY_TAG_ARRAY);
-        filesystem_read(ksm_file, g.index_size * g.index_count, g.indices, &bytes_read);
+        valid = valid && ksm_read(reader, sizeof(u32), &g.index_size);
+        valid = valid && ksm_read(reader, sizeof(u32), &g.index_count);
+        valid = valid && (g.index_size == sizeof(u16) || g.index_size == sizeof(u32));
+        u64 index_data_size = (u64)g.index_size * g.index_count;
+        valid = valid && index_data_size <= reader->size - reader->offset;
+        if (valid) {
+            g.indices = kallocate(index_data_size, MEMORY_TAG_ARRAY);
+            ksm_read(reader, index_data_size, g.indices);
+            // Files written before 16-bit index support always hold 32-bit indices.
+            geometry_system_config_compact_indices(&g);
+            // Files written before packed vertex support always hold full vertices.
+            geometry_system_config_pack_vertices(&g);
+        }
 
         // Name
-        u32 g_name_length = 0;
-        filesystem_read(ksm_file, sizeof(u32), &g_name_length, &bytes_read);
-        filesystem_read(ksm_file, sizeof(char) * g_name_length, g.name, &bytes_read);
+        valid = valid && ksm_read_string(reader, g.name, GEOMETRY_NAME_MAX_LENGTH);
 
         // Material Name
-        u32 m_name_length = 0;
-        filesystem_read(ksm_file, sizeof(u32), &m_name_length, &bytes_read);
-        filesystem_read(ksm_file, sizeof(char) * m_name_length, g.material_name, &bytes_read);
-
-        // Center
-        filesystem_read(ksm_file, sizeof(vertex_3d), &g.center, &bytes_read);
+        valid = valid && ksm_read_string(reader, g.material_name, MATERIAL_NAME_MAX_LENGTH);
+
+        // Center and extents (min/max). NOTE: Each is stored with the stride of a vertex_3d,
+        // of which only the leading vec3 is meaningful.
+        vec3* vectors[3] = {&g.center, &g.min_extents, &g.max_extents};
+        for (u32 v = 0; v < 3; ++v) {
+            valid = valid && ksm_read(reader, sizeof(vec3), vectors[v]);
+            valid = valid && ksm_read(reader, sizeof(vertex_3d) - sizeof(vec3), 0);
+        }
 
-        // Extents (min/max)
-        filesystem_read(ksm_file, sizeof(vertex_3d), &g.min_extents, &bytes_read);
-        filesystem_read(ksm_file, sizeof(vertex_3d), &g.max_extents, &bytes_read);
+        if (!valid) {
+            KERROR("Ksm file '%s' is truncated or malformed at geometry %u.", path, i);
+            geometry_system_config_dispose(&g);
+            for (u32 j = 0; j < i; ++j) {
+                geometry_system_config_dispose(&(*out_geometries_darray)[j]);
+            }
+            darray_clear(*out_geometries_darray);
+            return false;
+        }
 
         // Add to the output array.
         darray_push(*out_geometries_darray, g);
     }
 
-    filesystem_close(ksm_file);
+    return true;
+}
+
+// Checks that a section of the given size at the given offset lies within the file and is aligned.
+static b8 ksm_section_valid(const file_mapping* mapping, u64 offset, u64 size, u64 alignment) {
+    return offset <= mapping->size && size <= mapping->size - offset && offset % alignment == 0;
+}
 
+// Copies a name from the string section into out_str, which holds max_length characters.
+static b8 ksm_copy_name(const file_mapping* mapping, u32 offset, u32 length, char* out_str, u32 max_length) {
+    if (length >= max_length || !ksm_section_valid(mapping, offset, length, 1)) {
+        return false;
+    }
+    kcopy_memory(out_str, (const u8*)mapping->data + offset, length);
+    out_str[length] = 0;
     return true;
 }
 
-b8 write_ksm_file(const char* path, const char* name, u32 geometry_count, geometry_config* geometries) {
-    if (filesystem_exists(path)) {
-        KINFO("File '%s' already exists and will be overwritten.", path);
+// Checks that every index refers to one of the vertices, as indices are uploaded straight from the file.
+static b8 ksm_indices_valid(const void* indices, u32 index_size, u32 index_count, u32 vertex_count) {
+    if (index_size == sizeof(u16)) {
+        const u16* indices16 = indices;
+        for (u32 i = 0; i < index_count; ++i) {
+            if (indices16[i] >= vertex_count) {
+                return false;
+            }
+        }
+    } else {
+        const u32* indices32 = indices;
+        for (u32 i = 0; i < index_count; ++i) {
+            if (indices32[i] >= vertex_count) {
+                return false;
+            }
+        }
     }
+    return true;
+}
 
-    file_handle f;
-    if (!filesystem_open(path, FILE_MODE_WRITE, true, &f)) {
-        KERROR("Unable to open file '%s' for writing. KSM write failed.", path);
+static b8 load_ksm_v2(const char* path, u16 version, const file_mapping* mapping, geometry_config** out_geometries_darray) {
+    if (mapping->size < sizeof(ksm_header)) {
+        KERROR("Ksm file '%s' has a malformed header.", path);
+        return false;
+    }
+    const u8* data = mapping->data;
+    ksm_header header;
+    kcopy_memory(&header, data, sizeof(ksm_header));
+    u64 entry_size = version == KSM_VERSION_2 ? KSM_V2_GEOMETRY_ENTRY_SIZE : (version == KSM_VERSION_3 ? KSM_V3_GEOMETRY_ENTRY_SIZE : sizeof(ksm_geometry_entry));
+    if (!ksm_section_valid(mapping, header.geometry_table_offset, (u64)header.geometry_count * entry_size, 8)) {
+        KERROR("Ksm file '%s' has a malformed geometry table.", path);
         return false;
     }
 
-    // Version
-    u64 written = 0;
-    u16 version = 0x0001U;
-    filesystem_write(&f, sizeof(u16), &version, &written);
-
-    // Name length
-    u32 name_length = string_length(name) + 1;
-    filesystem_write(&f, sizeof(u32), &name_length, &written);
-    // Name + terminator
-    filesystem_write(&f, sizeof(char) * name_length, name, &written);
+    for (u32 i = 0; i < header.geometry_count; ++i) {
+        // Older entries are shorter, and the fields they lack stay zeroed.
+        ksm_geometry_entry entry = {};
+        kcopy_memory(&entry, data + header.geometry_table_offset + entry_size * i, entry_size);
+        if (version == KSM_VERSION_2) {
+            entry.lod_count = 0;
+        }
+        const ksm_geometry_entry* e = &entry;
+        geometry_config g = {};
+        g.vertex_size = e->vertex_size;
+        g.vertex_count = e->vertex_count;
+        g.index_size = e->index_size;
+        g.index_count = e->index_count;
+        g.center = e->center;
+        g.min_extents = e->min_extents;
+        g.max_extents = e->max_extents;
+
+        // Vertex and index data are used in place, so must already be in the form they are uploaded in.
+        b8 valid = e->vertex_size == sizeof(vertex_3d_packed) && (e->index_size == sizeof(u16) || e->index_size == sizeof(u32));
+        valid = valid && ksm_section_valid(mapping, e->vertex_offset, (u64)e->vertex_size * e->vertex_count, sizeof(f32));
+        valid = valid && ksm_section_valid(mapping, e->index_offset, (u64)e->index_size * e->index_count, e->index_size);
+        valid = valid && ksm_indices_valid(data + e->index_offset, e->index_size, e->index_count, e->vertex_count);
+        valid = valid && ksm_copy_name(mapping, e->name_offset, e->name_length, g.name, GEOMETRY_NAME_MAX_LENGTH);
+        valid = valid && ksm_copy_name(mapping, e->material_name_offset, e->material_name_length, g.material_name, MATERIAL_NAME_MAX_LENGTH);
+        valid = valid && e->lod_count <= GEOMETRY_MAX_LODS && ksm_section_valid(mapping, e->lod_table_offset, (u64)e->lod_count * sizeof(ksm_lod), sizeof(u32));
+        if (valid && e->lod_count) {
+            const ksm_lod* lods = (const ksm_lod*)(data + e->lod_table_offset);
+            g.lod_count = (u8)e->lod_count;
+            for (u32 l = 0; l < e->lod_count; ++l) {
+                valid = valid && lods[l].index_offset <= e->index_count && lods[l].index_count <= e->index_count - lods[l].index_offset;
+                g.lods[l].index_offset = lods[l].index_offset;
+                g.lods[l].index_count = lods[l].index_count;
+                g.lods[l].error = lods[l].error;
+            }
+        }
+        valid = valid && ksm_section_valid(mapping, e->meshlet_table_offset, (u64)e->meshlet_count * sizeof(ksm_meshlet), sizeof(u32));
+        if (valid && e->meshlet_count) {
+            // Meshlets cover the full level of detail, in order.
+            const ksm_meshlet* meshlets = (const ksm_meshlet*)(data + e->meshlet_table_offset);
+            u32 full_count = g.lod_count ? g.lods[0].index_count : e->index_count;
+            u32 next_index = 0;
+            g.meshlet_count = e->meshlet_count;
+            g.meshlets = kallocate(sizeof(geometry_meshlet) * g.meshlet_count, MEMORY_TAG_ARRAY);
+            for (u32 m = 0; m < e->meshlet_count && valid; ++m) {
+                const ksm_meshlet* km = &meshlets[m];
+                valid = km->index_offset == next_index && km->index_count <= full_count - next_index;
+                next_index += km->index_count;
+                geometry_meshlet* gm = &g.meshlets[m];
+                gm->index_offset = km->index_offset;
+                gm->index_count = km->index_count;
+                gm->center = km->center;
+                gm->radius = km->radius;
+                gm->cone_apex = km->cone_apex;
+                gm->cone_axis = km->cone_axis;
+                gm->cone_cutoff = km->cone_cutoff;
+            }
+        }
+        if (!valid) {
+            KERROR("Ksm file '%s' is truncated or malformed at geometry %u.", path, i);
+            // Only the meshlets are copied out of the mapping.
+            if (g.meshlets) {
+                kfree(g.meshlets, sizeof(geometry_meshlet) * g.meshlet_count, MEMORY_TAG_ARRAY);
+            }
+            u32 count = darray_length(*out_geometries_darray);
+            for (u32 j = 0; j < count; ++j) {
+                geometry_config* pushed = &(*out_geometries_darray)[j];
+                if (pushed->meshlets) {
+                    kfree(pushed->meshlets, sizeof(geometry_meshlet) * pushed->meshlet_count, MEMORY_TAG_ARRAY);
+                }
+            }
+            darray_clear(*out_geometries_darray);
+            return false;
+        }
 
-    // Geometry count
-    filesystem_write(&f, sizeof(u32), &geometry_count, &written);
+        // NOTE: The mapping is read-only, so these must not be written to.
+        g.vertices = (void*)(data + e->vertex_offset);
+        g.indices = e->index_count ? (void*)(data + e->index_offset) : 0;
+        darray_push(*out_geometries_darray, g);
+    }
 
-    // Each geometry
-    for (u32 i = 0; i < geometry_count; ++i) {
-        geometry_config* g = &geometries[i];
+    return true;
+}
 
-        // Vertices (size/count/array)
-        filesystem_write(&f, sizeof(u32), &g->vertex_size, &written);
-        filesystem_write(&f, sizeof(u32), &g->vertex_count, &written);
-        filesystem_write(&f, g->vertex_size * g->vertex_count, g->vertices, &written);
+/**
+ * @brief Parses the contents of a ksm file. Version 2 and later files are parsed in place, so
+ * their geometry data points into the contents, which must then be kept as long as it is used.
+ */
+static b8 parse_ksm(const char* path, const file_mapping* contents, geometry_config** out_geometries_darray, b8* out_in_place) {
+    *out_in_place = false;
+    ksm_reader reader = {contents->data, contents->size, 0};
 
-        // Indices (size/count/array)
-        filesystem_write(&f, sizeof(u32), &g->index_size, &written);
-        filesystem_write(&f, sizeof(u32), &g->index_count, &written);
-        filesystem_write(&f, g->index_size * g->index_count, g->indices, &written);
+    // Version
+    u16 version = 0;
+    if (!ksm_read(&reader, sizeof(u16), &version)) {
+        KERROR("Ksm file '%s' has a malformed header.", path);
+        return false;
+    }
 
-        // Name
-        u32 g_name_length = string_length(g->name) + 1;
-        filesystem_write(&f, sizeof(u32), &g_name_length, &written);
-        filesystem_write(&f, sizeof(char) * g_name_length, g->name, &written);
+    if (version == KSM_VERSION_2 || version == KSM_VERSION_3 || version == KSM_VERSION_4) {
+        *out_in_place = true;
+        return load_ksm_v2(path, version, contents, out_geometries_darray);
+    }
+    if (version == KSM_VERSION_1) {
+        return load_ksm_v1(path, &reader, out_geometries_darray);
+    }
+    KERROR("Ksm file '%s' has unsupported version %u.", path, version);
+    return false;
+}
 
-        // Material Name
-        u32 m_name_length = string_length(g->material_name) + 1;
-        filesystem_write(&f, sizeof(u32), &m_name_length, &written);
-        filesystem_write(&f, sizeof(char) * m_name_length, g->material_name, &written);
+b8 load_ksm_file(const char* path, geometry_config** out_geometries_darray, ksm_contents** out_contents) {
+    PROFILE_SCOPE("load_ksm_file");
+    *out_contents = 0;
+    // The whole file is mapped and parsed in place, rather than issuing a read per field.
+    file_mapping mapping;
+    if (!filesystem_map(path, FILE_MAP_HINT_SEQUENTIAL | FILE_MAP_HINT_WILL_NEED, &mapping)) {
+        KERROR("Unable to map ksm file '%s'.", path);
+        return false;
+    }
 
-        // Center
-        filesystem_write(&f, sizeof(vertex_3d), &g->center, &written);
+    b8 in_place = false;
+    if (!parse_ksm(path, &mapping, out_geometries_darray, &in_place)) {
+        filesystem_unmap(&mapping);
+        return false;
+    }
+    if (in_place) {
+        // The geometry data points into the mapping, which is kept until the resource is unloaded.
+        *out_contents = kallocate(sizeof(ksm_contents), MEMORY_TAG_RESOURCE);
+        (*out_contents)->contents = mapping;
+        (*out_contents)->allocated = false;
+    } else {
+        filesystem_unmap(&mapping);
+    }
+    return true;
+}
 
-        // Extents (min/max)
-        filesystem_write(&f, sizeof(vertex_3d), &g->min_extents, &written);
-        filesystem_write(&f, sizeof(vertex_3d), &g->max_extents, &written);
+b8 write_ksm_file(const char* path, const char* name, u32 geometry_count, geometry_config* geometries) {
+    PROFILE_SCOPE("write_ksm_file");
+    if (filesystem_exists(path)) {
+        KINFO("File '%s' already exists and will be overwritten.", path);
     }
 
-    filesystem_close(&f);
+    // Lay out the file: header, geometry table, level of detail tables, strings, then the aligned data sections.
+    u64 table_offset = get_aligned(sizeof(ksm_header), 8);
+    u64 lod_table_offset = table_offset + sizeof(ksm_geometry_entry) * geometry_count;
+    u64 meshlet_table_offset = lod_table_offset;
+    for (u32 i = 0; i < geometry_count; ++i) {
+        meshlet_table_offset += sizeof(ksm_lod) * geometries[i].lod_count;
+    }
+    u64 name_offset = meshlet_table_offset;
+    for (u32 i = 0; i < geometry_count; ++i) {
+        name_offset += sizeof(ksm_meshlet) * geometries[i].meshlet_count;
+    }
+    u32 name_length = string_length(name);
+    u64 offset = name_offset + name_length + 1;
+    for (u32 i = 0; i < geometry_count; ++i) {
+        offset += string_length(geometries[i].name) + 1 + string_length(geometries[i].material_name) + 1;
+    }
+    for (u32 i = 0; i < geometry_count; ++i) {
+        offset = get_aligned(offset, KSM_SECTION_ALIGNMENT) + (u64)geometries[i].vertex_size * geometries[i].vertex_count;
+        offset = get_aligned(offset, KSM_SECTION_ALIGNMENT) + (u64)geometries[i].index_size * geometries[i].index_count;
+    }
+    u64 file_size = offset;
 
-    return true;
-}
+    // Build the whole file in memory so it is written at once.
+    u8* blob = kallocate(file_size, MEMORY_TAG_ARRAY);
+    ksm_header* header = (ksm_header*)blob;
+    header->version = KSM_VERSION_4;
+    header->geometry_count = geometry_count;
+    header->name_offset = (u32)name_offset;
+    header->name_length = name_length;
+    header->geometry_table_offset = table_offset;
 
-/**
- * @brief Imports an obj file. This reads the obj, creates geometry configs, then calls logic to write
- * those geometries out to a binary ksm file. That file can be used on the next load.
- *
- * @param obj_file A pointer to the obj file handle to be read.
- * @param out_ksm_filename The path to the ksm file to be written to.
- * @param out_geometries_darray A darray of geometries parsed from the file.
- * @return True on success; otherwise false.
- */
-b8 import_obj_file(file_handle* obj_file, const char* out_ksm_filename, geometry_config** out_geometries_darray) {
-    // Positions
-    vec3* positions = darray_reserve(vec3, 16384);
+    kcopy_memory(blob + name_offset, name, name_length);
+    offset = name_offset + name_length + 1;
 
-    // Normals
-    vec3* normals = darray_reserve(vec3, 16384);
+    ksm_geometry_entry* entries = (ksm_geometry_entry*)(blob + table_offset);
+    for (u32 i = 0; i < geometry_count; ++i) {
+        geometry_config* g = &geometries[i];
+        ksm_geometry_entry* e = &entries[i];
+        e->vertex_size = g->vertex_size;
+        e->vertex_count = g->vertex_count;
+        e->index_size = g->index_size;
+        e->index_count = g->index_count;
+        e->center = g->center;
+        e->min_extents = g->min_extents;
+        e->max_extents = g->max_extents;
+
+        e->lod_count = g->lod_count;
+        e->lod_table_offset = lod_table_offset;
+        ksm_lod* lods = (ksm_lod*)(blob + lod_table_offset);
+        for (u32 l = 0; l < g->lod_count; ++l) {
+            lods[l].index_offset = g->lods[l].index_offset;
+            lods[l].index_count = g->lods[l].index_count;
+            lods[l].error = g->lods[l].error;
+        }
+        lod_table_offset += sizeof(ksm_lod) * g->lod_count;
+
+        e->meshlet_count = g->meshlet_count;
+        e->meshlet_table_offset = meshlet_table_offset;
+        ksm_meshlet* meshlets = (ksm_meshlet*)(blob + meshlet_table_offset);
+        for (u32 m = 0; m < g->meshlet_count; ++m) {
+            const geometry_meshlet* gm = &g->meshlets[m];
+            meshlets[m].index_offset = gm->index_offset;
+            meshlets[m].index_count = gm->index_count;
+            meshlets[m].center = gm->center;
+            meshlets[m].radius = gm->radius;
+            meshlets[m].cone_apex = gm->cone_apex;
+            meshlets[m].cone_axis = gm->cone_axis;
+            meshlets[m].cone_cutoff = gm->cone_cutoff;
+        }
+        meshlet_table_offset += sizeof(ksm_meshlet) * g->meshlet_count;
+
+        e->name_offset = (u32)offset;
+        e->name_length = string_length(g->name);
+        kcopy_memory(blob + offset, g->name, e->name_length);
+        offset += e->name_length + 1;
+        e->material_name_offset = (u32)offset;
+        e->material_name_length = string_length(g->material_name);
+        kcopy_memory(blob + offset, g->material_name, e->material_name_length);
+        offset += e->material_name_length + 1;
+    }
 
-    // Normals
-    vec2* tex_coords = darray_reserve(vec2, 16384);
+    for (u32 i = 0; i < geometry_count; ++i) {
+        geometry_config* g = &geometries[i];
+        ksm_geometry_entry* e = &entries[i];
+        u64 vertex_data_size = (u64)g->vertex_size * g->vertex_count;
+        e->vertex_offset = get_aligned(offset, KSM_SECTION_ALIGNMENT);
+        kcopy_memory(blob + e->vertex_offset, g->vertices, vertex_data_size);
+        u64 index_data_size = (u64)g->index_size * g->index_count;
+        e->index_offset = get_aligned(e->vertex_offset + vertex_data_size, KSM_SECTION_ALIGNMENT);
+        if (index_data_size) {
+            kcopy_memory(blob + e->index_offset, g->indices, index_data_size);
+        }
+        offset = e->index_offset + index_data_size;
+    }
 
-    // Groups
-    mesh_group_data* groups = darray_reserve(mesh_group_data, 4);
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_WRITE, true, &f)) {
+        KERROR("Unable to open file '%s' for writing. KSM write failed.", path);
+        kfree(blob, file_size, MEMORY_TAG_ARRAY);
+        return false;
+    }
+    u64 written = 0;
+    b8 result = filesystem_write(&f, file_size, blob, &written) && written == file_size;
+    filesystem_close(&f);
+    kfree(blob, file_size, MEMORY_TAG_ARRAY);
+    if (!result) {
+        KERROR("Failed to write ksm file '%s'.", path);
+    }
 
-    char material_file_name[512] = "";
+    return result;
+}
 
-    char name[512];
-    u8 current_mat_name_count = 0;
-    char material_names[32][64];
+// The minimum size of each chunk of an obj file parsed in parallel.
+#define OBJ_MIN_CHUNK_SIZE (256 * 1024)
+// The maximum number of chunks per thread, so uneven chunks balance out.
+#define OBJ_CHUNKS_PER_THREAD 4
+
+/** @brief The results of parsing a line-aligned chunk of an obj file. */
+typedef struct obj_chunk {
+    const char* start;
+    const char* end;
+    // darrays
+    vec3* positions;
+    vec3* normals;
+    vec2* tex_coords;
+    mesh_face_data* faces;
+    obj_directive* directives;
+    // Offsets of this chunk's faces in the merged face stream.
+    u64 face_offset;
+} obj_chunk;
+
+/** @brief A run of faces in the merged face stream which forms one geometry. */
+typedef struct obj_group_range {
+    u64 first_face;
+    u64 face_count;
+} obj_group_range;
+
+/** @brief The shared state of processing groups into geometries in parallel. */
+typedef struct obj_process_params {
+    const vec3* positions;
+    u64 position_count;
+    const vec3* normals;
+    u64 normal_count;
+    const vec2* tex_coords;
+    u64 tex_coord_count;
+    const mesh_face_data* faces;
+    const obj_group_range* ranges;
+    geometry_config* geometries;
+} obj_process_params;
+
+/** @brief Parses the next whitespace-separated float on the line. Missing or malformed values are 0. */
+static f32 obj_next_f32(string_view* line) {
+    f32 value = 0;
+    string_view token;
+    if (string_view_token_next(line, &token)) {
+        string_view_parse_f32(token, &value);
+    }
+    return value;
+}
 
-    char line_buf[512] = "";
-    char* p = &line_buf[0];
-    u64 line_length = 0;
+/** @brief Parses an index at the start of the view, and advances past it. Missing indices are 0. */
+static u32 obj_next_index(string_view* view) {
+    u64 value = 0;
+    u64 parsed = string_view_parse_u64(*view, &value);
+    *view = string_view_mid(*view, parsed, view->length);
+    return (u32)value;
+}
 
-    // index 0 is previous, 1 is previous before that.
-    char prev_first_chars[2] = {0, 0};
-    while (true) {
-        if (!filesystem_read_line(obj_file, 511, &p, &line_length)) {
-            break;
+/**
+ * @brief Parses a face vertex in any of the forms v, v/t, v//n and v/t/n. Missing indices are
+ * left at 0. Relative (negative) indices are not supported.
+ */
+static void obj_parse_face_vertex(string_view token, mesh_vertex_index_data* out_data) {
+    out_data->texcoord_index = 0;
+    out_data->normal_index = 0;
+    out_data->position_index = obj_next_index(&token);
+    if (token.length > 0 && token.data[0] == '/') {
+        token = string_view_mid(token, 1, token.length);
+        out_data->texcoord_index = obj_next_index(&token);
+        if (token.length > 0 && token.data[0] == '/') {
+            token = string_view_mid(token, 1, token.length);
+            out_data->normal_index = obj_next_index(&token);
         }
+    }
+}
 
-        // Skip blank lines.
-        if (line_length < 1) {
-            continue;
-        }
+static void obj_push_directive(obj_chunk* chunk, obj_directive_type type, string_view text) {
+    obj_directive directive;
+    directive.type = type;
+    directive.face_index = darray_length(chunk->faces);
+    string_view_copy(directive.text, string_view_trim(text), MATERIAL_NAME_MAX_LENGTH);
+    darray_push(chunk->directives, directive);
+}
 
-        char first_char = line_buf[0];
+static void obj_parse_line(obj_chunk* chunk, string_view line) {
+    string_view keyword;
+    if (!string_view_token_next(&line, &keyword)) {
+        return;
+    }
 
-        switch (first_char) {
-            case '#':
-                // Skip comments
+    if (string_view_equal(keyword, "v")) {
+        vec3 pos;
+        pos.x = obj_next_f32(&line);
+        pos.y = obj_next_f32(&line);
+        pos.z = obj_next_f32(&line);
+        darray_push(chunk->positions, pos);
+    } else if (string_view_equal(keyword, "vn")) {
+        vec3 norm;
+        norm.x = obj_next_f32(&line);
+        norm.y = obj_next_f32(&line);
+        norm.z = obj_next_f32(&line);
+        darray_push(chunk->normals, norm);
+    } else if (string_view_equal(keyword, "vt")) {
+        // NOTE: Ignoring Z if present.
+        vec2 tex_coord;
+        tex_coord.x = obj_next_f32(&line);
+        tex_coord.y = obj_next_f32(&line);
+        darray_push(chunk->tex_coords, tex_coord);
+    } else if (string_view_equal(keyword, "f")) {
+        // f 1/1/1 2/2/2 3/3/3  = pos/tex/norm pos/tex/norm pos/tex/norm
+        // Polygons with more than three vertices are split into a triangle fan.
+        mesh_face_data face;
+        u32 vertex_count = 0;
+        string_view token;
+        while (string_view_token_next(&line, &token)) {
+            mesh_vertex_index_data vertex;
+            obj_parse_face_vertex(token, &vertex);
+            if (vertex.position_index == 0) {
                 continue;
-            case 'v': {
-                char second_char = line_buf[1];
-                switch (second_char) {
-                    case ' ': {
-                        // Vertex position
-                        vec3 pos;
-                        char t[2];
-                        sscanf(
-                            line_buf,
-                            "%s %f %f %f",
-                            t,
-                            &pos.x,
-                            &pos.y,
-                            &pos.z);
-
-                        darray_push(positions, pos);
-                    } break;
-                    case 'n': {
-                        // Vertex normal
-                        vec3 norm;
-                        char t[2];
-                        sscanf(
-                            line_buf,
-                            "%s %f %f %f",
-                            t,
-                            &norm.x,
-                            &norm.y,
-                            &norm.z);
-
-                        darray_push(normals, norm);
-                    } break;
-                    case 't': {
-                        // Vertex texture coords.
-                        vec2 tex_coord;
-                        char t[2];
-
-                        // NOTE: Ignoring Z if present.
-                        sscanf(
-                            line_buf,
-                            "%s %f %f",
-                            t,
-                            &tex_coord.x,
-                            &tex_coord.y);
-
-                        darray_push(tex_coords, tex_coord);
-                    } break;
-                }
-            } break;
-            case 's': {
-            } break;
-            case 'f': {
-                // face
-                // f 1/1/1 2/2/2 3/3/3  = pos/tex/norm pos/tex/norm pos/tex/norm
-                mesh_face_data face;
-                char t[2];
-
-                u64 normal_count = darray_length(normals);
-                u64 tex_coord_count = darray_length(tex_coords);
-
-                if (normal_count == 0 || tex_coord_count == 0) {
-                    sscanf(
-                        line_buf,
-                        "%s %d %d %d",
-                        t,
-                        &face.vertices[0].position_index,
-                        &face.vertices[1].position_index,
-                        &face.vertices[2].position_index);
-                } else {
-                    sscanf(
-                        line_buf,
-                        "%s %d/%d/%d %d/%d/%d %d/%d/%d",
-                        t,
-                        &face.vertices[0].position_index,
-                        &face.vertices[0].texcoord_index,
-                        &face.vertices[0].normal_index,
-
-                        &face.vertices[1].position_index,
-                        &face.vertices[1].texcoord_index,
-                        &face.vertices[1].normal_index,
-
-                        &face.vertices[2].position_index,
-                        &face.vertices[2].texcoord_index,
-                        &face.vertices[2].normal_index);
-                }
-                u64 group_index = darray_length(groups) - 1;
-                darray_push(groups[group_index].faces, face);
-            } break;
-            case 'm': {
-                // Material library file.
-                char substr[7];
-
-                sscanf(
-                    line_buf,
-                    "%s %s",
-                    substr,
-                    material_file_name);
-
-                // If found, save off the material file name.
-                if (strings_nequali(substr, "mtllib", 6)) {
-                    // TODO: verification
-                }
-            } break;
-            case 'u': {
-                // Any time there is a usemtl, assume a new group.
-                // New named group or smoothing group, all faces coming after should be added to it.
-                mesh_group_data new_group;
-                new_group.faces = darray_reserve(mesh_face_data, 16384);
-                darray_push(groups, new_group);
-
-                // usemtl
-                // Read the material name.
-                char t[8];
-                sscanf(line_buf, "%s %s", t, material_names[current_mat_name_count]);
-                current_mat_name_count++;
-            } break;
-            case 'g': {
-                u64 group_count = darray_length(groups);
-                // Process each group as a subobject.
-                for (u64 i = 0; i < group_count; ++i) {
-                    geometry_config new_data = {};
-                    string_ncopy(new_data.name, name, 255);
-                    if (i > 0) {
-                        string_append_int(new_data.name, new_data.name, i);
-                    }
-                    string_ncopy(new_data.material_name, material_names[i], 255);
-
-                    process_subobject(positions, normals, tex_coords, groups[i].faces, &new_data);
-                    new_data.vertex_count = darray_length(new_data.vertices);
-                    new_data.vertex_size = sizeof(vertex_3d);
-                    new_data.index_count = darray_length(new_data.indices);
-                    new_data.index_size = sizeof(u32);
-
-                    darray_push(*out_geometries_darray, new_data);
-
-                    // Increment the number of objects.
-                    darray_destroy(groups[i].faces);
-                    kzero_memory(material_names[i], 64);
-                }
+            }
+            if (vertex_count < 3) {
+                face.vertices[vertex_count] = vertex;
+            } else {
+                face.vertices[1] = face.vertices[2];
+                face.vertices[2] = vertex;
+            }
+            vertex_count++;
+            if (vertex_count >= 3) {
+                darray_push(chunk->faces, face);
+            }
+        }
+    } else if (string_view_equal(keyword, "usemtl")) {
+        obj_push_directive(chunk, OBJ_DIRECTIVE_USEMTL, line);
+    } else if (string_view_equal(keyword, "mtllib")) {
+        obj_push_directive(chunk, OBJ_DIRECTIVE_MTLLIB, line);
+    } else if (string_view_equal(keyword, "g")) {
+        obj_push_directive(chunk, OBJ_DIRECTIVE_GROUP, line);
+    }
+    // Anything else, such as comments and smoothing groups, is ignored.
+}
 
-                current_mat_name_count = 0;
-                darray_clear(groups);
-                kzero_memory(name, 512);
+static void obj_parse_chunk_range(u32 start, u32 end, void* params) {
+    obj_chunk* chunks = params;
+    for (u32 c = start; c < end; ++c) {
+        PROFILE_SCOPE("obj_parse_chunk");
+        obj_chunk* chunk = &chunks[c];
+        string_view remaining = string_view_create_from_range(chunk->start, (u64)(chunk->end - chunk->start));
+        string_view line;
+        while (string_view_split_next(&remaining, '\n', &line)) {
+            obj_parse_line(chunk, line);
+        }
+    }
+}
 
-                // Read the name
-                char t[2];
-                sscanf(line_buf, "%s %s", t, name);
+void obj_parse(const char* data, u64 size, u32 chunk_count, obj_parse_result* out_result) {
+    PROFILE_SCOPE("obj_parse");
+    const char* data_end = data + size;
 
-            } break;
+    // Split into chunks, each starting at the beginning of a line.
+    if (chunk_count == 0) {
+        u64 count = size / OBJ_MIN_CHUNK_SIZE;
+        u64 max_chunk_count = (u64)job_system_thread_count() * OBJ_CHUNKS_PER_THREAD;
+        if (count > max_chunk_count) {
+            count = max_chunk_count;
         }
+        chunk_count = count < 1 ? 1 : (u32)count;
+    }
+    obj_chunk* chunks = kallocate(sizeof(obj_chunk) * chunk_count, MEMORY_TAG_ARRAY);
+    const char* chunk_start = data;
+    for (u32 c = 0; c < chunk_count; ++c) {
+        const char* chunk_end = c + 1 == chunk_count ? data_end : data + (size / chunk_count) * (c + 1);
+        if (chunk_end < chunk_start) {
+            chunk_end = chunk_start;
+        }
+        while (chunk_end > data && chunk_end < data_end && chunk_end[-1] != '\n') {
+            chunk_end++;
+        }
+        obj_chunk* chunk = &chunks[c];
+        chunk->start = chunk_start;
+        chunk->end = chunk_end;
+        // Reserve roughly what a typical chunk of this size holds.
+        u64 estimate = (u64)(chunk_end - chunk_start) / 64 + 16;
+        chunk->positions = darray_reserve(vec3, estimate);
+        chunk->normals = darray_reserve(vec3, estimate);
+        chunk->tex_coords = darray_reserve(vec2, estimate);
+        chunk->faces = darray_reserve(mesh_face_data, estimate);
+        chunk->directives = darray_create(obj_directive);
+        chunk_start = chunk_end;
+    }
 
-        prev_first_chars[1] = prev_first_chars[0];
-        prev_first_chars[0] = first_char;
-    }  // each line
+    job_system_parallel_for(chunk_count, 1, obj_parse_chunk_range, chunks, JOB_PRIORITY_HIGH);
 
-    // Process the remaining group since the last one will not have been trigged
-    // by the finding of a new name.
-    // Process each group as a subobject.
-    u64 group_count = darray_length(groups);
-    for (u64 i = 0; i < group_count; ++i) {
-        geometry_config new_data = {};
-        string_ncopy(new_data.name, name, 255);
-        if (i > 0) {
-            string_append_int(new_data.name, new_data.name, i);
+    // Merge the attribute and face streams, in file order.
+    kzero_memory(out_result, sizeof(obj_parse_result));
+    for (u32 c = 0; c < chunk_count; ++c) {
+        out_result->position_count += darray_length(chunks[c].positions);
+        out_result->normal_count += darray_length(chunks[c].normals);
+        out_result->tex_coord_count += darray_length(chunks[c].tex_coords);
+        chunks[c].face_offset = out_result->face_count;
+        out_result->face_count += darray_length(chunks[c].faces);
+    }
+    // Any of these may be absent from the file.
+    out_result->positions = out_result->position_count ? kallocate(sizeof(vec3) * out_result->position_count, MEMORY_TAG_ARRAY) : 0;
+    out_result->normals = out_result->normal_count ? kallocate(sizeof(vec3) * out_result->normal_count, MEMORY_TAG_ARRAY) : 0;
+    out_result->tex_coords = out_result->tex_coord_count ? kallocate(sizeof(vec2) * out_result->tex_coord_count, MEMORY_TAG_ARRAY) : 0;
+    out_result->faces = out_result->face_count ? kallocate(sizeof(mesh_face_data) * out_result->face_count, MEMORY_TAG_ARRAY) : 0;
+    out_result->directives = darray_create(obj_directive);
+    u64 position_offset = 0;
+    u64 normal_offset = 0;
+    u64 tex_coord_offset = 0;
+    for (u32 c = 0; c < chunk_count; ++c) {
+        obj_chunk* chunk = &chunks[c];
+        u64 length = darray_length(chunk->positions);
+        kcopy_memory(out_result->positions + position_offset, chunk->positions, sizeof(vec3) * length);
+        position_offset += length;
+        length = darray_length(chunk->normals);
+        kcopy_memory(out_result->normals + normal_offset, chunk->normals, sizeof(vec3) * length);
+        normal_offset += length;
+        length = darray_length(chunk->tex_coords);
+        kcopy_memory(out_result->tex_coords + tex_coord_offset, chunk->tex_coords, sizeof(vec2) * length);
+        tex_coord_offset += length;
+        kcopy_memory(out_result->faces + chunk->face_offset, chunk->faces, sizeof(mesh_face_data) * darray_length(chunk->faces));
+
+        // Directives refer to faces of their own chunk until they are merged.
+        length = darray_length(chunk->directives);
+        for (u64 d = 0; d < length; ++d) {
+            obj_directive directive = chunk->directives[d];
+            directive.face_index += chunk->face_offset;
+            darray_push(out_result->directives, directive);
         }
-        string_ncopy(new_data.material_name, material_names[i], 255);
-
-        process_subobject(positions, normals, tex_coords, groups[i].faces, &new_data);
-        new_data.vertex_count = darray_length(new_data.vertices);
-        new_data.vertex_size = sizeof(vertex_3d);
-        new_data.index_count = darray_length(new_data.indices);
-        new_data.index_size = sizeof(u32);
 
-        darray_push(*out_geometries_darray, new_data);
+        darray_destroy(chunk->positions);
+        darray_destroy(chunk->normals);
+        darray_destroy(chunk->tex_coords);
+        darray_destroy(chunk->faces);
+        darray_destroy(chunk->directives);
+    }
+    kfree(chunks, sizeof(obj_chunk) * chunk_count, MEMORY_TAG_ARRAY);
+}
 
-        // Increment the number of objects.
-        darray_destroy(groups[i].faces);
+void obj_parse_result_destroy(obj_parse_result* result) {
+    if (result->positions) {
+        kfree(result->positions, sizeof(vec3) * result->position_count, MEMORY_TAG_ARRAY);
+    }
+    if (result->normals) {
+        kfree(result->normals, sizeof(vec3) * result->normal_count, MEMORY_TAG_ARRAY);
     }
+    if (result->tex_coords) {
+        kfree(result->tex_coords, sizeof(vec2) * result->tex_coord_count, MEMORY_TAG_ARRAY);
+    }
+    if (result->faces) {
+        kfree(result->faces, sizeof(mesh_face_data) * result->face_count, MEMORY_TAG_ARRAY);
+    }
+    if (result->directives) {
+        darray_destroy(result->directives);
+    }
+    kzero_memory(result, sizeof(obj_parse_result));
+}
 
-    darray_destroy(groups);
-    darray_destroy(positions);
-    darray_destroy(normals);
-    darray_destroy(tex_coords);
+// Each level of detail aims for this fraction of the indices of the level before.
+#define MESH_LOD_REDUCTION 0.5f
+// A level which keeps more than this fraction of the level before is not worth keeping, and ends the chain.
+#define MESH_LOD_MIN_REDUCTION 0.75f
+// The most error each level may add, relative to the size of the geometry.
+#define MESH_LOD_MAX_ERROR_STEP 0.02f
+// Levels with fewer triangles than this are not simplified further.
+#define MESH_LOD_MIN_TRIANGLES 64
 
-    if (string_length(material_file_name) > 0) {
-        // Load up the material file
-        char full_mtl_path[512];
-        string_directory_from_path(full_mtl_path, out_ksm_filename);
-        string_append_string(full_mtl_path, full_mtl_path, material_file_name);
+/**
+ * @brief Generates a chain of simplified levels of detail for the given config, which must have
+ * vertex_3d vertices and 32-bit indices. Every level shares the vertices, and the levels are
+ * stored one after another in the indices, with the full geometry first.
+ */
+static void generate_lods(geometry_config* config) {
+    u32 full_count = config->index_count;
+    config->lod_count = 1;
+    config->lods[0].index_offset = 0;
+    config->lods[0].index_count = full_count;
+    config->lods[0].error = 0.0f;
+    if (full_count / 3 < MESH_LOD_MIN_TRIANGLES) {
+        return;
+    }
 
-        // Process material library file.
-        if (!import_obj_material_library_file(full_mtl_path)) {
-            KERROR("Error reading obj mtl file.");
+    // Each level is at most MESH_LOD_MIN_REDUCTION of the one before, so the whole chain fits in 4x.
+    u64 capacity = (u64)full_count * 4;
+    u32* levels = kallocate(sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+    kcopy_memory(levels, config->indices, sizeof(u32) * full_count);
+    u32 offset = full_count;
+    f32 error = 0.0f;
+    while (config->lod_count < GEOMETRY_MAX_LODS) {
+        geometry_lod* previous = &config->lods[config->lod_count - 1];
+        if (previous->index_count / 3 < MESH_LOD_MIN_TRIANGLES) {
+            break;
+        }
+        u32 target = (u32)(previous->index_count * MESH_LOD_REDUCTION) / 3 * 3;
+        f32 step_error = 0.0f;
+        u32 count = geometry_simplify(config->vertex_count, config->vertices, previous->index_count, levels + previous->index_offset, target, MESH_LOD_MAX_ERROR_STEP, levels + offset, &step_error);
+        if (count == 0 || count > previous->index_count * MESH_LOD_MIN_REDUCTION) {
+            break;
         }
+        geometry_optimize_vertex_cache(config->vertex_count, config->vertices, count, levels + offset, GEOMETRY_VERTEX_CACHE_SIZE);
+
+        // Each level is simplified from the one before, so their errors add up.
+        error += step_error;
+        geometry_lod* lod = &config->lods[config->lod_count];
+        lod->index_offset = offset;
+        lod->index_count = count;
+        lod->error = error;
+        offset += count;
+        config->lod_count++;
     }
 
-    // De-duplicate geometry
-    u32 count = darray_length(*out_geometries_darray);
-    for (u64 i = 0; i < count; ++i) {
-        geometry_config* g = &((*out_geometries_darray)[i]);
-        KDEBUG("Geometry de-duplication process starting on geometry object named '%s'...", g->name);
+    if (config->lod_count > 1) {
+        u32* indices = kallocate(sizeof(u32) * offset, MEMORY_TAG_ARRAY);
+        kcopy_memory(indices, levels, sizeof(u32) * offset);
+        kfree(config->indices, sizeof(u32) * config->index_count, MEMORY_TAG_ARRAY);
+        config->indices = indices;
+        config->index_count = offset;
+
+        char counts[128];
+        u32 length = 0;
+        for (u8 i = 0; i < config->lod_count; ++i) {
+            length += string_format(counts + length, "%s%u", i ? ", " : "", config->lods[i].index_count / 3);
+        }
+        KINFO("Geometry '%s' levels of detail (triangles): %s, error %.4f.", config->name, counts, error);
+    }
+    kfree(levels, sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+}
 
-        u32 new_vert_count = 0;
-        vertex_3d* unique_verts = 0;
-        geometry_deduplicate_vertices(g->vertex_count, g->vertices, g->index_count, g->indices, &new_vert_count, &unique_verts);
+// Geometries with fewer triangles than this are culled whole, rather than split into meshlets.
+#define MESH_MESHLET_MIN_TRIANGLES 512
 
-        // Destroy the old, large array...
-        darray_destroy(g->vertices);
+/**
+ * @brief Splits the full level of detail of the given config into meshlets, which must have
+ * vertex_3d vertices and 32-bit indices already ordered for the vertex cache.
+ */
+static void generate_meshlets(geometry_config* config) {
+    u32 index_count = config->lod_count ? config->lods[0].index_count : config->index_count;
+    if (index_count / 3 < MESH_MESHLET_MIN_TRIANGLES) {
+        return;
+    }
 
-        // And replace with the de-duplicated one.
-        g->vertices = unique_verts;
-        g->vertex_count = new_vert_count;
+    u32 bound = geometry_meshlet_count_bound(index_count, GEOMETRY_MESHLET_MAX_VERTICES, GEOMETRY_MESHLET_MAX_TRIANGLES);
+    geometry_meshlet* meshlets = kallocate(sizeof(geometry_meshlet) * bound, MEMORY_TAG_ARRAY);
+    u32 count = geometry_build_meshlets(config->vertex_count, config->vertices, index_count, config->indices, GEOMETRY_MESHLET_MAX_VERTICES, GEOMETRY_MESHLET_MAX_TRIANGLES, meshlets);
 
-        // Take a copy of the indices as a normal, non-darray
-        u32* indices = kallocate(sizeof(u32) * g->index_count, MEMORY_TAG_ARRAY);
-        kcopy_memory(indices, g->indices, sizeof(u32) * g->index_count);
-        // Destroy the darray
-        darray_destroy(g->indices);
-        // Replace with the non-darray version.
-        g->indices = indices;
+    config->meshlet_count = count;
+    config->meshlets = kallocate(sizeof(geometry_meshlet) * count, MEMORY_TAG_ARRAY);
+    kcopy_memory(config->meshlets, meshlets, sizeof(geometry_meshlet) * count);
+    kfree(meshlets, sizeof(geometry_meshlet) * bound, MEMORY_TAG_ARRAY);
 
-        // Also generate tangents here, this way tangents are also stored in the output file.
-        geometry_generate_tangents(g->vertex_count, g->vertices, g->index_count, g->indices);
+    u32 cullable = 0;
+    for (u32 i = 0; i < count; ++i) {
+        cullable += config->meshlets[i].cone_cutoff < 1.0f;
     }
-
-    // Output a ksm file, which will be loaded in the future.
-    return write_ksm_file(out_ksm_filename, name, count, *out_geometries_darray);
+    KINFO("Geometry '%s' split into %u meshlets, %u of which can be backface culled.", config->name, count, cullable);
 }
 
-void process_subobject(vec3* positions, vec3* normals, vec2* tex_coords, mesh_face_data* faces, geometry_config* out_data) {
-    out_data->indices = darray_create(u32);
-    out_data->vertices = darray_create(vertex_3d);
-    b8 extent_set = false;
-    kzero_memory(&out_data->min_extents, sizeof(vec3));
-    kzero_memory(&out_data->max_extents, sizeof(vec3));
-
-    u64 face_count = darray_length(faces);
-    u64 normal_count = darray_length(normals);
-    u64 tex_coord_count = darray_length(tex_coords);
-
-    b8 skip_normals = false;
-    b8 skip_tex_coords = false;
-    if (normal_count == 0) {
+/**
+ * @brief Builds a geometry's vertices and indices from its faces, which refer to the merged
+ * position, normal and texture coordinate streams.
+ */
+static void process_subobject(const obj_process_params* params, const mesh_face_data* faces, u64 face_count, geometry_config* out_data) {
+    out_data->vertex_count = (u32)(face_count * 3);
+    out_data->vertex_size = sizeof(vertex_3d);
+    out_data->index_count = (u32)(face_count * 3);
+    out_data->index_size = sizeof(u32);
+    vertex_3d* vertices = kallocate(sizeof(vertex_3d) * out_data->vertex_count, MEMORY_TAG_ARRAY);
+    u32* indices = kallocate(sizeof(u32) * out_data->index_count, MEMORY_TAG_ARRAY);
+
+    if (params->normal_count == 0) {
         KWARN("No normals are present in this model.");
-        skip_normals = true;
     }
-    if (tex_coord_count == 0) {
+    if (params->tex_coord_count == 0) {
         KWARN("No texture coordinates are present in this model.");
-        skip_tex_coords = true;
     }
     for (u64 f = 0; f < face_count; ++f) {
-        mesh_face_data face = faces[f];
-
         // Each vertex
         for (u64 i = 0; i < 3; ++i) {
-            mesh_vertex_index_data index_data = face.vertices[i];
-            darray_push(out_data->indices, (u32)(i + (f * 3)));
+            const mesh_vertex_index_data* index_data = &faces[f].vertices[i];
+            u64 v = f * 3 + i;
+            indices[v] = (u32)v;
+
+            // Indices are 1-based. Missing or out of range attributes get defaults.
+            vertex_3d* vert = &vertices[v];
+            vert->position = index_data->position_index - 1 < params->position_count
+                                 ? params->positions[index_data->position_index - 1]
+                                 : vec3_zero();
+            vert->normal = index_data->normal_index - 1 < params->normal_count
+                               ? params->normals[index_data->normal_index - 1]
+                               : vec3_create(0, 0, 1);
+            vert->texcoord = index_data->texcoord_index - 1 < params->tex_coord_count
+                                 ? params->tex_coords[index_data->texcoord_index - 1]
+                                 : vec2_zero();
 
-            vertex_3d vert;
+            // TODO: Color. Hardcode to white for now.
+            vert->colour = vec4_one();
+        }
+    }
 
-            vec3 pos = positions[index_data.position_index - 1];
-            vert.position = pos;
+    kernel_vertex_3d_extents(out_data->vertex_count, vertices, &out_data->min_extents, &out_data->max_extents);
 
-            // Check extents - min
-            if (pos.x < out_data->min_extents.x || !extent_set) {
-                out_data->min_extents.x = pos.x;
-            }
-            if (pos.y < out_data->min_extents.y || !extent_set) {
-                out_data->min_extents.y = pos.y;
-            }
-            if (pos.z < out_data->min_extents.z || !extent_set) {
-                out_data->min_extents.z = pos.z;
-            }
+    // Calculate the center based on the extents.
+    for (u8 i = 0; i < 3; ++i) {
+        out_data->center.elements[i] = (out_data->min_extents.elements[i] + out_data->max_extents.elements[i]) / 2.0f;
+    }
 
-            // Check extents - max
-            if (pos.x > out_data->max_extents.x || !extent_set) {
-                out_data->max_extents.x = pos.x;
-            }
-            if (pos.y > out_data->max_extents.y || !extent_set) {
-                out_data->max_extents.y = pos.y;
-            }
-            if (pos.z > out_data->max_extents.z || !extent_set) {
-                out_data->max_extents.z = pos.z;
-            }
+    // De-duplicate geometry
+    KDEBUG("Geometry de-duplication process starting on geometry object named '%s'...", out_data->name);
+    u32 new_vert_count = 0;
+    vertex_3d* unique_verts = 0;
+    geometry_deduplicate_vertices(out_data->vertex_count, vertices, out_data->index_count, indices, &new_vert_count, &unique_verts);
+    kfree(vertices, sizeof(vertex_3d) * out_data->vertex_count, MEMORY_TAG_ARRAY);
+    out_data->vertices = unique_verts;
+    out_data->vertex_count = new_vert_count;
+    out_data->indices = indices;
+
+    // Also generate tangents here, this way tangents are also stored in the output file.
+    geometry_generate_tangents(out_data->vertex_count, out_data->vertices, out_data->index_count, out_data->indices);
+
+    // Reorder triangles for the vertex cache and overdraw, then vertices to match, so the ksm
+    // is stored in the optimized order.
+    geometry_vertex_cache_stats before;
+    geometry_analyze_vertex_cache(out_data->vertex_count, out_data->index_count, out_data->indices, GEOMETRY_VERTEX_CACHE_SIZE, &before);
+    geometry_optimize_vertex_cache(out_data->vertex_count, out_data->vertices, out_data->index_count, out_data->indices, GEOMETRY_VERTEX_CACHE_SIZE);
+    geometry_optimize_vertex_fetch(out_data->vertex_count, out_data->vertices, out_data->index_count, out_data->indices);
+    geometry_vertex_cache_stats after;
+    geometry_analyze_vertex_cache(out_data->vertex_count, out_data->index_count, out_data->indices, GEOMETRY_VERTEX_CACHE_SIZE, &after);
+    KINFO("Geometry '%s' (%u triangles): ACMR %.3f -> %.3f, ATVR %.3f -> %.3f.",
+          out_data->name, out_data->index_count / 3, before.acmr, after.acmr, before.atvr, after.atvr);
+
+    // Simplified levels of detail share the optimized vertices, and follow the full geometry in the indices.
+    generate_lods(out_data);
+    generate_meshlets(out_data);
+
+    // Most geometries are small enough for 16-bit indices, which halve the index memory and bandwidth.
+    geometry_system_config_compact_indices(out_data);
+    geometry_system_config_pack_vertices(out_data);
+}
 
-            extent_set = true;
+static void obj_process_group_range(u32 start, u32 end, void* params) {
+    obj_process_params* process = params;
+    for (u32 i = start; i < end; ++i) {
+        PROFILE_SCOPE("obj_process_group");
+        const obj_group_range* range = &process->ranges[i];
+        process_subobject(process, process->faces + range->first_face, range->face_count, &process->geometries[i]);
+    }
+}
 
-            if (skip_normals) {
-                vert.normal = vec3_create(0, 0, 1);
-            } else {
-                vert.normal = normals[index_data.normal_index - 1];
-            }
+/**
+ * @brief Imports an obj file. This reads the obj, creates geometry configs, then calls logic to write
+ * those geometries out to a binary ksm file. That file can be used on the next load.
+ *
+ * The file is mapped and parsed with obj_parse, then each group of faces is processed into a
+ * geometry in parallel.
+ *
+ * @param obj_path The path of the obj file to be read.
+ * @param out_ksm_filename The path to the ksm file to be written to.
+ * @param out_geometries_darray A darray of geometries parsed from the file.
+ * @return True on success; otherwise false.
+ */
+b8 import_obj_file(const char* obj_path, const char* out_ksm_filename, geometry_config** out_geometries_darray) {
+    PROFILE_SCOPE("import_obj_file");
+    file_mapping mapping;
+    if (!filesystem_map(obj_path, FILE_MAP_HINT_SEQUENTIAL | FILE_MAP_HINT_WILL_NEED, &mapping)) {
+        KERROR("Unable to map obj file '%s'.", obj_path);
+        return false;
+    }
+    obj_parse_result parsed;
+    obj_parse(mapping.data, mapping.size, 0, &parsed);
+    filesystem_unmap(&mapping);
+
+    obj_process_params process = {};
+    process.positions = parsed.positions;
+    process.position_count = parsed.position_count;
+    process.normals = parsed.normals;
+    process.normal_count = parsed.normal_count;
+    process.tex_coords = parsed.tex_coords;
+    process.tex_coord_count = parsed.tex_coord_count;
+    process.faces = parsed.faces;
+
+    // Replay the directives in order. Any time there is a usemtl, a new group starts, which runs
+    // until the next usemtl or g. Each g names the groups which follow it. Faces outside of any
+    // usemtl form a group without a material.
+    char material_file_name[512] = "";
+    char name[GEOMETRY_NAME_MAX_LENGTH] = "";
+    obj_group_range* ranges = darray_create(obj_group_range);
+    u32 group_index_in_object = 0;
+    u64 group_start = 0;
+    const char* group_material = "";
+    u64 directive_count = darray_length(parsed.directives);
+    for (u64 d = 0; d <= directive_count; ++d) {
+        // A final pass past the last directive closes the last group at the end of the file.
+        obj_directive* directive = d < directive_count ? &parsed.directives[d] : 0;
+        u64 face_index = directive ? directive->face_index : parsed.face_count;
+        if (directive && directive->type == OBJ_DIRECTIVE_MTLLIB) {
+            string_ncopy(material_file_name, directive->text, 511);
+            continue;
+        }
 
-            if (skip_tex_coords) {
-                vert.texcoord = vec2_zero();
-            } else {
-                vert.texcoord = tex_coords[index_data.texcoord_index - 1];
-            }
+        // Close the current group. Groups without faces produce no geometry.
+        if (face_index > group_start) {
+            obj_group_range range = {group_start, face_index - group_start};
+            darray_push(ranges, range);
 
-            // TODO: Color. Hardcode to white for now.
-            vert.colour = vec4_one();
+            geometry_config new_data = {};
+            string_ncopy(new_data.name, name, GEOMETRY_NAME_MAX_LENGTH - 1);
+            if (group_index_in_object > 0) {
+                string_append_int(new_data.name, new_data.name, group_index_in_object);
+            }
+            string_ncopy(new_data.material_name, group_material, MATERIAL_NAME_MAX_LENGTH - 1);
+            darray_push(*out_geometries_darray, new_data);
+            group_index_in_object++;
+        }
+        group_start = face_index;
 
-            darray_push(out_data->vertices, vert);
+        if (!directive) {
+            break;
+        }
+        if (directive->type == OBJ_DIRECTIVE_GROUP) {
+            string_ncopy(name, directive->text, GEOMETRY_NAME_MAX_LENGTH - 1);
+            group_index_in_object = 0;
+            group_material = "";
+        } else {
+            group_material = directive->text;
         }
     }
+    u32 count = darray_length(ranges);
 
-    // Calculate the center based on the extents.
-    for (u8 i = 0; i < 3; ++i) {
-        out_data->center.elements[i] = (out_data->min_extents.elements[i] + out_data->max_extents.elements[i]) / 2.0f;
+    // Process each group as a subobject, in parallel.
+    process.ranges = ranges;
+    process.geometries = *out_geometries_darray;
+    job_system_parallel_for(count, 1, obj_process_group_range, &process, JOB_PRIORITY_HIGH);
+
+    darray_destroy(ranges);
+    obj_parse_result_destroy(&parsed);
+
+    if (string_length(material_file_name) > 0) {
+        // Load up the material file
+        char full_mtl_path[512];
+        string_directory_from_path(full_mtl_path, out_ksm_filename);
+        string_append_string(full_mtl_path, full_mtl_path, material_file_name);
+
+        // Process material library file.
+        if (!import_obj_material_library_file(full_mtl_path)) {
+            KERROR("Error reading obj mtl file.");
+        }
     }
+
+    // Output a ksm file, which will be loaded in the future.
+    return write_ksm_file(out_ksm_filename, name, count, *out_geometries_darray);
 }
 
 // TODO: Load the material library file, and create material definitions from it.
@@ -634,8 +1233,8 @@ void process_subobject(vec3* positions, vec3* normals, vec2* tex_coords, mesh_fa
 b8 import_obj_material_library_file(const char* mtl_file_path) {
     KDEBUG("Importing obj .mtl file '%s'...", mtl_file_path);
     // Grab the .mtl file, if it exists, and read the material information.
-    file_handle mtl_file;
-    if (!filesystem_open(mtl_file_path, FILE_MODE_READ, false, &mtl_file)) {
+    file_mapping mapping;
+    if (!filesystem_map(mtl_file_path, FILE_MAP_HINT_SEQUENTIAL, &mapping)) {
         KERROR("Unable to open mtl file: %s", mtl_file_path);
         return false;
     }
@@ -645,153 +1244,80 @@ b8 import_obj_material_library_file(const char* mtl_file_path) {
 
     b8 hit_name = false;
 
-    char* line = 0;
-    char line_buffer[512];
-    char* p = &line_buffer[0];
-    u64 line_length = 0;
-    while (true) {
-        if (!filesystem_read_line(&mtl_file, 512, &p, &line_length)) {
-            break;
-        }
-        // Trim the line first.
-        line = string_trim(line_buffer);
-        line_length = string_length(line);
-
+    string_view remaining = string_view_create_from_range(mapping.data, mapping.size);
+    string_view line;
+    while (string_view_split_next(&remaining, '\n', &line)) {
         // Skip blank lines.
-        if (line_length < 1) {
+        string_view keyword;
+        if (!string_view_token_next(&line, &keyword)) {
             continue;
         }
+        // The rest of the line is the value, which may be a path containing spaces.
+        string_view value = string_view_trim(line);
 
-        char first_char = line[0];
-        switch (first_char) {
-            case '#':
-                // Skip comments
-                continue;
-            case 'K': {
-                char second_char = line[1];
-                switch (second_char) {
-                    case 'a':
-                    case 'd': {
-                        // Ambient/Diffuse colour are treated the same at this level.
-                        // ambient colour is determined by the level.
-                        char t[2];
-                        sscanf(
-                            line,
-                            "%s %f %f %f",
-                            t,
-                            &current_config.diffuse_colour.r,
-                            &current_config.diffuse_colour.g,
-                            &current_config.diffuse_colour.b);
-
-                        // NOTE: This is only used by the colour shader, and will set to max_norm by default.
-                        // Transparency could be added as a material property all its own at a later time.
-                        current_config.diffuse_colour.a = 1.0f;
-                    } break;
-                    case 's': {
-                        // Specular colour
-                        char t[2];
-
-                        // NOTE: Not using this for now.
-                        f32 spec_rubbish = 0.0f;
-                        sscanf(
-                            line,
-                            "%s %f %f %f",
-                            t,
-                            &spec_rubbish,
-                            &spec_rubbish,
-                            &spec_rubbish);
-                    } break;
-                }
-            } break;
-            case 'N': {
-                char second_char = line[1];
-                switch (second_char) {
-                    case 's': {
-                        // Specular exponent
-                        char t[2];
-
-                        sscanf(line, "%s %f", t, &current_config.shininess);
-                    } break;
-                }
-            } break;
-            case 'm': {
-                // map
-                char substr[10];
-                char texture_file_name[512];
-
-                sscanf(
-                    line,
-                    "%s %s",
-                    substr,
-                    texture_file_name);
-
-                //
-                if (strings_nequali(substr, "map_Kd", 6)) {
-                    // Is a diffuse texture map
-                    string_filename_no_extension_from_path(current_config.diffuse_map_name, texture_file_name);
-                } else if (strings_nequali(substr, "map_Ks", 6)) {
-                    // Is a specular texture map
-                    string_filename_no_extension_from_path(current_config.specular_map_name, texture_file_name);
-                } else if (strings_nequali(substr, "map_bump", 8)) {
-                    // Is a bump texture map
-                    string_filename_no_extension_from_path(current_config.normal_map_name, texture_file_name);
-                }
-            } break;
-            case 'b': {
-                // Some implementations use 'bump' instead of 'map_bump'.
-                char substr[10];
-                char texture_file_name[512];
-
-                sscanf(
-                    line,
-                    "%s %s",
-                    substr,
-                    texture_file_name);
-                if (strings_nequali(substr, "bump", 4)) {
-                    // Is a bump (normal) texture map
-                    string_filename_no_extension_from_path(current_config.normal_map_name, texture_file_name);
-                }
+        if (keyword.data[0] == '#') {
+            // Skip comments
+            continue;
+        } else if (string_view_equal(keyword, "Ka") || string_view_equal(keyword, "Kd")) {
+            // Ambient/Diffuse colour are treated the same at this level.
+            // ambient colour is determined by the level.
+            current_config.diffuse_colour.r = obj_next_f32(&line);
+            current_config.diffuse_colour.g = obj_next_f32(&line);
+            current_config.diffuse_colour.b = obj_next_f32(&line);
+
+            // NOTE: This is only used by the colour shader, and will set to max_norm by default.
+            // Transparency could be added as a material property all its own at a later time.
+            current_config.diffuse_colour.a = 1.0f;
+        } else if (string_view_equal(keyword, "Ns")) {
+            // Specular exponent
+            current_config.shininess = obj_next_f32(&line);
+        } else if (string_view_equali(keyword, "map_Kd")) {
+            // Is a diffuse texture map
+            char texture_file_name[512];
+            string_view_copy(texture_file_name, value, 512);
+            string_filename_no_extension_from_path(current_config.diffuse_map_name, texture_file_name);
+        } else if (string_view_equali(keyword, "map_Ks")) {
+            // Is a specular texture map
+            char texture_file_name[512];
+            string_view_copy(texture_file_name, value, 512);
+            string_filename_no_extension_from_path(current_config.specular_map_name, texture_file_name);
+        } else if (string_view_equali(keyword, "map_bump") || string_view_equali(keyword, "bump")) {
+            // Is a bump (normal) texture map. Some implementations use 'bump' instead of 'map_bump'.
+            char texture_file_name[512];
+            string_view_copy(texture_file_name, value, 512);
+            string_filename_no_extension_from_path(current_config.normal_map_name, texture_file_name);
+        } else if (string_view_equali(keyword, "newmtl")) {
+            // Is a material name.
+
+            // NOTE: Hardcoding default material shader name because all objects imported this way
+            // will be treated the same.
+            current_config.shader_name = "Shader.Builtin.Material";
+            // NOTE: Shininess of 0 will cause problems in the shader. Use a default
+            // if this is the case.
+            if (current_config.shininess == 0.0f) {
+                current_config.shininess = 8.0f;
             }
-            case 'n': {
-                // Some implementations use 'bump' instead of 'map_bump'.
-                char substr[10];
-                char material_name[512];
-
-                sscanf(
-                    line,
-                    "%s %s",
-                    substr,
-                    material_name);
-                if (strings_nequali(substr, "newmtl", 6)) {
-                    // Is a material name.
-
-                    // NOTE: Hardcoding default material shader name because all objects imported this way
-                    // will be treated the same.
-                    current_config.shader_name = "Shader.Builtin.Material";
-                    // NOTE: Shininess of 0 will cause problems in the shader. Use a default
-                    // if this is the case.
-                    if (current_config.shininess == 0.0f) {
-                        current_config.shininess = 8.0f;
-                    }
-                    if (hit_name) {
-                        //  Write out a kmt file and move on.
-                        if (!write_kmt_file(mtl_file_path, &current_config)) {
-                            KERROR("Unable to write kmt file.");
-                            return false;
-                        }
-
-                        // Reset the material for the next round.
-                        kzero_memory(&current_config, sizeof(current_config));
-                    }
-
-                    hit_name = true;
-
-                    string_ncopy(current_config.name, material_name, 256);
+            if (hit_name) {
+                //  Write out a kmt file and move on.
+                if (!write_kmt_file(mtl_file_path, &current_config)) {
+                    KERROR("Unable to write kmt file.");
+                    filesystem_unmap(&mapping);
+                    return false;
                 }
+
+                // Reset the material for the next round.
+                kzero_memory(&current_config, sizeof(current_config));
             }
+
+            hit_name = true;
+
+            string_view_copy(current_config.name, value, MATERIAL_NAME_MAX_LENGTH);
         }
+        // Anything else, such as the specular colour, is not used for now.
     }  // each line
 
+    filesystem_unmap(&mapping);
+
     // Write out the remaining kmt file.
     // NOTE: Hardcoding default material shader name because all objects imported this way
     // will be treated the same.
@@ -806,7 +1332,6 @@ b8 import_obj_material_library_file(const char* mtl_file_path) {
         return false;
     }
 
-    filesystem_close(&mtl_file);
     return true;
 }
 
@@ -871,6 +1396,8 @@ resource_loader mesh_resource_loader_create() {
     loader.custom_type = 0;
     loader.load = mesh_loader_load;
     loader.unload = mesh_loader_unload;
+    loader.resolve_path = mesh_loader_resolve_path;
+    loader.load_from_memory = mesh_loader_load_from_memory;
     loader.type_path = "models";
 
     return loader;
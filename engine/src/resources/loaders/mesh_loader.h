@@ -12,6 +12,56 @@
 #pragma once
 
 #include "systems/resource_system.h"
+#include "systems/geometry_system.h"
+#include "platform/filesystem.h"
+
+typedef struct mesh_vertex_index_data {
+    u32 position_index;
+    u32 normal_index;
+    u32 texcoord_index;
+} mesh_vertex_index_data;
+
+typedef struct mesh_face_data {
+    mesh_vertex_index_data vertices[3];
+} mesh_face_data;
+
+typedef enum obj_directive_type {
+    OBJ_DIRECTIVE_MTLLIB,
+    OBJ_DIRECTIVE_USEMTL,
+    OBJ_DIRECTIVE_GROUP
+} obj_directive_type;
+
+/**
+ * @brief A statement which affects how faces are grouped, recorded along with the number of
+ * faces before it, so it can be replayed in file order.
+ */
+typedef struct obj_directive {
+    obj_directive_type type;
+    u64 face_index;
+    char text[MATERIAL_NAME_MAX_LENGTH];
+} obj_directive;
+
+/** @brief The attributes, faces and directives of an obj file, in file order. */
+typedef struct obj_parse_result {
+    vec3* positions;
+    u64 position_count;
+    vec3* normals;
+    u64 normal_count;
+    vec2* tex_coords;
+    u64 tex_coord_count;
+    /** @brief The faces, with polygons split into triangle fans. Indices are 1-based, and 0 where missing. */
+    mesh_face_data* faces;
+    u64 face_count;
+    /** @brief A darray of the directives. */
+    obj_directive* directives;
+} obj_parse_result;
+
+/** @brief The contents of a ksm file, kept for as long as geometry data points into them. */
+typedef struct ksm_contents {
+    file_mapping contents;
+    /** @brief Set if the contents were read into an allocation, rather than mapped. */
+    b8 allocated;
+} ksm_contents;
 
 /**
  * @brief Creates and returns a mesh resource loader.
@@ -19,3 +69,44 @@
  * @return The newly created resource loader.
  */
 resource_loader mesh_resource_loader_create();
+
+/**
+ * @brief Loads the geometries of a ksm file into the given darray. Version 2 and later files
+ * are mapped and used in place, in which case out_contents is set to the mapping, which must
+ * be kept for as long as the geometry data is used.
+ *
+ * @param path The path of the file.
+ * @param out_geometries_darray A pointer to a darray of geometry_configs to add to.
+ * @param out_contents A pointer to hold the contents the geometry data points into, or 0 if it does not.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 load_ksm_file(const char* path, geometry_config** out_geometries_darray, ksm_contents** out_contents);
+
+/**
+ * @brief Writes the given geometries to a ksm file of the current version.
+ *
+ * @param path The path of the file.
+ * @param name The name of the mesh.
+ * @param geometry_count The number of geometries.
+ * @param geometries The geometries to write.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 write_ksm_file(const char* path, const char* name, u32 geometry_count, geometry_config* geometries);
+
+/**
+ * @brief Parses the contents of an obj file. The contents are split into line-aligned chunks,
+ * which are parsed in parallel and then stitched back together in file order.
+ *
+ * @param data The contents of the file.
+ * @param size The size of the contents in bytes.
+ * @param chunk_count The number of chunks to split the contents into, or 0 to pick one from the size and thread count.
+ * @param out_result A pointer to hold the result, which should be destroyed with obj_parse_result_destroy.
+ */
+KAPI void obj_parse(const char* data, u64 size, u32 chunk_count, obj_parse_result* out_result);
+
+/**
+ * @brief Releases the memory held by the result of obj_parse.
+ *
+ * @param result A pointer to the result to destroy.
+ */
+KAPI void obj_parse_result_destroy(obj_parse_result* result);
@@ -3,6 +3,7 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "core/profiler.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
 #include "math/kmath.h"
@@ -11,7 +12,24 @@
 
 #include "platform/filesystem.h"
 
+/**
+ * @brief Splits a comma-separated value into trimmed fields, storing up to max_fields of them.
+ * Returns the total number of fields, which may be more than were stored.
+ */
+static u32 split_fields(string_view value, string_view* out_fields, u32 max_fields) {
+    u32 count = 0;
+    string_view field;
+    while (string_view_split_next(&value, ',', &field)) {
+        if (count < max_fields) {
+            out_fields[count] = string_view_trim(field);
+        }
+        count++;
+    }
+    return count;
+}
+
 b8 shader_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
+    PROFILE_SCOPE("shader_loader_load");
     if (!self || !name || !out_resource) {
         return false;
     }
@@ -20,8 +38,9 @@ b8 shader_loader_load(struct resource_loader* self, const char* name, resource*
     char full_file_path[512];
     string_format(full_file_path, format_str, resource_system_base_path(), self->type_path, name, ".shadercfg");
 
-    file_handle f;
-    if (!filesystem_open(full_file_path, FILE_MODE_READ, false, &f)) {
+    // The whole file is mapped and parsed in place through views, without copying each line.
+    file_mapping mapping;
+    if (!filesystem_map(full_file_path, FILE_MAP_HINT_SEQUENTIAL, &mapping)) {
         KERROR("shader_loader_load - unable to open shader file for reading: '%s'.", full_file_path);
         return false;
     }
@@ -46,189 +65,189 @@ b8 shader_loader_load(struct resource_loader* self, const char* name, resource*
     resource_data->name = 0;
 
     // Read each line of the file.
-    char line_buf[512] = "";
-    char* p = &line_buf[0];
-    u64 line_length = 0;
-    u32 line_number = 1;
-    while (filesystem_read_line(&f, 511, &p, &line_length)) {
-        // Trim the string.
-        char* trimmed = string_trim(line_buf);
-
-        // Get the trimmed length.
-        line_length = string_length(trimmed);
+    string_view remaining = string_view_create_from_range(mapping.data, mapping.size);
+    string_view line;
+    u32 line_number = 0;
+    while (string_view_split_next(&remaining, '\n', &line)) {
+        line_number++;
+        // Trim the line.
+        line = string_view_trim(line);
 
         // Skip blank lines and comments.
-        if (line_length < 1 || trimmed[0] == '#') {
-            line_number++;
+        if (line.length < 1 || line.data[0] == '#') {
             continue;
         }
 
         // Split into var/value
-        i32 equal_index = string_index_of(trimmed, '=');
+        i64 equal_index = string_view_index_of(line, '=');
         if (equal_index == -1) {
-            KWARN("Potential formatting issue found in file '%s': '=' token not found. Skipping line %ui.", full_file_path, line_number);
-            line_number++;
+            KWARN("Potential formatting issue found in file '%s': '=' token not found. Skipping line %u.", full_file_path, line_number);
             continue;
         }
 
-        // Assume a max of 64 characters for the variable name.
-        char raw_var_name[64];
-        kzero_memory(raw_var_name, sizeof(char) * 64);
-        string_mid(raw_var_name, trimmed, 0, equal_index);
-        char* trimmed_var_name = string_trim(raw_var_name);
-
-        // Assume a max of 511-65 (446) for the max length of the value to account for the variable name and the '='.
-        char raw_value[446];
-        kzero_memory(raw_value, sizeof(char) * 446);
-        string_mid(raw_value, trimmed, equal_index + 1, -1);  // Read the rest of the line
-        char* trimmed_value = string_trim(raw_value);
+        string_view var_name = string_view_trim(string_view_mid(line, 0, (u64)equal_index));
+        string_view value = string_view_trim(string_view_mid(line, (u64)equal_index + 1, line.length));
 
         // Process the variable.
-        if (strings_equali(trimmed_var_name, "version")) {
+        if (string_view_equali(var_name, "version")) {
             // TODO: version
-        } else if (strings_equali(trimmed_var_name, "name")) {
-            resource_data->name = string_duplicate(trimmed_value);
-        } else if (strings_equali(trimmed_var_name, "renderpass")) {
-            resource_data->renderpass_name = string_duplicate(trimmed_value);
-        } else if (strings_equali(trimmed_var_name, "stages")) {
-            // Parse the stages
-            char** stage_names = darray_create(char*);
-            u32 count = string_split(trimmed_value, ',', &stage_names, true, true);
-            resource_data->stage_names = stage_names;
-            // Ensure stage name and stage file name count are the same, as they should align.
-            if (resource_data->stage_count == 0) {
-                resource_data->stage_count = count;
-            } else if (resource_data->stage_count != count) {
-                KERROR("shader_loader_load: Invalid file layout. Count mismatch between stage names and stage filenames.");
-            }
-            // Parse each stage and add the right type to the array.
-            for (u8 i = 0; i < resource_data->stage_count; ++i) {
-                if (strings_equali(stage_names[i], "frag") || strings_equali(stage_names[i], "fragment")) {
+        } else if (string_view_equali(var_name, "name")) {
+            resource_data->name = string_view_duplicate(value);
+        } else if (string_view_equali(var_name, "renderpass")) {
+            resource_data->renderpass_name = string_view_duplicate(value);
+        } else if (string_view_equali(var_name, "stages")) {
+            // Parse the stages, keeping a copy of each name.
+            u32 count = 0;
+            string_view stage_name;
+            while (string_view_split_next(&value, ',', &stage_name)) {
+                stage_name = string_view_trim(stage_name);
+                darray_push(resource_data->stage_names, string_view_duplicate(stage_name));
+                count++;
+                // Add the right type to the array.
+                if (string_view_equali(stage_name, "frag") || string_view_equali(stage_name, "fragment")) {
                     darray_push(resource_data->stages, SHADER_STAGE_FRAGMENT);
-                } else if (strings_equali(stage_names[i], "vert") || strings_equali(stage_names[i], "vertex")) {
+                } else if (string_view_equali(stage_name, "vert") || string_view_equali(stage_name, "vertex")) {
                     darray_push(resource_data->stages, SHADER_STAGE_VERTEX);
-                } else if (strings_equali(stage_names[i], "geom") || strings_equali(stage_names[i], "geometry")) {
+                } else if (string_view_equali(stage_name, "geom") || string_view_equali(stage_name, "geometry")) {
                     darray_push(resource_data->stages, SHADER_STAGE_GEOMETRY);
-                } else if (strings_equali(stage_names[i], "comp") || strings_equali(stage_names[i], "compute")) {
+                } else if (string_view_equali(stage_name, "comp") || string_view_equali(stage_name, "compute")) {
                     darray_push(resource_data->stages, SHADER_STAGE_COMPUTE);
                 } else {
-                    KERROR("shader_loader_load: Invalid file layout. Unrecognized stage '%s'", stage_names[i]);
+                    char stage_name_text[64];
+                    string_view_copy(stage_name_text, stage_name, 64);
+                    KERROR("shader_loader_load: Invalid file layout. Unrecognized stage '%s'", stage_name_text);
                 }
             }
-        } else if (strings_equali(trimmed_var_name, "stagefiles")) {
-            // Parse the stage file names
-            resource_data->stage_filenames = darray_create(char*);
-            u32 count = string_split(trimmed_value, ',', &resource_data->stage_filenames, true, true);
             // Ensure stage name and stage file name count are the same, as they should align.
             if (resource_data->stage_count == 0) {
                 resource_data->stage_count = count;
             } else if (resource_data->stage_count != count) {
                 KERROR("shader_loader_load: Invalid file layout. Count mismatch between stage names and stage filenames.");
             }
-        } else if (strings_equali(trimmed_var_name, "use_instance")) {
-            string_to_bool(trimmed_value, &resource_data->use_instances);
-        } else if (strings_equali(trimmed_var_name, "use_local")) {
-            string_to_bool(trimmed_value, &resource_data->use_local);
-        } else if (strings_equali(trimmed_var_name, "attribute")) {
+        } else if (string_view_equali(var_name, "stagefiles")) {
+            // Parse the stage file names, keeping a copy of each.
+            u32 count = 0;
+            string_view stage_filename;
+            while (string_view_split_next(&value, ',', &stage_filename)) {
+                darray_push(resource_data->stage_filenames, string_view_duplicate(string_view_trim(stage_filename)));
+                count++;
+            }
+            // Ensure stage name and stage file name count are the same, as they should align.
+            if (resource_data->stage_count == 0) {
+                resource_data->stage_count = count;
+            } else if (resource_data->stage_count != count) {
+                KERROR("shader_loader_load: Invalid file layout. Count mismatch between stage names and stage filenames.");
+            }
+        } else if (string_view_equali(var_name, "use_instance")) {
+            string_view_to_bool(value, &resource_data->use_instances);
+        } else if (string_view_equali(var_name, "use_local")) {
+            string_view_to_bool(value, &resource_data->use_local);
+        } else if (string_view_equali(var_name, "attribute")) {
             // Parse attribute.
-            char** fields = darray_create(char*);
-            u32 field_count = string_split(trimmed_value, ',', &fields, true, true);
+            string_view fields[2];
+            u32 field_count = split_fields(value, fields, 2);
             if (field_count != 2) {
                 KERROR("shader_loader_load: Invalid file layout. Attribute fields must be 'type,name'. Skipping.");
             } else {
                 shader_attribute_config attribute;
                 // Parse field type
-                if (strings_equali(fields[0], "f32")) {
+                if (string_view_equali(fields[0], "f32")) {
                     attribute.type = SHADER_ATTRIB_TYPE_FLOAT32;
                     attribute.size = 4;
-                } else if (strings_equali(fields[0], "vec2")) {
+                } else if (string_view_equali(fields[0], "vec2")) {
                     attribute.type = SHADER_ATTRIB_TYPE_FLOAT32_2;
                     attribute.size = 8;
-                } else if (strings_equali(fields[0], "vec3")) {
+                } else if (string_view_equali(fields[0], "vec3")) {
                     attribute.type = SHADER_ATTRIB_TYPE_FLOAT32_3;
                     attribute.size = 12;
-                } else if (strings_equali(fields[0], "vec4")) {
+                } else if (string_view_equali(fields[0], "vec4")) {
                     attribute.type = SHADER_ATTRIB_TYPE_FLOAT32_4;
                     attribute.size = 16;
-                } else if (strings_equali(fields[0], "u8")) {
+                } else if (string_view_equali(fields[0], "u8")) {
                     attribute.type = SHADER_ATTRIB_TYPE_UINT8;
                     attribute.size = 1;
-                } else if (strings_equali(fields[0], "u16")) {
+                } else if (string_view_equali(fields[0], "u16")) {
                     attribute.type = SHADER_ATTRIB_TYPE_UINT16;
                     attribute.size = 2;
-                } else if (strings_equali(fields[0], "u32")) {
+                } else if (string_view_equali(fields[0], "u32")) {
                     attribute.type = SHADER_ATTRIB_TYPE_UINT32;
                     attribute.size = 4;
-                } else if (strings_equali(fields[0], "i8")) {
+                } else if (string_view_equali(fields[0], "i8")) {
                     attribute.type = SHADER_ATTRIB_TYPE_INT8;
                     attribute.size = 1;
-                } else if (strings_equali(fields[0], "i16")) {
+                } else if (string_view_equali(fields[0], "i16")) {
                     attribute.type = SHADER_ATTRIB_TYPE_INT16;
                     attribute.size = 2;
-                } else if (strings_equali(fields[0], "i32")) {
+                } else if (string_view_equali(fields[0], "i32")) {
                     attribute.type = SHADER_ATTRIB_TYPE_INT32;
                     attribute.size = 4;
+                } else if (string_view_equali(fields[0], "f16vec2")) {
+                    attribute.type = SHADER_ATTRIB_TYPE_FLOAT16_2;
+                    attribute.size = 4;
+                } else if (string_view_equali(fields[0], "snorm16vec4")) {
+                    attribute.type = SHADER_ATTRIB_TYPE_SNORM16_4;
+                    attribute.size = 8;
+                } else if (string_view_equali(fields[0], "unorm8vec4")) {
+                    attribute.type = SHADER_ATTRIB_TYPE_UNORM8_4;
+                    attribute.size = 4;
                 } else {
-                    KERROR("shader_loader_load: Invalid file layout. Attribute type must be f32, vec2, vec3, vec4, i8, i16, i32, u8, u16, or u32.");
+                    KERROR("shader_loader_load: Invalid file layout. Attribute type must be f32, vec2, vec3, vec4, i8, i16, i32, u8, u16, u32, f16vec2, snorm16vec4 or unorm8vec4.");
                     KWARN("Defaulting to f32.");
                     attribute.type = SHADER_ATTRIB_TYPE_FLOAT32;
                     attribute.size = 4;
                 }
 
                 // Take a copy of the attribute name.
-                attribute.name_length = string_length(fields[1]);
-                attribute.name = string_duplicate(fields[1]);
+                attribute.name_length = fields[1].length;
+                attribute.name = string_view_duplicate(fields[1]);
 
                 // Add the attribute.
                 darray_push(resource_data->attributes, attribute);
                 resource_data->attribute_count++;
             }
-
-            string_cleanup_split_array(fields);
-            darray_destroy(fields);
-        } else if (strings_equali(trimmed_var_name, "uniform")) {
+        } else if (string_view_equali(var_name, "uniform")) {
             // Parse uniform.
-            char** fields = darray_create(char*);
-            u32 field_count = string_split(trimmed_value, ',', &fields, true, true);
+            string_view fields[3];
+            u32 field_count = split_fields(value, fields, 3);
             if (field_count != 3) {
                 KERROR("shader_loader_load: Invalid file layout. Uniform fields must be 'type,scope,name'. Skipping.");
             } else {
                 shader_uniform_config uniform;
                 // Parse field type
-                if (strings_equali(fields[0], "f32")) {
+                if (string_view_equali(fields[0], "f32")) {
                     uniform.type = SHADER_UNIFORM_TYPE_FLOAT32;
                     uniform.size = 4;
-                } else if (strings_equali(fields[0], "vec2")) {
+                } else if (string_view_equali(fields[0], "vec2")) {
                     uniform.type = SHADER_UNIFORM_TYPE_FLOAT32_2;
                     uniform.size = 8;
-                } else if (strings_equali(fields[0], "vec3")) {
+                } else if (string_view_equali(fields[0], "vec3")) {
                     uniform.type = SHADER_UNIFORM_TYPE_FLOAT32_3;
                     uniform.size = 12;
-                } else if (strings_equali(fields[0], "vec4")) {
+                } else if (string_view_equali(fields[0], "vec4")) {
                     uniform.type = SHADER_UNIFORM_TYPE_FLOAT32_4;
                     uniform.size = 16;
-                } else if (strings_equali(fields[0], "u8")) {
+                } else if (string_view_equali(fields[0], "u8")) {
                     uniform.type = SHADER_UNIFORM_TYPE_UINT8;
                     uniform.size = 1;
-                } else if (strings_equali(fields[0], "u16")) {
+                } else if (string_view_equali(fields[0], "u16")) {
                     uniform.type = SHADER_UNIFORM_TYPE_UINT16;
                     uniform.size = 2;
-                } else if (strings_equali(fields[0], "u32")) {
+                } else if (string_view_equali(fields[0], "u32")) {
                     uniform.type = SHADER_UNIFORM_TYPE_UINT32;
                     uniform.size = 4;
-                } else if (strings_equali(fields[0], "i8")) {
+                } else if (string_view_equali(fields[0], "i8")) {
                     uniform.type = SHADER_UNIFORM_TYPE_INT8;
                     uniform.size = 1;
-                } else if (strings_equali(fields[0], "i16")) {
+                } else if (string_view_equali(fields[0], "i16")) {
                     uniform.type = SHADER_UNIFORM_TYPE_INT16;
                     uniform.size = 2;
-                } else if (strings_equali(fields[0], "i32")) {
+                } else if (string_view_equali(fields[0], "i32")) {
                     uniform.type = SHADER_UNIFORM_TYPE_INT32;
                     uniform.size = 4;
-                } else if (strings_equali(fields[0], "mat4")) {
+                } else if (string_view_equali(fields[0], "mat4")) {
                     uniform.type = SHADER_UNIFORM_TYPE_MATRIX_4;
                     uniform.size = 64;
-                } else if (strings_equali(fields[0], "samp") || strings_equali(fields[0], "sampler")) {
+                } else if (string_view_equali(fields[0], "samp") || string_view_equali(fields[0], "sampler")) {
                     uniform.type = SHADER_UNIFORM_TYPE_SAMPLER;
                     uniform.size = 0;  // Samplers don't have a size.
                 } else {
@@ -239,11 +258,11 @@ b8 shader_loader_load(struct resource_loader* self, const char* name, resource*
                 }
 
                 // Parse the scope
-                if (strings_equal(fields[1], "0")) {
+                if (string_view_equal(fields[1], "0")) {
                     uniform.scope = SHADER_SCOPE_GLOBAL;
-                } else if (strings_equal(fields[1], "1")) {
+                } else if (string_view_equal(fields[1], "1")) {
                     uniform.scope = SHADER_SCOPE_INSTANCE;
-                } else if (strings_equal(fields[1], "2")) {
+                } else if (string_view_equal(fields[1], "2")) {
                     uniform.scope = SHADER_SCOPE_LOCAL;
                 } else {
                     KERROR("shader_loader_load: Invalid file layout: Uniform scope must be 0 for global, 1 for instance or 2 for local.");
@@ -252,26 +271,19 @@ b8 shader_loader_load(struct resource_loader* self, const char* name, resource*
                 }
 
                 // Take a copy of the attribute name.
-                uniform.name_length = string_length(fields[2]);
-                uniform.name = string_duplicate(fields[2]);
+                uniform.name_length = fields[2].length;
+                uniform.name = string_view_duplicate(fields[2]);
 
                 // Add the attribute.
                 darray_push(resource_data->uniforms, uniform);
                 resource_data->uniform_count++;
             }
-
-            string_cleanup_split_array(fields);
-            darray_destroy(fields);
         }
 
         // TODO: more fields.
-
-        // Clear the line buffer.
-        kzero_memory(line_buf, sizeof(char) * 512);
-        line_number++;
     }
 
-    filesystem_close(&f);
+    filesystem_unmap(&mapping);
 
     out_resource->data = resource_data;
     out_resource->data_size = sizeof(shader_config);
@@ -321,6 +333,8 @@ resource_loader shader_resource_loader_create() {
     loader.custom_type = 0;
     loader.load = shader_loader_load;
     loader.unload = shader_loader_unload;
+    loader.resolve_path = 0;
+    loader.load_from_memory = 0;
     loader.type_path = "shaders";
 
     return loader;
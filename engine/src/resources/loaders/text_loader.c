@@ -3,6 +3,7 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "core/profiler.h"
 #include "resources/resource_types.h"
 #include "systems/resource_system.h"
 #include "math/kmath.h"
@@ -11,6 +12,7 @@
 #include "platform/filesystem.h"
 
 b8 text_loader_load(struct resource_loader* self, const char* name, resource* out_resource) {
+    PROFILE_SCOPE("text_loader_load");
     if (!self || !name || !out_resource) {
         return false;
     }
@@ -65,6 +67,8 @@ resource_loader text_resource_loader_create() {
     loader.custom_type = 0;
     loader.load = text_loader_load;
     loader.unload = text_loader_unload;
+    loader.resolve_path = 0;
+    loader.load_from_memory = 0;
     loader.type_path = "";
 
     return loader;
@@ -46,6 +46,8 @@ typedef struct resource {
     u64 data_size;
     /** @brief The resource data. */
     void* data;
+    /** @brief Data private to the loader which must live as long as the resource, such as a file mapping the data points into. */
+    void* loader_data;
 } resource;
 
 /**
@@ -212,6 +214,30 @@ typedef struct material {
 /** @brief The maximum length of a geometry name. */
 #define GEOMETRY_NAME_MAX_LENGTH 256
 
+/** @brief The maximum number of levels of detail a geometry can have, including the full one. */
+#define GEOMETRY_MAX_LODS 5
+
+/** @brief A range of a geometry's indices, drawn on its own. */
+typedef struct geometry_index_range {
+    /** @brief The first index of the range. */
+    u32 index_offset;
+    /** @brief The number of indices in the range. */
+    u32 index_count;
+} geometry_index_range;
+
+/**
+ * @brief A level of detail of a geometry. Every level shares the geometry's vertices
+ * and draws its own range of the geometry's indices.
+ */
+typedef struct geometry_lod {
+    /** @brief The first index of the level. */
+    u32 index_offset;
+    /** @brief The number of indices in the level. */
+    u32 index_count;
+    /** @brief The simplification error of the level, relative to the size of the geometry. */
+    f32 error;
+} geometry_lod;
+
 /**
  * @brief Represents actual geometry in the world.
  * Typically (but not always, depending on use) paired with a material.
@@ -227,11 +253,28 @@ typedef struct geometry {
     char name[GEOMETRY_NAME_MAX_LENGTH];
     /** @brief A pointer to the material associated with this geometry.. */
     material* material;
+    /** @brief The center of the geometry's bounds, in local space. */
+    vec3 center;
+    /** @brief The radius of a sphere around center enclosing the geometry, in local space. */
+    f32 radius;
+    /** @brief The number of levels of detail. 0 means the geometry is always drawn whole. */
+    u8 lod_count;
+    /** @brief The levels of detail, from the full geometry to the coarsest. */
+    geometry_lod lods[GEOMETRY_MAX_LODS];
+    /** @brief The number of meshlets the full level of detail is split into. 0 if it is not. */
+    u32 meshlet_count;
+    /** @brief The meshlets of the full level of detail, in index order, for culling it in parts. */
+    geometry_meshlet* meshlets;
 } geometry;
 
 typedef struct mesh {
     u16 geometry_count;
     geometry** geometries;
+    /**
+     * @brief The level of detail last selected for each geometry, kept to apply hysteresis between
+     * frames. Held per mesh, as the same geometry may be drawn by several meshes at different distances.
+     */
+    u8* geometry_lods;
     transform transform;
 } mesh;
 
@@ -256,6 +299,12 @@ typedef enum shader_attribute_type {
     SHADER_ATTRIB_TYPE_UINT16 = 8U,
     SHADER_ATTRIB_TYPE_INT32 = 9U,
     SHADER_ATTRIB_TYPE_UINT32 = 10U,
+    /** @brief Two half floats. */
+    SHADER_ATTRIB_TYPE_FLOAT16_2 = 11U,
+    /** @brief Four signed 16-bit values, normalized to [-1, 1]. */
+    SHADER_ATTRIB_TYPE_SNORM16_4 = 12U,
+    /** @brief Four unsigned 8-bit values, normalized to [0, 1]. */
+    SHADER_ATTRIB_TYPE_UNORM8_4 = 13U,
 } shader_attribute_type;
 
 /** @brief Available uniform types. */
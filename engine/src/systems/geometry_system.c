@@ -3,6 +3,7 @@
 #include "core/logger.h"
 #include "core/kmemory.h"
 #include "core/kstring.h"
+#include "math/kmath.h"
 #include "math/geometry_utils.h"
 #include "systems/material_system.h"
 #include "renderer/renderer_frontend.h"
@@ -114,13 +115,40 @@ void geometry_system_config_dispose(geometry_config* config) {
         if (config->vertices) {
             kfree(config->vertices, config->vertex_size * config->vertex_count, MEMORY_TAG_ARRAY);
         }
-        if (config->vertices) {
+        if (config->indices) {
             kfree(config->indices, config->index_size * config->index_count, MEMORY_TAG_ARRAY);
         }
+        if (config->meshlets) {
+            kfree(config->meshlets, sizeof(geometry_meshlet) * config->meshlet_count, MEMORY_TAG_ARRAY);
+        }
         kzero_memory(config, sizeof(geometry_config));
     }
 }
 
+void geometry_system_config_compact_indices(geometry_config* config) {
+    if (!config || !config->indices || config->index_size != sizeof(u32) || config->vertex_count > GEOMETRY_U16_INDEX_VERTEX_LIMIT) {
+        return;
+    }
+
+    u16* indices = kallocate(sizeof(u16) * config->index_count, MEMORY_TAG_ARRAY);
+    geometry_indices_narrow_u16(config->index_count, config->indices, indices);
+    kfree(config->indices, sizeof(u32) * config->index_count, MEMORY_TAG_ARRAY);
+    config->indices = indices;
+    config->index_size = sizeof(u16);
+}
+
+void geometry_system_config_pack_vertices(geometry_config* config) {
+    if (!config || !config->vertices || config->vertex_size != sizeof(vertex_3d)) {
+        return;
+    }
+
+    vertex_3d_packed* vertices = kallocate(sizeof(vertex_3d_packed) * config->vertex_count, MEMORY_TAG_ARRAY);
+    geometry_pack_vertices(config->vertex_count, config->vertices, vertices);
+    kfree(config->vertices, sizeof(vertex_3d) * config->vertex_count, MEMORY_TAG_ARRAY);
+    config->vertices = vertices;
+    config->vertex_size = sizeof(vertex_3d_packed);
+}
+
 void geometry_system_release(geometry* geometry) {
     if (geometry && geometry->id != INVALID_ID) {
         geometry_reference* ref = &state_ptr->registered_geometries[geometry->id];
@@ -166,8 +194,21 @@ geometry* geometry_system_get_default_2d() {
 }
 
 b8 create_geometry(geometry_system_state* state, geometry_config config, geometry* g) {
+    // 3D geometry is drawn with packed vertices. The config belongs to the caller, so pack a copy.
+    vertex_3d_packed* packed_vertices = 0;
+    if (config.vertex_size == sizeof(vertex_3d) && config.vertex_count && config.vertices) {
+        packed_vertices = kallocate(sizeof(vertex_3d_packed) * config.vertex_count, MEMORY_TAG_ARRAY);
+        geometry_pack_vertices(config.vertex_count, config.vertices, packed_vertices);
+        config.vertex_size = sizeof(vertex_3d_packed);
+        config.vertices = packed_vertices;
+    }
+
     // Send the geometry off to the renderer to be uploaded to the GPU.
-    if (!renderer_create_geometry(g, config.vertex_size, config.vertex_count, config.vertices, config.index_size, config.index_count, config.indices)) {
+    b8 result = renderer_create_geometry(g, config.vertex_size, config.vertex_count, config.vertices, config.index_size, config.index_count, config.indices);
+    if (packed_vertices) {
+        kfree(packed_vertices, sizeof(vertex_3d_packed) * config.vertex_count, MEMORY_TAG_ARRAY);
+    }
+    if (!result) {
         // Invalidate the entry.
         state->registered_geometries[g->id].reference_count = 0;
         state->registered_geometries[g->id].auto_release = false;
@@ -178,6 +219,42 @@ b8 create_geometry(geometry_system_state* state, geometry_config config, geometr
         return false;
     }
 
+    // The bounds are used to pick a level of detail. Generated configs leave them empty, so find them.
+    vec3 min_extents = config.min_extents;
+    vec3 max_extents = config.max_extents;
+    if (vec3_compare(min_extents, max_extents, 0.0f) && config.vertex_count && config.vertices &&
+        (config.vertex_size == sizeof(vertex_3d_packed) || config.vertex_size == sizeof(vertex_3d))) {
+        // Both 3D vertex types start with the position.
+        min_extents = max_extents = *(vec3*)config.vertices;
+        for (u32 i = 1; i < config.vertex_count; ++i) {
+            vec3 p = *(vec3*)((u8*)config.vertices + (u64)config.vertex_size * i);
+            min_extents = vec3_create(KMIN(min_extents.x, p.x), KMIN(min_extents.y, p.y), KMIN(min_extents.z, p.z));
+            max_extents = vec3_create(KMAX(max_extents.x, p.x), KMAX(max_extents.y, p.y), KMAX(max_extents.z, p.z));
+        }
+    }
+    g->center = vec3_mul_scalar(vec3_add(min_extents, max_extents), 0.5f);
+    g->radius = vec3_distance(min_extents, max_extents) * 0.5f;
+
+    // Without levels of detail, the whole geometry is the only level.
+    if (config.lod_count > 0 && config.lod_count <= GEOMETRY_MAX_LODS) {
+        g->lod_count = config.lod_count;
+        kcopy_memory(g->lods, config.lods, sizeof(geometry_lod) * config.lod_count);
+    } else {
+        g->lod_count = 1;
+        g->lods[0].index_offset = 0;
+        g->lods[0].index_count = config.index_count;
+        g->lods[0].error = 0.0f;
+    }
+
+    // Meshlets are only used for culling on the CPU, so the geometry keeps its own copy.
+    g->meshlet_count = 0;
+    g->meshlets = 0;
+    if (config.meshlet_count && config.meshlets) {
+        g->meshlet_count = config.meshlet_count;
+        g->meshlets = kallocate(sizeof(geometry_meshlet) * config.meshlet_count, MEMORY_TAG_ARRAY);
+        kcopy_memory(g->meshlets, config.meshlets, sizeof(geometry_meshlet) * config.meshlet_count);
+    }
+
     // Acquire the material
     if (string_length(config.material_name) > 0) {
         g->material = material_system_acquire(config.material_name);
@@ -189,11 +266,80 @@ b8 create_geometry(geometry_system_state* state, geometry_config config, geometr
     return true;
 }
 
+u8 geometry_system_select_lod(const geometry* g, const mat4* model, vec3 view_position, f32 projection_scale, u8 previous_lod) {
+    if (!g || g->lod_count < 2) {
+        return 0;
+    }
+
+    // Move the bounding sphere into world space, scaling its radius by the largest axis scale.
+    const f32* m = model->data;
+    vec3 c = g->center;
+    vec3 center = vec3_create(
+        c.x * m[0] + c.y * m[4] + c.z * m[8] + m[12],
+        c.x * m[1] + c.y * m[5] + c.z * m[9] + m[13],
+        c.x * m[2] + c.y * m[6] + c.z * m[10] + m[14]);
+    f32 scale_squared = KMAX(m[0] * m[0] + m[1] * m[1] + m[2] * m[2], KMAX(m[4] * m[4] + m[5] * m[5] + m[6] * m[6], m[8] * m[8] + m[9] * m[9] + m[10] * m[10]));
+    f32 radius = g->radius * ksqrt(scale_squared);
+    f32 distance = vec3_distance(center, view_position);
+
+    if (distance <= radius) {
+        // Inside the bounds, so always draw the full geometry.
+        return 0;
+    }
+    f32 size = radius * projection_scale / distance;
+    return geometry_select_lod(g->lod_count, state_ptr->config.lod_screen_sizes, state_ptr->config.lod_hysteresis, size, previous_lod);
+}
+
+u32 geometry_system_cull_meshlets(const geometry* g, const mat4* model, const mat4* view_projection, vec3 view_position, geometry_index_range* out_ranges) {
+    // Cull in the geometry's own space, where the meshlet bounds are. Which side of a plane a
+    // point is on survives the move, so this is exact even for non-uniformly scaled models.
+    frustum f = frustum_from_matrix(mat4_mul(*model, *view_projection));
+    mat4 inverse_model = mat4_inverse(*model);
+    const f32* inverse = inverse_model.data;
+    vec3 v = view_position;
+    vec3 local_view_position = vec3_create(
+        v.x * inverse[0] + v.y * inverse[4] + v.z * inverse[8] + inverse[12],
+        v.x * inverse[1] + v.y * inverse[5] + v.z * inverse[9] + inverse[13],
+        v.x * inverse[2] + v.y * inverse[6] + v.z * inverse[10] + inverse[14]);
+
+    u32 range_count = 0;
+    b8 extending = false;
+    for (u32 i = 0; i < g->meshlet_count; ++i) {
+        const geometry_meshlet* m = &g->meshlets[i];
+        b8 visible = frustum_intersects_sphere(&f, m->center, m->radius);
+        if (visible && m->cone_cutoff < 1.0f) {
+            vec3 to_apex = vec3_sub(m->cone_apex, local_view_position);
+            f32 length = vec3_length(to_apex);
+            // Facing away if the direction to the apex is inside the cone.
+            visible = length == 0.0f || vec3_dot(to_apex, m->cone_axis) < m->cone_cutoff * length;
+        }
+        if (!visible) {
+            extending = false;
+            continue;
+        }
+        if (extending) {
+            out_ranges[range_count - 1].index_count += m->index_count;
+        } else {
+            out_ranges[range_count].index_offset = m->index_offset;
+            out_ranges[range_count].index_count = m->index_count;
+            range_count++;
+            extending = true;
+        }
+    }
+    return range_count;
+}
+
 void destroy_geometry(geometry_system_state* state, geometry* g) {
     renderer_destroy_geometry(g);
     g->internal_id = INVALID_ID;
     g->generation = INVALID_ID;
     g->id = INVALID_ID;
+    g->lod_count = 0;
+    if (g->meshlets) {
+        kfree(g->meshlets, sizeof(geometry_meshlet) * g->meshlet_count, MEMORY_TAG_ARRAY);
+        g->meshlets = 0;
+    }
+    g->meshlet_count = 0;
 
     string_empty(g->name);
 
@@ -230,11 +376,14 @@ b8 create_default_geometries(geometry_system_state* state) {
     verts[3].texcoord.x = 1.0f;
     verts[3].texcoord.y = 0.0f;
 
-    u32 indices[6] = {0, 1, 2, 0, 3, 1};
+    u16 indices[6] = {0, 1, 2, 0, 3, 1};
+
+    vertex_3d_packed packed_verts[4];
+    geometry_pack_vertices(4, verts, packed_verts);
 
     // Send the geometry off to the renderer to be uploaded to the GPU.
     state->default_geometry.internal_id = INVALID_ID;
-    if (!renderer_create_geometry(&state->default_geometry, sizeof(vertex_3d), 4, verts, sizeof(u32), 6, indices)) {
+    if (!renderer_create_geometry(&state->default_geometry, sizeof(vertex_3d_packed), 4, packed_verts, sizeof(u16), 6, indices)) {
         KFATAL("Failed to create default geometry. Application cannot continue.");
         return false;
     }
@@ -266,10 +415,10 @@ b8 create_default_geometries(geometry_system_state* state) {
     verts2d[3].texcoord.y = 0.0f;
 
     // Indices (NOTE: counter-clockwise)
-    u32 indices2d[6] = {2, 1, 0, 3, 0, 1};
+    u16 indices2d[6] = {2, 1, 0, 3, 0, 1};
 
     // Send the geometry off to the renderer to be uploaded to the GPU.
-    if (!renderer_create_geometry(&state->default_2d_geometry, sizeof(vertex_2d), 4, verts2d, sizeof(u32), 6, indices2d)) {
+    if (!renderer_create_geometry(&state->default_2d_geometry, sizeof(vertex_2d), 4, verts2d, sizeof(u16), 6, indices2d)) {
         KFATAL("Failed to create default 2d geometry. Application cannot continue.");
         return false;
     }
@@ -307,7 +456,7 @@ geometry_config geometry_system_generate_plane_config(f32 width, f32 height, u32
         tile_y = 1.0f;
     }
 
-    geometry_config config;
+    geometry_config config = {};
     config.vertex_size = sizeof(vertex_3d);
     config.vertex_count = x_segment_count * y_segment_count * 4;  // 4 verts per segment
     config.vertices = kallocate(sizeof(vertex_3d) * config.vertex_count, MEMORY_TAG_ARRAY);
@@ -381,6 +530,9 @@ geometry_config geometry_system_generate_plane_config(f32 width, f32 height, u32
         string_ncopy(config.material_name, DEFAULT_MATERIAL_NAME, MATERIAL_NAME_MAX_LENGTH);
     }
 
+    geometry_system_config_compact_indices(&config);
+    geometry_system_config_pack_vertices(&config);
+
     return config;
 }
 
@@ -406,7 +558,7 @@ geometry_config geometry_system_generate_cube_config(f32 width, f32 height, f32
         tile_y = 1.0f;
     }
 
-    geometry_config config;
+    geometry_config config = {};
     config.vertex_size = sizeof(vertex_3d);
     config.vertex_count = 4 * 6;  // 4 verts per side, 6 sides
     config.vertices = kallocate(sizeof(vertex_3d) * config.vertex_count, MEMORY_TAG_ARRAY);
@@ -540,6 +692,8 @@ geometry_config geometry_system_generate_cube_config(f32 width, f32 height, f32
     }
 
     geometry_generate_tangents(config.vertex_count, config.vertices, config.index_count, config.indices);
+    geometry_system_config_compact_indices(&config);
+    geometry_system_config_pack_vertices(&config);
 
     return config;
 }
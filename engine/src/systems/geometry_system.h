@@ -23,6 +23,17 @@ typedef struct geometry_system_config {
      */
     u32 max_geometry_count;
 
+    /**
+     * @brief The projected sizes below which each coarser level of detail is used. Entry i is
+     * where level i + 1 takes over from level i. Sizes are the bounding sphere's radius over the
+     * distance to it, scaled by the projection, so 1 is about half the height of the screen.
+     */
+    f32 lod_screen_sizes[GEOMETRY_MAX_LODS - 1];
+    /**
+     * @brief The fraction a projected size must move past a threshold before the level of detail
+     * changes, so geometries near a threshold do not switch back and forth.
+     */
+    f32 lod_hysteresis;
 } geometry_system_config;
 
 /**
@@ -45,7 +56,17 @@ typedef struct geometry_config {
     vec3 center;
     vec3 min_extents;
     vec3 max_extents;
-    
+
+    /** @brief The number of levels of detail in indices. 0 means the indices are a single, full level. */
+    u8 lod_count;
+    /** @brief The levels of detail, as ranges of indices from the full geometry to the coarsest. */
+    geometry_lod lods[GEOMETRY_MAX_LODS];
+
+    /** @brief The number of meshlets the full level of detail is split into. 0 if it is not. */
+    u32 meshlet_count;
+    /** @brief The meshlets of the full level of detail, in index order. */
+    geometry_meshlet* meshlets;
+
     /** @brief The name of the geometry. */
     char name[GEOMETRY_NAME_MAX_LENGTH];
     /** @brief The name of the material used by the geometry. */
@@ -98,6 +119,51 @@ geometry* geometry_system_acquire_from_config(geometry_config config, b8 auto_re
  */
 void geometry_system_config_dispose(geometry_config* config);
 
+/**
+ * @brief Converts the provided configuration's indices to 16-bit if it has few enough vertices,
+ * halving the memory and bandwidth they use. Does nothing if they are already 16-bit, or if
+ * 32-bit indices are required.
+ *
+ * @param config A pointer to the configuration whose indices should be compacted.
+ */
+void geometry_system_config_compact_indices(geometry_config* config);
+
+/**
+ * @brief Converts the provided configuration's vertices from vertex_3d to vertex_3d_packed, the
+ * form 3D geometry is drawn with. Does nothing if they are not vertex_3d.
+ *
+ * @param config A pointer to the configuration whose vertices should be packed.
+ */
+void geometry_system_config_pack_vertices(geometry_config* config);
+
+/**
+ * @brief Selects the level of detail to draw the given geometry with, from its projected size
+ * on screen. Levels only change from the previous one once the size moves past a threshold by
+ * the configured hysteresis.
+ *
+ * @param geometry A pointer to the geometry.
+ * @param model A pointer to the model matrix the geometry is drawn with.
+ * @param view_position The position of the camera in world space.
+ * @param projection_scale The vertical scale of the projection, 1 / tan(fov / 2).
+ * @param previous_lod The level of detail the same draw was made with last frame, or 0 if none.
+ * @return The selected level of detail.
+ */
+u8 geometry_system_select_lod(const geometry* geometry, const mat4* model, vec3 view_position, f32 projection_scale, u8 previous_lod);
+
+/**
+ * @brief Culls the meshlets of the given geometry's full level of detail against a view
+ * frustum and by their normal cones, and writes out the ranges of indices which survive.
+ * Neighbouring meshlets which both survive are merged into one range.
+ *
+ * @param geometry A pointer to the geometry. Must have meshlets.
+ * @param model A pointer to the model matrix the geometry is drawn with.
+ * @param view_projection A pointer to the view matrix multiplied by the projection.
+ * @param view_position The position of the camera in world space.
+ * @param out_ranges An array of at least meshlet_count ranges to hold the result.
+ * @return The number of ranges written to out_ranges.
+ */
+u32 geometry_system_cull_meshlets(const geometry* geometry, const mat4* model, const mat4* view_projection, vec3 view_position, geometry_index_range* out_ranges);
+
 /**
  * @brief Releases a reference to the provided geometry.
  *
@@ -0,0 +1,392 @@
+#include "job_system.h"
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "core/profiler.h"
+#include "platform/platform.h"
+
+// The number of jobs each deque can hold. Must be a power of 2.
+#define JOB_DEQUE_CAPACITY 1024
+// The number of jobs the injection queue can hold, per priority. Must be a power of 2.
+#define JOB_INJECTION_QUEUE_CAPACITY 1024
+// The maximum number of worker threads, not including the main thread.
+#define JOB_SYSTEM_MAX_WORKERS 63
+// The number of times an idle worker looks for work before going to sleep.
+#define JOB_IDLE_SPIN_COUNT 64
+// The maximum number of batches a parallel for is split into.
+#define JOB_PARALLEL_FOR_MAX_BATCHES 256
+
+/**
+ * A Chase-Lev work-stealing deque. The owning thread pushes and pops jobs at the bottom,
+ * while other threads steal from the top. Top and bottom are kept on separate cache lines
+ * so that the owner and thieves don't contend unless the deque is nearly empty.
+ */
+typedef struct job_deque {
+    volatile u64 top;
+    u8 top_padding[56];
+    volatile u64 bottom;
+    u8 bottom_padding[56];
+    job_info jobs[JOB_DEQUE_CAPACITY];
+} job_deque;
+
+// A thread which runs jobs. Index 0 is the main thread.
+typedef struct job_thread {
+    kthread thread;
+    u32 index;
+    // Used to pick steal victims.
+    u32 random_state;
+    job_deque deques[JOB_PRIORITY_MAX];
+} job_thread;
+
+// Holds jobs submitted from threads not owned by the job system.
+typedef struct job_injection_queue {
+    volatile u64 head;
+    volatile u64 tail;
+    job_info jobs[JOB_INJECTION_QUEUE_CAPACITY];
+} job_injection_queue;
+
+typedef struct job_system_state {
+    volatile u32 is_running;
+    // The number of job threads, including the main thread.
+    u32 thread_count;
+    // The number of workers waiting on job_available.
+    volatile u32 sleeping_count;
+    ksemaphore job_available;
+    kmutex injection_mutex;
+    job_injection_queue injection_queues[JOB_PRIORITY_MAX];
+    job_thread* threads;
+} job_system_state;
+
+static job_system_state* state_ptr;
+
+// The job thread the calling thread is, if any.
+static KTHREAD_LOCAL job_thread* current_thread = 0;
+
+static b8 deque_push(job_deque* deque, const job_info* job) {
+    u64 bottom = deque->bottom;
+    u64 top = platform_atomic_load_u64(&deque->top);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) {
+        return false;
+    }
+    deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)] = *job;
+    // Publish the job.
+    platform_atomic_store_u64(&deque->bottom, bottom + 1);
+    return true;
+}
+
+static b8 deque_pop(job_deque* deque, job_info* out_job) {
+    u64 bottom = deque->bottom - 1;
+    platform_atomic_store_u64(&deque->bottom, bottom);
+    // Bottom must be visible to thieves before top is read.
+    platform_atomic_fence();
+    u64 top = platform_atomic_load_u64(&deque->top);
+
+    if ((i64)top > (i64)bottom) {
+        // Empty.
+        platform_atomic_store_u64(&deque->bottom, bottom + 1);
+        return false;
+    }
+
+    *out_job = deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)];
+    if (top != bottom) {
+        return true;
+    }
+
+    // This is the last job, so race any thieves for it.
+    b8 won = platform_atomic_compare_exchange_u64(&deque->top, &top, top + 1);
+    platform_atomic_store_u64(&deque->bottom, bottom + 1);
+    return won;
+}
+
+static b8 deque_steal(job_deque* deque, job_info* out_job) {
+    u64 top = platform_atomic_load_u64(&deque->top);
+    platform_atomic_fence();
+    u64 bottom = platform_atomic_load_u64(&deque->bottom);
+    if ((i64)top >= (i64)bottom) {
+        return false;
+    }
+
+    // The owner can't overwrite this slot until top moves past it, so the copy is safe
+    // as long as the exchange below succeeds.
+    job_info job = deque->jobs[top & (JOB_DEQUE_CAPACITY - 1)];
+    if (!platform_atomic_compare_exchange_u64(&deque->top, &top, top + 1)) {
+        return false;
+    }
+    *out_job = job;
+    return true;
+}
+
+static b8 injection_push(job_injection_queue* queue, const job_info* job) {
+    b8 pushed = false;
+    platform_mutex_lock(&state_ptr->injection_mutex);
+    if (queue->tail - queue->head < JOB_INJECTION_QUEUE_CAPACITY) {
+        queue->jobs[queue->tail & (JOB_INJECTION_QUEUE_CAPACITY - 1)] = *job;
+        platform_atomic_store_u64(&queue->tail, queue->tail + 1);
+        pushed = true;
+    }
+    platform_mutex_unlock(&state_ptr->injection_mutex);
+    return pushed;
+}
+
+static b8 injection_pop(job_injection_queue* queue, job_info* out_job) {
+    // Avoid taking the lock when there's obviously nothing there.
+    if (platform_atomic_load_u64(&queue->head) == platform_atomic_load_u64(&queue->tail)) {
+        return false;
+    }
+    b8 popped = false;
+    platform_mutex_lock(&state_ptr->injection_mutex);
+    if (queue->head != queue->tail) {
+        *out_job = queue->jobs[queue->head & (JOB_INJECTION_QUEUE_CAPACITY - 1)];
+        platform_atomic_store_u64(&queue->head, queue->head + 1);
+        popped = true;
+    }
+    platform_mutex_unlock(&state_ptr->injection_mutex);
+    return popped;
+}
+
+/**
+ * Finds a job for the given thread (which may be 0 for threads not owned by the job
+ * system). High priority jobs are taken from anywhere before low priority ones; within
+ * a priority the thread's own deque is tried first, then the injection queue, then the
+ * deques of other threads starting from a random one.
+ */
+static b8 find_job(job_thread* self, job_info* out_job) {
+    u32 start = 0;
+    if (self) {
+        // xorshift
+        u32 x = self->random_state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        self->random_state = x;
+        start = x % state_ptr->thread_count;
+    }
+
+    for (u32 priority = 0; priority < JOB_PRIORITY_MAX; ++priority) {
+        if (self && deque_pop(&self->deques[priority], out_job)) {
+            return true;
+        }
+        if (injection_pop(&state_ptr->injection_queues[priority], out_job)) {
+            return true;
+        }
+        for (u32 i = 0; i < state_ptr->thread_count; ++i) {
+            job_thread* victim = &state_ptr->threads[(start + i) % state_ptr->thread_count];
+            if (victim != self && deque_steal(&victim->deques[priority], out_job)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void run_job(const job_info* job) {
+    PROFILE_BEGIN(job);
+    job->entry_point(job->params);
+    PROFILE_END(job);
+    if (job->counter) {
+        platform_atomic_fetch_add_u32(&job->counter->value, (u32)-1);
+    }
+}
+
+static u32 job_worker_thread(void* params) {
+    job_thread* self = params;
+    current_thread = self;
+
+    u32 idle_count = 0;
+    while (platform_atomic_load_u32(&state_ptr->is_running)) {
+        job_info job;
+        if (find_job(self, &job)) {
+            run_job(&job);
+            idle_count = 0;
+            continue;
+        }
+
+        if (++idle_count < JOB_IDLE_SPIN_COUNT) {
+            continue;
+        }
+
+        // Announce this worker is going to sleep, then check once more, so that a job
+        // submitted in the meantime either gets found here or sees this worker sleeping.
+        platform_atomic_fetch_add_u32(&state_ptr->sleeping_count, 1);
+        platform_atomic_fence();
+        b8 found = find_job(self, &job);
+        if (!found) {
+            platform_semaphore_wait(&state_ptr->job_available);
+        }
+        platform_atomic_fetch_add_u32(&state_ptr->sleeping_count, (u32)-1);
+        if (found) {
+            run_job(&job);
+        }
+        idle_count = 0;
+    }
+
+    current_thread = 0;
+    return 0;
+}
+
+b8 job_system_initialize(u64* memory_requirement, void* state, job_system_config config) {
+    // By default, one worker per core, leaving one for the main thread.
+    u32 worker_count = config.worker_count ? config.worker_count : platform_get_processor_count() - 1;
+    if (worker_count > JOB_SYSTEM_MAX_WORKERS) {
+        worker_count = JOB_SYSTEM_MAX_WORKERS;
+    }
+    u32 thread_count = worker_count + 1;
+
+    *memory_requirement = sizeof(job_system_state) + sizeof(job_thread) * thread_count;
+    if (state == 0) {
+        return true;
+    }
+
+    kzero_memory(state, *memory_requirement);
+    state_ptr = state;
+    state_ptr->thread_count = thread_count;
+    // The threads are in the same block of memory, after the state.
+    state_ptr->threads = (job_thread*)((u8*)state + sizeof(job_system_state));
+    for (u32 i = 0; i < thread_count; ++i) {
+        state_ptr->threads[i].index = i;
+        state_ptr->threads[i].random_state = 0x9E3779B9 * (i + 1);
+    }
+
+    if (!platform_semaphore_create(0, &state_ptr->job_available) || !platform_mutex_create(&state_ptr->injection_mutex)) {
+        KERROR("Failed to create job system synchronization objects.");
+        state_ptr = 0;
+        return false;
+    }
+
+    // The calling thread is the main thread, which runs jobs while waiting.
+    current_thread = &state_ptr->threads[0];
+
+    state_ptr->is_running = true;
+    for (u32 i = 1; i < thread_count; ++i) {
+        if (!platform_thread_create(job_worker_thread, &state_ptr->threads[i], &state_ptr->threads[i].thread)) {
+            KERROR("Failed to create job worker thread %u.", i);
+            // Run with whatever was started.
+            state_ptr->thread_count = i;
+            break;
+        }
+    }
+
+    KINFO("Job system initialized with %u worker threads.", state_ptr->thread_count - 1);
+    return true;
+}
+
+void job_system_shutdown(void* state) {
+    if (!state_ptr) {
+        return;
+    }
+
+    platform_atomic_store_u32(&state_ptr->is_running, false);
+    for (u32 i = 1; i < state_ptr->thread_count; ++i) {
+        platform_semaphore_signal(&state_ptr->job_available);
+    }
+    for (u32 i = 1; i < state_ptr->thread_count; ++i) {
+        platform_thread_join(&state_ptr->threads[i].thread);
+    }
+
+    platform_mutex_destroy(&state_ptr->injection_mutex);
+    platform_semaphore_destroy(&state_ptr->job_available);
+    current_thread = 0;
+    state_ptr = 0;
+}
+
+u32 job_system_thread_count() {
+    return state_ptr ? state_ptr->thread_count : 1;
+}
+
+void job_system_submit(job_info job) {
+    if (!job.entry_point) {
+        KERROR("job_system_submit requires an entry point.");
+        return;
+    }
+    if (job.priority >= JOB_PRIORITY_MAX) {
+        job.priority = JOB_PRIORITY_LOW;
+    }
+    if (job.counter) {
+        platform_atomic_fetch_add_u32(&job.counter->value, 1);
+    }
+
+    if (!state_ptr) {
+        run_job(&job);
+        return;
+    }
+
+    b8 queued = current_thread ? deque_push(&current_thread->deques[job.priority], &job) : false;
+    if (!queued) {
+        queued = injection_push(&state_ptr->injection_queues[job.priority], &job);
+    }
+    if (!queued) {
+        // Everything is full, so just get it done.
+        run_job(&job);
+        return;
+    }
+
+    // Wake a worker if any are asleep. See job_worker_thread.
+    platform_atomic_fence();
+    if (platform_atomic_load_u32(&state_ptr->sleeping_count) > 0) {
+        platform_semaphore_signal(&state_ptr->job_available);
+    }
+}
+
+void job_system_wait(job_counter* counter) {
+    u32 idle_count = 0;
+    while (platform_atomic_load_u32(&counter->value) != 0) {
+        job_info job;
+        if (state_ptr && find_job(current_thread, &job)) {
+            run_job(&job);
+            idle_count = 0;
+        } else if (++idle_count >= JOB_IDLE_SPIN_COUNT) {
+            // The remaining jobs are running elsewhere.
+            platform_sleep(0);
+            idle_count = 0;
+        }
+    }
+}
+
+b8 job_counter_is_complete(job_counter* counter) {
+    return platform_atomic_load_u32(&counter->value) == 0;
+}
+
+typedef struct parallel_for_batch {
+    pfn_parallel_for func;
+    void* params;
+    u32 start;
+    u32 end;
+} parallel_for_batch;
+
+static void parallel_for_job(void* params) {
+    parallel_for_batch* batch = params;
+    batch->func(batch->start, batch->end, batch->params);
+}
+
+void job_system_parallel_for(u32 count, u32 min_batch_size, pfn_parallel_for func, void* params, job_priority priority) {
+    if (count == 0) {
+        return;
+    }
+
+    // Aim for a few batches per thread, so stealing can even out uneven work.
+    u32 batch_count = KMIN(job_system_thread_count() * 4, JOB_PARALLEL_FOR_MAX_BATCHES);
+    u32 batch_size = KMAX((count + batch_count - 1) / batch_count, KMAX(min_batch_size, 1));
+    batch_count = (count + batch_size - 1) / batch_size;
+
+    if (batch_count <= 1 || !state_ptr) {
+        func(0, count, params);
+        return;
+    }
+
+    parallel_for_batch batches[JOB_PARALLEL_FOR_MAX_BATCHES];
+    job_counter counter = {0};
+    for (u32 i = 0; i < batch_count; ++i) {
+        batches[i].func = func;
+        batches[i].params = params;
+        batches[i].start = i * batch_size;
+        batches[i].end = KMIN(batches[i].start + batch_size, count);
+    }
+
+    // Queue all but the first batch, which this thread runs while the others are picked up.
+    for (u32 i = 1; i < batch_count; ++i) {
+        job_info job = {parallel_for_job, &batches[i], &counter, priority};
+        job_system_submit(job);
+    }
+    parallel_for_job(&batches[0]);
+    job_system_wait(&counter);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file job_system.h
+ * @author Travis Vroman (travis@kohiengine.com)
+ * @brief This file contains the job system, which runs small units of work (jobs)
+ * across a pool of worker threads, one per processor core. Each worker (and the main
+ * thread) owns a work-stealing deque per priority, and idle workers steal from the
+ * others. Jobs can be tracked by counters, which can be waited on; waiting threads
+ * run other jobs until the counter reaches zero, so jobs may safely wait on other jobs.
+ * @version 1.0
+ * @date 2022-06-05
+ *
+ * @copyright Kohi Game Engine is Copyright (c) Travis Vroman 2021-2022
+ *
+ */
+
+#pragma once
+
+#include "defines.h"
+
+/** @brief The priority of a job. Higher priority jobs are always picked up first. */
+typedef enum job_priority {
+    /** @brief For work which must be done within the current frame. */
+    JOB_PRIORITY_HIGH = 0,
+    /** @brief For work which can be spread across frames, such as asset loading. */
+    JOB_PRIORITY_LOW = 1,
+    JOB_PRIORITY_MAX
+} job_priority;
+
+/**
+ * @brief A function to be invoked to run a job.
+ * @param params The parameters supplied with the job.
+ */
+typedef void (*pfn_job_start)(void* params);
+
+/**
+ * @brief A function to be invoked for a range of a parallel for.
+ * @param start The index of the first item in the range.
+ * @param end One past the index of the last item in the range.
+ * @param params The parameters passed to job_system_parallel_for().
+ */
+typedef void (*pfn_parallel_for)(u32 start, u32 end, void* params);
+
+/**
+ * @brief Counts the outstanding jobs associated with it. Used to group jobs
+ * and to express dependencies by waiting on it. Must be zero-initialized.
+ */
+typedef struct job_counter {
+    /** @brief The number of associated jobs which have not yet completed. */
+    volatile u32 value;
+} job_counter;
+
+/** @brief Describes a job to be submitted. */
+typedef struct job_info {
+    /** @brief The function to be invoked. */
+    pfn_job_start entry_point;
+    /** @brief Parameters to pass to entry_point. Must remain valid until the job completes. */
+    void* params;
+    /** @brief An optional counter, incremented on submission and decremented on completion. */
+    job_counter* counter;
+    /** @brief The priority of the job. */
+    job_priority priority;
+} job_info;
+
+/** @brief The job system configuration. */
+typedef struct job_system_config {
+    /**
+     * @brief The number of worker threads to create. 0 creates one for each
+     * processor core, other than the one used by the main thread.
+     */
+    u8 worker_count;
+} job_system_config;
+
+/**
+ * @brief Initializes the job system and starts its worker threads. The calling thread
+ * is treated as the main thread, and runs jobs whenever it waits on a counter.
+ * Should be called twice; once to get the memory requirement (passing state=0), and a second
+ * time passing an allocated block of memory to actually initialize the system.
+ *
+ * @param memory_requirement A pointer to hold the memory requirement as it is calculated.
+ * @param state A block of memory to hold the state or, if gathering the memory requirement, 0.
+ * @param config The configuration for this system.
+ * @return True on success; otherwise false.
+ */
+KAPI b8 job_system_initialize(u64* memory_requirement, void* state, job_system_config config);
+
+/**
+ * @brief Shuts down the job system, stopping all worker threads. Jobs which have
+ * not yet been started are discarded.
+ *
+ * @param state The state block of memory for this system.
+ */
+KAPI void job_system_shutdown(void* state);
+
+/**
+ * @brief Gets the number of threads running jobs, including the main thread.
+ *
+ * @return The number of threads running jobs.
+ */
+KAPI u32 job_system_thread_count();
+
+/**
+ * @brief Submits a job to be run. When submitted from the main thread or a worker thread,
+ * the job goes to that thread's own deque, from which it may be stolen by idle workers.
+ * If the job system is not running, the job is run immediately on the calling thread.
+ *
+ * @param job The job to be submitted.
+ */
+KAPI void job_system_submit(job_info job);
+
+/**
+ * @brief Blocks until the given counter reaches zero. Rather than idling, the calling
+ * thread runs other queued jobs in the meantime.
+ *
+ * @param counter A pointer to the counter to wait on.
+ */
+KAPI void job_system_wait(job_counter* counter);
+
+/**
+ * @brief Indicates if all jobs associated with the given counter have completed.
+ *
+ * @param counter A pointer to the counter to check.
+ * @return True if complete; otherwise false.
+ */
+KAPI b8 job_counter_is_complete(job_counter* counter);
+
+/**
+ * @brief Invokes func over the range [0, count), split into batches which are run in
+ * parallel as jobs. Returns once the whole range has been processed. The calling thread
+ * runs batches as well.
+ *
+ * @param count The number of items to process.
+ * @param min_batch_size The minimum number of items to process per batch. Use larger
+ * batches when the work per item is small.
+ * @param func The function to invoke for each batch.
+ * @param params Parameters to be passed to func.
+ * @param priority The priority of the batch jobs.
+ */
+KAPI void job_system_parallel_for(u32 count, u32 min_batch_size, pfn_parallel_for func, void* params, job_priority priority);
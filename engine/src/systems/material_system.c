@@ -2,6 +2,7 @@
 
 #include "core/logger.h"
 #include "core/kstring.h"
+#include "core/kmemory.h"
 #include "containers/hashtable.h"
 #include "math/kmath.h"
 #include "renderer/renderer_frontend.h"
@@ -9,6 +10,7 @@
 
 #include "systems/resource_system.h"
 #include "systems/shader_system.h"
+#include "systems/job_system.h"
 
 typedef struct material_shader_uniform_locations {
     u16 projection;
@@ -178,6 +180,52 @@ material* material_system_acquire(const char* name) {
     return m;
 }
 
+typedef struct material_prefetch {
+    const char* name;
+    b8 loaded;
+    resource config;
+} material_prefetch;
+
+static void prefetch_range(u32 start, u32 end, void* params) {
+    material_prefetch* prefetches = params;
+    for (u32 i = start; i < end; ++i) {
+        prefetches[i].loaded = resource_system_load(prefetches[i].name, RESOURCE_TYPE_MATERIAL, &prefetches[i].config);
+    }
+}
+
+void material_system_prefetch(u32 count, const char** names) {
+    if (count == 0) {
+        return;
+    }
+    material_prefetch* prefetches = kallocate(sizeof(material_prefetch) * count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < count; ++i) {
+        prefetches[i].name = names[i];
+    }
+    // Configurations are small, so batch them.
+    job_system_parallel_for(count, 4, prefetch_range, prefetches, JOB_PRIORITY_HIGH);
+
+    // Gather the maps of every material, which the texture system also dedupes.
+    const char** texture_names = kallocate(sizeof(const char*) * count * 3, MEMORY_TAG_ARRAY);
+    u32 texture_count = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (prefetches[i].loaded) {
+            material_config* config = prefetches[i].config.data;
+            texture_names[texture_count++] = config->diffuse_map_name;
+            texture_names[texture_count++] = config->specular_map_name;
+            texture_names[texture_count++] = config->normal_map_name;
+        }
+    }
+    texture_system_prefetch(texture_count, texture_names);
+
+    for (u32 i = 0; i < count; ++i) {
+        if (prefetches[i].loaded) {
+            resource_system_unload(&prefetches[i].config);
+        }
+    }
+    kfree(texture_names, sizeof(const char*) * count * 3, MEMORY_TAG_ARRAY);
+    kfree(prefetches, sizeof(material_prefetch) * count, MEMORY_TAG_ARRAY);
+}
+
 material* material_system_acquire_from_config(material_config config) {
     // Return default material.
     if (strings_equali(config.name, DEFAULT_MATERIAL_NAME)) {
@@ -54,6 +54,17 @@ void material_system_shutdown(void* state);
  */
 material* material_system_acquire(const char* name);
 
+/**
+ * @brief Loads the configurations of the given materials in parallel on the job system, and
+ * prefetches the textures they use, so a later material_system_acquire() of any of them only
+ * has to upload those textures to the GPU. Blocks until complete, and must be called from the
+ * main thread.
+ *
+ * @param count The number of material names.
+ * @param names An array of material names.
+ */
+void material_system_prefetch(u32 count, const char** names);
+
 /**
  * @brief Attempts to acquire a material from the given configuration. If it has not yet been loaded,
  * this triggers it to load. If the material is not found, a pointer to the default material
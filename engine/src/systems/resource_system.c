@@ -2,6 +2,9 @@
 
 #include "core/logger.h"
 #include "core/kstring.h"
+#include "core/kmemory.h"
+#include "platform/platform.h"
+#include "platform/filesystem.h"
 
 // Known resource loaders.
 #include "resources/loaders/text_loader.h"
@@ -92,23 +95,122 @@ b8 resource_system_register_loader(resource_loader loader) {
     return false;
 }
 
-b8 resource_system_load(const char* name, resource_type type, resource* out_resource) {
+static resource_loader* find_loader(resource_type type) {
     if (state_ptr && type != RESOURCE_TYPE_CUSTOM) {
-        // Select loader.
         u32 count = state_ptr->config.max_loader_count;
         for (u32 i = 0; i < count; ++i) {
             resource_loader* l = &state_ptr->registered_loaders[i];
             if (l->id != INVALID_ID && l->type == type) {
-                return load(name, l, out_resource);
+                return l;
             }
         }
     }
+    return 0;
+}
+
+b8 resource_system_load(const char* name, resource_type type, resource* out_resource) {
+    resource_loader* l = find_loader(type);
+    if (l) {
+        return load(name, l, out_resource);
+    }
 
     out_resource->loader_id = INVALID_ID;
     KERROR("resource_system_load - No loader for type %d was found.", type);
     return false;
 }
 
+static void batch_load_job(void* params) {
+    resource_load_request* r = params;
+    f64 start = platform_get_absolute_time();
+    if (r->contents) {
+        // The loader takes ownership of the contents.
+        r->resource.loader_id = r->loader->id;
+        r->loaded = r->loader->load_from_memory(r->loader, r->name, r->path, r->contents, r->contents_size, &r->resource);
+        r->contents = 0;
+    } else {
+        r->loaded = load(r->name, r->loader, &r->resource);
+    }
+    r->seconds = platform_get_absolute_time() - start;
+}
+
+static void batch_submit_load(resource_load_request* r) {
+    job_info job;
+    job.entry_point = batch_load_job;
+    job.params = r;
+    job.counter = &r->batch->counter;
+    job.priority = JOB_PRIORITY_HIGH;
+    job_system_submit(job);
+}
+
+static void batch_read_complete(const char* path, void* dest, u64 bytes_read, b8 success, void* user_data) {
+    resource_load_request* r = user_data;
+    r->batch->reads_outstanding--;
+    if (!success) {
+        KWARN("Failed to read '%s' ahead of loading it. It will be loaded directly instead.", path);
+        kfree(r->contents, r->contents_size, MEMORY_TAG_RESOURCE);
+        r->contents = 0;
+    }
+    batch_submit_load(r);
+}
+
+static b8 file_size(const char* path, u64* out_size) {
+    file_handle handle;
+    if (!filesystem_open(path, FILE_MODE_READ, true, &handle)) {
+        return false;
+    }
+    b8 result = filesystem_size(&handle, out_size);
+    filesystem_close(&handle);
+    return result;
+}
+
+void resource_system_load_batch_begin(resource_load_batch* batch) {
+    batch->reads_outstanding = 0;
+    batch->counter.value = 0;
+    for (u32 i = 0; i < batch->count; ++i) {
+        resource_load_request* r = &batch->requests[i];
+        r->batch = batch;
+        r->loaded = false;
+        r->seconds = 0;
+        r->contents = 0;
+        r->contents_size = 0;
+        r->resource.loader_id = INVALID_ID;
+        r->loader = find_loader(r->type);
+        if (!r->loader) {
+            KERROR("resource_system_load_batch_begin - No loader for type %d was found.", r->type);
+            continue;
+        }
+
+        // Read the file ahead of loading if the loader can load from its contents.
+        u64 size = 0;
+        if (r->loader->resolve_path && r->loader->load_from_memory &&
+            r->loader->resolve_path(r->loader, r->name, r->path) && file_size(r->path, &size) && size > 0) {
+            r->contents = kallocate(size, MEMORY_TAG_RESOURCE);
+            r->contents_size = size;
+            // Counted first, as the callback is invoked straight away if reads are not asynchronous.
+            batch->reads_outstanding++;
+            if (filesystem_read_async(r->path, 0, size, r->contents, batch_read_complete, r)) {
+                continue;
+            }
+            // Most likely too many reads are outstanding, so load it directly instead.
+            batch->reads_outstanding--;
+            kfree(r->contents, r->contents_size, MEMORY_TAG_RESOURCE);
+            r->contents = 0;
+        }
+        batch_submit_load(r);
+    }
+}
+
+void resource_system_load_batch_end(resource_load_batch* batch) {
+    while (batch->reads_outstanding > 0) {
+        if (filesystem_async_wait() == 0) {
+            // Can only happen if asynchronous reads were shut down with reads outstanding.
+            KERROR("resource_system_load_batch_end - file reads were dropped before completing.");
+            break;
+        }
+    }
+    job_system_wait(&batch->counter);
+}
+
 b8 resource_system_load_custom(const char* name, const char* custom_type, resource* out_resource) {
     if (state_ptr && custom_type && string_length(custom_type) > 0) {
         // Select loader.
@@ -14,6 +14,10 @@
 #pragma once
 
 #include "resources/resource_types.h"
+#include "systems/job_system.h"
+
+/** @brief The maximum length of a resource's full path, including the terminator. */
+#define RESOURCE_PATH_MAX_LENGTH 512
 
 /** @brief The configuration for the resource system */
 typedef struct resource_system_config {
@@ -42,6 +46,28 @@ typedef struct resource_loader {
      */
     b8 (*load)(struct resource_loader* self, const char* name, resource* out_resource);
 
+    /**
+     * @brief Optional. Finds the file a resource would be loaded from, so its contents can be
+     * read ahead of loading it. Set along with load_from_memory.
+     * @param self A pointer to the loader itself.
+     * @param name The name of the resource.
+     * @param out_path A buffer of RESOURCE_PATH_MAX_LENGTH characters to hold the full path of the file.
+     * @returns True if the resource can be loaded from the file's contents alone; otherwise false.
+     */
+    b8 (*resolve_path)(struct resource_loader* self, const char* name, char* out_path);
+
+    /**
+     * @brief Optional. Loads a resource from the contents of the file given by resolve_path.
+     * @param self A pointer to the loader itself.
+     * @param name The name of the resource to be loaded.
+     * @param full_path The full path of the file the contents were read from.
+     * @param data The contents of the file, allocated with MEMORY_TAG_RESOURCE. The loader takes ownership, whether or not it succeeds.
+     * @param size The size of the contents in bytes.
+     * @param out_resource A pointer to hold the loaded resource.
+     * @returns True on success; otherwise false.
+     */
+    b8 (*load_from_memory)(struct resource_loader* self, const char* name, const char* full_path, void* data, u64 size, resource* out_resource);
+
     /**
      * @brief Unloads the given resource. Loader is determined by the resource's assigned loader id.
      * @param self A pointer to the loader itself.
@@ -97,6 +123,58 @@ KAPI b8 resource_system_load(const char* name, resource_type type, resource* out
  */
 KAPI b8 resource_system_load_custom(const char* name, const char* custom_type, resource* out_resource);
 
+/** @brief A resource to be loaded as part of a batch. See resource_system_load_batch_begin() and resource_system_load_batch_end(). */
+typedef struct resource_load_request {
+    /** @brief The name of the resource to load. Must remain valid until the batch is finished. */
+    const char* name;
+    /** @brief The type of resource to load. Custom types are not supported. */
+    resource_type type;
+    /** @brief Set once the batch is finished, if the resource was loaded. */
+    b8 loaded;
+    /** @brief Holds the resource once loaded. */
+    resource resource;
+    /** @brief The time taken to load the resource, in seconds, from when its file was read. */
+    f64 seconds;
+
+    // Private to the resource system.
+    struct resource_load_batch* batch;
+    resource_loader* loader;
+    char path[RESOURCE_PATH_MAX_LENGTH];
+    void* contents;
+    u64 contents_size;
+} resource_load_request;
+
+/** @brief A batch of resources being loaded. See resource_system_load_batch_begin() and resource_system_load_batch_end(). */
+typedef struct resource_load_batch {
+    /** @brief The number of requests. */
+    u32 count;
+    /** @brief The requests. Must remain valid until the batch is finished. */
+    resource_load_request* requests;
+    /** @brief The number of file reads not yet completed. */
+    u32 reads_outstanding;
+    /** @brief Counts the load jobs not yet completed. */
+    job_counter counter;
+} resource_load_batch;
+
+/**
+ * @brief Starts loading a batch of resources. The files of resources whose loaders can load from
+ * memory are all read with asynchronous file reads, so many are in flight at once, and each is
+ * loaded on the job system as its read completes. Other resources are loaded on the job system
+ * straight away. Reads progress as filesystem_async_pump() is called. Must be called from the
+ * thread which pumps asynchronous file reads.
+ *
+ * @param batch A pointer to the batch, whose count and requests are set. Must remain valid until finished.
+ */
+KAPI void resource_system_load_batch_begin(resource_load_batch* batch);
+
+/**
+ * @brief Blocks until every resource of a batch has been loaded, or failed to load. Must be
+ * called from the same thread as resource_system_load_batch_begin().
+ *
+ * @param batch A pointer to the batch.
+ */
+KAPI void resource_system_load_batch_end(resource_load_batch* batch);
+
 /**
  * @brief Unloads the given resource.
  * 
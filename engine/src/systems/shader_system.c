@@ -347,9 +347,12 @@ b8 add_attribute(shader* shader, const shader_attribute_config* config) {
         case SHADER_ATTRIB_TYPE_FLOAT32:
         case SHADER_ATTRIB_TYPE_INT32:
         case SHADER_ATTRIB_TYPE_UINT32:
+        case SHADER_ATTRIB_TYPE_FLOAT16_2:
+        case SHADER_ATTRIB_TYPE_UNORM8_4:
             size = 4;
             break;
         case SHADER_ATTRIB_TYPE_FLOAT32_2:
+        case SHADER_ATTRIB_TYPE_SNORM16_4:
             size = 8;
             break;
         case SHADER_ATTRIB_TYPE_FLOAT32_3:
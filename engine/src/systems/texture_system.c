@@ -5,9 +5,19 @@
 #include "core/kmemory.h"
 #include "containers/hashtable.h"
 
+#include "math/kernels.h"
+
 #include "renderer/renderer_frontend.h"
 
 #include "systems/resource_system.h"
+#include "systems/job_system.h"
+
+typedef struct texture_prefetch {
+    char name[TEXTURE_NAME_MAX_LENGTH];
+    // Set once the image is loaded, and cleared once it has been taken.
+    b8 loaded;
+    resource image;
+} texture_prefetch;
 
 typedef struct texture_system_state {
     texture_system_config config;
@@ -21,6 +31,11 @@ typedef struct texture_system_state {
 
     // Hashtable for texture lookups.
     hashtable registered_texture_table;
+
+    // Images decoded ahead of being acquired. See texture_system_prefetch().
+    // The count is of entries allocated, which may include unused ones.
+    u32 prefetch_count;
+    texture_prefetch* prefetches;
 } texture_system_state;
 
 typedef struct texture_reference {
@@ -36,6 +51,7 @@ void destroy_default_textures(texture_system_state* state);
 b8 load_texture(const char* texture_name, texture* t);
 void destroy_texture(texture* t);
 b8 process_texture_reference(const char* name, i8 reference_diff, b8 auto_release, b8 skip_load, u32* out_texture_id);
+static void release_prefetches();
 
 b8 texture_system_initialize(u64* memory_requirement, void* state, texture_system_config config) {
     if (config.max_texture_count == 0) {
@@ -55,6 +71,8 @@ b8 texture_system_initialize(u64* memory_requirement, void* state, texture_syste
 
     state_ptr = state;
     state_ptr->config = config;
+    state_ptr->prefetch_count = 0;
+    state_ptr->prefetches = 0;
 
     // The array block is after the state. Already allocated, so just set the pointer.
     void* array_block = state + struct_requirement;
@@ -98,6 +116,8 @@ void texture_system_shutdown(void* state) {
 
         destroy_default_textures(state_ptr);
 
+        release_prefetches();
+
         state_ptr = 0;
     }
 }
@@ -120,6 +140,99 @@ texture* texture_system_acquire(const char* name, b8 auto_release) {
     return &state_ptr->registered_textures[id];
 }
 
+static void release_prefetches() {
+    if (state_ptr->prefetches) {
+        for (u32 i = 0; i < state_ptr->prefetch_count; ++i) {
+            if (state_ptr->prefetches[i].loaded) {
+                resource_system_unload(&state_ptr->prefetches[i].image);
+            }
+        }
+        kfree(state_ptr->prefetches, sizeof(texture_prefetch) * state_ptr->prefetch_count, MEMORY_TAG_TEXTURE);
+        state_ptr->prefetches = 0;
+        state_ptr->prefetch_count = 0;
+    }
+}
+
+/**
+ * @brief Takes the prefetched image of the given texture, if it was prefetched. The caller
+ * becomes responsible for unloading it.
+ * @return True if the texture was prefetched, whether or not its image loaded.
+ */
+static b8 take_prefetched_image(const char* name, b8* out_loaded, resource* out_image) {
+    for (u32 i = 0; i < state_ptr->prefetch_count; ++i) {
+        texture_prefetch* p = &state_ptr->prefetches[i];
+        if (p->name[0] && strings_equali(p->name, name)) {
+            *out_loaded = p->loaded;
+            if (p->loaded) {
+                *out_image = p->image;
+            }
+            // Taken either way, so a failed load is not retried.
+            p->loaded = false;
+            p->name[0] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void texture_system_prefetch(u32 count, const char** names) {
+    if (!state_ptr) {
+        KERROR("texture_system_prefetch called before texture system is initialized.");
+        return;
+    }
+    release_prefetches();
+    if (count == 0) {
+        return;
+    }
+
+    texture_prefetch* prefetches = kallocate(sizeof(texture_prefetch) * count, MEMORY_TAG_TEXTURE);
+    u32 prefetch_count = 0;
+    for (u32 i = 0; i < count; ++i) {
+        const char* name = names[i];
+        if (!name || !name[0] || strings_equali(name, DEFAULT_TEXTURE_NAME)) {
+            continue;
+        }
+        // Skip textures which are already loaded.
+        texture_reference ref;
+        if (hashtable_get(&state_ptr->registered_texture_table, name, &ref) && ref.handle != INVALID_ID) {
+            continue;
+        }
+        b8 duplicate = false;
+        for (u32 j = 0; j < prefetch_count; ++j) {
+            if (strings_equali(prefetches[j].name, name)) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) {
+            string_ncopy(prefetches[prefetch_count].name, name, TEXTURE_NAME_MAX_LENGTH);
+            prefetch_count++;
+        }
+    }
+
+    // Every image file is read at once, and each is decoded on the job system as its read completes.
+    if (prefetch_count > 0) {
+        resource_load_batch batch;
+        batch.count = prefetch_count;
+        batch.requests = kallocate(sizeof(resource_load_request) * prefetch_count, MEMORY_TAG_TEXTURE);
+        for (u32 i = 0; i < prefetch_count; ++i) {
+            batch.requests[i].name = prefetches[i].name;
+            batch.requests[i].type = RESOURCE_TYPE_IMAGE;
+        }
+        resource_system_load_batch_begin(&batch);
+        resource_system_load_batch_end(&batch);
+        for (u32 i = 0; i < prefetch_count; ++i) {
+            prefetches[i].loaded = batch.requests[i].loaded;
+            prefetches[i].image = batch.requests[i].resource;
+        }
+        kfree(batch.requests, sizeof(resource_load_request) * prefetch_count, MEMORY_TAG_TEXTURE);
+    }
+
+    state_ptr->prefetches = prefetches;
+    state_ptr->prefetch_count = count;
+    KDEBUG("Prefetched %u textures.", prefetch_count);
+}
+
 texture* texture_system_aquire_writeable(const char* name, u32 width, u32 height, u8 channel_count, b8 has_transparency) {
     u32 id = INVALID_ID;
     // NOTE: Wrapped textures are never auto-released because it means that thier
@@ -351,7 +464,11 @@ void destroy_default_textures(texture_system_state* state) {
 
 b8 load_texture(const char* texture_name, texture* t) {
     resource img_resource;
-    if (!resource_system_load(texture_name, RESOURCE_TYPE_IMAGE, &img_resource)) {
+    b8 loaded = false;
+    if (!take_prefetched_image(texture_name, &loaded, &img_resource)) {
+        loaded = resource_system_load(texture_name, RESOURCE_TYPE_IMAGE, &img_resource);
+    }
+    if (!loaded) {
         KERROR("Failed to load image resource for texture '%s'", texture_name);
         return false;
     }
@@ -367,16 +484,9 @@ b8 load_texture(const char* texture_name, texture* t) {
     u32 current_generation = t->generation;
     t->generation = INVALID_ID;
 
-    u64 total_size = temp_texture.width * temp_texture.height * temp_texture.channel_count;
     // Check for transparency
-    b32 has_transparency = false;
-    for (u64 i = 0; i < total_size; i += temp_texture.channel_count) {
-        u8 a = resource_data->pixels[i + 3];
-        if (a < 255) {
-            has_transparency = true;
-            break;
-        }
-    }
+    u64 pixel_count = (u64)temp_texture.width * temp_texture.height;
+    b32 has_transparency = temp_texture.channel_count == 4 && kernel_rgba8_has_transparency(resource_data->pixels, pixel_count);
 
     // Take a copy of the name.
     string_ncopy(temp_texture.name, texture_name, TEXTURE_NAME_MAX_LENGTH);
@@ -65,6 +65,19 @@ void texture_system_shutdown(void* state);
  */
 texture* texture_system_acquire(const char* name, b8 auto_release);
 
+/**
+ * @brief Reads the images of the given textures with asynchronous file reads, all at once, and
+ * decodes them in parallel on the job system as their reads complete, so that a later
+ * texture_system_acquire() of any of them only has to upload it to the GPU.
+ * Textures which are already loaded are skipped. Images prefetched by a previous call which
+ * have not been acquired since are discarded. Blocks until all images are decoded, and must
+ * be called from the main thread.
+ *
+ * @param count The number of texture names.
+ * @param names An array of texture names. Duplicates and empty names are ignored.
+ */
+void texture_system_prefetch(u32 count, const char** names);
+
 /**
  * @brief Attempts to acquire a writeable texture with the given name. This does not point to
  * nor attempt to load a texture file. Does also increment the reference counter.
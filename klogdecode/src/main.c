@@ -0,0 +1,25 @@
+#include <core/logger.h>
+#include <core/kmemory.h>
+
+/**
+ * Renders a binary log written by the engine in binary mode (console.klog)
+ * to text, in the same form as console.log.
+ *
+ * Usage: klogdecode [binary_log_path] [text_log_path]
+ */
+int main(int argc, char** argv) {
+    const char* binary_log_path = argc > 1 ? argv[1] : "console.klog";
+    const char* text_log_path = argc > 2 ? argv[2] : "console_decoded.log";
+
+    memory_system_configuration memory_config = {};
+    memory_config.total_alloc_size = GIBIBYTES(1);
+    if (!memory_system_initialize(memory_config)) {
+        KFATAL("Failed to initialize memory system.");
+        return 1;
+    }
+
+    b8 result = log_binary_decode(binary_log_path, text_log_path);
+
+    memory_system_shutdown();
+    return result ? 0 : 1;
+}
@@ -4,6 +4,8 @@
 
 #include <core/kmemory.h>
 
+#include <stdlib.h>  // getenv
+
 // Define the function to create a game
 b8 create_game(game* out_game) {
     // Application configuration.
@@ -12,6 +14,13 @@ b8 create_game(game* out_game) {
     out_game->app_config.start_width = 1280;
     out_game->app_config.start_height = 720;
     out_game->app_config.name = "Kohi Engine Testbed";
+    out_game->app_config.target_frame_rate = 60.0f;
+    out_game->app_config.present_mode = RENDERER_PRESENT_MODE_DEFAULT;
+    // Run without a window when requested, e.g. on build machines with no display.
+    const char* headless = getenv("KOHI_HEADLESS");
+    out_game->app_config.headless = headless && headless[0] != 0 && headless[0] != '0';
+    // There is no window to render to when headless, so only count the renderer calls.
+    out_game->app_config.renderer_backend = out_game->app_config.headless ? RENDERER_BACKEND_TYPE_NULL : RENDERER_BACKEND_TYPE_VULKAN;
     out_game->update = game_update;
     out_game->render = game_render;
     out_game->initialize = game_initialize;
@@ -5,6 +5,8 @@
 
 #include <core/input.h>
 #include <core/event.h>
+#include <core/profiler.h>
+#include <core/application.h>
 
 #include <math/kmath.h>
 
@@ -71,6 +73,20 @@ b8 game_update(game* game_inst, f32 delta_time) {
 
     game_state* state = (game_state*)game_inst->state;
 
+    // In benchmark mode, follow a scripted path instead of input: a full orbit of the
+    // scene facing its centre, bobbing up and down twice along the way.
+    f32 benchmark_progress = 0;
+    if (application_benchmark_progress(&benchmark_progress)) {
+        f32 angle = benchmark_progress * K_PI_2;
+        f32 radius = 60.0f;
+        state->camera_position = (vec3){15.0f + ksin(angle) * radius, 10.0f + ksin(angle * 2.0f) * 5.0f, 1.0f + kcos(angle) * radius};
+        state->camera_euler = (vec3){deg_to_rad(-10.0f), angle, 0};
+        state->camera_view_dirty = true;
+        recalculate_view_matrix(state);
+        renderer_set_view(state->view, state->camera_position);
+        return true;
+    }
+
     // HACK: temp hack to move camera around.
     if (input_is_key_down('A') || input_is_key_down(KEY_LEFT)) {
         camera_yaw(state, 1.0f * delta_time);
@@ -161,6 +177,27 @@ b8 game_update(game* game_inst, f32 delta_time) {
         data.data.i32[0] = RENDERER_VIEW_MODE_DEFAULT;
         event_fire(EVENT_CODE_SET_RENDER_MODE, game_inst, data);
     }
+
+    // Profiler. F8 captures the next 120 frames.
+    if (input_is_key_up(KEY_F8) && input_was_key_down(KEY_F8)) {
+        profiler_capture(120, "profile.json");
+    }
+
+    // Input journal. F9 toggles recording, F10 replays the last recording.
+    // Ignored during replay so the recorded keypresses don't restart it.
+    if (!input_journal_is_replaying()) {
+        if (input_is_key_up(KEY_F9) && input_was_key_down(KEY_F9)) {
+            if (input_journal_is_recording()) {
+                input_journal_stop();
+            } else {
+                input_journal_record_begin("input.kij");
+            }
+        }
+
+        if (input_is_key_up(KEY_F10) && input_was_key_down(KEY_F10)) {
+            input_journal_replay_begin("input.kij");
+        }
+    }
     // TODO: end temp
 
     return true;
@@ -0,0 +1,52 @@
+#include "application_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/application.h>
+
+u8 application_should_only_idle_when_rendering_on_demand() {
+    application_idle_state state = {0};
+
+    // Nothing has changed, but every frame is rendered unless rendering on demand.
+    expect_to_be_false(application_can_idle(&state));
+    state.suspended = true;
+    expect_to_be_false(application_can_idle(&state));
+
+    // Benchmark frames are never skipped.
+    state.suspended = false;
+    state.render_on_demand = true;
+    state.benchmarking = true;
+    expect_to_be_false(application_can_idle(&state));
+
+    state.benchmarking = false;
+    expect_to_be_true(application_can_idle(&state));
+    return true;
+}
+
+u8 application_should_not_idle_while_something_changes() {
+    application_idle_state state = {0};
+    state.render_on_demand = true;
+
+    // Frames requested by a redraw are rendered.
+    state.redraw_frames_remaining = 1;
+    expect_to_be_false(application_can_idle(&state));
+    state.redraw_frames_remaining = 0;
+    expect_to_be_true(application_can_idle(&state));
+
+    // As are frames while input is driving change.
+    state.input_active = true;
+    expect_to_be_false(application_can_idle(&state));
+
+    // Unless suspended, where nothing is visible.
+    state.redraw_frames_remaining = 2;
+    state.suspended = true;
+    expect_to_be_true(application_can_idle(&state));
+    return true;
+}
+
+void application_register_tests() {
+    test_manager_register_test(application_should_only_idle_when_rendering_on_demand, "Application should only idle when rendering on demand, outside benchmark mode.");
+    test_manager_register_test(application_should_not_idle_while_something_changes, "Application should not idle while a redraw is requested or input is active.");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void application_register_tests();
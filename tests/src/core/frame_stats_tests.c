@@ -0,0 +1,85 @@
+#include "frame_stats_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/frame_stats.h>
+
+u8 frame_stats_should_summarize_window() {
+    frame_stats stats;
+    expect_to_be_true(frame_stats_create(128, &stats));
+
+    // Nothing to summarize yet.
+    frame_stat_summary summary;
+    expect_to_be_false(frame_stats_summarize(&stats, FRAME_STAT_METRIC_FRAME, &summary));
+
+    // Frame times of 1-100ms, out of order.
+    for (u32 i = 0; i < 100; ++i) {
+        f64 ms = (f64)((i * 37) % 100 + 1);
+        frame_stats_record(&stats, ms / 1000.0, ms / 2000.0, 0);
+    }
+
+    expect_to_be_true(frame_stats_summarize(&stats, FRAME_STAT_METRIC_FRAME, &summary));
+    expect_should_be(100, summary.sample_count);
+    expect_float_to_be(1.0, summary.min * 1000.0);
+    expect_float_to_be(100.0, summary.max * 1000.0);
+    expect_float_to_be(50.5, summary.avg * 1000.0);
+    expect_float_to_be(50.0, summary.p50 * 1000.0);
+    expect_float_to_be(95.0, summary.p95 * 1000.0);
+    expect_float_to_be(99.0, summary.p99 * 1000.0);
+
+    // 1ms is in [1, 2), 2-3ms in [2, 4), 14-16ms in [14, 16.7) and 50-100ms in the unbounded last bucket.
+    expect_should_be(0, summary.histogram[2]);
+    expect_should_be(1, summary.histogram[3]);
+    expect_should_be(2, summary.histogram[4]);
+    expect_should_be(3, summary.histogram[10]);
+    expect_should_be(51, summary.histogram[FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1]);
+    u32 total = 0;
+    for (u32 i = 0; i < FRAME_STATS_HISTOGRAM_BUCKET_COUNT; ++i) {
+        total += summary.histogram[i];
+    }
+    expect_should_be(100, total);
+
+    // Metrics are summarized independently.
+    expect_to_be_true(frame_stats_summarize(&stats, FRAME_STAT_METRIC_UPDATE, &summary));
+    expect_float_to_be(50.0, summary.max * 1000.0);
+
+    frame_stats_destroy(&stats);
+    return true;
+}
+
+u8 frame_stats_should_keep_most_recent_frames() {
+    frame_stats stats;
+    expect_to_be_true(frame_stats_create(4, &stats));
+
+    for (u32 i = 1; i <= 10; ++i) {
+        frame_stats_record(&stats, i / 1000.0, 0, 0);
+    }
+
+    frame_stat_summary summary;
+    expect_to_be_true(frame_stats_summarize(&stats, FRAME_STAT_METRIC_FRAME, &summary));
+    expect_should_be(4, summary.sample_count);
+    expect_should_be(10, stats.total_frame_count);
+    // Only frames 7-10 remain.
+    expect_float_to_be(7.0, summary.min * 1000.0);
+    expect_float_to_be(10.0, summary.max * 1000.0);
+    expect_float_to_be(8.5, summary.avg * 1000.0);
+
+    // Sparse metrics keep their own window, independent of the frame count.
+    expect_to_be_false(frame_stats_summarize(&stats, FRAME_STAT_METRIC_INPUT_TO_PRESENT, &summary));
+    frame_stats_record_sample(&stats, FRAME_STAT_METRIC_INPUT_TO_PRESENT, 0.020);
+    frame_stats_record_sample(&stats, FRAME_STAT_METRIC_INPUT_TO_PRESENT, 0.030);
+    expect_to_be_true(frame_stats_summarize(&stats, FRAME_STAT_METRIC_INPUT_TO_PRESENT, &summary));
+    expect_should_be(2, summary.sample_count);
+    expect_float_to_be(25.0, summary.avg * 1000.0);
+    expect_should_be(10, stats.total_frame_count);
+
+    frame_stats_destroy(&stats);
+    return true;
+}
+
+void frame_stats_register_tests() {
+    test_manager_register_test(frame_stats_should_summarize_window, "Frame stats should summarize the samples in the window.");
+    test_manager_register_test(frame_stats_should_keep_most_recent_frames, "Frame stats should keep only the most recent frames.");
+}
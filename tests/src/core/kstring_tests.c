@@ -0,0 +1,142 @@
+#include "kstring_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kstring.h>
+#include <core/kmemory.h>
+#include <containers/darray.h>
+
+#include <stdio.h>   // snprintf
+#include <stdlib.h>  // strtod
+
+u8 kstring_should_tokenize_views() {
+    string_view line = string_view_create("  vt 1.5\t-2  ");
+    string_view token;
+    expect_to_be_true(string_view_token_next(&line, &token));
+    expect_to_be_true(string_view_equal(token, "vt"));
+    expect_to_be_true(string_view_token_next(&line, &token));
+    expect_to_be_true(string_view_equal(token, "1.5"));
+    expect_to_be_true(string_view_token_next(&line, &token));
+    expect_to_be_true(string_view_equal(token, "-2"));
+    expect_to_be_false(string_view_token_next(&line, &token));
+
+    // Empty entries are kept, but nothing follows a trailing delimiter.
+    string_view remaining = string_view_create("a = b\n\n c \r\n");
+    string_view entry;
+    expect_to_be_true(string_view_split_next(&remaining, '\n', &entry));
+    expect_to_be_true(string_view_equal(entry, "a = b"));
+    expect_to_be_true(string_view_split_next(&remaining, '\n', &entry));
+    expect_should_be(0, entry.length);
+    expect_to_be_true(string_view_split_next(&remaining, '\n', &entry));
+    expect_to_be_true(string_view_equal(string_view_trim(entry), "c"));
+    expect_to_be_false(string_view_split_next(&remaining, '\n', &entry));
+
+    string_view view = string_view_create("Name=Value");
+    expect_should_be(4, string_view_index_of(view, '='));
+    expect_should_be(-1, string_view_index_of(view, '#'));
+    expect_to_be_true(string_view_equali(string_view_mid(view, 0, 4), "NAME"));
+    expect_to_be_false(string_view_equal(string_view_mid(view, 0, 4), "NAME"));
+    expect_to_be_false(string_view_equal(string_view_mid(view, 0, 4), "Nam"));
+    expect_to_be_false(string_view_equal(string_view_mid(view, 0, 4), "Names"));
+    expect_to_be_true(string_view_equal(string_view_mid(view, 5, 100), "Value"));
+    expect_should_be(0, string_view_mid(view, 20, 4).length);
+
+    // Copies are truncated to fit.
+    char buffer[4];
+    expect_should_be(3, string_view_copy(buffer, view, 4));
+    expect_to_be_true(strings_equal(buffer, "Nam"));
+
+    // The allocating split still yields the same entries.
+    char** entries = darray_create(char*);
+    expect_should_be(4, string_split(" a, b,,c ", ',', &entries, true, true));
+    expect_to_be_true(strings_equal(entries[1], "b"));
+    expect_to_be_true(strings_equal(entries[2], ""));
+    string_cleanup_split_array(entries);
+    expect_should_be(3, string_split("a,b,", ',', &entries, true, true));
+    string_cleanup_split_array(entries);
+    expect_should_be(2, string_split("a,b,", ',', &entries, true, false));
+    string_cleanup_split_array(entries);
+    darray_destroy(entries);
+
+    return true;
+}
+
+u8 kstring_should_parse_numbers() {
+    f64 d = 0;
+    expect_should_be(4, string_view_parse_f64(string_view_create("3.25abc"), &d));
+    expect_float_to_be(3.25, d);
+    expect_should_be(7, string_view_parse_f64(string_view_create("-2.5e-3"), &d));
+    expect_float_to_be(-0.0025, d);
+    // An exponent without digits is not part of the number.
+    expect_should_be(1, string_view_parse_f64(string_view_create("1e+"), &d));
+    expect_float_to_be(1.0, d);
+    expect_should_be(0, string_view_parse_f64(string_view_create("."), &d));
+    expect_should_be(0, string_view_parse_f64(string_view_create(" 1"), &d));
+
+    u64 u = 0;
+    expect_should_be(20, string_view_parse_u64(string_view_create("18446744073709551615"), &u));
+    b8 is_max = u == 18446744073709551615ULL;
+    expect_to_be_true(is_max);
+    expect_should_be(0, string_view_parse_u64(string_view_create("18446744073709551616"), &u));
+    i64 i = 0;
+    expect_should_be(20, string_view_parse_i64(string_view_create("-9223372036854775808"), &i));
+    b8 is_min = i == -9223372036854775807LL - 1;
+    expect_to_be_true(is_min);
+    expect_should_be(0, string_view_parse_i64(string_view_create("9223372036854775808"), &i));
+    expect_should_be(0, string_view_parse_i64(string_view_create("-"), &i));
+
+    // Whole-string conversions reject trailing text and out-of-range values.
+    u32 u32_value = 0;
+    expect_to_be_true(string_to_u32(" 20 ", &u32_value));
+    expect_should_be(20, u32_value);
+    expect_to_be_false(string_to_u32("20x", &u32_value));
+    expect_to_be_false(string_to_u32("-1", &u32_value));
+    i8 i8_value = 0;
+    expect_to_be_true(string_to_i8("-128", &i8_value));
+    expect_should_be(-128, i8_value);
+    expect_to_be_false(string_to_i8("128", &i8_value));
+
+    vec4 v;
+    expect_to_be_true(string_to_vec4("0.588000 1 -2.5 1.0", &v));
+    expect_float_to_be(0.588f, v.x);
+    expect_float_to_be(-2.5f, v.z);
+    expect_to_be_false(string_to_vec4("1 2 3", &v));
+    expect_to_be_false(string_to_vec4("1 2 x 4", &v));
+    expect_to_be_false(string_to_vec4("1 2 3 4 5", &v));
+
+    b8 b = false;
+    expect_to_be_true(string_view_to_bool(string_view_create(" TRUE"), &b));
+    expect_to_be_false(string_to_bool("0", &b));
+
+    return true;
+}
+
+u8 kstring_should_parse_floats_as_strtod_does() {
+    // Values as written by the exporters and by write_kmt_file.
+    char text[64];
+    u32 seed = 12345;
+    for (u32 n = 0; n < 20000; ++n) {
+        seed = seed * 1664525u + 1013904223u;
+        f64 value = ((f64)(seed >> 8) / (f64)(1 << 24) - 0.5) * 2000.0;
+        snprintf(text, sizeof(text), (n & 1) ? "%.6f" : "%g", value);
+
+        f32 parsed = 0;
+        string_view view = string_view_create(text);
+        u64 length = string_view_parse_f32(view, &parsed);
+        expect_should_be(view.length, length);
+        f32 expected = (f32)strtod(text, 0);
+        if (parsed != expected) {
+            KERROR("--> Parsed '%s' as %.9g, but strtod gives %.9g.", text, parsed, expected);
+            return false;
+        }
+    }
+    return true;
+}
+
+void kstring_register_tests() {
+    test_manager_register_test(kstring_should_tokenize_views, "String views should tokenize, split and compare without allocating.");
+    test_manager_register_test(kstring_should_parse_numbers, "String number parsers should parse prefixes and reject invalid input.");
+    test_manager_register_test(kstring_should_parse_floats_as_strtod_does, "String float parser should agree with strtod.");
+}
@@ -0,0 +1,82 @@
+#include "logger_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/logger.h>
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <platform/filesystem.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+
+#define BINARY_LOG_PATH "console.klog"
+#define DECODED_LOG_PATH "logger_test_decoded.log"
+
+static u32 log_from_other_thread(void* params) {
+    KDEBUG("Binary ordering from another thread: %d", 2);
+    return 0;
+}
+
+u8 logger_should_round_trip_binary_records() {
+    remove(BINARY_LOG_PATH);
+    remove(DECODED_LOG_PATH);
+
+    u64 memory_requirement = 0;
+    initialize_logging(&memory_requirement, 0);
+    void* state = kallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_true(initialize_logging(&memory_requirement, state));
+
+    // The binary log is only created once binary mode is enabled.
+    b8 created_before_enabled = filesystem_exists(BINARY_LOG_PATH);
+    log_binary_mode_set(true);
+    b8 created_once_enabled = filesystem_exists(BINARY_LOG_PATH);
+
+    // Encoded as records of raw arguments, of each supported type.
+    for (i32 i = 0; i < 2; ++i) {
+        KDEBUG("Binary round trip %d: %u %lld %.3f '%s' %5.1f%%", i, 4000000000u, -1234567890123ll, 3.5, "text", 2.3f);
+    }
+    KTRACE("Binary round trip of '%s' with nothing else.", "a string");
+
+    // Another thread's entries are buffered separately, but decode in the order they were logged.
+    kthread thread;
+    expect_to_be_true(platform_thread_create(log_from_other_thread, 0, &thread));
+    platform_thread_join(&thread);
+    KDEBUG("Binary ordering after the other thread: %d", 3);
+    log_binary_mode_set(false);
+
+    // Shutting down writes out every buffered record.
+    shutdown_logging(state);
+    kfree(state, memory_requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_false(created_before_enabled);
+    expect_to_be_true(created_once_enabled);
+
+    expect_to_be_true(log_binary_decode(BINARY_LOG_PATH, DECODED_LOG_PATH));
+    file_handle f;
+    expect_to_be_true(filesystem_open(DECODED_LOG_PATH, FILE_MODE_READ, false, &f));
+    char decoded[1024] = {0};
+    u64 size = 0;
+    expect_to_be_true(filesystem_size(&f, &size));
+    expect_to_be_true(size < sizeof(decoded));
+    u64 read = 0;
+    filesystem_read_all_text(&f, decoded, &read);
+    filesystem_close(&f);
+    remove(BINARY_LOG_PATH);
+    remove(DECODED_LOG_PATH);
+    remove("console.log");
+
+    const char* expected =
+        "[thread 0] [DEBUG]: Binary round trip 0: 4000000000 -1234567890123 3.500 'text'   2.3%\n"
+        "[thread 0] [DEBUG]: Binary round trip 1: 4000000000 -1234567890123 3.500 'text'   2.3%\n"
+        "[thread 0] [TRACE]: Binary round trip of 'a string' with nothing else.\n"
+        "[thread 1] [DEBUG]: Binary ordering from another thread: 2\n"
+        "[thread 0] [DEBUG]: Binary ordering after the other thread: 3\n";
+    expect_to_be_true(strings_equal(expected, decoded));
+    return true;
+}
+
+void logger_register_tests() {
+    test_manager_register_test(logger_should_round_trip_binary_records, "Binary log records should decode to the text they were logged with.");
+}
@@ -0,0 +1,136 @@
+#include "profiler_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kmemory.h>
+#include <core/profiler.h>
+#include <platform/filesystem.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_CAPTURE_PATH "profiler_test.json"
+
+static void* start_profiler(u64* out_memory_requirement) {
+    profiler_config config = {0};
+    config.events_per_thread = 256;
+    config.max_thread_count = 2;
+    profiler_initialize(out_memory_requirement, 0, config);
+    void* state = kallocate(*out_memory_requirement, MEMORY_TAG_ARRAY);
+    if (!profiler_initialize(out_memory_requirement, state, config)) {
+        kfree(state, *out_memory_requirement, MEMORY_TAG_ARRAY);
+        return 0;
+    }
+    return state;
+}
+
+static char* read_capture(u64* out_size) {
+    file_handle f;
+    if (!filesystem_open(TEST_CAPTURE_PATH, FILE_MODE_READ, false, &f)) {
+        return 0;
+    }
+    filesystem_size(&f, out_size);
+    char* text = kallocate(*out_size + 1, MEMORY_TAG_STRING);
+    u64 read = 0;
+    filesystem_read_all_text(&f, text, &read);
+    filesystem_close(&f);
+    return text;
+}
+
+static u32 count_occurrences(const char* text, const char* pattern) {
+    u32 count = 0;
+    for (const char* c = strstr(text, pattern); c; c = strstr(c + 1, pattern)) {
+        count++;
+    }
+    return count;
+}
+
+static void profiled_work() {
+    PROFILE_SCOPE("outer");
+    PROFILE_SCOPE("inner");
+}
+
+u8 profiler_should_capture_requested_frames() {
+    u64 memory_requirement = 0;
+    void* state = start_profiler(&memory_requirement);
+    expect_should_not_be(0, state);
+
+    // Nothing is recorded outside a capture.
+    expect_to_be_false(profiler_zone_begin("before_capture"));
+    profiler_frame_mark();
+
+    expect_to_be_true(profiler_capture(2, TEST_CAPTURE_PATH));
+    expect_to_be_true(profiler_is_capturing());
+    // Only one capture at a time.
+    expect_to_be_false(profiler_capture(1, TEST_CAPTURE_PATH));
+
+    profiler_frame_mark();
+    profiled_work();
+    profiler_frame_mark();
+    profiled_work();
+    profiler_frame_mark();
+    expect_to_be_false(profiler_is_capturing());
+
+    // The capture has ended.
+    profiled_work();
+    expect_to_be_false(profiler_zone_begin("after_capture"));
+
+    u64 size = 0;
+    char* text = read_capture(&size);
+    expect_should_not_be(0, text);
+    expect_should_be(2, count_occurrences(text, "\"name\":\"outer\""));
+    expect_should_be(0, count_occurrences(text, "after_capture"));
+    expect_should_be(0, count_occurrences(text, "before_capture"));
+    // Two frames of two zones each, balanced.
+    expect_should_be(4, count_occurrences(text, "\"ph\":\"B\""));
+    expect_should_be(4, count_occurrences(text, "\"ph\":\"E\""));
+    expect_should_be(2, count_occurrences(text, "\"ph\":\"i\""));
+    expect_should_be(1, count_occurrences(text, "\"name\":\"Main\""));
+
+    kfree(text, size + 1, MEMORY_TAG_STRING);
+    profiler_shutdown(state);
+    kfree(state, memory_requirement, MEMORY_TAG_ARRAY);
+    remove(TEST_CAPTURE_PATH);
+    return true;
+}
+
+u8 profiler_should_close_zones_open_at_capture_end() {
+    u64 memory_requirement = 0;
+    void* state = start_profiler(&memory_requirement);
+    expect_should_not_be(0, state);
+
+    expect_to_be_true(profiler_capture(1, TEST_CAPTURE_PATH));
+    profiler_frame_mark();
+    {
+        PROFILE_SCOPE("spans_capture_end");
+        profiler_frame_mark();
+    }
+    // More zones than fit in the ring buffer, the oldest of which are lost.
+    expect_to_be_true(profiler_capture(1, TEST_CAPTURE_PATH));
+    profiler_frame_mark();
+    for (u32 i = 0; i < 500; ++i) {
+        profiled_work();
+    }
+    profiler_frame_mark();
+
+    u64 size = 0;
+    char* text = read_capture(&size);
+    expect_should_not_be(0, text);
+    // Only the second capture is in the file, and it is balanced despite the lost events.
+    expect_should_be(0, count_occurrences(text, "spans_capture_end"));
+    expect_should_be(count_occurrences(text, "\"ph\":\"B\""), count_occurrences(text, "\"ph\":\"E\""));
+    expect_should_not_be(0, count_occurrences(text, "\"ph\":\"B\""));
+    kfree(text, size + 1, MEMORY_TAG_STRING);
+
+    profiler_shutdown(state);
+    kfree(state, memory_requirement, MEMORY_TAG_ARRAY);
+    remove(TEST_CAPTURE_PATH);
+    return true;
+}
+
+void profiler_register_tests() {
+    test_manager_register_test(profiler_should_capture_requested_frames, "Profiler should capture only the requested frames.");
+    test_manager_register_test(profiler_should_close_zones_open_at_capture_end, "Profiler should write balanced zones.");
+}
@@ -4,18 +4,55 @@
 #include "containers/hashtable_tests.h"
 #include "containers/freelist_tests.h"
 #include "memory/dynamic_allocator_tests.h"
+#include "platform/threading_tests.h"
+#include "platform/filesystem_async_tests.h"
+#include "systems/job_system_tests.h"
+#include "math/kernels_tests.h"
+#include "math/geometry_utils_tests.h"
+#include "core/profiler_tests.h"
+#include "core/frame_stats_tests.h"
+#include "core/kstring_tests.h"
+#include "core/application_tests.h"
+#include "core/logger_tests.h"
+#include "resources/mesh_loader_tests.h"
+#include "renderer/null_backend_tests.h"
 
 #include <core/logger.h>
+#include <core/kstring.h>
 
-int main() {
+int main(int argc, char** argv) {
     // Always initalize the test manager first.
     test_manager_init();
 
+    // Timed tests on large inputs are left out of the normal run.
+    b8 benchmark = false;
+    for (i32 i = 1; i < argc; ++i) {
+        if (strings_equal(argv[i], "--benchmark")) {
+            benchmark = true;
+        }
+    }
+
     // TODO: add test registrations here.
     linear_allocator_register_tests();
     hashtable_register_tests();
     freelist_register_tests();
     dynamic_allocator_register_tests();
+    threading_register_tests();
+    filesystem_async_register_tests();
+    job_system_register_tests();
+    kernels_register_tests();
+    geometry_utils_register_tests();
+    profiler_register_tests();
+    frame_stats_register_tests();
+    kstring_register_tests();
+    application_register_tests();
+    logger_register_tests();
+    mesh_loader_register_tests();
+    null_backend_register_tests();
+
+    if (benchmark) {
+        geometry_utils_register_benchmarks();
+    }
 
     KDEBUG("Starting tests...");
 
@@ -0,0 +1,562 @@
+#include "geometry_utils_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kmemory.h>
+#include <core/logger.h>
+#include <core/clock.h>
+#include <math/kmath.h>
+#include <math/geometry_utils.h>
+
+// The original quadratic de-duplication, kept as a reference for the output of the current one.
+static b8 reference_vertex_equal(vertex_3d vert_0, vertex_3d vert_1) {
+    return vec3_compare(vert_0.position, vert_1.position, K_FLOAT_EPSILON) &&
+           vec3_compare(vert_0.normal, vert_1.normal, K_FLOAT_EPSILON) &&
+           vec2_compare(vert_0.texcoord, vert_1.texcoord, K_FLOAT_EPSILON) &&
+           vec4_compare(vert_0.colour, vert_1.colour, K_FLOAT_EPSILON) &&
+           vec4_compare(vert_0.tangent, vert_1.tangent, K_FLOAT_EPSILON);
+}
+
+static void reference_reassign_index(u32 index_count, u32* indices, u32 from, u32 to) {
+    for (u32 i = 0; i < index_count; ++i) {
+        if (indices[i] == from) {
+            indices[i] = to;
+        } else if (indices[i] > from) {
+            indices[i]--;
+        }
+    }
+}
+
+static u32 reference_deduplicate_vertices(u32 vertex_count, vertex_3d* vertices, u32 index_count, u32* indices, vertex_3d* out_vertices) {
+    u32 unique_count = 0;
+    u32 found_count = 0;
+    for (u32 v = 0; v < vertex_count; ++v) {
+        b8 found = false;
+        for (u32 u = 0; u < unique_count; ++u) {
+            if (reference_vertex_equal(vertices[v], out_vertices[u])) {
+                reference_reassign_index(index_count, indices, v - found_count, u);
+                found = true;
+                found_count++;
+                break;
+            }
+        }
+        if (!found) {
+            out_vertices[unique_count] = vertices[v];
+            unique_count++;
+        }
+    }
+    return unique_count;
+}
+
+/**
+ * @brief Builds a grid of quads the way the OBJ importer does, with three vertices per triangle,
+ * so most vertices are duplicates. Each quad gets a face normal, so vertices shared between quads
+ * with different normals stay unique.
+ */
+static void create_triangle_soup(u32 quads_per_side, f32 spacing, vertex_3d** out_vertices, u32** out_indices, u32* out_count) {
+    u32 count = quads_per_side * quads_per_side * 6;
+    vertex_3d* vertices = kallocate(sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    u32* indices = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    const u32 corners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+    u32 v = 0;
+    for (u32 qy = 0; qy < quads_per_side; ++qy) {
+        for (u32 qx = 0; qx < quads_per_side; ++qx) {
+            vec3 normal = vec3_normalized(vec3_create((f32)(qx % 3), 1.0f, (f32)(qy % 2)));
+            for (u32 c = 0; c < 6; ++c) {
+                u32 x = qx + corners[c][0];
+                u32 y = qy + corners[c][1];
+                vertices[v].position = vec3_create(x * spacing - 10.0f, 0.5f, y * spacing - 10.0f);
+                vertices[v].normal = normal;
+                vertices[v].texcoord = (vec2){(f32)x / quads_per_side, (f32)y / quads_per_side};
+                vertices[v].colour = vec4_one();
+                indices[v] = v;
+                v++;
+            }
+        }
+    }
+    *out_vertices = vertices;
+    *out_indices = indices;
+    *out_count = count;
+}
+
+static u8 expect_matches_reference(u32 count, vertex_3d* vertices, u32* indices) {
+    u32* reference_indices = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    kcopy_memory(reference_indices, indices, sizeof(u32) * count);
+    vertex_3d* reference_vertices = kallocate(sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    u32 reference_count = reference_deduplicate_vertices(count, vertices, count, reference_indices, reference_vertices);
+
+    u32 unique_count = 0;
+    vertex_3d* unique_vertices = 0;
+    geometry_deduplicate_vertices(count, vertices, count, indices, &unique_count, &unique_vertices);
+
+    expect_should_be(reference_count, unique_count);
+    // Identical, as both copy the first occurrence.
+    const f32* reference_floats = (const f32*)reference_vertices;
+    const f32* unique_floats = (const f32*)unique_vertices;
+    for (u64 i = 0; i < (u64)unique_count * sizeof(vertex_3d) / sizeof(f32); ++i) {
+        b8 same = reference_floats[i] == unique_floats[i];
+        expect_to_be_true(same);
+    }
+    for (u32 i = 0; i < count; ++i) {
+        expect_should_be(reference_indices[i], indices[i]);
+    }
+
+    kfree(unique_vertices, sizeof(vertex_3d) * unique_count, MEMORY_TAG_ARRAY);
+    kfree(reference_vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    kfree(reference_indices, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 geometry_deduplicate_vertices_should_match_reference() {
+    vertex_3d* vertices;
+    u32* indices;
+    u32 count;
+    create_triangle_soup(12, 1.0f, &vertices, &indices, &count);
+    expect_to_be_true(expect_matches_reference(count, vertices, indices));
+    kfree(vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+
+    // Near-duplicates within and just beyond the tolerance, around zero and grid cell boundaries,
+    // where matches lie in neighbouring cells.
+    const f32 bases[] = {0.0f, -0.0001220703125f, 0.0001220703125f, 1.0f, -3.5f};
+    const f32 offsets[] = {0.0f, 0.5f * K_FLOAT_EPSILON, -0.75f * K_FLOAT_EPSILON, K_FLOAT_EPSILON, 3.0f * K_FLOAT_EPSILON, -2.0f * K_FLOAT_EPSILON};
+    const u32 base_count = sizeof(bases) / sizeof(f32);
+    const u32 offset_count = sizeof(offsets) / sizeof(f32);
+    count = base_count * offset_count * 4;
+    vertices = kallocate(sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    indices = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    u32 v = 0;
+    for (u32 b = 0; b < base_count; ++b) {
+        for (u32 o = 0; o < offset_count; ++o) {
+            for (u32 axis = 0; axis < 4; ++axis) {
+                f32 value = bases[b] + offsets[(o + axis) % offset_count];
+                vertices[v].position = vec3_create(bases[b], bases[b], bases[b]);
+                if (axis < 3) {
+                    vertices[v].position.elements[axis] = value;
+                } else {
+                    // Differs by texture coordinate alone.
+                    vertices[v].texcoord.x = offsets[o];
+                }
+                // Index out of order, to check indices are remapped by value.
+                indices[count - 1 - v] = v;
+                v++;
+            }
+        }
+    }
+    expect_to_be_true(expect_matches_reference(count, vertices, indices));
+    kfree(vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+
+    // Positions too far out for their grid cell to fit in an i64 still weld.
+    const f32 far_values[] = {1.0e30f, -1.0e30f, 3.0e38f, 1.0e30f, -3.0e38f, -1.0e30f, 3.0e38f};
+    count = sizeof(far_values) / sizeof(f32);
+    vertices = kallocate(sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    indices = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < count; ++i) {
+        vertices[i].position = vec3_create(far_values[i], 1.0f, far_values[i]);
+        indices[i] = i;
+    }
+    expect_to_be_true(expect_matches_reference(count, vertices, indices));
+    kfree(vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 geometry_deduplicate_vertices_should_keep_non_finite_positions() {
+    // As from a malformed file. These are never welded, even to each other.
+    f32 zero = 0.0f;
+    f32 infinity = 1.0f / zero;
+    f32 nan = zero / zero;
+    vertex_3d vertices[6] = {0};
+    vertices[0].position = vec3_create(nan, 0.0f, 0.0f);
+    vertices[1].position = vec3_create(nan, 0.0f, 0.0f);
+    vertices[2].position = vec3_create(0.0f, infinity, 0.0f);
+    vertices[3].position = vec3_create(0.0f, infinity, 0.0f);
+    vertices[4].position = vec3_create(0.0f, 0.0f, -infinity);
+    vertices[5].position = vec3_create(1.0f, 2.0f, 3.0f);
+    u32 indices[8] = {0, 1, 2, 3, 4, 5, 5, 0};
+
+    u32 unique_count = 0;
+    vertex_3d* unique_vertices = 0;
+    geometry_deduplicate_vertices(6, vertices, 8, indices, &unique_count, &unique_vertices);
+    expect_should_be(6, unique_count);
+    for (u32 i = 0; i < 6; ++i) {
+        expect_should_be(i, indices[i]);
+    }
+    expect_should_be(5, indices[6]);
+    expect_should_be(0, indices[7]);
+
+    kfree(unique_vertices, sizeof(vertex_3d) * unique_count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 geometry_deduplicate_vertices_benchmark() {
+    // Small enough for the reference to finish in reasonable time.
+    vertex_3d* vertices;
+    u32* indices;
+    u32 count;
+    create_triangle_soup(40, 0.5f, &vertices, &indices, &count);
+    vertex_3d* reference_vertices = kallocate(sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    clock timer;
+    clock_start(&timer);
+    reference_deduplicate_vertices(count, vertices, count, indices, reference_vertices);
+    clock_update(&timer);
+    f64 reference_seconds = timer.elapsed;
+    kfree(reference_vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+
+    u32 unique_count = 0;
+    vertex_3d* unique_vertices = 0;
+    clock_start(&timer);
+    geometry_deduplicate_vertices(count, vertices, count, indices, &unique_count, &unique_vertices);
+    clock_update(&timer);
+    KINFO("De-duplicating %u vertices: reference %.3fms, hash grid %.3fms.", count, reference_seconds * 1000.0, timer.elapsed * 1000.0);
+    kfree(unique_vertices, sizeof(vertex_3d) * unique_count, MEMORY_TAG_ARRAY);
+    kfree(vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+
+    // About the size of sponza as imported: ~262k triangles, three vertices each.
+    create_triangle_soup(362, 0.1f, &vertices, &indices, &count);
+    clock_start(&timer);
+    geometry_deduplicate_vertices(count, vertices, count, indices, &unique_count, &unique_vertices);
+    clock_update(&timer);
+    KINFO("De-duplicating %u vertices (sponza-sized): hash grid %.3fms, %u unique.", count, timer.elapsed * 1000.0, unique_count);
+    // No neighbouring quads share a normal, so each quad keeps its own four corners.
+    expect_should_be(362 * 362 * 4, unique_count);
+    kfree(unique_vertices, sizeof(vertex_3d) * unique_count, MEMORY_TAG_ARRAY);
+    kfree(vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+/** @brief Builds a welded grid mesh, then shuffles its triangles as a poorly ordered export would. */
+static void create_shuffled_grid(u32 quads_per_side, vertex_3d** out_vertices, u32* out_vertex_count, u32** out_indices, u32* out_index_count) {
+    vertex_3d* soup;
+    u32 count;
+    create_triangle_soup(quads_per_side, 1.0f, &soup, out_indices, &count);
+    // Share normals, so the quads weld into one connected surface.
+    for (u32 v = 0; v < count; ++v) {
+        soup[v].normal = vec3_create(0, 1, 0);
+    }
+    geometry_deduplicate_vertices(count, soup, count, *out_indices, out_vertex_count, out_vertices);
+    kfree(soup, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+
+    u32* indices = *out_indices;
+    u32 triangle_count = count / 3;
+    u32 seed = 7;
+    for (u32 t = triangle_count - 1; t > 0; --t) {
+        seed = seed * 1664525u + 1013904223u;
+        u32 other = (seed >> 8) % (t + 1);
+        for (u32 c = 0; c < 3; ++c) {
+            u32 temp = indices[t * 3 + c];
+            indices[t * 3 + c] = indices[other * 3 + c];
+            indices[other * 3 + c] = temp;
+        }
+    }
+    *out_index_count = count;
+}
+
+u8 geometry_optimize_vertex_cache_should_reduce_misses() {
+    vertex_3d* vertices;
+    u32 vertex_count;
+    u32* indices;
+    u32 index_count;
+    create_shuffled_grid(24, &vertices, &vertex_count, &indices, &index_count);
+    u32* original = kallocate(sizeof(u32) * index_count, MEMORY_TAG_ARRAY);
+    kcopy_memory(original, indices, sizeof(u32) * index_count);
+
+    geometry_vertex_cache_stats before;
+    geometry_analyze_vertex_cache(vertex_count, index_count, indices, GEOMETRY_VERTEX_CACHE_SIZE, &before);
+    geometry_optimize_vertex_cache(vertex_count, vertices, index_count, indices, GEOMETRY_VERTEX_CACHE_SIZE);
+    geometry_vertex_cache_stats after;
+    geometry_analyze_vertex_cache(vertex_count, index_count, indices, GEOMETRY_VERTEX_CACHE_SIZE, &after);
+    KINFO("Shuffled %u-triangle grid: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f.", index_count / 3, before.acmr, after.acmr, before.atvr, after.atvr);
+
+    // A shuffled grid misses almost every vertex. An ordered one transforms each vertex about once.
+    b8 improved = after.acmr < before.acmr * 0.5f && after.atvr < 1.5f;
+    expect_to_be_true(improved);
+
+    // Every triangle is kept exactly once, with its winding.
+    u32 triangle_count = index_count / 3;
+    u8* matched = kallocate(sizeof(u8) * triangle_count, MEMORY_TAG_ARRAY);
+    for (u32 t = 0; t < triangle_count; ++t) {
+        b8 found = false;
+        for (u32 o = 0; o < triangle_count && !found; ++o) {
+            if (!matched[o] && original[o * 3] == indices[t * 3] && original[o * 3 + 1] == indices[t * 3 + 1] && original[o * 3 + 2] == indices[t * 3 + 2]) {
+                matched[o] = true;
+                found = true;
+            }
+        }
+        expect_to_be_true(found);
+    }
+    kfree(matched, sizeof(u8) * triangle_count, MEMORY_TAG_ARRAY);
+
+    // Fetch reordering numbers vertices by first use, without changing what is drawn.
+    geometry_optimize_vertex_fetch(vertex_count, vertices, index_count, indices);
+    u32 next_new = 0;
+    for (u32 i = 0; i < index_count; ++i) {
+        b8 in_order = indices[i] <= next_new;
+        expect_to_be_true(in_order);
+        if (indices[i] == next_new) {
+            next_new++;
+        }
+    }
+    expect_should_be(vertex_count, next_new);
+
+    kfree(original, sizeof(u32) * index_count, MEMORY_TAG_ARRAY);
+    kfree(vertices, sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * index_count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 geometry_optimize_vertex_fetch_should_keep_triangles() {
+    vertex_3d* vertices;
+    u32 vertex_count;
+    u32* indices;
+    u32 index_count;
+    create_shuffled_grid(8, &vertices, &vertex_count, &indices, &index_count);
+    vec3* positions = kallocate(sizeof(vec3) * index_count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < index_count; ++i) {
+        positions[i] = vertices[indices[i]].position;
+    }
+
+    geometry_optimize_vertex_fetch(vertex_count, vertices, index_count, indices);
+    for (u32 i = 0; i < index_count; ++i) {
+        b8 same = vec3_compare(positions[i], vertices[indices[i]].position, 0.0f);
+        expect_to_be_true(same);
+    }
+
+    kfree(positions, sizeof(vec3) * index_count, MEMORY_TAG_ARRAY);
+    kfree(vertices, sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * index_count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 geometry_indices_narrow_u16_should_keep_values() {
+    u32 indices[6] = {0, 1, 2, 65535, 40000, 2};
+    u16 narrowed[6];
+    geometry_indices_narrow_u16(6, indices, narrowed);
+    for (u32 i = 0; i < 6; ++i) {
+        expect_should_be(indices[i], narrowed[i]);
+    }
+    return true;
+}
+
+u8 geometry_pack_vertices_should_round_trip() {
+    b8 compact = sizeof(vertex_3d_packed) == 28;
+    expect_to_be_true(compact);
+
+    const u32 count = 1000;
+    vertex_3d* vertices = kallocate(sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    vertex_3d_packed* packed = kallocate(sizeof(vertex_3d_packed) * count, MEMORY_TAG_ARRAY);
+    vertex_3d* unpacked = kallocate(sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < count; ++i) {
+        vertex_3d* v = &vertices[i];
+        v->position = (vec3){fkrandom_in_range(-100.0f, 100.0f), fkrandom_in_range(-100.0f, 100.0f), fkrandom_in_range(-100.0f, 100.0f)};
+        // Include the axes, where the octahedral encoding folds.
+        if (i < 6) {
+            v->normal = vec3_zero();
+            v->normal.elements[i / 2] = (i & 1) ? -1.0f : 1.0f;
+        } else {
+            v->normal = vec3_normalized((vec3){fkrandom_in_range(-1.0f, 1.0f), fkrandom_in_range(-1.0f, 1.0f), fkrandom_in_range(-1.0f, 1.0f)});
+        }
+        vec3 t = vec3_normalized(vec3_cross(v->normal, vec3_normalized((vec3){fkrandom_in_range(-1.0f, 1.0f), fkrandom_in_range(-1.0f, 1.0f), 0.5f})));
+        v->tangent = (vec4){t.x, t.y, t.z, (i & 1) ? -1.0f : 1.0f};
+        v->texcoord = (vec2){fkrandom_in_range(-4.0f, 4.0f), fkrandom_in_range(0.0f, 1.0f)};
+        v->colour = (vec4){fkrandom_in_range(0.0f, 1.0f), fkrandom_in_range(0.0f, 1.0f), fkrandom_in_range(0.0f, 1.0f), 1.0f};
+    }
+
+    geometry_pack_vertices(count, vertices, packed);
+    geometry_unpack_vertices(count, packed, unpacked);
+    for (u32 i = 0; i < count; ++i) {
+        vertex_3d* a = &vertices[i];
+        vertex_3d* b = &unpacked[i];
+        b8 same_position = vec3_compare(a->position, b->position, 0.0f);
+        expect_to_be_true(same_position);
+        b8 close_normal = vec3_dot(a->normal, b->normal) > 0.9999f;
+        expect_to_be_true(close_normal);
+        vec3 at = (vec3){a->tangent.x, a->tangent.y, a->tangent.z};
+        vec3 bt = (vec3){b->tangent.x, b->tangent.y, b->tangent.z};
+        b8 close_tangent = vec3_dot(at, bt) > 0.999f;
+        expect_to_be_true(close_tangent);
+        expect_float_to_be(a->tangent.w, b->tangent.w);
+        b8 close_texcoord = vec2_compare(a->texcoord, b->texcoord, 0.002f);
+        expect_to_be_true(close_texcoord);
+        b8 close_colour = vec4_compare(a->colour, b->colour, 0.5f / 255.0f + K_FLOAT_EPSILON);
+        expect_to_be_true(close_colour);
+    }
+
+    kfree(vertices, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    kfree(packed, sizeof(vertex_3d_packed) * count, MEMORY_TAG_ARRAY);
+    kfree(unpacked, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 geometry_simplify_should_keep_borders_and_seams() {
+    const u32 quads_per_side = 16;
+    vertex_3d* soup;
+    u32* indices;
+    u32 count;
+    create_triangle_soup(quads_per_side, 1.0f, &soup, &indices, &count);
+    // A flat grid, split down the middle by a colour seam.
+    for (u32 v = 0; v < count; ++v) {
+        soup[v].normal = vec3_create(0, 1, 0);
+        soup[v].colour.x = (v / 6) % quads_per_side < quads_per_side / 2 ? 0.0f : 1.0f;
+    }
+    vertex_3d* vertices;
+    u32 vertex_count;
+    geometry_deduplicate_vertices(count, soup, count, indices, &vertex_count, &vertices);
+    kfree(soup, sizeof(vertex_3d) * count, MEMORY_TAG_ARRAY);
+
+    u32* simplified = kallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    f32 error = 1.0f;
+    u32 simplified_count = geometry_simplify(vertex_count, vertices, count, indices, 0, 0.001f, simplified, &error);
+    KINFO("Simplified a %u-triangle grid with a seam to %u triangles, error %.6f.", count / 3, simplified_count / 3, error);
+
+    // A flat grid simplifies a long way with no error.
+    b8 reduced = simplified_count > 0 && simplified_count < count / 4;
+    expect_to_be_true(reduced);
+    b8 no_error = error < 0.0001f;
+    expect_to_be_true(no_error);
+
+    f32 area = 0.0f;
+    for (u32 i = 0; i < simplified_count; i += 3) {
+        b8 valid = simplified[i] < vertex_count && simplified[i + 1] < vertex_count && simplified[i + 2] < vertex_count;
+        expect_to_be_true(valid);
+        vertex_3d* a = &vertices[simplified[i]];
+        vertex_3d* b = &vertices[simplified[i + 1]];
+        vertex_3d* c = &vertices[simplified[i + 2]];
+        // Triangles stay on their own side of the seam, and keep their winding.
+        b8 one_side = a->colour.x == b->colour.x && b->colour.x == c->colour.x;
+        expect_to_be_true(one_side);
+        f32 signed_area = vec3_cross(vec3_sub(b->position, a->position), vec3_sub(c->position, a->position)).y * -0.5f;
+        b8 not_flipped = signed_area > 0.0f;
+        expect_to_be_true(not_flipped);
+        area += signed_area;
+    }
+    // The outer border is kept, so the grid covers the same area.
+    expect_float_to_be((f32)(quads_per_side * quads_per_side), area);
+
+    kfree(simplified, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    kfree(vertices, sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 geometry_select_lod_should_apply_thresholds_with_hysteresis() {
+    const f32 screen_sizes[] = {0.5f, 0.25f, 0.1f, 0.0f};
+    const f32 hysteresis = 0.1f;
+
+    // Without levels of detail, the whole geometry is always drawn.
+    expect_should_be(0, geometry_select_lod(0, screen_sizes, hysteresis, 0.01f, 0));
+    expect_should_be(0, geometry_select_lod(1, screen_sizes, hysteresis, 0.01f, 3));
+
+    // Well past the thresholds, the same level is selected from anywhere.
+    for (u8 previous = 0; previous < 4; ++previous) {
+        expect_should_be(0, geometry_select_lod(4, screen_sizes, hysteresis, 1.0f, previous));
+        expect_should_be(1, geometry_select_lod(4, screen_sizes, hysteresis, 0.35f, previous));
+        expect_should_be(2, geometry_select_lod(4, screen_sizes, hysteresis, 0.17f, previous));
+        expect_should_be(3, geometry_select_lod(4, screen_sizes, hysteresis, 0.05f, previous));
+    }
+
+    // Within the hysteresis of a threshold, the previous level is kept on either side of it.
+    expect_should_be(0, geometry_select_lod(4, screen_sizes, hysteresis, 0.48f, 0));
+    expect_should_be(1, geometry_select_lod(4, screen_sizes, hysteresis, 0.48f, 1));
+    expect_should_be(0, geometry_select_lod(4, screen_sizes, hysteresis, 0.52f, 0));
+    expect_should_be(1, geometry_select_lod(4, screen_sizes, hysteresis, 0.52f, 1));
+    // And changes once past it.
+    expect_should_be(1, geometry_select_lod(4, screen_sizes, hysteresis, 0.44f, 0));
+    expect_should_be(0, geometry_select_lod(4, screen_sizes, hysteresis, 0.56f, 1));
+
+    // A size moving back and forth across a threshold only switches once, as long as each draw keeps its own previous level.
+    u8 near_lod = 0;
+    u8 far_lod = 0;
+    for (u32 frame = 0; frame < 8; ++frame) {
+        f32 wobble = (frame & 1) ? 0.02f : -0.02f;
+        near_lod = geometry_select_lod(4, screen_sizes, hysteresis, 0.5f + wobble, near_lod);
+        far_lod = geometry_select_lod(4, screen_sizes, hysteresis, 0.1f + wobble * 0.1f, far_lod);
+        expect_should_be(0, near_lod);
+        expect_should_be(2, far_lod);
+    }
+
+    // A threshold of 0 stops at its level, however small the size.
+    const f32 capped[] = {0.5f, 0.25f, 0.0f, 0.0f};
+    expect_should_be(2, geometry_select_lod(5, capped, hysteresis, 0.001f, 0));
+    // The previous level is clamped to the levels there are.
+    expect_should_be(2, geometry_select_lod(3, screen_sizes, hysteresis, 0.001f, 4));
+    return true;
+}
+
+u8 geometry_build_meshlets_should_cover_triangles_within_limits() {
+    vertex_3d* vertices;
+    u32 vertex_count;
+    u32* indices;
+    u32 index_count;
+    create_shuffled_grid(24, &vertices, &vertex_count, &indices, &index_count);
+    geometry_optimize_vertex_cache(vertex_count, vertices, index_count, indices, GEOMETRY_VERTEX_CACHE_SIZE);
+
+    u32 bound = geometry_meshlet_count_bound(index_count, GEOMETRY_MESHLET_MAX_VERTICES, GEOMETRY_MESHLET_MAX_TRIANGLES);
+    geometry_meshlet* meshlets = kallocate(sizeof(geometry_meshlet) * bound, MEMORY_TAG_ARRAY);
+    u32 meshlet_count = geometry_build_meshlets(vertex_count, vertices, index_count, indices, GEOMETRY_MESHLET_MAX_VERTICES, GEOMETRY_MESHLET_MAX_TRIANGLES, meshlets);
+    KINFO("Split a %u-triangle grid into %u meshlets.", index_count / 3, meshlet_count);
+    b8 within_bound = meshlet_count > 1 && meshlet_count <= bound;
+    expect_to_be_true(within_bound);
+
+    // The grid faces -y, so is culled from above and not from below.
+    vec3 above = vec3_create(0, 50.0f, 0);
+    vec3 below = vec3_create(0, -50.0f, 0);
+
+    u32* used = kallocate(sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    u32 next_index = 0;
+    for (u32 m = 0; m < meshlet_count; ++m) {
+        geometry_meshlet* meshlet = &meshlets[m];
+        // Meshlets cover the indices in order, without gaps.
+        expect_should_be(next_index, meshlet->index_offset);
+        next_index += meshlet->index_count;
+        b8 within_triangles = meshlet->index_count > 0 && meshlet->index_count / 3 <= GEOMETRY_MESHLET_MAX_TRIANGLES;
+        expect_to_be_true(within_triangles);
+
+        u32 unique = 0;
+        for (u32 i = meshlet->index_offset; i < meshlet->index_offset + meshlet->index_count; ++i) {
+            if (used[indices[i]] != m + 1) {
+                used[indices[i]] = m + 1;
+                unique++;
+            }
+            b8 in_sphere = vec3_distance(meshlet->center, vertices[indices[i]].position) <= meshlet->radius + K_FLOAT_EPSILON;
+            expect_to_be_true(in_sphere);
+        }
+        b8 within_vertices = unique <= GEOMETRY_MESHLET_MAX_VERTICES;
+        expect_to_be_true(within_vertices);
+
+        b8 culled_above = vec3_dot(vec3_normalized(vec3_sub(meshlet->cone_apex, above)), meshlet->cone_axis) >= meshlet->cone_cutoff;
+        expect_to_be_true(culled_above);
+        b8 culled_below = vec3_dot(vec3_normalized(vec3_sub(meshlet->cone_apex, below)), meshlet->cone_axis) >= meshlet->cone_cutoff;
+        expect_to_be_false(culled_below);
+    }
+    expect_should_be(index_count, next_index);
+
+    kfree(used, sizeof(u32) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(meshlets, sizeof(geometry_meshlet) * bound, MEMORY_TAG_ARRAY);
+    kfree(vertices, sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    kfree(indices, sizeof(u32) * index_count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void geometry_utils_register_tests() {
+    test_manager_register_test(geometry_deduplicate_vertices_should_match_reference, "Vertex de-duplication should match the reference implementation.");
+    test_manager_register_test(geometry_deduplicate_vertices_should_keep_non_finite_positions, "Vertex de-duplication should keep vertices with non-finite positions.");
+    test_manager_register_test(geometry_optimize_vertex_cache_should_reduce_misses, "Vertex cache optimization should reduce cache misses and keep every triangle.");
+    test_manager_register_test(geometry_optimize_vertex_fetch_should_keep_triangles, "Vertex fetch optimization should keep what each index refers to.");
+    test_manager_register_test(geometry_indices_narrow_u16_should_keep_values, "Narrowing indices to 16 bits should keep their values.");
+    test_manager_register_test(geometry_pack_vertices_should_round_trip, "Packed vertices should unpack to within their quantization error.");
+    test_manager_register_test(geometry_simplify_should_keep_borders_and_seams, "Simplification should reduce a flat grid while keeping its border and seams.");
+    test_manager_register_test(geometry_select_lod_should_apply_thresholds_with_hysteresis, "Level of detail selection should apply its thresholds with hysteresis.");
+    test_manager_register_test(geometry_build_meshlets_should_cover_triangles_within_limits, "Meshlets should cover every triangle in order, within their limits and bounds.");
+}
+
+void geometry_utils_register_benchmarks() {
+    test_manager_register_test(geometry_deduplicate_vertices_benchmark, "Vertex de-duplication should weld a sponza-sized mesh quickly.");
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+void geometry_utils_register_tests();
+
+/** @brief Registers the timed tests, which are only run when the tests are started with --benchmark. */
+void geometry_utils_register_benchmarks();
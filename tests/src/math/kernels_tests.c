@@ -0,0 +1,85 @@
+#include "kernels_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kmemory.h>
+#include <math/kernels.h>
+
+u8 kernels_rgba8_transparency_should_match_across_sets() {
+    const u64 pixel_count = 1003;
+    u8* pixels = kallocate(pixel_count * 4, MEMORY_TAG_TEXTURE);
+    kset_memory(pixels, 255, pixel_count * 4);
+    // Colour values must not affect the result.
+    for (u64 i = 0; i < pixel_count * 4; i += 4) {
+        pixels[i] = (u8)i;
+    }
+
+    // Covers the first pixel, block boundaries of both vector widths and the scalar tail.
+    const u64 transparent_pixels[] = {0, 15, 16, 31, 32, 990, 1002};
+    kernel_set original = kernels_active_set();
+    for (u32 set = 0; set < KERNEL_SET_MAX; ++set) {
+        if (!kernels_select((kernel_set)set)) {
+            continue;
+        }
+        expect_to_be_false(kernel_rgba8_has_transparency(pixels, pixel_count));
+        for (u32 t = 0; t < sizeof(transparent_pixels) / sizeof(u64); ++t) {
+            u8* alpha = &pixels[transparent_pixels[t] * 4 + 3];
+            *alpha = 254;
+            expect_to_be_true(kernel_rgba8_has_transparency(pixels, pixel_count));
+            *alpha = 255;
+        }
+    }
+    kernels_select(original);
+
+    kfree(pixels, pixel_count * 4, MEMORY_TAG_TEXTURE);
+    return true;
+}
+
+u8 kernels_vertex_extents_should_match_across_sets() {
+    const u32 vertex_count = 1001;
+    vertex_3d* vertices = kallocate(sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < vertex_count; ++i) {
+        vertices[i].position = vec3_create(fkrandom_in_range(-1000.0f, 1000.0f), fkrandom_in_range(-1000.0f, 1000.0f), fkrandom_in_range(-1000.0f, 1000.0f));
+        // Should be ignored.
+        vertices[i].normal = vec3_create(5000.0f, -5000.0f, 5000.0f);
+    }
+    // Place the extremes in the tail, after the last full vector block.
+    vertices[vertex_count - 1].position = vec3_create(-2000.0f, 2000.0f, 1.0f);
+
+    kernel_set original = kernels_active_set();
+    kernels_select(KERNEL_SET_SCALAR);
+    vec3 expected_min, expected_max;
+    kernel_vertex_3d_extents(vertex_count, vertices, &expected_min, &expected_max);
+    expect_float_to_be(-2000.0f, expected_min.x);
+    expect_float_to_be(2000.0f, expected_max.y);
+
+    for (u32 set = 0; set < KERNEL_SET_MAX; ++set) {
+        if (!kernels_select((kernel_set)set)) {
+            continue;
+        }
+        // Also covers counts smaller than a vector block.
+        u32 counts[] = {vertex_count, 3};
+        for (u32 c = 0; c < 2; ++c) {
+            vec3 scalar_min, scalar_max, min, max;
+            kernels_select(KERNEL_SET_SCALAR);
+            kernel_vertex_3d_extents(counts[c], vertices, &scalar_min, &scalar_max);
+            kernels_select((kernel_set)set);
+            kernel_vertex_3d_extents(counts[c], vertices, &min, &max);
+            for (u8 e = 0; e < 3; ++e) {
+                expect_float_to_be(scalar_min.elements[e], min.elements[e]);
+                expect_float_to_be(scalar_max.elements[e], max.elements[e]);
+            }
+        }
+    }
+    kernels_select(original);
+
+    kfree(vertices, sizeof(vertex_3d) * vertex_count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void kernels_register_tests() {
+    test_manager_register_test(kernels_rgba8_transparency_should_match_across_sets, "Transparency kernels should agree across kernel sets.");
+    test_manager_register_test(kernels_vertex_extents_should_match_across_sets, "Vertex extents kernels should agree across kernel sets.");
+}
@@ -0,0 +1,116 @@
+#include "filesystem_async_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kmemory.h>
+#include <platform/filesystem.h>
+
+#include <stdio.h>
+
+#define TEST_FILE_PATH "filesystem_async_test.bin"
+#define TEST_FILE_SIZE (256 * 1024)
+#define TEST_READ_COUNT 16
+#define TEST_READ_SIZE 4096
+
+typedef struct read_result {
+    u32 callback_count;
+    u64 bytes_read;
+    b8 success;
+} read_result;
+
+static void on_read(const char* path, void* dest, u64 bytes_read, b8 success, void* user_data) {
+    read_result* result = user_data;
+    result->callback_count++;
+    result->bytes_read = bytes_read;
+    result->success = success;
+}
+
+static b8 write_test_file() {
+    file_handle f;
+    if (!filesystem_open(TEST_FILE_PATH, FILE_MODE_WRITE, true, &f)) {
+        return false;
+    }
+    u8* data = kallocate(TEST_FILE_SIZE, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < TEST_FILE_SIZE; ++i) {
+        data[i] = (u8)(i * 7 + (i >> 8));
+    }
+    u64 written = 0;
+    b8 result = filesystem_write(&f, TEST_FILE_SIZE, data, &written);
+    filesystem_close(&f);
+    kfree(data, TEST_FILE_SIZE, MEMORY_TAG_ARRAY);
+    return result;
+}
+
+static u8 run_async_reads(b8 force_worker_threads) {
+    expect_to_be_true(write_test_file());
+
+    u64 memory_requirement = 0;
+    filesystem_async_config config = {0};
+    config.max_requests = 32;
+    config.force_worker_threads = force_worker_threads;
+    filesystem_async_initialize(&memory_requirement, 0, config);
+    void* state = kallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    expect_to_be_true(filesystem_async_initialize(&memory_requirement, state, config));
+
+    u8* buffers = kallocate(TEST_READ_COUNT * TEST_READ_SIZE, MEMORY_TAG_ARRAY);
+    read_result results[TEST_READ_COUNT + 2] = {0};
+    for (u32 i = 0; i < TEST_READ_COUNT; ++i) {
+        u64 offset = (u64)i * 15000;
+        expect_to_be_true(filesystem_read_async(TEST_FILE_PATH, offset, TEST_READ_SIZE, buffers + i * TEST_READ_SIZE, on_read, &results[i]));
+    }
+    // A read crossing the end of the file, and one of a file which does not exist.
+    u8 tail[64];
+    expect_to_be_true(filesystem_read_async(TEST_FILE_PATH, TEST_FILE_SIZE - 32, 64, tail, on_read, &results[TEST_READ_COUNT]));
+    expect_to_be_true(filesystem_read_async("filesystem_async_missing.bin", 0, 64, tail, on_read, &results[TEST_READ_COUNT + 1]));
+
+    // Callbacks are only ever invoked from the pump.
+    for (u32 i = 0; i < TEST_READ_COUNT + 2; ++i) {
+        expect_should_be(0, results[i].callback_count);
+    }
+
+    // Blocking waits until at least one read has completed and been delivered.
+    expect_to_be_true(filesystem_async_wait() > 0);
+
+    // Pump the rest as a frame loop would, giving up eventually rather than hanging.
+    for (u64 spins = 0; filesystem_async_outstanding_count() > 0 && spins < 100000000; ++spins) {
+        filesystem_async_pump();
+    }
+    expect_should_be(0, filesystem_async_outstanding_count());
+
+    for (u32 i = 0; i < TEST_READ_COUNT; ++i) {
+        expect_should_be(1, results[i].callback_count);
+        expect_to_be_true(results[i].success);
+        expect_should_be(TEST_READ_SIZE, results[i].bytes_read);
+        u64 offset = (u64)i * 15000;
+        for (u32 b = 0; b < TEST_READ_SIZE; ++b) {
+            u64 position = offset + b;
+            expect_should_be((u8)(position * 7 + (position >> 8)), buffers[i * TEST_READ_SIZE + b]);
+        }
+    }
+    expect_should_be(1, results[TEST_READ_COUNT].callback_count);
+    expect_to_be_false(results[TEST_READ_COUNT].success);
+    expect_should_be(32, results[TEST_READ_COUNT].bytes_read);
+    expect_should_be(1, results[TEST_READ_COUNT + 1].callback_count);
+    expect_to_be_false(results[TEST_READ_COUNT + 1].success);
+
+    filesystem_async_shutdown(state);
+    kfree(state, memory_requirement, MEMORY_TAG_ARRAY);
+    kfree(buffers, TEST_READ_COUNT * TEST_READ_SIZE, MEMORY_TAG_ARRAY);
+    remove(TEST_FILE_PATH);
+    return true;
+}
+
+u8 filesystem_async_should_read_with_default_backend() {
+    return run_async_reads(false);
+}
+
+u8 filesystem_async_should_read_with_worker_threads() {
+    return run_async_reads(true);
+}
+
+void filesystem_async_register_tests() {
+    test_manager_register_test(filesystem_async_should_read_with_default_backend, "Async reads should complete with the default backend.");
+    test_manager_register_test(filesystem_async_should_read_with_worker_threads, "Async reads should complete with worker threads.");
+}
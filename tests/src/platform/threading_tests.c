@@ -0,0 +1,163 @@
+#include "threading_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <platform/platform.h>
+
+#define TEST_THREAD_COUNT 4
+#define TEST_ITERATIONS 10000
+
+typedef struct counter_test_data {
+    kmutex mutex;
+    volatile u64 atomic_counter;
+    u64 locked_counter;
+} counter_test_data;
+
+static u32 counter_thread(void* params) {
+    counter_test_data* data = params;
+    for (u32 i = 0; i < TEST_ITERATIONS; ++i) {
+        platform_atomic_fetch_add_u64(&data->atomic_counter, 1);
+
+        platform_mutex_lock(&data->mutex);
+        data->locked_counter++;
+        platform_mutex_unlock(&data->mutex);
+    }
+    return 0;
+}
+
+u8 threading_should_create_and_join_threads() {
+    counter_test_data data = {0};
+    expect_to_be_true(platform_mutex_create(&data.mutex));
+
+    kthread threads[TEST_THREAD_COUNT];
+    for (u32 i = 0; i < TEST_THREAD_COUNT; ++i) {
+        expect_to_be_true(platform_thread_create(counter_thread, &data, &threads[i]));
+    }
+    for (u32 i = 0; i < TEST_THREAD_COUNT; ++i) {
+        platform_thread_join(&threads[i]);
+        expect_should_be(0, threads[i].thread_id);
+    }
+
+    // Every increment should be accounted for, both atomically and under the mutex.
+    expect_should_be(TEST_THREAD_COUNT * TEST_ITERATIONS, platform_atomic_load_u64(&data.atomic_counter));
+    expect_should_be(TEST_THREAD_COUNT * TEST_ITERATIONS, data.locked_counter);
+
+    platform_mutex_destroy(&data.mutex);
+    expect_should_be(0, data.mutex.internal_data);
+
+    return true;
+}
+
+u8 threading_atomic_compare_exchange() {
+    volatile u32 value = 5;
+    u32 expected = 4;
+
+    // Mismatch should fail and report the current value.
+    expect_to_be_false(platform_atomic_compare_exchange_u32(&value, &expected, 10));
+    expect_should_be(5, expected);
+    expect_should_be(5, platform_atomic_load_u32(&value));
+
+    // Match should succeed.
+    expect_to_be_true(platform_atomic_compare_exchange_u32(&value, &expected, 10));
+    expect_should_be(10, platform_atomic_load_u32(&value));
+
+    volatile u64 value64 = 0;
+    platform_atomic_store_u64(&value64, 0xFFFFFFFF00000000);
+    expect_should_be(0xFFFFFFFF00000000, platform_atomic_fetch_add_u64(&value64, 1));
+    expect_should_be(0xFFFFFFFF00000001, platform_atomic_load_u64(&value64));
+
+    return true;
+}
+
+typedef struct condition_test_data {
+    kmutex mutex;
+    kcondition condition;
+    ksemaphore semaphore;
+    u32 produced;
+    u32 consumed;
+} condition_test_data;
+
+static u32 producer_thread(void* params) {
+    condition_test_data* data = params;
+    for (u32 i = 0; i < 100; ++i) {
+        platform_mutex_lock(&data->mutex);
+        data->produced++;
+        platform_condition_signal(&data->condition);
+        platform_mutex_unlock(&data->mutex);
+    }
+    // Let the main thread know all items were produced.
+    platform_semaphore_signal(&data->semaphore);
+    return 0;
+}
+
+u8 threading_condition_and_semaphore() {
+    condition_test_data data = {0};
+    expect_to_be_true(platform_mutex_create(&data.mutex));
+    expect_to_be_true(platform_condition_create(&data.condition));
+    expect_to_be_true(platform_semaphore_create(0, &data.semaphore));
+
+    kthread producer;
+    expect_to_be_true(platform_thread_create(producer_thread, &data, &producer));
+
+    // Consume everything produced, waiting whenever there is nothing available.
+    platform_mutex_lock(&data.mutex);
+    while (data.consumed < 100) {
+        while (data.consumed == data.produced) {
+            platform_condition_wait(&data.condition, &data.mutex);
+        }
+        data.consumed++;
+    }
+    platform_mutex_unlock(&data.mutex);
+
+    expect_to_be_true(platform_semaphore_wait(&data.semaphore));
+    platform_thread_join(&producer);
+    expect_should_be(100, data.produced);
+    expect_should_be(100, data.consumed);
+
+    platform_semaphore_destroy(&data.semaphore);
+    platform_condition_destroy(&data.condition);
+    platform_mutex_destroy(&data.mutex);
+
+    return true;
+}
+
+static KTHREAD_LOCAL u64 thread_local_value = 0;
+
+static u32 thread_local_thread(void* params) {
+    // Set this thread's instance and report it back.
+    thread_local_value = platform_current_thread_id();
+    *(u64*)params = thread_local_value;
+    return 0;
+}
+
+u8 threading_thread_local_storage() {
+    thread_local_value = 42;
+
+    u64 other_value = 0;
+    kthread thread;
+    expect_to_be_true(platform_thread_create(thread_local_thread, &other_value, &thread));
+    platform_thread_join(&thread);
+
+    // The other thread's writes should not be visible to this thread.
+    expect_should_be(42, thread_local_value);
+    expect_should_not_be(0, other_value);
+    expect_should_not_be(platform_current_thread_id(), other_value);
+
+    return true;
+}
+
+u8 threading_processor_count() {
+    b8 has_processors = platform_get_processor_count() >= 1;
+    expect_to_be_true(has_processors);
+    return true;
+}
+
+void threading_register_tests() {
+    test_manager_register_test(threading_should_create_and_join_threads, "Threads should be created and joined, with mutex and atomic counters consistent.");
+    test_manager_register_test(threading_atomic_compare_exchange, "Atomic compare-exchange should only succeed on a match.");
+    test_manager_register_test(threading_condition_and_semaphore, "Condition variables and semaphores should wake waiting threads.");
+    test_manager_register_test(threading_thread_local_storage, "Thread-local variables should be separate per thread.");
+    test_manager_register_test(threading_processor_count, "Processor count should be at least 1.");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void threading_register_tests();
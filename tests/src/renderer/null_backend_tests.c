@@ -0,0 +1,85 @@
+#include "null_backend_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kmemory.h>
+#include <renderer/null/null_backend.h>
+
+u8 null_backend_should_count_draws_and_uploads() {
+    renderer_backend_config config = {0};
+    config.application_name = "null backend test";
+    u8 window_render_target_count = 0;
+    expect_to_be_true(null_renderer_backend_initialize(0, &config, &window_render_target_count));
+
+    // Two levels of detail: the full 12 indices, then the first 6.
+    vertex_3d vertices[4] = {0};
+    u32 indices[12] = {0, 1, 2, 2, 1, 3, 0, 2, 1, 1, 2, 3};
+    geometry g = {0};
+    g.internal_id = INVALID_ID;
+    g.lod_count = 2;
+    g.lods[0].index_count = 12;
+    g.lods[1].index_count = 6;
+    expect_to_be_true(null_renderer_create_geometry(&g, sizeof(vertex_3d), 4, vertices, sizeof(u32), 12, indices));
+    expect_should_not_be(INVALID_ID, g.internal_id);
+
+    texture t = {0};
+    t.width = 4;
+    t.height = 2;
+    t.channel_count = 4;
+    u8 pixels[4 * 2 * 4] = {0};
+    null_renderer_texture_create(pixels, &t);
+
+    geometry_render_data data = {0};
+    data.geometry = &g;
+    // The full level, the reduced level, then a range of indices.
+    null_renderer_draw_geometry(data);
+    data.lod = 1;
+    null_renderer_draw_geometry(data);
+    data.index_offset = 3;
+    data.index_count = 3;
+    null_renderer_draw_geometry(data);
+
+    // Missing and non-uploaded geometries are not drawn.
+    geometry not_uploaded = {0};
+    not_uploaded.internal_id = INVALID_ID;
+    data.geometry = &not_uploaded;
+    null_renderer_draw_geometry(data);
+    data.geometry = 0;
+    null_renderer_draw_geometry(data);
+
+    expect_to_be_true(null_renderer_backend_end_frame(0, 0.0f));
+    renderer_frame_stats last_frame;
+    renderer_frame_stats totals;
+    expect_to_be_true(null_renderer_frame_stats_get(&last_frame, &totals));
+    expect_should_be(1, last_frame.frame_count);
+    expect_should_be(3, last_frame.draw_count);
+    expect_should_be(12 + 6 + 3, last_frame.element_count);
+    expect_should_be(1, last_frame.geometry_create_count);
+    expect_should_be(1, last_frame.texture_create_count);
+    expect_should_be(sizeof(vertices) + sizeof(indices) + sizeof(pixels), last_frame.bytes_uploaded);
+
+    // An empty frame clears the last frame's counts, but not the totals.
+    data.geometry = &g;
+    data.index_count = 0;
+    data.lod = 0;
+    null_renderer_draw_geometry(data);
+    expect_to_be_true(null_renderer_backend_end_frame(0, 0.0f));
+    expect_to_be_true(null_renderer_frame_stats_get(&last_frame, &totals));
+    expect_should_be(1, last_frame.draw_count);
+    expect_should_be(12, last_frame.element_count);
+    expect_should_be(0, last_frame.bytes_uploaded);
+    expect_should_be(2, totals.frame_count);
+    expect_should_be(4, totals.draw_count);
+    expect_should_be(12 + 6 + 3 + 12, totals.element_count);
+    expect_should_be(sizeof(vertices) + sizeof(indices) + sizeof(pixels), totals.bytes_uploaded);
+
+    null_renderer_destroy_geometry(&g);
+    null_renderer_backend_shutdown(0);
+    return true;
+}
+
+void null_backend_register_tests() {
+    test_manager_register_test(null_backend_should_count_draws_and_uploads, "The null renderer should count draws, elements and uploaded bytes.");
+}
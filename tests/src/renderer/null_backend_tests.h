@@ -0,0 +1,3 @@
+#pragma once
+
+void null_backend_register_tests();
@@ -0,0 +1,371 @@
+#include "mesh_loader_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kmemory.h>
+#include <core/kstring.h>
+#include <containers/darray.h>
+#include <math/kmath.h>
+#include <platform/filesystem.h>
+#include <resources/loaders/mesh_loader.h>
+
+#include <stdio.h>
+
+#define TEST_KSM_PATH "mesh_loader_test.ksm"
+#define TEST_KSM_BAD_PATH "mesh_loader_test_bad.ksm"
+#define TEST_GEOMETRY_COUNT 2
+
+// Byte offsets of the header fields patched to produce malformed files.
+#define KSM_HEADER_VERSION_OFFSET 0
+#define KSM_HEADER_GEOMETRY_TABLE_OFFSET 16
+
+// Builds a geometry of quads along x, each split into two triangles.
+static void create_test_geometry(u32 quad_count, const char* name, const char* material_name, geometry_config* out_config) {
+    kzero_memory(out_config, sizeof(geometry_config));
+    out_config->vertex_size = sizeof(vertex_3d_packed);
+    out_config->vertex_count = (quad_count + 1) * 2;
+    out_config->vertices = kallocate(sizeof(vertex_3d_packed) * out_config->vertex_count, MEMORY_TAG_ARRAY);
+    vertex_3d_packed* vertices = out_config->vertices;
+    for (u32 i = 0; i < out_config->vertex_count; ++i) {
+        vertices[i].position = (vec3){(f32)(i / 2), (f32)(i % 2), 0.0f};
+        vertices[i].colour[0] = (u8)i;
+    }
+    out_config->index_size = sizeof(u16);
+    out_config->index_count = quad_count * 6;
+    out_config->indices = kallocate(sizeof(u16) * out_config->index_count, MEMORY_TAG_ARRAY);
+    u16* indices = out_config->indices;
+    for (u32 q = 0; q < quad_count; ++q) {
+        u16 base = (u16)(q * 2);
+        u16 quad[6] = {base, base + 2, base + 1, base + 1, base + 2, base + 3};
+        kcopy_memory(&indices[q * 6], quad, sizeof(quad));
+    }
+    out_config->min_extents = (vec3){0.0f, 0.0f, 0.0f};
+    out_config->max_extents = (vec3){(f32)quad_count, 1.0f, 0.0f};
+    out_config->center = (vec3){quad_count * 0.5f, 0.5f, 0.0f};
+
+    // The full geometry, and a level using its first half.
+    out_config->lod_count = 2;
+    out_config->lods[0].index_count = out_config->index_count;
+    out_config->lods[1].index_count = (quad_count / 2) * 6;
+    out_config->lods[1].error = 0.25f;
+
+    // One meshlet per quad.
+    out_config->meshlet_count = quad_count;
+    out_config->meshlets = kallocate(sizeof(geometry_meshlet) * quad_count, MEMORY_TAG_ARRAY);
+    for (u32 q = 0; q < quad_count; ++q) {
+        out_config->meshlets[q].index_offset = q * 6;
+        out_config->meshlets[q].index_count = 6;
+        out_config->meshlets[q].center = (vec3){q + 0.5f, 0.5f, 0.0f};
+        out_config->meshlets[q].cone_cutoff = 1.0f;
+    }
+
+    string_ncopy(out_config->name, name, GEOMETRY_NAME_MAX_LENGTH);
+    string_ncopy(out_config->material_name, material_name, MATERIAL_NAME_MAX_LENGTH);
+}
+
+static b8 bytes_equal(const void* a, const void* b, u64 size) {
+    for (u64 i = 0; i < size; ++i) {
+        if (((const u8*)a)[i] != ((const u8*)b)[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static b8 write_test_ksm(geometry_config* geometries) {
+    create_test_geometry(4, "test_geometry_a", "test_material_a", &geometries[0]);
+    create_test_geometry(10, "test_geometry_b", "test_material_b", &geometries[1]);
+    return write_ksm_file(TEST_KSM_PATH, "test_mesh", TEST_GEOMETRY_COUNT, geometries);
+}
+
+static b8 read_whole_file(const char* path, u8** out_bytes, u64* out_size) {
+    file_handle f;
+    if (!filesystem_open(path, FILE_MODE_READ, true, &f)) {
+        return false;
+    }
+    b8 result = filesystem_size(&f, out_size);
+    *out_bytes = kallocate(*out_size, MEMORY_TAG_ARRAY);
+    u64 read = 0;
+    result = result && filesystem_read_all_bytes(&f, *out_bytes, &read) && read == *out_size;
+    filesystem_close(&f);
+    return result;
+}
+
+// Releases loaded geometries, whose vertex and index data point into the contents.
+static void release_loaded(geometry_config* loaded, ksm_contents* contents) {
+    u32 count = darray_length(loaded);
+    for (u32 i = 0; i < count; ++i) {
+        if (contents) {
+            loaded[i].vertices = 0;
+            loaded[i].indices = 0;
+        }
+        geometry_system_config_dispose(&loaded[i]);
+    }
+    darray_destroy(loaded);
+    if (contents) {
+        filesystem_unmap(&contents->contents);
+        kfree(contents, sizeof(ksm_contents), MEMORY_TAG_RESOURCE);
+    }
+}
+
+// Writes the given bytes as a ksm file and attempts to load it.
+static b8 load_bytes(const u8* bytes, u64 size) {
+    file_handle f;
+    if (!filesystem_open(TEST_KSM_BAD_PATH, FILE_MODE_WRITE, true, &f)) {
+        return false;
+    }
+    u64 written = 0;
+    filesystem_write(&f, size, bytes, &written);
+    filesystem_close(&f);
+
+    geometry_config* loaded = darray_create(geometry_config);
+    ksm_contents* contents = 0;
+    b8 result = load_ksm_file(TEST_KSM_BAD_PATH, &loaded, &contents);
+    release_loaded(loaded, contents);
+    remove(TEST_KSM_BAD_PATH);
+    return result;
+}
+
+u8 ksm_should_round_trip_in_place() {
+    geometry_config written[TEST_GEOMETRY_COUNT];
+    expect_to_be_true(write_test_ksm(written));
+
+    geometry_config* loaded = darray_create(geometry_config);
+    ksm_contents* contents = 0;
+    expect_to_be_true(load_ksm_file(TEST_KSM_PATH, &loaded, &contents));
+    expect_should_be(TEST_GEOMETRY_COUNT, darray_length(loaded));
+    expect_should_not_be(0, contents);
+    expect_to_be_false(contents->allocated);
+
+    const u8* mapping_start = contents->contents.data;
+    const u8* mapping_end = mapping_start + contents->contents.size;
+    for (u32 i = 0; i < TEST_GEOMETRY_COUNT; ++i) {
+        geometry_config* w = &written[i];
+        geometry_config* l = &loaded[i];
+        expect_to_be_true(strings_equal(w->name, l->name));
+        expect_to_be_true(strings_equal(w->material_name, l->material_name));
+        expect_should_be(w->vertex_size, l->vertex_size);
+        expect_should_be(w->vertex_count, l->vertex_count);
+        expect_should_be(w->index_size, l->index_size);
+        expect_should_be(w->index_count, l->index_count);
+        expect_to_be_true(vec3_compare(w->center, l->center, K_FLOAT_EPSILON));
+        expect_to_be_true(vec3_compare(w->min_extents, l->min_extents, K_FLOAT_EPSILON));
+        expect_to_be_true(vec3_compare(w->max_extents, l->max_extents, K_FLOAT_EPSILON));
+        expect_should_be(w->lod_count, l->lod_count);
+        expect_should_be(w->lods[1].index_count, l->lods[1].index_count);
+        expect_float_to_be(w->lods[1].error, l->lods[1].error);
+        expect_should_be(w->meshlet_count, l->meshlet_count);
+        for (u32 m = 0; m < w->meshlet_count; ++m) {
+            expect_should_be(w->meshlets[m].index_offset, l->meshlets[m].index_offset);
+            expect_should_be(w->meshlets[m].index_count, l->meshlets[m].index_count);
+            expect_to_be_true(vec3_compare(w->meshlets[m].center, l->meshlets[m].center, K_FLOAT_EPSILON));
+            expect_float_to_be(w->meshlets[m].cone_cutoff, l->meshlets[m].cone_cutoff);
+        }
+
+        // The data is used in place rather than copied out of the mapping.
+        const u8* vertices = l->vertices;
+        const u8* indices = l->indices;
+        expect_to_be_true(vertices >= mapping_start && vertices + (u64)l->vertex_size * l->vertex_count <= mapping_end);
+        expect_to_be_true(indices >= mapping_start && indices + (u64)l->index_size * l->index_count <= mapping_end);
+        expect_to_be_true(bytes_equal(w->vertices, l->vertices, (u64)w->vertex_size * w->vertex_count));
+        expect_to_be_true(bytes_equal(w->indices, l->indices, (u64)w->index_size * w->index_count));
+        geometry_system_config_dispose(w);
+    }
+
+    release_loaded(loaded, contents);
+    remove(TEST_KSM_PATH);
+    return true;
+}
+
+u8 ksm_should_reject_malformed_files() {
+    geometry_config written[TEST_GEOMETRY_COUNT];
+    expect_to_be_true(write_test_ksm(written));
+    for (u32 i = 0; i < TEST_GEOMETRY_COUNT; ++i) {
+        geometry_system_config_dispose(&written[i]);
+    }
+    u8* bytes = 0;
+    u64 size = 0;
+    expect_to_be_true(read_whole_file(TEST_KSM_PATH, &bytes, &size));
+    remove(TEST_KSM_PATH);
+
+    // Unmodified, the file loads.
+    expect_to_be_true(load_bytes(bytes, size));
+
+    // Truncated, the last geometry's indices run past the end of the file.
+    expect_to_be_false(load_bytes(bytes, size - 1));
+
+    // Corrupted, the last index refers past the end of the vertices.
+    u8 last_byte = bytes[size - 1];
+    bytes[size - 1] = 0xFF;
+    expect_to_be_false(load_bytes(bytes, size));
+    bytes[size - 1] = last_byte;
+
+    // Misaligned, the geometry table no longer starts on its alignment.
+    u64 table_offset = 0;
+    kcopy_memory(&table_offset, bytes + KSM_HEADER_GEOMETRY_TABLE_OFFSET, sizeof(u64));
+    u64 misaligned_offset = table_offset + 4;
+    kcopy_memory(bytes + KSM_HEADER_GEOMETRY_TABLE_OFFSET, &misaligned_offset, sizeof(u64));
+    expect_to_be_false(load_bytes(bytes, size));
+    kcopy_memory(bytes + KSM_HEADER_GEOMETRY_TABLE_OFFSET, &table_offset, sizeof(u64));
+
+    // An unknown version.
+    u16 version = 0x7F;
+    kcopy_memory(bytes + KSM_HEADER_VERSION_OFFSET, &version, sizeof(u16));
+    expect_to_be_false(load_bytes(bytes, size));
+
+    kfree(bytes, size, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+static b8 face_vertex_is(const mesh_vertex_index_data* vertex, u32 position_index, u32 texcoord_index, u32 normal_index) {
+    return vertex->position_index == position_index && vertex->texcoord_index == texcoord_index && vertex->normal_index == normal_index;
+}
+
+static b8 parse_results_equal(const obj_parse_result* a, const obj_parse_result* b) {
+    if (a->position_count != b->position_count || a->normal_count != b->normal_count ||
+        a->tex_coord_count != b->tex_coord_count || a->face_count != b->face_count ||
+        darray_length(a->directives) != darray_length(b->directives)) {
+        return false;
+    }
+    if (!bytes_equal(a->positions, b->positions, sizeof(vec3) * a->position_count) ||
+        !bytes_equal(a->normals, b->normals, sizeof(vec3) * a->normal_count) ||
+        !bytes_equal(a->tex_coords, b->tex_coords, sizeof(vec2) * a->tex_coord_count) ||
+        !bytes_equal(a->faces, b->faces, sizeof(mesh_face_data) * a->face_count)) {
+        return false;
+    }
+    for (u64 i = 0; i < darray_length(a->directives); ++i) {
+        if (a->directives[i].type != b->directives[i].type || a->directives[i].face_index != b->directives[i].face_index ||
+            !strings_equal(a->directives[i].text, b->directives[i].text)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+u8 obj_parse_should_parse_each_face_form() {
+    const char* obj =
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 0 1.5 -2\n"
+        "vt 0.25 0.75\n"
+        "vt 1 1\n"
+        "vn 0 0 1\n"
+        "vn 0 1 0\n"
+        "f 1 2 3\n"
+        "f 1/2 2/1 3/2\n"
+        "f 1//2 2//1 3//2\n"
+        "f 3/1/2 2/2/1 1/1/1\n";
+    obj_parse_result result;
+    obj_parse(obj, string_length(obj), 1, &result);
+
+    expect_should_be(3, result.position_count);
+    expect_should_be(2, result.tex_coord_count);
+    expect_should_be(2, result.normal_count);
+    expect_to_be_true(vec3_compare(result.positions[2], (vec3){0.0f, 1.5f, -2.0f}, K_FLOAT_EPSILON));
+    expect_float_to_be(0.25f, result.tex_coords[0].x);
+    expect_float_to_be(0.75f, result.tex_coords[0].y);
+    expect_float_to_be(1.0f, result.normals[1].y);
+
+    expect_should_be(4, result.face_count);
+    // v
+    expect_to_be_true(face_vertex_is(&result.faces[0].vertices[0], 1, 0, 0));
+    expect_to_be_true(face_vertex_is(&result.faces[0].vertices[2], 3, 0, 0));
+    // v/t
+    expect_to_be_true(face_vertex_is(&result.faces[1].vertices[0], 1, 2, 0));
+    expect_to_be_true(face_vertex_is(&result.faces[1].vertices[1], 2, 1, 0));
+    // v//n
+    expect_to_be_true(face_vertex_is(&result.faces[2].vertices[0], 1, 0, 2));
+    expect_to_be_true(face_vertex_is(&result.faces[2].vertices[1], 2, 0, 1));
+    // v/t/n
+    expect_to_be_true(face_vertex_is(&result.faces[3].vertices[0], 3, 1, 2));
+    expect_to_be_true(face_vertex_is(&result.faces[3].vertices[1], 2, 2, 1));
+    expect_to_be_true(face_vertex_is(&result.faces[3].vertices[2], 1, 1, 1));
+
+    obj_parse_result_destroy(&result);
+    return true;
+}
+
+u8 obj_parse_should_split_polygons_into_fans() {
+    const char* obj =
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv -1 0.5 0\n"
+        "f 1/1/1 2/1/1 3/1/1 4/1/1 5/1/1\n"
+        "f 1 2 3 4\n";
+    obj_parse_result result;
+    obj_parse(obj, string_length(obj), 1, &result);
+
+    // A pentagon is three triangles, and a quad two, all sharing the polygon's first vertex.
+    u32 expected[5][3] = {{1, 2, 3}, {1, 3, 4}, {1, 4, 5}, {1, 2, 3}, {1, 3, 4}};
+    expect_should_be(5, result.face_count);
+    for (u32 f = 0; f < 5; ++f) {
+        for (u32 v = 0; v < 3; ++v) {
+            expect_should_be(expected[f][v], result.faces[f].vertices[v].position_index);
+        }
+    }
+    expect_should_be(1, result.faces[2].vertices[2].normal_index);
+    expect_should_be(0, result.faces[4].vertices[2].normal_index);
+
+    obj_parse_result_destroy(&result);
+    return true;
+}
+
+u8 obj_parse_should_match_across_chunk_boundaries() {
+    // The midpoint, where a split into two chunks would fall, is inside the usemtl line.
+    const char* obj =
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvt 0 0\nvn 0 0 1\nf 1 2 3\n"
+        "usemtl split_material\n"
+        "f 2 4 3\ng second_group\nf 1/1/1 2/1/1 4/1/1\n";
+    u64 size = string_length(obj);
+    const char* line_start = obj + size / 2;
+    while (line_start > obj && line_start[-1] != '\n') {
+        line_start--;
+    }
+    expect_to_be_true(line_start < obj + size / 2 && line_start[0] == 'u');
+
+    obj_parse_result single;
+    obj_parse(obj, size, 1, &single);
+    expect_should_be(3, single.face_count);
+    expect_should_be(2, darray_length(single.directives));
+    expect_should_be(OBJ_DIRECTIVE_USEMTL, single.directives[0].type);
+    expect_should_be(1, single.directives[0].face_index);
+    expect_to_be_true(strings_equal("split_material", single.directives[0].text));
+    expect_should_be(OBJ_DIRECTIVE_GROUP, single.directives[1].type);
+    expect_should_be(2, single.directives[1].face_index);
+
+    obj_parse_result split;
+    obj_parse(obj, size, 2, &split);
+    expect_to_be_true(parse_results_equal(&single, &split));
+    obj_parse_result_destroy(&split);
+    obj_parse_result_destroy(&single);
+
+    // A longer file, split at every count of chunks up to more chunks than lines.
+    const char* block =
+        "g part\nusemtl material_a\nv 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0.5 0.5\nvn 0 0 1\n"
+        "f 1/1/1 2/1/1 3/1/1\nusemtl material_b\nf 3//1 2//1 1//1 4//1\n";
+    u64 block_length = string_length(block);
+    u32 block_count = 16;
+    u64 long_size = block_length * block_count;
+    char* long_obj = kallocate(long_size, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < block_count; ++i) {
+        kcopy_memory(long_obj + block_length * i, block, block_length);
+    }
+    obj_parse(long_obj, long_size, 1, &single);
+    expect_should_be(block_count * 3, single.face_count);
+    for (u32 chunk_count = 2; chunk_count <= 200; chunk_count += chunk_count < 16 ? 1 : 61) {
+        obj_parse(long_obj, long_size, chunk_count, &split);
+        expect_to_be_true(parse_results_equal(&single, &split));
+        obj_parse_result_destroy(&split);
+    }
+    obj_parse_result_destroy(&single);
+    kfree(long_obj, long_size, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void mesh_loader_register_tests() {
+    test_manager_register_test(ksm_should_round_trip_in_place, "Ksm files should load back what was written, in place.");
+    test_manager_register_test(ksm_should_reject_malformed_files, "Ksm files that are truncated, misaligned, out of range or of an unknown version should be rejected.");
+    test_manager_register_test(obj_parse_should_parse_each_face_form, "Obj faces should parse in each of the v, v/t, v//n and v/t/n forms.");
+    test_manager_register_test(obj_parse_should_split_polygons_into_fans, "Obj polygons should be split into triangle fans.");
+    test_manager_register_test(obj_parse_should_match_across_chunk_boundaries, "Obj files parsed in chunks should match a single-chunk parse.");
+}
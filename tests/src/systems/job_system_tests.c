@@ -0,0 +1,127 @@
+#include "job_system_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/kmemory.h>
+#include <platform/platform.h>
+#include <systems/job_system.h>
+
+static void* create_job_system(u64* out_memory_requirement) {
+    job_system_config config;
+    config.worker_count = 3;
+    job_system_initialize(out_memory_requirement, 0, config);
+    void* state = kallocate(*out_memory_requirement, MEMORY_TAG_JOB);
+    if (!job_system_initialize(out_memory_requirement, state, config)) {
+        kfree(state, *out_memory_requirement, MEMORY_TAG_JOB);
+        return 0;
+    }
+    return state;
+}
+
+static void destroy_job_system(void* state, u64 memory_requirement) {
+    job_system_shutdown(state);
+    kfree(state, memory_requirement, MEMORY_TAG_JOB);
+}
+
+static void increment_job(void* params) {
+    platform_atomic_fetch_add_u32((volatile u32*)params, 1);
+}
+
+u8 job_system_should_run_all_submitted_jobs() {
+    u64 memory_requirement = 0;
+    void* state = create_job_system(&memory_requirement);
+    expect_should_not_be(0, state);
+
+    volatile u32 value = 0;
+    job_counter counter = {0};
+    for (u32 i = 0; i < 2000; ++i) {
+        job_info job = {increment_job, (void*)&value, &counter, i % 2 ? JOB_PRIORITY_LOW : JOB_PRIORITY_HIGH};
+        job_system_submit(job);
+    }
+    job_system_wait(&counter);
+
+    expect_to_be_true(job_counter_is_complete(&counter));
+    expect_should_be(2000, platform_atomic_load_u32(&value));
+
+    destroy_job_system(state, memory_requirement);
+    return true;
+}
+
+static void mark_range(u32 start, u32 end, void* params) {
+    u8* marks = params;
+    for (u32 i = start; i < end; ++i) {
+        marks[i]++;
+    }
+}
+
+u8 job_system_parallel_for_should_cover_range_once() {
+    u64 memory_requirement = 0;
+    void* state = create_job_system(&memory_requirement);
+    expect_should_not_be(0, state);
+
+    const u32 count = 100003;
+    u8* marks = kallocate(count, MEMORY_TAG_ARRAY);
+    job_system_parallel_for(count, 64, mark_range, marks, JOB_PRIORITY_HIGH);
+
+    for (u32 i = 0; i < count; ++i) {
+        expect_should_be(1, marks[i]);
+    }
+
+    kfree(marks, count, MEMORY_TAG_ARRAY);
+    destroy_job_system(state, memory_requirement);
+    return true;
+}
+
+typedef struct nested_job_params {
+    volatile u32 value;
+} nested_job_params;
+
+static void parent_job(void* params) {
+    // Jobs waiting on other jobs should run them rather than deadlock.
+    job_counter children = {0};
+    for (u32 i = 0; i < 10; ++i) {
+        job_info job = {increment_job, params, &children, JOB_PRIORITY_HIGH};
+        job_system_submit(job);
+    }
+    job_system_wait(&children);
+}
+
+u8 job_system_jobs_should_wait_on_other_jobs() {
+    u64 memory_requirement = 0;
+    void* state = create_job_system(&memory_requirement);
+    expect_should_not_be(0, state);
+
+    nested_job_params params = {0};
+    job_counter counter = {0};
+    for (u32 i = 0; i < 50; ++i) {
+        job_info job = {parent_job, (void*)&params.value, &counter, JOB_PRIORITY_LOW};
+        job_system_submit(job);
+    }
+    job_system_wait(&counter);
+
+    expect_should_be(500, platform_atomic_load_u32(&params.value));
+
+    destroy_job_system(state, memory_requirement);
+    return true;
+}
+
+u8 job_system_should_run_inline_when_not_running() {
+    volatile u32 value = 0;
+    job_counter counter = {0};
+    job_info job = {increment_job, (void*)&value, &counter, JOB_PRIORITY_HIGH};
+    job_system_submit(job);
+
+    // Nothing to wait for, as it has already run.
+    expect_to_be_true(job_counter_is_complete(&counter));
+    expect_should_be(1, value);
+    return true;
+}
+
+void job_system_register_tests() {
+    test_manager_register_test(job_system_should_run_all_submitted_jobs, "Job system should run all submitted jobs.");
+    test_manager_register_test(job_system_parallel_for_should_cover_range_once, "Parallel for should process every index exactly once.");
+    test_manager_register_test(job_system_jobs_should_wait_on_other_jobs, "Jobs should be able to wait on other jobs.");
+    test_manager_register_test(job_system_should_run_inline_when_not_running, "Jobs should run inline when the job system is not running.");
+}